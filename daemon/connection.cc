@@ -46,10 +46,14 @@
 #include <utilities/logtags.h>
 #include <gsl/gsl>
 
+#include <algorithm>
 #include <cctype>
+#include <cstring>
 #include <exception>
+#include <iterator>
 #ifndef WIN32
 #include <netinet/tcp.h> // For TCP_NODELAY etc
+#include <unistd.h>
 #endif
 
 /// The TLS packet is using the following format:
@@ -528,6 +532,11 @@ void Connection::updateDescription() {
 }
 
 void Connection::setBucketIndex(int bucketIndex) {
+    // Any prefetched items belong to the bucket we're leaving (which may be
+    // deleted once we've left), so they must be released now. Items held
+    // for zerocopy sends were handed over by disassociate_bucket.
+    clearPrefetchedGets();
+
     Connection::bucketIndex.store(bucketIndex, std::memory_order_relaxed);
 
     // Update the privilege context. If a problem occurs within the RBAC
@@ -856,6 +865,190 @@ int Connection::sslPreConnection() {
     return 0;
 }
 
+bool Connection::batchResponse() {
+    const auto limit = Settings::instance().getSendBatchSize();
+    if (limit == 0 || ssl.isEnabled() || isDCP() || zerocopyItem ||
+        write_and_go != StateMachine::State::new_cmd || !isPacketAvailable()) {
+        return false;
+    }
+
+    // Only small responses are copied into the batch; the cost of copying
+    // a large one (e.g. one carrying a document value) outweighs the
+    // system call saved. A large response is instead sent straight from
+    // its IO vector, along with (and after) the batch by sendmsgWithBatch.
+    static constexpr std::size_t MaxBatchedResponseSize = 4096;
+    size_t size = 0;
+    for (auto ii = msgcurr; ii < msglist.size(); ++ii) {
+        for (int jj = 0; jj < int(msglist[ii].msg_iovlen); ++jj) {
+            size += msglist[ii].msg_iov[jj].iov_len;
+        }
+    }
+    if (size > MaxBatchedResponseSize || sendBatch.size() + size > limit) {
+        return false;
+    }
+
+    // Copy the response (it references the write buffer, reserved items
+    // and temporary allocations, all of which are released once we report
+    // the transmit as complete)
+    for (auto ii = msgcurr; ii < msglist.size(); ++ii) {
+        for (int jj = 0; jj < int(msglist[ii].msg_iovlen); ++jj) {
+            const auto& entry = msglist[ii].msg_iov[jj];
+            sendBatch.append(static_cast<const char*>(entry.iov_base),
+                             entry.iov_len);
+        }
+    }
+    msgcurr = msglist.size();
+    write->consumed(write->rsize());
+    return true;
+}
+
+ssize_t Connection::sendmsgWithBatch(struct msghdr* m) {
+    const auto count = std::min(size_t(m->msg_iovlen), size_t(IOV_MAX - 1));
+    std::vector<iovec> vec;
+    vec.reserve(count + 1);
+    vec.push_back({const_cast<char*>(sendBatch.data()), sendBatch.size()});
+    std::copy(m->msg_iov, m->msg_iov + count, std::back_inserter(vec));
+
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = vec.data();
+    msg.msg_iovlen = vec.size();
+
+    const auto res = cb::net::sendmsg(socketDescriptor, &msg, 0);
+    if (res > 0) {
+        totalSend += res;
+    }
+    return res;
+}
+
+bool Connection::flushSendBatch() {
+    while (!sendBatch.empty()) {
+        const auto res = cb::net::send(
+                socketDescriptor, sendBatch.data(), sendBatch.size(), 0);
+        if (res <= 0) {
+            // The socket buffer is full (or the socket is broken); the rest
+            // is sent (or the error detected) by transmit()
+            return false;
+        }
+        totalSend += res;
+        get_thread_stats(this)->bytes_written += res;
+        sendBatch.erase(0, size_t(res));
+    }
+    return true;
+}
+
+bool Connection::enableZerocopy() {
+#ifdef HAVE_MSG_ZEROCOPY
+    if (zerocopyState == ZerocopyState::Unknown) {
+        int enable = 1;
+        if (cb::net::setsockopt(socketDescriptor,
+                                SOL_SOCKET,
+                                SO_ZEROCOPY,
+                                &enable,
+                                sizeof(enable)) == 0) {
+            zerocopyState = ZerocopyState::Enabled;
+        } else {
+            LOG_DEBUG("{}: Failed to enable SO_ZEROCOPY: {}",
+                      getId(),
+                      cb_strerror());
+            zerocopyState = ZerocopyState::Disabled;
+        }
+    }
+    return zerocopyState == ZerocopyState::Enabled;
+#else
+    return false;
+#endif
+}
+
+bool Connection::addZerocopyIov(const void* buf,
+                                size_t len,
+                                cb::unique_item_ptr& item) {
+    const auto threshold = Settings::instance().getZerocopyThreshold();
+    if (threshold == 0 || len < threshold || ssl.isEnabled() ||
+        zerocopyItem || !enableZerocopy()) {
+        return false;
+    }
+
+    addMsgHdr(false);
+    zerocopyMsg = msglist.size() - 1;
+    addIov(buf, len);
+    zerocopyItem = std::move(item);
+    zerocopyItemSeq = zerocopy.getSeq();
+    return true;
+}
+
+ssize_t Connection::sendmsgZerocopy(struct msghdr* m) {
+#ifdef HAVE_MSG_ZEROCOPY
+    auto res = cb::net::sendmsg(socketDescriptor, m, MSG_ZEROCOPY);
+    if (res > 0) {
+        zerocopy.sent();
+    } else if (res == -1 && cb::net::get_socket_error() == ENOBUFS) {
+        // Too many notifications outstanding (they're accounted against
+        // the socket's optmem limit); send this chunk the normal way
+        res = cb::net::sendmsg(socketDescriptor, m, 0);
+    }
+#else
+    auto res = cb::net::sendmsg(socketDescriptor, m, 0);
+#endif
+    if (res > 0) {
+        totalSend += res;
+    }
+    return res;
+}
+
+void Connection::retireZerocopyItem() {
+    if (zerocopy.getSeq() == zerocopyItemSeq) {
+        // None of it was sent with MSG_ZEROCOPY, so the kernel holds no
+        // reference to the value
+        zerocopyItem.reset();
+    } else {
+        zerocopy.retire(std::move(zerocopyItem));
+    }
+}
+
+void Connection::reapZerocopyCompletions() {
+    if (zerocopy.reap(socketDescriptor)) {
+        // The kernel had to copy the data anyway (e.g. loopback), so
+        // zerocopy only adds overhead for this connection
+        zerocopyState = ZerocopyState::Disabled;
+    }
+}
+
+bool Connection::deferZerocopySends() {
+#ifdef HAVE_MSG_ZEROCOPY
+    if (zerocopyItem) {
+        // A response is completely sent before the next command executes
+        // (or abandoned as the connection closes), so the kernel can only
+        // reference the item through the sends already made
+        retireZerocopyItem();
+    }
+    reapZerocopyCompletions();
+    if (!zerocopy.hasPending()) {
+        return false;
+    }
+
+    // The thread needs its own descriptor for the socket to read the
+    // completions from, as the connection may close before they arrive
+    auto sock = ::dup(socketDescriptor);
+    if (sock == -1) {
+        LOG_WARNING(
+                "{}: Failed to duplicate the socket to reap zerocopy "
+                "completions on: {}. Holding the items until shutdown",
+                getId(),
+                cb_strerror());
+    }
+    getThread().deferred_zerocopy.push(
+            sock, std::move(zerocopy), getBucket());
+    zerocopy = ZerocopySends();
+    zerocopyState = ZerocopyState::Disabled;
+    zerocopyDeferred = true;
+    notify_thread(getThread());
+    return true;
+#else
+    return false;
+#endif
+}
+
 int Connection::recv(char* dest, size_t nbytes) {
     if (nbytes == 0) {
         throw std::logic_error("Connection::recv: Can't read 0 bytes");
@@ -989,21 +1182,53 @@ Connection::TransmitResult Connection::transmit() {
         // buffer to send to the client). Go ahead and send more data
     }
 
+    if (zerocopy.inFlight()) {
+        reapZerocopyCompletions();
+    }
+
     while (msgcurr < msglist.size() && msglist[msgcurr].msg_iovlen == 0) {
         /* Finished writing the current msg; advance to the next. */
         msgcurr++;
     }
 
-    if (msgcurr < msglist.size()) {
-        ssize_t res;
-        struct msghdr* m = &msglist[msgcurr];
+    if (msgcurr < msglist.size() && batchResponse()) {
+        return TransmitResult::Complete;
+    }
 
-        res = sendmsg(m);
+    if (msgcurr < msglist.size() || !sendBatch.empty()) {
+        ssize_t res;
+        // With no response of our own we're just sending the batched
+        // responses flushSendBatch() couldn't
+        struct msghdr empty;
+        memset(&empty, 0, sizeof(empty));
+        struct msghdr* m =
+                msgcurr < msglist.size() ? &msglist[msgcurr] : &empty;
+
+        if (!sendBatch.empty()) {
+            res = sendmsgWithBatch(m);
+        } else if (zerocopyItem && msgcurr == zerocopyMsg) {
+            res = sendmsgZerocopy(m);
+        } else {
+            res = sendmsg(m);
+        }
         auto error = cb::net::get_socket_error();
         if (res > 0) {
             get_thread_stats(this)->bytes_written += res;
 
-            if (adjust_msghdr(*write, m, res) == 0) {
+            // The batched responses were sent first
+            const auto batched = std::min(size_t(res), sendBatch.size());
+            sendBatch.erase(0, batched);
+            res -= ssize_t(batched);
+
+            if (m == &empty) {
+                return sendBatch.empty() ? TransmitResult::Complete
+                                         : TransmitResult::Incomplete;
+            }
+
+            if (res > 0 && adjust_msghdr(*write, m, res) == 0) {
+                if (zerocopyItem && msgcurr == zerocopyMsg) {
+                    retireZerocopyItem();
+                }
                 msgcurr++;
                 if (msgcurr == msglist.size()) {
                     // We sent the final chunk of data.. In our SSL connections
@@ -1253,9 +1478,14 @@ bool Connection::dcpUseWriteBuffer(size_t size) const {
 
 void Connection::addMsgHdr(bool reset) {
     if (reset) {
+        if (zerocopyItem) {
+            // The previous response was abandoned part way
+            retireZerocopyItem();
+        }
         msgcurr = 0;
         msglist.clear();
         iovused = 0;
+        msgbytesQueued = 0;
     }
 
     msglist.emplace_back();
@@ -1279,8 +1509,10 @@ void Connection::addIov(const void* buf, size_t len) {
 
     struct msghdr* m = &msglist.back();
 
-    /* We may need to start a new msghdr if this one is full. */
-    if (m->msg_iovlen == IOV_MAX) {
+    /* We may need to start a new msghdr if this one is full (or is
+       reserved for the value of the zerocopy item) */
+    if (m->msg_iovlen == IOV_MAX ||
+        (zerocopyItem && zerocopyMsg == msglist.size() - 1)) {
         addMsgHdr(false);
     }
 
@@ -1309,6 +1541,7 @@ void Connection::addIov(const void* buf, size_t len) {
     }
 
     msgbytes += len;
+    msgbytesQueued += len;
 }
 
 void Connection::releaseReservedItems() {
@@ -1319,6 +1552,34 @@ void Connection::releaseReservedItems() {
     reservedItems.clear();
 }
 
+void Connection::addPrefetchedGet(cb::const_byte_buffer key,
+                                  Vbid vbucket,
+                                  cb::EngineErrorItemPair result) {
+    prefetchedGets.push_back(
+            {{reinterpret_cast<const char*>(key.data()), key.size()},
+             vbucket,
+             std::move(result)});
+}
+
+bool Connection::takePrefetchedGet(cb::const_byte_buffer key,
+                                   Vbid vbucket,
+                                   cb::EngineErrorItemPair& result) {
+    if (prefetchedGets.empty()) {
+        return false;
+    }
+
+    auto& next = prefetchedGets.front();
+    if (next.vbucket != vbucket || next.key.size() != key.size() ||
+        std::memcmp(next.key.data(), key.data(), key.size()) != 0) {
+        prefetchedGets.clear();
+        return false;
+    }
+
+    result = std::move(next.result);
+    prefetchedGets.pop_front();
+    return true;
+}
+
 void Connection::ensureIovSpace() {
     if (iovused < iov.size()) {
         // There is still size in the list
@@ -1408,6 +1669,7 @@ Connection::~Connection() {
     }
 
     releaseReservedItems();
+    clearPrefetchedGets();
     for (auto* ptr : temp_alloc) {
         cb_free(ptr);
     }
@@ -1504,6 +1766,18 @@ bool Connection::processServerEvents() {
 }
 
 void Connection::runEventLoop(short which) {
+    if (zerocopy.inFlight()) {
+        // The completions are queued on the socket error queue, which keeps
+        // the socket reported as ready until we've read them
+        reapZerocopyCompletions();
+    }
+
+    if (zerocopyDeferred) {
+        // The completions of the sends handed over to the thread are queued
+        // on our socket too
+        thread.deferred_zerocopy.reap();
+    }
+
     conn_loan_buffers(this);
     currentEvent = which;
     numEvents = max_reqs_per_event;
@@ -1600,12 +1874,24 @@ bool Connection::close() {
             unregisterEvent();
         }
 
+        // Send what we can of the responses to the preceding commands
+        flushSendBatch();
+        sendBatch.clear();
+
         // Shut down the read end of the socket to avoid more data
-        // to arrive
-        shutdown(socketDescriptor, SHUT_RD);
+        // to arrive. If the thread holds (or is about to hold) a descriptor
+        // for the socket to reap zerocopy completions on, closing ours
+        // won't close the socket, so shut down the write end too.
+        if (zerocopyDeferred || zerocopyItem || zerocopy.hasPending()) {
+            shutdown(socketDescriptor, SHUT_RDWR);
+        } else {
+            shutdown(socketDescriptor, SHUT_RD);
+        }
 
-        // Release all reserved items!
+        // Release all reserved items! (The items held for zerocopy sends
+        // are handed over to the thread by disassociate_bucket)
         releaseReservedItems();
+        clearPrefetchedGets();
     }
 
     // Notify interested parties that the connection is currently being
@@ -22,6 +22,7 @@
 #include "statemachine.h"
 #include "stats.h"
 #include "task.h"
+#include "zerocopy_sends.h"
 
 #include <cbsasl/client.h>
 #include <cbsasl/server.h>
@@ -29,6 +30,7 @@
 #include <event.h>
 #include <mcbp/protocol/unsigned_leb128.h>
 #include <memcached/dcp.h>
+#include <memcached/engine.h>
 #include <memcached/openssl.h>
 #include <memcached/rbac.h>
 #include <nlohmann/json_fwd.hpp>
@@ -37,6 +39,7 @@
 
 #include <array>
 #include <chrono>
+#include <deque>
 #include <memory>
 #include <queue>
 #include <string>
@@ -277,6 +280,20 @@ public:
 
     void setBucketIndex(int bucketIndex);
 
+    /**
+     * The connection is leaving its bucket (or closing) while the kernel
+     * may still be sending the values of items from the bucket with
+     * MSG_ZEROCOPY. Those items can't be released until the kernel reports
+     * the sends as completed, so hand them (and the connection's reference
+     * to the bucket) over to the front end thread which releases them once
+     * it has reaped the completions. Zerocopy is disabled for the rest of
+     * the connection's lifetime, as the completions of any further sends
+     * would be reaped by the thread.
+     *
+     * @return true if the thread now holds the reference to the bucket
+     */
+    bool deferZerocopySends();
+
     Bucket& getBucket() const;
 
     EngineIface* getBucketEngine() const;
@@ -556,6 +573,17 @@ public:
      */
     TransmitResult transmit();
 
+    /**
+     * Try to send any responses batched up by transmit() (see sendBatch)
+     * without blocking. Called when the connection stops processing its
+     * pipeline (it runs out of input, blocks, yields or closes) so the
+     * client doesn't have to wait for them. Whatever can't be sent now is
+     * sent by the next transmit().
+     *
+     * @return true if there is nothing left to send
+     */
+    bool flushSendBatch();
+
     enum class TryReadResult {
         /** Data received on the socket and ready to parse */
         DataReceived,
@@ -603,6 +631,14 @@ public:
         return iovused;
     }
 
+    /**
+     * Get the number of bytes queued in the message headers since they were
+     * last reset
+     */
+    size_t getMsgBytesQueued() const {
+        return msgbytesQueued;
+    }
+
     /**
      * Adds a message header to a connection.
      *
@@ -620,6 +656,24 @@ public:
      */
     void addIov(const void* buf, size_t len);
 
+    /**
+     * Add the value of an item to the IO vector, to be sent with
+     * MSG_ZEROCOPY (in a message header of its own so that nothing else,
+     * like the response header in the write buffer, gets pinned by the
+     * kernel). If the value is added the connection takes over the item
+     * and keeps it until the kernel reports that it is done with the data.
+     *
+     * @param buf pointer to the value (which must live inside the item)
+     * @param len number of bytes to send
+     * @param item the item owning the value
+     * @return true if the value was added, false if zerocopy isn't enabled
+     *         or applicable (the caller should use addIov instead)
+     * @throws std::bad_alloc
+     */
+    bool addZerocopyIov(const void* buf,
+                        size_t len,
+                        cb::unique_item_ptr& item);
+
     /**
      * Release all of the items we've saved a reference to
      */
@@ -640,6 +694,35 @@ public:
         }
     }
 
+    /**
+     * Remember the result of looking up a GET which is pipelined behind the
+     * command currently executing, so that the GET doesn't have to go to the
+     * engine itself (see GetCommandContext). Results must be added in the
+     * order the commands appear in the input buffer.
+     */
+    void addPrefetchedGet(cb::const_byte_buffer key,
+                          Vbid vbucket,
+                          cb::EngineErrorItemPair result);
+
+    /**
+     * Take the prefetched result for the GET about to be executed.
+     *
+     * @param key the key in the request
+     * @param vbucket the vbucket in the request
+     * @param result set to the prefetched result if there is one
+     * @return true if the next prefetched result is for this key; if not
+     *         all prefetched results are dropped (the pipeline didn't
+     *         execute as predicted) and false is returned
+     */
+    bool takePrefetchedGet(cb::const_byte_buffer key,
+                           Vbid vbucket,
+                           cb::EngineErrorItemPair& result);
+
+    /// Drop all prefetched GET results (releasing the items)
+    void clearPrefetchedGets() {
+        prefetchedGets.clear();
+    }
+
     void releaseTempAlloc() {
         for (auto* ptr : temp_alloc) {
             cb_free(ptr);
@@ -992,6 +1075,50 @@ protected:
      */
     void ensureIovSpace();
 
+    /**
+     * Move the response being transmitted into sendBatch if the next command
+     * is already available, the response is small and the batch has room
+     * for it.
+     *
+     * @return true if the response was batched (and is complete as far as
+     *         the state machine is concerned)
+     */
+    bool batchResponse();
+
+    /**
+     * Send the batched responses followed by (as much as fits in the same
+     * call of) the message header.
+     *
+     * @return the total number of bytes sent, or -1 for an error
+     */
+    ssize_t sendmsgWithBatch(struct msghdr* m);
+
+    /**
+     * Enable SO_ZEROCOPY on the socket (the first time we want to use it)
+     *
+     * @return true if MSG_ZEROCOPY may be used on this connection
+     */
+    bool enableZerocopy();
+
+    /**
+     * Send the message header containing the zerocopy item's value with
+     * MSG_ZEROCOPY (falling back to a copy if the kernel is out of
+     * resources to track the send).
+     */
+    ssize_t sendmsgZerocopy(struct msghdr* m);
+
+    /**
+     * The value of zerocopyItem is completely handed over to the kernel;
+     * keep the item until the kernel reports it is done with it.
+     */
+    void retireZerocopyItem();
+
+    /**
+     * Read the zerocopy completion notifications from the socket error
+     * queue and release the items the kernel is done with.
+     */
+    void reapZerocopyCompletions();
+
     /**
      * Try to enable SSL for this connection
      *
@@ -1235,6 +1362,8 @@ protected:
     size_t msgcurr = 0;
     /** number of bytes in current msg */
     size_t msgbytes = 0;
+    /** number of bytes in all msgs */
+    size_t msgbytesQueued = 0;
 
     /**
      * List of items we've reserved during the command (should call
@@ -1242,6 +1371,19 @@ protected:
      */
     std::vector<void*> reservedItems;
 
+    /// A GET looked up ahead of time by addPrefetchedGet()
+    struct PrefetchedGet {
+        std::string key;
+        Vbid vbucket;
+        cb::EngineErrorItemPair result;
+    };
+
+    /**
+     * Results of the GETs pipelined behind the command currently executing,
+     * in the order of the input buffer.
+     */
+    std::deque<PrefetchedGet> prefetchedGets;
+
     /**
      * A vector of temporary allocations that should be freed when the
      * the connection is done sending all of the data. Use pushTempAlloc to
@@ -1267,6 +1409,36 @@ protected:
     // Total number of bytes sent to the network
     size_t totalSend = 0;
 
+    /**
+     * Responses to pipelined commands which haven't been sent yet. When the
+     * next command is already in the input buffer (and send_batch_size
+     * allows) transmit() copies a small response here instead of sending
+     * it, so the responses to a pipeline go out with a single sendmsg.
+     * Large responses aren't copied; they're sent from their own IO vector
+     * in the same sendmsg as the batch.
+     */
+    std::string sendBatch;
+
+    /// Is SO_ZEROCOPY enabled on the socket?
+    enum class ZerocopyState : uint8_t { Unknown, Enabled, Disabled };
+    ZerocopyState zerocopyState = ZerocopyState::Unknown;
+
+    /**
+     * The item whose value is referenced by msglist[zerocopyMsg] (see
+     * addZerocopyIov)
+     */
+    cb::unique_item_ptr zerocopyItem;
+    size_t zerocopyMsg = 0;
+
+    /// The value of zerocopy.getSeq() when zerocopyItem was added
+    uint32_t zerocopyItemSeq = 0;
+
+    /// The zerocopy sends the kernel hasn't completed yet (and their items)
+    ZerocopySends zerocopy;
+
+    /// Have sends been handed over to the thread (see deferZerocopySends)?
+    bool zerocopyDeferred = false;
+
     /**
      * The list of commands currently being processed. Currently we
      * only use a single entry in this vector (and always reuse that
@@ -17,6 +17,8 @@
 
 #pragma once
 
+#include "zerocopy_sends.h"
+
 #include <JSON_checker.h>
 #include <event.h>
 #include <memcached/engine_error.h>
@@ -36,6 +38,7 @@ namespace cb {
 class Pipe;
 }
 
+class Bucket;
 class Cookie;
 class Connection;
 class ListeningPort;
@@ -116,6 +119,54 @@ struct FrontEndThread {
         std::vector<Connection*> connections;
     } notification;
 
+    /**
+     * Zerocopy sends still in flight when their connection left the bucket
+     * (or closed); see Connection::deferZerocopySends. The items (and a
+     * reference to their bucket) are held until the kernel completes the
+     * sends, which it does once the data is acknowledged (or the
+     * connection is reset or times out).
+     */
+    class DeferredZerocopySends {
+    public:
+        /**
+         * Take over the sends (and the reference to the bucket)
+         *
+         * @param sock a descriptor for the socket owned by this object, or
+         *             INVALID_SOCKET to hold the items until abort()
+         */
+        void push(SOCKET sock, ZerocopySends sends, Bucket& bucket);
+
+        /**
+         * Reap the completions and release the items (and buckets) the
+         * kernel is done with.
+         *
+         * @return true if sends are still in flight
+         */
+        bool reap();
+
+        /**
+         * Reset the sockets, which discards the data not yet sent, so the
+         * items may be released. Only valid once the connections using the
+         * sockets are closed.
+         */
+        void abort();
+
+    protected:
+        struct Entry {
+            SOCKET sock;
+            ZerocopySends sends;
+            Bucket* bucket;
+        };
+
+        static void release(Entry& entry);
+
+        std::mutex mutex;
+        std::vector<Entry> entries;
+    } deferred_zerocopy;
+
+    /// Timer reaping deferred_zerocopy while it holds sends in flight
+    struct event zerocopy_event = {};
+
     /// index of this thread in the threads array
     size_t index = 0;
 
@@ -209,7 +209,11 @@ static void set_stats_reset_time()
 void disassociate_bucket(Connection& connection) {
     Bucket& b = connection.getBucket();
     std::lock_guard<std::mutex> guard(b.mutex);
-    b.clients--;
+    // The items held for zerocopy sends in flight keep the bucket
+    // referenced until the kernel has completed the sends
+    if (!connection.deferZerocopySends()) {
+        b.clients--;
+    }
 
     connection.setBucketIndex(0);
 
@@ -218,6 +222,15 @@ void disassociate_bucket(Connection& connection) {
     }
 }
 
+void release_bucket_reference(Bucket& b) {
+    std::lock_guard<std::mutex> guard(b.mutex);
+    b.clients--;
+
+    if (b.clients == 0 && b.state == Bucket::State::Destroying) {
+        b.cond.notify_one();
+    }
+}
+
 bool associate_bucket(Connection& connection, const char* name) {
     bool found = false;
 
@@ -56,6 +56,7 @@ extern struct stats stats;
 namespace cb {
 class Pipe;
 }
+class Bucket;
 class Cookie;
 class Connection;
 struct thread_stats;
@@ -118,6 +119,7 @@ SERVER_HANDLE_V1* get_server_api();
 void shutdown_server();
 bool associate_bucket(Connection& connection, const char* name);
 void disassociate_bucket(Connection& connection);
+void release_bucket_reference(Bucket& bucket);
 
 void disable_listen();
 bool is_listen_disabled();
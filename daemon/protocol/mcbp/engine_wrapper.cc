@@ -187,6 +187,14 @@ cb::EngineErrorItemPair bucket_get(Cookie& cookie,
     return ret;
 }
 
+std::vector<cb::EngineErrorItemPair> bucket_get_multi(
+        Cookie& cookie,
+        const std::vector<std::pair<DocKey, Vbid>>& keys,
+        DocStateFilter documentStateFilter) {
+    auto& c = cookie.getConnection();
+    return c.getBucketEngine()->get_multi(&cookie, keys, documentStateFilter);
+}
+
 BucketCompressionMode bucket_get_compression_mode(Cookie& cookie) {
     auto& c = cookie.getConnection();
     return c.getBucketEngine()->getCompressionMode();
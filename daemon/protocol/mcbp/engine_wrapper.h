@@ -85,6 +85,11 @@ cb::EngineErrorItemPair bucket_get(
         Vbid vbucket,
         DocStateFilter documentStateFilter = DocStateFilter::Alive);
 
+std::vector<cb::EngineErrorItemPair> bucket_get_multi(
+        Cookie& cookie,
+        const std::vector<std::pair<DocKey, Vbid>>& keys,
+        DocStateFilter documentStateFilter = DocStateFilter::Alive);
+
 cb::EngineErrorItemPair bucket_get_if(
         Cookie& cookie,
         const DocKey& key,
@@ -22,14 +22,119 @@
 #include <daemon/debug_helpers.h>
 #include <daemon/mcaudit.h>
 #include <daemon/mcbp.h>
+#include <daemon/mcbp_privileges.h>
+#include <daemon/mcbp_validators.h>
 #include <daemon/memcached.h>
+#include <memcached/dockey.h>
 #include <logger/logger.h>
 #include <xattr/utils.h>
 #include <gsl/gsl>
 
+/**
+ * Is the packet a GET which may be looked up ahead of its execution? It must
+ * be a plain (no framing extras or value) GET; anything else ends the run of
+ * pipelined GETs. The packet must still pass validation and the access check
+ * (see mayPrefetch).
+ */
+static bool isPipelinedGet(const cb::mcbp::Request& req) {
+    if (req.getMagic() != cb::mcbp::Magic::ClientRequest) {
+        return false;
+    }
+
+    switch (req.getClientOpcode()) {
+    case cb::mcbp::ClientOpcode::Get:
+    case cb::mcbp::ClientOpcode::Getq:
+    case cb::mcbp::ClientOpcode::Getk:
+    case cb::mcbp::ClientOpcode::Getkq:
+        break;
+    default:
+        return false;
+    }
+
+    const auto key = req.getKey();
+    return req.getExtlen() == 0 && !key.empty() &&
+           req.getBodylen() == key.size();
+}
+
+/**
+ * May the pipelined GET in the given cookie be looked up ahead of its
+ * execution? Only if it passes the same packet validator and RBAC check it
+ * will be subject to when executed; otherwise the lookup could read a
+ * document the connection has no access to (or use a malformed key).
+ */
+static bool mayPrefetch(Cookie& cookie) {
+    static McbpValidator validator;
+    static McbpPrivilegeChains privilegeChains;
+
+    const auto opcode = cookie.getRequest().getClientOpcode();
+    return validator.validate(opcode, cookie) == cb::mcbp::Status::Success &&
+           privilegeChains.invoke(opcode, cookie) ==
+                   cb::rbac::PrivilegeAccess::Ok;
+}
+
+cb::EngineErrorItemPair GetCommandContext::getPipelinedItems(
+        const DocKey& key) {
+    std::vector<std::pair<DocKey, Vbid>> keys;
+    keys.emplace_back(key, vbucket);
+
+    // Collect the run of complete GET packets following this command
+    const auto input = connection.read->rdata();
+    auto offset = cookie.getPacket(Cookie::PacketContent::Full).size();
+    Cookie candidate(connection);
+    while (keys.size() < MaxPipelinedGets &&
+           input.size() - offset >= sizeof(cb::mcbp::Request)) {
+        const auto* req = reinterpret_cast<const cb::mcbp::Request*>(
+                input.data() + offset);
+        const auto size = sizeof(cb::mcbp::Request) + req->getBodylen();
+        if (input.size() - offset < size || !isPipelinedGet(*req)) {
+            break;
+        }
+        candidate.reset();
+        candidate.setPacket(Cookie::PacketContent::Full,
+                            {input.data() + offset, size});
+        if (!mayPrefetch(candidate)) {
+            break;
+        }
+        keys.emplace_back(connection.makeDocKey(req->getKey()),
+                          req->getVBucket());
+        offset += size;
+    }
+
+    if (keys.size() > 1) {
+        auto results = bucket_get_multi(cookie, keys);
+        if (results.size() == keys.size()) {
+            for (size_t ii = 1; ii < keys.size(); ++ii) {
+                connection.addPrefetchedGet(
+                        {keys[ii].first.data(), keys[ii].first.size()},
+                        keys[ii].second,
+                        std::move(results[ii]));
+            }
+            return std::move(results.front());
+        }
+    }
+
+    return cb::makeEngineErrorItemPair(cb::engine_errc::would_block);
+}
+
 ENGINE_ERROR_CODE GetCommandContext::getItem() {
     const auto key = cookie.getRequestKey();
-    auto ret = bucket_get(cookie, key, vbucket);
+
+    // The first time through, use the result of a GET earlier in the
+    // pipeline which looked this key up; or else look up this key along
+    // with any GETs pipelined behind it.
+    auto ret = cb::makeEngineErrorItemPair(cb::engine_errc::would_block);
+    if (!pipelineChecked) {
+        pipelineChecked = true;
+        if (!connection.takePrefetchedGet(
+                    cookie.getRequest().getKey(), vbucket, ret)) {
+            ret = getPipelinedItems(key);
+        }
+    }
+
+    if (ret.first != cb::engine_errc::success &&
+        ret.first != cb::engine_errc::no_such_key) {
+        ret = bucket_get(cookie, key, vbucket);
+    }
     if (ret.first == cb::engine_errc::success) {
         it = std::move(ret.second);
         if (!bucket_get_item_info(connection, it.get(), &info)) {
@@ -134,7 +239,13 @@ ENGINE_ERROR_CODE GetCommandContext::sendResponse() {
             connection.addIov(key.data(), key.size());
         }
 
-        connection.addIov(payload.buf, payload.len);
+        // Large values living in the item (and not in our inflated copy)
+        // may be handed to the kernel without copying them (in which case
+        // the connection takes over the item)
+        if (buffer.size() != 0 ||
+            !connection.addZerocopyIov(payload.buf, payload.len, it)) {
+            connection.addIov(payload.buf, payload.len);
+        }
         connection.setState(StateMachine::State::send_data);
     }
     cb::audit::document::add(cookie, cb::audit::document::Operation::Read);
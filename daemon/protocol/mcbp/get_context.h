@@ -89,6 +89,18 @@ protected:
      */
     ENGINE_ERROR_CODE getItem();
 
+    /**
+     * Look up the key without blocking, together with the run of GETs
+     * pipelined behind this command which are already in the input buffer
+     * (so they need a single call to the engine). The results for the
+     * following GETs are kept in the connection, where they're picked up
+     * when those commands are executed.
+     *
+     * @return the result for this command's key; would_block if it must be
+     *         looked up with a normal get
+     */
+    cb::EngineErrorItemPair getPipelinedItems(const DocKey& key);
+
     /**
      * Handle the case where the item isn't found. If the client don't want
      * to be notified about misses we'd just update the stats. Otherwise
@@ -115,15 +127,23 @@ protected:
      * the command context object lives until we start the next command
      * we don't need to copy the data into temporary buffers, but can point
      * directly into the actual item (or the temporary allocated inflated
-     * buffer).
+     * buffer). Values above the zerocopy threshold are sent with
+     * MSG_ZEROCOPY, and the item is then kept by the connection until the
+     * kernel is done with it.
      *
      * @return ENGINE_DISCONNECT or ENGINE_SUCCESS
      */
     ENGINE_ERROR_CODE sendResponse();
 
 private:
+    /// The maximum number of GETs to look up in one call to the engine
+    static const size_t MaxPipelinedGets = 128;
+
     const Vbid vbucket;
 
+    /// Set once the pipeline has been considered (on the first getItem())
+    bool pipelineChecked = false;
+
     cb::unique_item_ptr it;
     item_info info;
 
@@ -230,6 +230,21 @@ static void handle_max_concurrent_commands_per_connection(
     s.setMaxConcurrentCommandsPerConnection(obj.get<size_t>());
 }
 
+static void handle_send_batch_size(Settings& s, const nlohmann::json& obj) {
+    if (!obj.is_number_unsigned()) {
+        cb::throwJsonTypeError(R"("send_batch_size" must be an unsigned int)");
+    }
+    s.setSendBatchSize(obj.get<size_t>());
+}
+
+static void handle_zerocopy_threshold(Settings& s, const nlohmann::json& obj) {
+    if (!obj.is_number_unsigned()) {
+        cb::throwJsonTypeError(
+                R"("zerocopy_threshold" must be an unsigned int)");
+    }
+    s.setZerocopyThreshold(obj.get<size_t>());
+}
+
 /**
  * Handle the "tracing_enabled" tag in the settings
  *
@@ -699,6 +714,8 @@ void Settings::reconfigure(const nlohmann::json& json) {
              handle_active_external_users_push_interval},
             {"max_concurrent_commands_per_connection",
              handle_max_concurrent_commands_per_connection},
+            {"send_batch_size", handle_send_batch_size},
+            {"zerocopy_threshold", handle_zerocopy_threshold},
             {"opentracing", handle_opentracing},
             {"portnumber_file", handle_portnumber_file},
             {"parent_identifier", handle_parent_identifier}};
@@ -1183,6 +1200,24 @@ void Settings::updateSettings(const Settings& other, bool apply) {
                     other.getMaxConcurrentCommandsPerConnection());
         }
     }
+
+    if (other.has.send_batch_size) {
+        if (other.getSendBatchSize() != getSendBatchSize()) {
+            LOG_INFO("Change send batch size from {} to {}",
+                     getSendBatchSize(),
+                     other.getSendBatchSize());
+            setSendBatchSize(other.getSendBatchSize());
+        }
+    }
+
+    if (other.has.zerocopy_threshold) {
+        if (other.getZerocopyThreshold() != getZerocopyThreshold()) {
+            LOG_INFO("Change zerocopy threshold from {} to {}",
+                     getZerocopyThreshold(),
+                     other.getZerocopyThreshold());
+            setZerocopyThreshold(other.getZerocopyThreshold());
+        }
+    }
 }
 
 /**
@@ -1378,3 +1413,23 @@ void Settings::setMaxConcurrentCommandsPerConnection(size_t num) {
     has.max_concurrent_commands_per_connection = true;
     notify_changed("max_concurrent_commands_per_connection");
 }
+
+size_t Settings::getSendBatchSize() const {
+    return send_batch_size.load(std::memory_order_consume);
+}
+
+void Settings::setSendBatchSize(size_t size) {
+    send_batch_size.store(size, std::memory_order_release);
+    has.send_batch_size = true;
+    notify_changed("send_batch_size");
+}
+
+size_t Settings::getZerocopyThreshold() const {
+    return zerocopy_threshold.load(std::memory_order_consume);
+}
+
+void Settings::setZerocopyThreshold(size_t size) {
+    zerocopy_threshold.store(size, std::memory_order_release);
+    has.zerocopy_threshold = true;
+    notify_changed("zerocopy_threshold");
+}
@@ -337,6 +337,23 @@ public:
 
     void setMaxConcurrentCommandsPerConnection(size_t num);
 
+    /**
+     * Get the maximum number of bytes of responses to pipelined commands
+     * which may be batched up to be sent with a single system call
+     * (0 == send each response as soon as it is ready)
+     */
+    size_t getSendBatchSize() const;
+
+    void setSendBatchSize(size_t size);
+
+    /**
+     * Get the minimum size of a document value to send with MSG_ZEROCOPY
+     * (0 == always copy the value into the socket buffer)
+     */
+    size_t getZerocopyThreshold() const;
+
+    void setZerocopyThreshold(size_t size);
+
     /**
      * Set the number of request to handle per notification from the
      * event library
@@ -986,6 +1003,13 @@ protected:
     /// blocking execution
     std::atomic<std::size_t> max_concurrent_commands_per_connection{32};
 
+    /// The maximum number of bytes of responses to pipelined commands to
+    /// batch up before sending them
+    std::atomic<std::size_t> send_batch_size{0};
+
+    /// The minimum size of a document value to send with MSG_ZEROCOPY
+    std::atomic<std::size_t> zerocopy_threshold{0};
+
     /// The name of the file to store portnumber information
     /// May also be set in environment (cannot change)
     std::string portnumber_file;
@@ -1040,6 +1064,8 @@ public:
         bool max_connections = false;
         bool system_connections = false;
         bool max_concurrent_commands_per_connection = false;
+        bool send_batch_size = false;
+        bool zerocopy_threshold = false;
         bool opentracing_config = false;
 
         bool portnumber_file = false;
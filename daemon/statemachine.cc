@@ -144,6 +144,14 @@ bool StateMachine::execute() {
     throw std::invalid_argument("execute(): invalid state");
 }
 
+/**
+ * The maximum number of bytes conn_ship_log queues for sending before
+ * writing them to the socket. Sent bytes are also bounded by the producer's
+ * flow control buffer, so this mostly limits the latency of the first
+ * message in a batch.
+ */
+static constexpr size_t DcpMaxBatchBytes = 256 * 1024;
+
 /**
  * Ship DCP log to the other end. This state differs with all other states
  * in the way that it support full duplex dialog. We're listening to both read
@@ -191,13 +199,34 @@ bool StateMachine::conn_ship_log() {
         if (connection.decrementNumEvents() >= 0) {
             auto& cookie = connection.getCookieObject();
             connection.addMsgHdr(true);
-            cookie.setEwouldblock(false);
             cont = true;
 
-            const auto ret = connection.getBucket().getDcpIface()->step(
-                    static_cast<const void*>(&cookie), &connection);
+            // Queue as many messages as the producer has ready (bounded by
+            // the events left in this timeslice and DcpMaxBatchBytes) so
+            // they are sent with a single write, instead of a round trip
+            // through send_data per message.
+            auto* dcp = connection.getBucket().getDcpIface();
+            size_t queued = 0;
+            ENGINE_ERROR_CODE ret;
+            do {
+                cookie.setEwouldblock(false);
+                ret = connection.remapErrorCode(dcp->step(
+                        static_cast<const void*>(&cookie), &connection));
+                if (ret == ENGINE_SUCCESS) {
+                    ++queued;
+                }
+            } while (ret == ENGINE_SUCCESS &&
+                     connection.getMsgBytesQueued() < DcpMaxBatchBytes &&
+                     connection.decrementNumEvents() >= 0);
+
+            if (queued > 0 &&
+                (ret == ENGINE_EWOULDBLOCK || ret == ENGINE_E2BIG)) {
+                // Send what we have. A message which didn't fit is kept by
+                // the producer and returned by the next step.
+                ret = ENGINE_SUCCESS;
+            }
 
-            switch (connection.remapErrorCode(ret)) {
+            switch (ret) {
             case ENGINE_SUCCESS:
                 /* The engine got more data it wants to send */
                 setCurrentState(State::send_data);
@@ -303,6 +332,15 @@ bool StateMachine::conn_new_cmd() {
     if (connection.decrementNumEvents() >= 0) {
         connection.getCookieObject().reset();
 
+        // Responses are only batched while the next command is available;
+        // send them before we wait for more input
+        if (!connection.isPacketAvailable() && !connection.flushSendBatch()) {
+            // The socket buffer is full; send the rest once it drains
+            connection.setWriteAndGo(State::new_cmd);
+            setCurrentState(State::send_data);
+            return true;
+        }
+
         connection.shrinkBuffers();
         if (connection.read->rsize() >= sizeof(cb::mcbp::Header)) {
             setCurrentState(State::parse_cmd);
@@ -312,6 +350,7 @@ bool StateMachine::conn_new_cmd() {
             setCurrentState(State::waiting);
         }
     } else {
+        connection.flushSendBatch();
         connection.yield();
 
         /*
@@ -410,6 +449,9 @@ bool StateMachine::conn_execute() {
     cookie.setEwouldblock(false);
 
     if (!cookie.execute()) {
+        // Don't hold back the responses to the preceding commands while
+        // this one blocks
+        connection.flushSendBatch();
         connection.unregisterEvent();
         return false;
     }
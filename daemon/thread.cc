@@ -2,6 +2,7 @@
 /*
  * Thread management for memcached.
  */
+#include "buckets.h"
 #include "connection.h"
 #include "connections.h"
 #include "cookie.h"
@@ -178,6 +179,21 @@ static void setup_dispatcher(struct event_base *main_base,
     dispatcher_thread.running = true;
 }
 
+static void schedule_zerocopy_reap(FrontEndThread& me) {
+    if (evtimer_pending(&me.zerocopy_event, nullptr) == 0) {
+        // The completions typically arrive within a round trip
+        struct timeval tv = {0, 10000};
+        evtimer_add(&me.zerocopy_event, &tv);
+    }
+}
+
+static void zerocopy_event_handler(evutil_socket_t, short, void* arg) {
+    auto& me = *reinterpret_cast<FrontEndThread*>(arg);
+    if (me.deferred_zerocopy.reap()) {
+        schedule_zerocopy_reap(me);
+    }
+}
+
 /*
  * Set up a thread's information.
  */
@@ -198,6 +214,13 @@ static void setup_thread(FrontEndThread& me) {
         (event_add(&me.notify_event, nullptr) == -1)) {
         FATAL_ERROR(EXIT_FAILURE, "Can't monitor libevent notify pipe");
     }
+
+    if (evtimer_assign(&me.zerocopy_event,
+                       me.base,
+                       zerocopy_event_handler,
+                       &me) == -1) {
+        FATAL_ERROR(EXIT_FAILURE, "Can't set up the zerocopy timer");
+    }
 }
 
 /*
@@ -216,6 +239,10 @@ static void worker_libevent(void *arg) {
     }
 
     event_base_loop(me.base, 0);
+
+    // All of the connections are closed, so the sends still in flight on
+    // their sockets may be discarded
+    me.deferred_zerocopy.abort();
     me.running = false;
 }
 
@@ -289,6 +316,12 @@ static void thread_libevent_process(evutil_socket_t fd, short, void* arg) {
 
     dispatch_new_connections(me);
 
+    // Connections handing over their zerocopy sends notify us to start
+    // reaping the completions
+    if (me.deferred_zerocopy.reap()) {
+        schedule_zerocopy_reap(me);
+    }
+
     FrontEndThread::PendingIoMap pending;
     {
         std::lock_guard<std::mutex> lock(me.pending_io.mutex);
@@ -498,6 +531,72 @@ FrontEndThread::~FrontEndThread() {
     }
 }
 
+void FrontEndThread::DeferredZerocopySends::push(SOCKET sock,
+                                                 ZerocopySends sends,
+                                                 Bucket& bucket) {
+    std::lock_guard<std::mutex> lock(mutex);
+    entries.push_back({sock, std::move(sends), &bucket});
+}
+
+bool FrontEndThread::DeferredZerocopySends::reap() {
+    std::vector<Entry> completed;
+    bool inflight;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto it = entries.begin(); it != entries.end();) {
+            if (it->sock != INVALID_SOCKET) {
+                it->sends.reap(it->sock);
+            }
+            if (it->sends.hasPending()) {
+                ++it;
+            } else {
+                completed.push_back(std::move(*it));
+                it = entries.erase(it);
+            }
+        }
+        inflight = !entries.empty();
+    }
+
+    // Releasing the bucket takes the bucket mutex, which is held while
+    // connections push their sends
+    for (auto& entry : completed) {
+        release(entry);
+    }
+    return inflight;
+}
+
+void FrontEndThread::DeferredZerocopySends::abort() {
+    std::vector<Entry> aborted;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        entries.swap(aborted);
+    }
+
+    for (auto& entry : aborted) {
+        if (entry.sock != INVALID_SOCKET) {
+            // Closing the last descriptor with a zero linger timeout resets
+            // the connection instead of sending the queued data
+            struct linger linger = {1, 0};
+            cb::net::setsockopt(entry.sock,
+                                SOL_SOCKET,
+                                SO_LINGER,
+                                &linger,
+                                sizeof(linger));
+        }
+        release(entry);
+    }
+}
+
+void FrontEndThread::DeferredZerocopySends::release(Entry& entry) {
+    if (entry.sock != INVALID_SOCKET) {
+        safe_close(entry.sock);
+        entry.sock = INVALID_SOCKET;
+    }
+    // The items must be released before the reference to their bucket
+    entry.sends = ZerocopySends();
+    release_bucket_reference(*entry.bucket);
+}
+
 void notify_thread(FrontEndThread& thread) {
     if (cb::net::send(thread.notify[1], "", 1, 0) != 1 &&
         !cb::net::is_blocking(cb::net::get_socket_error())) {
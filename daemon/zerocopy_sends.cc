@@ -0,0 +1,84 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2019 Couchbase, Inc.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+#include "zerocopy_sends.h"
+
+#include <array>
+#include <cstring>
+#ifdef HAVE_MSG_ZEROCOPY
+#include <netinet/in.h> // For IP_RECVERR
+#endif
+
+bool ZerocopySends::reap(SOCKET sock) {
+    bool copied = false;
+#ifdef HAVE_MSG_ZEROCOPY
+    while (completed != seq) {
+        std::array<char, 128> control;
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_control = control.data();
+        msg.msg_controllen = control.size();
+
+        if (::recvmsg(sock, &msg, MSG_ERRQUEUE) == -1) {
+            // EAGAIN: the remaining sends are still in progress
+            break;
+        }
+
+        for (auto* cmsg = CMSG_FIRSTHDR(&msg); cmsg != nullptr;
+             cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+            if (!(cmsg->cmsg_level == SOL_IP &&
+                  cmsg->cmsg_type == IP_RECVERR) &&
+                !(cmsg->cmsg_level == SOL_IPV6 &&
+                  cmsg->cmsg_type == IPV6_RECVERR)) {
+                continue;
+            }
+            const auto* serr = reinterpret_cast<const sock_extended_err*>(
+                    CMSG_DATA(cmsg));
+            if (serr->ee_errno != 0 ||
+                serr->ee_origin != SO_EE_ORIGIN_ZEROCOPY) {
+                continue;
+            }
+
+            if (serr->ee_code & SO_EE_CODE_ZEROCOPY_COPIED) {
+                copied = true;
+            }
+
+            // The notification covers the sends [ee_info, ee_data]. They
+            // normally complete in order, but may not (e.g. on retransmit)
+            completedRanges.emplace_back(serr->ee_info, serr->ee_data);
+        }
+
+        bool merged;
+        do {
+            merged = false;
+            for (auto it = completedRanges.begin(); it != completedRanges.end();
+                 ++it) {
+                if (it->first == completed) {
+                    completed = it->second + 1;
+                    completedRanges.erase(it);
+                    merged = true;
+                    break;
+                }
+            }
+        } while (merged);
+    }
+
+    while (!pending.empty() && int32_t(completed - pending.front().first) > 0) {
+        pending.pop_front();
+    }
+#endif
+    return copied;
+}
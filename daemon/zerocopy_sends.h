@@ -0,0 +1,96 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2019 Couchbase, Inc.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+#pragma once
+
+#include <memcached/engine.h>
+#include <platform/socket.h>
+
+#include <cstdint>
+#include <deque>
+#include <utility>
+#include <vector>
+
+#ifdef __linux__
+#include <linux/errqueue.h> // For the zerocopy completion notifications
+#if defined(SO_ZEROCOPY) && defined(MSG_ZEROCOPY) && \
+        defined(SO_EE_ORIGIN_ZEROCOPY)
+#define HAVE_MSG_ZEROCOPY 1
+#endif
+#endif
+
+/**
+ * Tracks the sends made with MSG_ZEROCOPY on a socket, and holds the items
+ * whose memory they were sent from until the kernel reports (on the socket
+ * error queue) that it no longer references it.
+ *
+ * An item must never be released before that: the kernel sends from the
+ * item's memory, so if it was freed and reused the peer would receive
+ * whatever was written there.
+ */
+class ZerocopySends {
+public:
+    /// A send with MSG_ZEROCOPY was accepted by the kernel
+    void sent() {
+        ++seq;
+    }
+
+    /// @returns the id the kernel assigns to the next zerocopy send
+    uint32_t getSeq() const {
+        return seq;
+    }
+
+    /// @returns true if the kernel hasn't completed all of the sends
+    bool inFlight() const {
+        return completed != seq;
+    }
+
+    /// @returns true if items are held for sends in flight
+    bool hasPending() const {
+        return !pending.empty();
+    }
+
+    /**
+     * Hold the item until the kernel has completed all of the sends made
+     * so far (the last of which contained the end of its value).
+     */
+    void retire(cb::unique_item_ptr item) {
+        pending.emplace_back(seq - 1, std::move(item));
+    }
+
+    /**
+     * Read the completion notifications from the socket error queue (without
+     * blocking), and release the items the kernel is done with.
+     *
+     * @return true if the kernel reported it had to copy the data anyway
+     *         (e.g. loopback), so zerocopy only adds overhead on the socket
+     */
+    bool reap(SOCKET sock);
+
+private:
+    /// The id the kernel assigns to our next successful zerocopy send
+    uint32_t seq = 0;
+    /// The kernel has completed all zerocopy sends with an id below this
+    uint32_t completed = 0;
+    /// Completed ranges of sends beyond completed
+    std::vector<std::pair<uint32_t, uint32_t>> completedRanges;
+
+    /**
+     * Items sent with MSG_ZEROCOPY which the kernel may still reference,
+     * each with the id of the last send containing its data.
+     */
+    std::deque<std::pair<uint32_t, cb::unique_item_ptr>> pending;
+};
@@ -0,0 +1,125 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2019 Couchbase, Inc
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+
+/*
+ * Benchmarks relating to the BloomFilter class.
+ */
+
+#include "bloomfilter.h"
+#include "storeddockey.h"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * Fixture which populates a BloomFilter of the type given by state.range(0)
+ * with state.range(1) keys.
+ *
+ * Lookups are measured for keys which were added (hits) and for keys which
+ * were not (misses) - the latter being the common case for a full-eviction
+ * bucket, where the filter is consulted to avoid a background fetch.
+ */
+class BloomFilterBench : public benchmark::Fixture {
+public:
+    void SetUp(const benchmark::State& state) override {
+        const auto type = BloomFilter::Type(state.range(0));
+        const auto numKeys = size_t(state.range(1));
+
+        filter = std::make_unique<BloomFilter>(
+                numKeys, 0.01, BFILTER_ENABLED, type);
+        for (size_t i = 0; i < numKeys; i++) {
+            filter->addKey(makeKey("key_", i));
+        }
+
+        // Look up a fixed set of keys, spread over the whole key space so
+        // they hit different parts of the filter.
+        const size_t stride = std::max(size_t(1), numKeys / numLookupKeys);
+        for (size_t i = 0; i < numLookupKeys; i++) {
+            hitKeys.push_back(makeKey("key_", (i * stride) % numKeys));
+            missKeys.push_back(makeKey("miss_", i));
+        }
+    }
+
+    void TearDown(const benchmark::State& state) override {
+        hitKeys.clear();
+        missKeys.clear();
+        filter.reset();
+    }
+
+protected:
+    static StoredDocKey makeKey(const std::string& prefix, size_t i) {
+        return StoredDocKey(prefix + std::to_string(i), CollectionID::Default);
+    }
+
+    void lookup(benchmark::State& state,
+                const std::vector<StoredDocKey>& keys) {
+        state.SetLabel(to_string(filter->getType()).c_str());
+        size_t i = 0;
+        while (state.KeepRunning()) {
+            benchmark::DoNotOptimize(filter->maybeKeyExists(keys[i]));
+            i = (i + 1) % keys.size();
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+
+    static const size_t numLookupKeys = 100000;
+
+    std::unique_ptr<BloomFilter> filter;
+    std::vector<StoredDocKey> hitKeys;
+    std::vector<StoredDocKey> missKeys;
+};
+
+BENCHMARK_DEFINE_F(BloomFilterBench, MaybeKeyExistsHit)
+(benchmark::State& state) {
+    lookup(state, hitKeys);
+}
+
+BENCHMARK_DEFINE_F(BloomFilterBench, MaybeKeyExistsMiss)
+(benchmark::State& state) {
+    lookup(state, missKeys);
+}
+
+BENCHMARK_DEFINE_F(BloomFilterBench, AddKey)(benchmark::State& state) {
+    state.SetLabel(to_string(filter->getType()).c_str());
+    size_t i = 0;
+    while (state.KeepRunning()) {
+        filter->addKey(missKeys[i]);
+        i = (i + 1) % missKeys.size();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+// Run each benchmark for both filter types; with a filter which fits in
+// cache and one (~12MB) which does not.
+static void BloomFilterArguments(benchmark::internal::Benchmark* b) {
+    for (auto type :
+         {BloomFilter::Type::BitArray, BloomFilter::Type::Blocked}) {
+        for (auto keys : {100000, 10000000}) {
+            b->Args({int(type), keys});
+        }
+    }
+}
+
+BENCHMARK_REGISTER_F(BloomFilterBench, MaybeKeyExistsHit)
+        ->Apply(BloomFilterArguments);
+BENCHMARK_REGISTER_F(BloomFilterBench, MaybeKeyExistsMiss)
+        ->Apply(BloomFilterArguments);
+BENCHMARK_REGISTER_F(BloomFilterBench, AddKey)->Apply(BloomFilterArguments);
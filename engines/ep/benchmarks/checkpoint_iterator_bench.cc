@@ -16,11 +16,14 @@
  */
 
 /*
- * Benchmarks relating to the CheckpointIterator class.
+ * Benchmarks relating to the CheckpointIterator class and the checkpoint
+ * queue it iterates over.
  */
 
 #include "atomic.h"
 #include "checkpoint_iterator.h"
+#include "chunked_queue.h"
+#include "memory_tracking_allocator.h"
 
 #include <benchmark/benchmark.h>
 #include <list>
@@ -59,3 +62,116 @@ static void BM_CheckpointIteratorCompare(benchmark::State& state) {
 
 // Register the function as a benchmark
 BENCHMARK(BM_CheckpointIteratorCompare);
+
+/*
+ * Benchmarks comparing std::list and ChunkedQueue as the checkpoint queue,
+ * holding reference-counted pointers as the real CheckpointQueue does.
+ */
+
+class BenchItem : public RCValue {
+public:
+    explicit BenchItem(int value) : value(value) {
+    }
+
+    int value;
+};
+
+using BenchQueuedItem = SingleThreadedRCPtr<BenchItem>;
+using BenchAllocator = MemoryTrackingAllocator<BenchQueuedItem>;
+using ListQueue = std::list<BenchQueuedItem, BenchAllocator>;
+using ChunkedQueueType = ChunkedQueue<BenchQueuedItem, BenchAllocator>;
+
+/**
+ * Fixture which fills a queue of type Queue with state.range(0) items,
+ * every fourth of which is null (as if de-duplicated).
+ */
+template <typename Queue>
+class CheckpointQueueBench : public benchmark::Fixture {
+public:
+    void SetUp(const benchmark::State& state) override {
+        queue = std::make_unique<Queue>(allocator);
+        for (int64_t ii = 0; ii < state.range(0); ++ii) {
+            queue->push_back(BenchQueuedItem(
+                    (ii % 4) == 3 ? nullptr : new BenchItem(int(ii))));
+        }
+    }
+
+    void TearDown(const benchmark::State& state) override {
+        queue.reset();
+    }
+
+protected:
+    BenchAllocator allocator;
+    std::unique_ptr<Queue> queue;
+};
+
+/*
+ * Walk the whole queue with a CheckpointIterator (skipping the nulls), as a
+ * cursor does.
+ */
+template <typename Queue>
+static void iterateQueue(benchmark::State& state, Queue& queue) {
+    while (state.KeepRunning()) {
+        int64_t sum = 0;
+        CheckpointIterator<Queue> end(queue,
+                                      CheckpointIterator<Queue>::Position::end);
+        for (CheckpointIterator<Queue> it(
+                     queue, CheckpointIterator<Queue>::Position::begin);
+             it != end;
+             ++it) {
+            sum += (*it)->value;
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK_TEMPLATE_DEFINE_F(CheckpointQueueBench, IterateList, ListQueue)
+(benchmark::State& state) {
+    iterateQueue(state, *queue);
+}
+
+BENCHMARK_TEMPLATE_DEFINE_F(CheckpointQueueBench,
+                            IterateChunked,
+                            ChunkedQueueType)
+(benchmark::State& state) {
+    iterateQueue(state, *queue);
+}
+
+/*
+ * Push state.range(0) items to an empty queue then remove them all, as a
+ * checkpoint does over its lifetime. Reports the bytes the queue allocated
+ * per item (excluding the items themselves).
+ */
+template <typename Queue>
+static void fillAndDrainQueue(benchmark::State& state) {
+    BenchQueuedItem item(new BenchItem(0));
+    size_t bytesPerItem = 0;
+    while (state.KeepRunning()) {
+        BenchAllocator allocator;
+        Queue queue(allocator);
+        for (int64_t ii = 0; ii < state.range(0); ++ii) {
+            queue.push_back(item);
+        }
+        bytesPerItem = *allocator.getBytesAllocated() / state.range(0);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.counters["BytesPerItem"] = bytesPerItem;
+}
+
+static void BM_CheckpointQueueFillList(benchmark::State& state) {
+    fillAndDrainQueue<ListQueue>(state);
+}
+
+static void BM_CheckpointQueueFillChunked(benchmark::State& state) {
+    fillAndDrainQueue<ChunkedQueueType>(state);
+}
+
+BENCHMARK_REGISTER_F(CheckpointQueueBench, IterateList)
+        ->Arg(1000)
+        ->Arg(100000);
+BENCHMARK_REGISTER_F(CheckpointQueueBench, IterateChunked)
+        ->Arg(1000)
+        ->Arg(100000);
+BENCHMARK(BM_CheckpointQueueFillList)->Arg(1000)->Arg(100000);
+BENCHMARK(BM_CheckpointQueueFillChunked)->Arg(1000)->Arg(100000);
@@ -0,0 +1,183 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2019 Couchbase, Inc
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+
+/*
+ * Benchmarks comparing the FutureQueue (heap) and TimerWheel as the store of
+ * tasks waiting for their wakeTime in a TaskQueue.
+ *
+ * These are ep-engine's TaskQueue internals, so the benchmarks live here
+ * (with ep_objs and Google Benchmark) rather than in tests/executor, which
+ * tests the daemon's separate cb::ExecutorPool.
+ */
+
+#include "futurequeue.h"
+#include "timer_wheel.h"
+#include "workload.h"
+
+#include <module_tests/test_task.h>
+
+#include <benchmark/benchmark.h>
+
+#include <memory>
+#include <random>
+#include <vector>
+
+using time_point = std::chrono::steady_clock::time_point;
+
+class BenchTaskable : public Taskable {
+public:
+    const std::string& getName() const override {
+        return name;
+    }
+    task_gid_t getGID() const override {
+        return 0;
+    }
+    bucket_priority_t getWorkloadPriority() const override {
+        return HIGH_BUCKET_PRIORITY;
+    }
+    void setWorkloadPriority(bucket_priority_t prio) override {
+    }
+    WorkLoadPolicy& getWorkLoadPolicy() override {
+        return policy;
+    }
+    void logQTime(TaskId id,
+                  const std::chrono::steady_clock::duration enqTime) override {
+    }
+    void logRunTime(TaskId id,
+                    const std::chrono::steady_clock::duration runTime) override {
+    }
+
+private:
+    std::string name = "bench";
+    WorkLoadPolicy policy{HIGH_BUCKET_PRIORITY, 1};
+};
+
+/*
+ * The operations TaskQueue performs, for each queue type.
+ */
+
+static size_t popReady(FutureQueue<>& queue, time_point now) {
+    size_t count = 0;
+    while (!queue.empty() && queue.top()->getWaketime() <= now) {
+        queue.pop();
+        ++count;
+    }
+    return count;
+}
+
+static size_t popReady(TimerWheel& queue, time_point now) {
+    return queue.popReady(now, [](ExTask) {});
+}
+
+/**
+ * Fixture which fills a queue of type Queue with state.range(0) tasks,
+ * snoozed for between 1 second and 1 hour.
+ */
+template <typename Queue>
+class TaskQueueBench : public benchmark::Fixture {
+public:
+    void SetUp(const benchmark::State& state) override {
+        queue = std::make_unique<Queue>();
+        const auto now = std::chrono::steady_clock::now();
+        for (int64_t i = 0; i < state.range(0); i++) {
+            tasks.push_back(std::make_shared<TestTask>(
+                    taskable, TaskId::PendingOpsNotification));
+            tasks.back()->updateWaketime(now + randomDelay());
+            queue->push(tasks.back());
+        }
+    }
+
+    void TearDown(const benchmark::State& state) override {
+        queue.reset();
+        tasks.clear();
+    }
+
+protected:
+    std::chrono::steady_clock::duration randomDelay() {
+        return std::chrono::milliseconds(delayMs(gen));
+    }
+
+    ExTask& randomTask() {
+        return tasks[taskIndex(gen) % tasks.size()];
+    }
+
+    BenchTaskable taskable;
+    std::unique_ptr<Queue> queue;
+    std::vector<ExTask> tasks;
+    std::mt19937 gen{0};
+    std::uniform_int_distribution<int64_t> delayMs{1000, 3600 * 1000};
+    std::uniform_int_distribution<size_t> taskIndex;
+};
+
+/*
+ * Move a queued task to a new time in the future (as snooze does).
+ */
+BENCHMARK_TEMPLATE_DEFINE_F(TaskQueueBench, SnoozeHeap, FutureQueue<>)
+(benchmark::State& state) {
+    while (state.KeepRunning()) {
+        queue->updateWaketime(randomTask(),
+                              std::chrono::steady_clock::now() + randomDelay());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK_TEMPLATE_DEFINE_F(TaskQueueBench, SnoozeWheel, TimerWheel)
+(benchmark::State& state) {
+    while (state.KeepRunning()) {
+        queue->updateWaketime(randomTask(),
+                              std::chrono::steady_clock::now() + randomDelay());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+/*
+ * Wake a queued task, move it out as ready (as a thread fetching it would)
+ * and then reschedule it into the future once it has "run".
+ */
+template <typename Queue>
+static void wakeRunReschedule(Queue& queue,
+                              ExTask task,
+                              std::chrono::steady_clock::duration delay) {
+    const auto now = std::chrono::steady_clock::now();
+    queue.updateWaketime(task, now);
+    benchmark::DoNotOptimize(popReady(queue, now));
+    task->updateWaketime(now + delay);
+    queue.push(task);
+}
+
+BENCHMARK_TEMPLATE_DEFINE_F(TaskQueueBench, WakeHeap, FutureQueue<>)
+(benchmark::State& state) {
+    while (state.KeepRunning()) {
+        wakeRunReschedule(*queue, randomTask(), randomDelay());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK_TEMPLATE_DEFINE_F(TaskQueueBench, WakeWheel, TimerWheel)
+(benchmark::State& state) {
+    while (state.KeepRunning()) {
+        wakeRunReschedule(*queue, randomTask(), randomDelay());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+// Compare with a queue which fits in cache, and the 100k tasks a large
+// deployment (many buckets * vBuckets) may have waiting.
+BENCHMARK_REGISTER_F(TaskQueueBench, SnoozeHeap)->Arg(1000)->Arg(100000);
+BENCHMARK_REGISTER_F(TaskQueueBench, SnoozeWheel)->Arg(1000)->Arg(100000);
+BENCHMARK_REGISTER_F(TaskQueueBench, WakeHeap)->Arg(1000)->Arg(100000);
+BENCHMARK_REGISTER_F(TaskQueueBench, WakeWheel)->Arg(1000)->Arg(100000);
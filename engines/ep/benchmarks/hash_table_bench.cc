@@ -27,6 +27,10 @@
 #include <folly/portability/GTest.h>
 #include <spdlog/fmt/fmt.h>
 
+#include <algorithm>
+#include <limits>
+#include <random>
+
 // Benchmarks inserting items into a HashTable
 class HashTableBench : public benchmark::Fixture {
 public:
@@ -111,6 +115,48 @@ public:
         }
     }
 
+    /**
+     * Make the given key hot - saturate its frequency counter and minimise
+     * its NRU value - so reads which track the reference don't need to
+     * modify it.
+     */
+    void makeHot(const DocKey& key) {
+        auto res = ht.findForWrite(key);
+        ASSERT_TRUE(res.storedValue);
+        res.storedValue->setFreqCounterValue(
+                std::numeric_limits<uint8_t>::max());
+        res.storedValue->setNRUValue(MIN_NRU_VALUE);
+    }
+
+    /**
+     * Read a copy of the given key under the HashTable lock.
+     */
+    std::unique_ptr<Item> copyLocked(const DocKey& key) {
+        auto res = ht.findForRead(key);
+        return res.storedValue->toItem(Vbid(0));
+    }
+
+    /**
+     * Read a copy of the given key as VBucket::getInternal() does - without
+     * the HashTable lock, falling back to copyLocked() if that fails.
+     *
+     * @param fallbacks incremented if the optimistic read failed
+     */
+    std::unique_ptr<Item> copyOptimistic(const DocKey& key,
+                                         size_t& fallbacks) {
+        auto res = ht.findForReadOptimistic(key,
+                                            Vbid(0),
+                                            TrackReference::Yes,
+                                            ForGetReplicaOp::No,
+                                            false,
+                                            StoredValue::IncludeValue::Yes);
+        if (res.item) {
+            return std::move(res.item);
+        }
+        ++fallbacks;
+        return copyLocked(key);
+    }
+
     EPStats stats;
     HashTable ht;
     static const size_t numItems = 100000;
@@ -147,6 +193,115 @@ BENCHMARK_DEFINE_F(HashTableBench, FindForRead)(benchmark::State& state) {
     state.SetItemsProcessed(state.iterations());
 }
 
+// Benchmark finding the same (hot) item in the HashTable from all threads -
+// models many clients concurrently reading a single popular key.
+BENCHMARK_DEFINE_F(HashTableBench, FindForReadHotKey)
+(benchmark::State& state) {
+    if (state.thread_index == 0) {
+        sharedItems = createItems("HotKey::");
+        for (auto& item : sharedItems) {
+            ASSERT_EQ(MutationStatus::WasClean, ht.set(item));
+        }
+    }
+
+    while (state.KeepRunning()) {
+        auto& key = sharedItems.front().getKey();
+        benchmark::DoNotOptimize(ht.findForRead(key));
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+
+// Benchmark each thread repeatedly finding its own item, where the items are
+// guarded by different (adjacent) HashTable locks - measures any interference
+// between threads accessing different lock stripes.
+BENCHMARK_DEFINE_F(HashTableBench, FindForReadPerThreadKey)
+(benchmark::State& state) {
+    if (state.thread_index == 0) {
+        sharedItems = createItems("PerThreadKey::");
+        for (auto& item : sharedItems) {
+            ASSERT_EQ(MutationStatus::WasClean, ht.set(item));
+        }
+    }
+
+    while (state.KeepRunning()) {
+        auto& key = sharedItems[state.thread_index].getKey();
+        benchmark::DoNotOptimize(ht.findForRead(key));
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+
+// Benchmark copying the same (hot) item out of the HashTable from all
+// threads; under the HashTable lock (CopyHotKeyLocked) vs without it
+// (CopyHotKeyOptimistic) - the latter should scale with the number of
+// threads as they no longer contend on the lock's cache line.
+BENCHMARK_DEFINE_F(HashTableBench, CopyHotKeyLocked)
+(benchmark::State& state) {
+    if (state.thread_index == 0) {
+        sharedItems = createItems("HotKey::");
+        for (auto& item : sharedItems) {
+            ASSERT_EQ(MutationStatus::WasClean, ht.set(item));
+        }
+        makeHot(sharedItems.front().getKey());
+    }
+
+    while (state.KeepRunning()) {
+        benchmark::DoNotOptimize(copyLocked(sharedItems.front().getKey()));
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK_DEFINE_F(HashTableBench, CopyHotKeyOptimistic)
+(benchmark::State& state) {
+    if (state.thread_index == 0) {
+        sharedItems = createItems("HotKey::");
+        for (auto& item : sharedItems) {
+            ASSERT_EQ(MutationStatus::WasClean, ht.set(item));
+        }
+        makeHot(sharedItems.front().getKey());
+    }
+
+    size_t fallbacks = 0;
+    while (state.KeepRunning()) {
+        benchmark::DoNotOptimize(
+                copyOptimistic(sharedItems.front().getKey(), fallbacks));
+    }
+
+    state.SetItemsProcessed(state.iterations());
+    state.counters["fallbacks"] = fallbacks;
+}
+
+// As CopyHotKeyOptimistic, but with the first thread repeatedly updating
+// the hot key - measures the cost of the readers' conflicts with a writer
+// (each forcing a fallback to the locked read).
+BENCHMARK_DEFINE_F(HashTableBench, CopyHotKeyOptimisticWithWriter)
+(benchmark::State& state) {
+    if (state.thread_index == 0) {
+        sharedItems = createItems("HotKey::");
+        for (auto& item : sharedItems) {
+            ASSERT_EQ(MutationStatus::WasClean, ht.set(item));
+        }
+        makeHot(sharedItems.front().getKey());
+        state.SetLabel("thread 0 writes");
+    }
+
+    size_t fallbacks = 0;
+    while (state.KeepRunning()) {
+        auto& item = sharedItems.front();
+        if (state.thread_index == 0) {
+            ASSERT_EQ(MutationStatus::WasDirty, ht.set(item));
+        } else {
+            benchmark::DoNotOptimize(
+                    copyOptimistic(item.getKey(), fallbacks));
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations());
+    state.counters["fallbacks"] = fallbacks;
+}
+
 // Benchmark finding items (for write) in the HashTable.
 // Includes extra  50% of Items are prepared SyncWrites -  an unrealistically
 // high percentage in a real-world, but want to measure any performance impact
@@ -252,9 +407,132 @@ BENCHMARK_DEFINE_F(HashTableBench, Delete)(benchmark::State& state) {
     state.SetItemsProcessed(state.iterations());
 }
 
+/**
+ * Fixture comparing the different HashTable bucket layouts with a large
+ * number of items.
+ *
+ * Benchmark arguments:
+ *   range(0): HashTable::Layout to use
+ *   range(1): Number of items to populate the HashTable with.
+ */
+class HashTableLayoutBench : public benchmark::Fixture {
+public:
+    void SetUp(benchmark::State& state) override {
+        const auto layout = HashTable::Layout(state.range(0));
+        const size_t numItems = state.range(1);
+        state.SetLabel(to_string(layout));
+
+        ht = std::make_unique<HashTable>(
+                stats,
+                std::make_unique<StoredValueFactory>(stats),
+                Configuration().getHtSize(),
+                Configuration().getHtLocks(),
+                layout);
+        ht->resize(numItems);
+
+        // Populate, creating Items one at a time to avoid holding numItems
+        // Items in memory in addition to the StoredValues.
+        const auto data = std::string(1, 'x');
+        keys.reserve(numItems);
+        for (size_t i = 0; i < numItems; i++) {
+            keys.emplace_back(makeStoredDocKey("key::" + std::to_string(i)));
+            Item item(keys.back(), 0, 0, data.data(), data.size());
+            ASSERT_EQ(MutationStatus::WasClean, ht->set(item));
+        }
+
+        // Keys which are not present; a smaller set is sufficient as they are
+        // looked up in a random order.
+        const size_t numMissKeys = std::min(numItems, size_t(1000000));
+        missKeys.reserve(numMissKeys);
+        for (size_t i = 0; i < numMissKeys; i++) {
+            missKeys.emplace_back(
+                    makeStoredDocKey("miss::" + std::to_string(i)));
+        }
+
+        // Access keys in a random order so successive lookups touch
+        // different areas of the HashTable (and aren't already in cache).
+        std::mt19937 gen(0);
+        std::shuffle(keys.begin(), keys.end(), gen);
+    }
+
+    void TearDown(benchmark::State& state) override {
+        ht.reset();
+        keys.clear();
+        keys.shrink_to_fit();
+        missKeys.clear();
+        missKeys.shrink_to_fit();
+    }
+
+    EPStats stats;
+    std::unique_ptr<HashTable> ht;
+    std::vector<StoredDocKey> keys;
+    std::vector<StoredDocKey> missKeys;
+};
+
+// Benchmark finding items which exist in the HashTable.
+BENCHMARK_DEFINE_F(HashTableLayoutBench, FindForReadHit)
+(benchmark::State& state) {
+    size_t i = 0;
+    while (state.KeepRunning()) {
+        benchmark::DoNotOptimize(ht->findForRead(keys[i++ % keys.size()]));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+// Benchmark looking up items which do not exist in the HashTable.
+BENCHMARK_DEFINE_F(HashTableLayoutBench, FindForReadMiss)
+(benchmark::State& state) {
+    size_t i = 0;
+    while (state.KeepRunning()) {
+        benchmark::DoNotOptimize(
+                ht->findForRead(missKeys[i++ % missKeys.size()]));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+// Benchmark finding items for write (which also searches for Pending items).
+BENCHMARK_DEFINE_F(HashTableLayoutBench, FindForWriteHit)
+(benchmark::State& state) {
+    size_t i = 0;
+    while (state.KeepRunning()) {
+        benchmark::DoNotOptimize(ht->findForWrite(keys[i++ % keys.size()]));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+static void HashTableLayoutArguments(benchmark::internal::Benchmark* b) {
+    for (auto layout : {HashTable::Layout::Chained, HashTable::Layout::Tagged}) {
+        for (int items : {1000000, 10000000}) {
+            b->Args({int(layout), items});
+        }
+    }
+}
+
+BENCHMARK_REGISTER_F(HashTableLayoutBench, FindForReadHit)
+        ->Apply(HashTableLayoutArguments);
+BENCHMARK_REGISTER_F(HashTableLayoutBench, FindForReadMiss)
+        ->Apply(HashTableLayoutArguments);
+BENCHMARK_REGISTER_F(HashTableLayoutBench, FindForWriteHit)
+        ->Apply(HashTableLayoutArguments);
+
 BENCHMARK_REGISTER_F(HashTableBench, FindForRead)
         ->ThreadPerCpu()
         ->Iterations(HashTableBench::numItems);
+BENCHMARK_REGISTER_F(HashTableBench, FindForReadHotKey)
+        ->ThreadRange(1, 16)
+        ->Iterations(HashTableBench::numItems);
+BENCHMARK_REGISTER_F(HashTableBench, FindForReadPerThreadKey)
+        ->ThreadRange(1, 16)
+        ->Iterations(HashTableBench::numItems);
+BENCHMARK_REGISTER_F(HashTableBench, CopyHotKeyLocked)
+        ->ThreadRange(1, 16)
+        ->Iterations(HashTableBench::numItems);
+BENCHMARK_REGISTER_F(HashTableBench, CopyHotKeyOptimistic)
+        ->ThreadRange(1, 16)
+        ->Iterations(HashTableBench::numItems);
+BENCHMARK_REGISTER_F(HashTableBench, CopyHotKeyOptimisticWithWriter)
+        ->ThreadRange(2, 16)
+        ->Iterations(HashTableBench::numItems);
 BENCHMARK_REGISTER_F(HashTableBench, FindForWrite)
         ->ThreadPerCpu()
         ->Iterations(HashTableBench::numItems);
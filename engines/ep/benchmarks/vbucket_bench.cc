@@ -143,6 +143,29 @@ protected:
     }
 };
 
+/*
+ * Fixture for CheckpointManager benchmarks with the default checkpoint
+ * configuration.
+ */
+class CheckpointCursorBench : public EngineFixture {
+protected:
+    void SetUp(const benchmark::State& state) override {
+        varConfig = "max_size=1000000000";
+        EngineFixture::SetUp(state);
+        if (state.thread_index == 0) {
+            engine->getKVBucket()->setVBucketState(Vbid(0),
+                                                   vbucket_state_active);
+        }
+    }
+
+    void TearDown(const benchmark::State& state) override {
+        if (state.thread_index == 0) {
+            engine->getKVBucket()->deleteVBucket(vbid, this);
+        }
+        EngineFixture::TearDown(state);
+    }
+};
+
 /**
  * Benchmark queueing items into a vBucket.
  * Items have a 10% chance of being a duplicate key of a previous item (to
@@ -392,6 +415,80 @@ BENCHMARK_DEFINE_F(CheckpointBench, QueueDirtyWithManyClosedUnrefCheckpoints)
     bgThread.join();
 }
 
+/*
+ * Measure the cost of CM::queueDirty from a frontend thread while a number of
+ * cursors (DCP streams) are concurrently fetching items from the same
+ * CheckpointManager, all of which need CM::queueLock.
+ */
+BENCHMARK_DEFINE_F(CheckpointCursorBench, QueueDirtyWithConcurrentCursors)
+(benchmark::State& state) {
+    const size_t numCursors = state.range(0);
+    // Number of distinct keys; the same items are re-queued (de-duplicated)
+    // so the open checkpoint does not grow unbounded.
+    const size_t numKeys = 10000;
+
+    auto* vb = engine->getKVBucket()->getVBucket(vbid).get();
+    auto* ckptMgr = vb->checkpointManager.get();
+
+    std::vector<queued_item> items;
+    for (size_t i = 0; i < numKeys; ++i) {
+        items.emplace_back(new Item(
+                StoredDocKey("key" + std::to_string(i), CollectionID::Default),
+                vbid,
+                queue_op::mutation,
+                /*revSeq*/ 0,
+                /*bySeq*/ 0));
+    }
+
+    ThreadGate tg(numCursors + 1);
+    std::atomic<bool> done{false};
+    std::atomic<size_t> itemsRead{0};
+    std::vector<std::thread> cursorThreads;
+    for (size_t i = 0; i < numCursors; ++i) {
+        auto cursor = ckptMgr->registerCursorBySeqno(
+                                     "cursor_" + std::to_string(i), 0)
+                              .cursor;
+        cursorThreads.emplace_back([&tg, &done, &itemsRead, ckptMgr, cursor]() {
+            tg.threadUp();
+            std::vector<queued_item> cursorItems;
+            while (!done) {
+                cursorItems.clear();
+                ckptMgr->getNextItemsForCursor(cursor.lock().get(),
+                                               cursorItems);
+                itemsRead += cursorItems.size();
+            }
+        });
+    }
+
+    size_t itemsQueuedTotal = 0;
+    tg.threadUp();
+    const auto begin = std::chrono::steady_clock::now();
+    while (state.KeepRunning()) {
+        ckptMgr->queueDirty(*vb,
+                            items[itemsQueuedTotal % numKeys],
+                            GenerateBySeqno::Yes,
+                            GenerateCas::Yes,
+                            /*preLinkDocCtx*/ nullptr);
+        ++itemsQueuedTotal;
+    }
+    const auto runtime = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                 std::chrono::steady_clock::now() - begin)
+                                 .count();
+
+    done = true;
+    for (auto& t : cursorThreads) {
+        t.join();
+    }
+
+    state.SetItemsProcessed(itemsQueuedTotal);
+    if (itemsQueuedTotal > 0) {
+        state.counters["AvgQueueDirtyRuntime"] = runtime / itemsQueuedTotal;
+    }
+    if (numCursors > 0) {
+        state.counters["ItemsReadPerCursor"] = itemsRead / numCursors;
+    }
+}
+
 // Run with item counts from 1..10,000,000.
 BENCHMARK_REGISTER_F(MemTrackingVBucketBench, QueueDirty)
         ->Args({1})
@@ -410,6 +507,13 @@ static void FlushArguments(benchmark::internal::Benchmark* b) {
 BENCHMARK_REGISTER_F(MemTrackingVBucketBench, FlushVBucket)
         ->Apply(FlushArguments);
 
+// Arguments: number of concurrent cursors
+BENCHMARK_REGISTER_F(CheckpointCursorBench, QueueDirtyWithConcurrentCursors)
+        ->Arg(0)
+        ->Arg(1)
+        ->Arg(8)
+        ->UseRealTime();
+
 // Arguments: numCheckpoints, numCkptToRemovePerIteration
 BENCHMARK_REGISTER_F(CheckpointBench, QueueDirtyWithManyClosedUnrefCheckpoints)
         ->Args({1000000, 1000})
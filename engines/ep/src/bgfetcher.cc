@@ -30,43 +30,56 @@
 #include <vector>
 
 BgFetcher::BgFetcher(KVBucket& s, KVShard& k)
-    : BgFetcher(s, k, s.getEPEngine().getEpStats()) {
+    : BgFetcher(s,
+                k,
+                s.getEPEngine().getEpStats(),
+                s.getEPEngine().getConfiguration().getBgFetcherTasks()) {
+    setCoalesceWindow(std::chrono::microseconds(
+            s.getEPEngine().getConfiguration().getBgFetcherCoalesceWindowUs()));
 }
 
 BgFetcher::~BgFetcher() {
-    LockHolder lh(queueMutex);
-    if (!pendingVbs.empty()) {
+    size_t pending = 0;
+    for (auto& p : partitions) {
+        LockHolder lh(p.queueMutex);
+        pending += p.pendingVbs.size();
+        p.pendingVbs.clear();
+    }
+    if (pending) {
         EP_LOG_DEBUG(
                 "Terminating database reader without completing "
                 "background fetches for {} vbuckets.",
-                pendingVbs.size());
-        pendingVbs.clear();
+                pending);
     }
 }
 
 void BgFetcher::start() {
     ExecutorPool* iom = ExecutorPool::get();
-    auto task =
-            std::make_shared<MultiBGFetcherTask>(&(store.getEPEngine()), this);
-    this->setTaskId(task->getId());
-    iom->schedule(task);
+    for (size_t i = 0; i < partitions.size(); i++) {
+        auto task = std::make_shared<MultiBGFetcherTask>(
+                &(store.getEPEngine()), this, i);
+        partitions[i].taskId = task->getId();
+        iom->schedule(task);
+    }
 }
 
 void BgFetcher::stop() {
-    bool inverse = true;
-    pendingFetch.compare_exchange_strong(inverse, false);
-    ExecutorPool::get()->cancel(taskId);
+    for (auto& p : partitions) {
+        bool inverse = true;
+        p.pendingFetch.compare_exchange_strong(inverse, false);
+        ExecutorPool::get()->cancel(p.taskId);
+    }
 }
 
-void BgFetcher::notifyBGEvent(void) {
+void BgFetcher::notifyBGEvent(Vbid vbId) {
     ++stats.numRemainingBgItems;
-    wakeUpTaskIfSnoozed();
+    wakeUpTaskIfSnoozed(getPartition(vbId));
 }
 
-void BgFetcher::wakeUpTaskIfSnoozed() {
+void BgFetcher::wakeUpTaskIfSnoozed(Partition& p) {
     bool expected = false;
-    if (pendingFetch.compare_exchange_strong(expected, true)) {
-        ExecutorPool::get()->wake(taskId);
+    if (p.pendingFetch.compare_exchange_strong(expected, true)) {
+        ExecutorPool::get()->wake(p.taskId);
     }
 }
 
@@ -114,7 +127,21 @@ size_t BgFetcher::doFetch(Vbid vbId, vb_bgfetch_queue_t& itemsToFetch) {
     return fetchedItems.size();
 }
 
-bool BgFetcher::run(GlobalTask *task) {
+bool BgFetcher::run(GlobalTask* task, size_t partition) {
+    auto& p = partitions.at(partition);
+
+    // Having been woken, wait for the coalescing window (if any) before
+    // fetching. pendingFetch stays set meanwhile, so further fetches queued
+    // for the partition's vBuckets don't wake the task early; they are read
+    // in the same batch.
+    const auto window = coalesceWindow.load();
+    if (window.count() > 0 && !p.coalescing) {
+        p.coalescing = true;
+        task->snooze(std::chrono::duration<double>(window).count());
+        return true;
+    }
+    p.coalescing = false;
+
     // Setup to snooze forever, and *then* clear the pending flag.
     // The ordering of these two statements is important - if we were
     // to clear the flag *before* snoozing, then we could have a Lost
@@ -131,13 +158,13 @@ bool BgFetcher::run(GlobalTask *task) {
     // By clearing pendingFlag after the snooze() we ensure the wake()
     // must happen after snooze().
     task->snooze(INT_MAX);
-    pendingFetch.store(false);
+    p.pendingFetch.store(false);
 
-    std::vector<Vbid> bg_vbs(pendingVbs.size());
+    std::vector<Vbid> bg_vbs;
     {
-        LockHolder lh(queueMutex);
-        bg_vbs.assign(pendingVbs.begin(), pendingVbs.end());
-        pendingVbs.clear();
+        LockHolder lh(p.queueMutex);
+        bg_vbs.assign(p.pendingVbs.begin(), p.pendingVbs.end());
+        p.pendingVbs.clear();
     }
 
     size_t num_fetched_items = 0;
@@ -148,10 +175,10 @@ bool BgFetcher::run(GlobalTask *task) {
             // Requeue the bg fetch task if vbucket DB file is not created yet.
             if (vb->isBucketCreation()) {
                 {
-                    LockHolder lh(queueMutex);
-                    pendingVbs.insert(vbId);
+                    LockHolder lh(p.queueMutex);
+                    p.pendingVbs.insert(vbId);
                 }
-                wakeUpTaskIfSnoozed();
+                wakeUpTaskIfSnoozed(p);
                 continue;
             }
 
@@ -16,9 +16,14 @@
  */
 #pragma once
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <list>
+#include <mutex>
 #include <set>
 #include <string>
+#include <vector>
 
 #include "vbucket.h"
 
@@ -31,6 +36,12 @@ class GlobalTask;
 /**
  * Dispatcher job responsible for batching data reads and push to
  * underlying storage
+ *
+ * The shard's vBuckets are partitioned between one or more
+ * MultiBGFetcherTasks (vBucket vbid is fetched by task vbid % N), so the
+ * reads of different vBuckets can be in flight concurrently. Each task may
+ * also wait for a short coalescing window after being woken, so the
+ * fetches queued by a burst of misses are read in one batch.
  */
 class BgFetcher {
 public:
@@ -40,16 +51,21 @@ public:
      * @param s  The store
      * @param k  The shard to which this background fetcher belongs
      * @param st reference to statistics
+     * @param numTasks The number of MultiBGFetcherTasks to fetch with
      */
-    BgFetcher(KVBucket& s, KVShard& k, EPStats& st)
-        : store(s), shard(k), taskId(0), stats(st), pendingFetch(false) {
+    BgFetcher(KVBucket& s, KVShard& k, EPStats& st, size_t numTasks = 1)
+        : store(s),
+          shard(k),
+          stats(st),
+          partitions(std::max(numTasks, size_t(1))) {
     }
 
     /**
      * Construct a BgFetcher
      *
      * Equivalent to above constructor except stats reference is obtained
-     * from KVBucket's reference to EPEngine's epstats.
+     * from KVBucket's reference to EPEngine's epstats, and the number of
+     * tasks and coalescing window from its configuration.
      *
      * @param s The store
      * @param k The shard to which this background fetcher belongs
@@ -60,29 +76,62 @@ public:
 
     void start(void);
     void stop(void);
-    bool run(GlobalTask *task);
+
+    /**
+     * Fetch the queued items of the vBuckets of the given partition.
+     *
+     * @param task The MultiBGFetcherTask running the fetch
+     * @param partition The index of the task's partition
+     */
+    bool run(GlobalTask* task, size_t partition = 0);
     bool pendingJob(void) const;
-    void notifyBGEvent(void);
-    void setTaskId(size_t newId) { taskId = newId; }
+    void notifyBGEvent(Vbid vbId);
     void addPendingVB(Vbid vbId) {
-        LockHolder lh(queueMutex);
-        pendingVbs.insert(vbId);
+        auto& p = getPartition(vbId);
+        LockHolder lh(p.queueMutex);
+        p.pendingVbs.insert(vbId);
+    }
+
+    size_t getNumTasks() const {
+        return partitions.size();
+    }
+
+    /**
+     * Set how long a task waits after being woken before fetching, so that
+     * further fetches can be added to the batch. Zero fetches immediately.
+     */
+    void setCoalesceWindow(std::chrono::microseconds window) {
+        coalesceWindow = window;
     }
 
 private:
+    /// The state of one MultiBGFetcherTask.
+    struct Partition {
+        size_t taskId = 0;
+        std::mutex queueMutex;
+        std::atomic<bool> pendingFetch{false};
+        std::set<Vbid> pendingVbs;
+        /// True while the task is snoozed for the coalescing window. Only
+        /// accessed by the task.
+        bool coalescing = false;
+    };
+
+    Partition& getPartition(Vbid vbId) {
+        return partitions[vbId.get() % partitions.size()];
+    }
+
     size_t doFetch(Vbid vbId, vb_bgfetch_queue_t& items);
 
-    /// If the BGFetch task is currently snoozed (not scheduled to
-    /// run), wake it up. Has no effect the if the task has already
-    /// been woken.
-    void wakeUpTaskIfSnoozed();
+    /// If the BGFetch task of the partition is currently snoozed (not
+    /// scheduled to run), wake it up. Has no effect the if the task has
+    /// already been woken.
+    void wakeUpTaskIfSnoozed(Partition& p);
 
     KVBucket& store;
     KVShard& shard;
-    size_t taskId;
-    std::mutex queueMutex;
     EPStats &stats;
 
-    std::atomic<bool> pendingFetch;
-    std::set<Vbid> pendingVbs;
+    std::vector<Partition> partitions;
+    std::atomic<std::chrono::microseconds> coalesceWindow{
+            std::chrono::microseconds::zero()};
 };
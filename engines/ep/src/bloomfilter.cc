@@ -21,7 +21,9 @@
 
 #include "murmurhash3.h"
 
+#include <algorithm>
 #include <cmath>
+#include <cstring>
 
 #if __x86_64__ || __ppc64__
 #define MURMURHASH_3 MurmurHash3_x64_128
@@ -29,19 +31,59 @@
 #define MURMURHASH_3 MurmurHash3_x86_128
 #endif
 
-BloomFilter::BloomFilter(size_t key_count, double false_positive_prob,
-                         bfilter_status_t new_status) {
-
+BloomFilter::BloomFilter(size_t key_count,
+                         double false_positive_prob,
+                         bfilter_status_t new_status,
+                         Type filterType)
+    : type(filterType) {
     status = new_status;
     filterSize = estimateFilterSize(key_count, false_positive_prob);
     noOfHashes = estimateNoOfHashes(key_count);
     keyCounter = 0;
-    bitArray.assign(filterSize, false);
+    allocateBits();
+}
+
+BloomFilter::BloomFilter(Type filterType,
+                         size_t size,
+                         size_t hashes,
+                         bfilter_status_t newStatus)
+    : type(filterType),
+      filterSize(size),
+      noOfHashes(hashes),
+      keyCounter(0),
+      status(newStatus) {
+    allocateBits();
 }
 
 BloomFilter::~BloomFilter() {
     status = BFILTER_DISABLED;
+    clearBits();
+}
+
+void BloomFilter::allocateBits() {
+    if (type == Type::Blocked) {
+        numBlocks = std::max(size_t(1),
+                             (filterSize + bitsPerBlock - 1) / bitsPerBlock);
+        filterSize = numBlocks * bitsPerBlock;
+
+        // std::vector only guarantees alignof(uint64_t); allocate one spare
+        // block and start at the first cache line boundary so a key's block
+        // never straddles two cache lines.
+        blockStorage.assign((numBlocks + 1) * wordsPerBlock, 0);
+        const auto addr = reinterpret_cast<uintptr_t>(blockStorage.data());
+        const auto aligned = (addr + bitsPerBlock / 8 - 1) &
+                             ~uintptr_t(bitsPerBlock / 8 - 1);
+        blocks = blockStorage.data() + (aligned - addr) / sizeof(uint64_t);
+    } else {
+        bitArray.assign(filterSize, false);
+    }
+}
+
+void BloomFilter::clearBits() {
     bitArray.clear();
+    blockStorage.clear();
+    blocks = nullptr;
+    numBlocks = 0;
 }
 
 size_t BloomFilter::estimateFilterSize(size_t key_count,
@@ -62,6 +104,62 @@ uint64_t BloomFilter::hashDocKey(const DocKey& key, uint32_t iteration) {
     return result;
 }
 
+uint64_t* BloomFilter::getBlockForKey(const DocKey& key,
+                                      block_mask_type& mask) {
+    uint64_t result = 0;
+    auto hashable = key.getIdAndKey();
+    MURMURHASH_3(hashable.second.data(),
+                 hashable.second.size(),
+                 uint32_t(hashable.first),
+                 &result);
+
+    // The upper half of the hash selects the block (multiply-shift rather
+    // than modulo to avoid a division), the lower half is split into two
+    // 16-bit hashes which generate the in-block probes by double hashing.
+    // h2 is odd so the first bitsPerBlock probes are all distinct.
+    const auto blockIndex =
+            (uint64_t(uint32_t(result >> 32)) * numBlocks) >> 32;
+    const auto h1 = uint32_t(result & 0xffff);
+    const auto h2 = uint32_t((result >> 16) & 0xffff) | 1;
+    mask.fill(0);
+    for (uint32_t i = 0; i < noOfHashes; i++) {
+        const uint32_t bit = (h1 + i * h2) % bitsPerBlock;
+        mask[bit / 64] |= uint64_t(1) << (bit % 64);
+    }
+    return blocks + blockIndex * wordsPerBlock;
+}
+
+void BloomFilter::addKeyBlocked(const DocKey& key) {
+    if (!blocks) {
+        return;
+    }
+    block_mask_type mask;
+    uint64_t* block = getBlockForKey(key, mask);
+    uint64_t missing = 0;
+    for (size_t i = 0; i < wordsPerBlock; i++) {
+        missing |= mask[i] & ~block[i];
+        block[i] |= mask[i];
+    }
+    if (missing) {
+        keyCounter++;
+    }
+}
+
+bool BloomFilter::maybeKeyExistsBlocked(const DocKey& key) {
+    if (!blocks) {
+        return true;
+    }
+    block_mask_type mask;
+    const uint64_t* block = getBlockForKey(key, mask);
+    // Deliberately branch-free over the whole block so the compiler can
+    // test all the probe bits with a few vector instructions.
+    uint64_t missing = 0;
+    for (size_t i = 0; i < wordsPerBlock; i++) {
+        missing |= mask[i] & ~block[i];
+    }
+    return missing == 0;
+}
+
 void BloomFilter::setStatus(bfilter_status_t to) {
     switch (status) {
         case BFILTER_DISABLED:
@@ -72,7 +170,7 @@ void BloomFilter::setStatus(bfilter_status_t to) {
         case BFILTER_PENDING:
             if (to == BFILTER_DISABLED) {
                 status = to;
-                bitArray.clear();
+                clearBits();
             } else if (to == BFILTER_COMPACTING) {
                 status = to;
             }
@@ -80,7 +178,7 @@ void BloomFilter::setStatus(bfilter_status_t to) {
         case BFILTER_COMPACTING:
             if (to == BFILTER_DISABLED) {
                 status = to;
-                bitArray.clear();
+                clearBits();
             } else if (to == BFILTER_ENABLED) {
                 status = to;
             }
@@ -88,7 +186,7 @@ void BloomFilter::setStatus(bfilter_status_t to) {
         case BFILTER_ENABLED:
             if (to == BFILTER_DISABLED) {
                 status = to;
-                bitArray.clear();
+                clearBits();
             } else if (to == BFILTER_COMPACTING) {
                 status = to;
             }
@@ -116,6 +214,10 @@ std::string BloomFilter::getStatusString() {
 
 void BloomFilter::addKey(const DocKey& key) {
     if (status == BFILTER_COMPACTING || status == BFILTER_ENABLED) {
+        if (type == Type::Blocked) {
+            addKeyBlocked(key);
+            return;
+        }
         bool overlap = true;
         for (uint32_t i = 0; i < noOfHashes; i++) {
             uint64_t result = hashDocKey(key, i);
@@ -132,6 +234,9 @@ void BloomFilter::addKey(const DocKey& key) {
 
 bool BloomFilter::maybeKeyExists(const DocKey& key) {
     if (status == BFILTER_COMPACTING || status == BFILTER_ENABLED) {
+        if (type == Type::Blocked) {
+            return maybeKeyExistsBlocked(key);
+        }
         for (uint32_t i = 0; i < noOfHashes; i++) {
             uint64_t result = hashDocKey(key, i);
             if (bitArray[result % filterSize] == 0) {
@@ -159,3 +264,151 @@ size_t BloomFilter::getFilterSize() {
         return 0;
     }
 }
+
+std::unique_ptr<BloomFilter> BloomFilter::makeEmptyCopy() const {
+    return std::unique_ptr<BloomFilter>(
+            new BloomFilter(type, filterSize, noOfHashes, BFILTER_ENABLED));
+}
+
+bool BloomFilter::merge(const BloomFilter& other) {
+    if (type != other.type || filterSize != other.filterSize ||
+        noOfHashes != other.noOfHashes) {
+        return false;
+    }
+
+    if (type == Type::Blocked) {
+        if (!blocks || !other.blocks) {
+            return false;
+        }
+        for (size_t i = 0; i < numBlocks * wordsPerBlock; i++) {
+            blocks[i] |= other.blocks[i];
+        }
+    } else {
+        if (bitArray.size() != filterSize ||
+            other.bitArray.size() != filterSize) {
+            return false;
+        }
+        for (size_t i = 0; i < filterSize; i++) {
+            if (other.bitArray[i]) {
+                bitArray[i] = true;
+            }
+        }
+    }
+    // The keys of the two filters may overlap; the larger count is the best
+    // estimate available.
+    keyCounter = std::max(keyCounter, other.keyCounter);
+    return true;
+}
+
+/// Version of the format written by BloomFilter::encode().
+static const uint64_t bloomFilterEncodingVersion = 1;
+
+static void appendUint64(std::string& out, uint64_t value) {
+    value = htonll(value);
+    out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+static bool readUint64(cb::const_char_buffer data,
+                       size_t& offset,
+                       uint64_t& value) {
+    if (offset + sizeof(value) > data.size()) {
+        return false;
+    }
+    std::memcpy(&value, data.data() + offset, sizeof(value));
+    value = ntohll(value);
+    offset += sizeof(value);
+    return true;
+}
+
+std::string BloomFilter::encode() const {
+    // Header of five uint64_t (network byte order):
+    //     version, type, filterSize, noOfHashes, keyCounter
+    // followed by the bits - each word of a Blocked filter in network byte
+    // order, or a BitArray packed 8 bits per byte (LSB first).
+    std::string out;
+    const size_t header = 5 * sizeof(uint64_t);
+    if (type == Type::Blocked) {
+        out.reserve(header + numBlocks * wordsPerBlock * sizeof(uint64_t));
+    } else {
+        out.reserve(header + (bitArray.size() + 7) / 8);
+    }
+
+    appendUint64(out, bloomFilterEncodingVersion);
+    appendUint64(out, uint64_t(type));
+    appendUint64(out, filterSize);
+    appendUint64(out, noOfHashes);
+    appendUint64(out, keyCounter);
+
+    if (type == Type::Blocked) {
+        for (size_t i = 0; blocks && i < numBlocks * wordsPerBlock; i++) {
+            appendUint64(out, blocks[i]);
+        }
+    } else {
+        uint8_t byte = 0;
+        for (size_t i = 0; i < bitArray.size(); i++) {
+            if (bitArray[i]) {
+                byte |= uint8_t(1) << (i % 8);
+            }
+            if (i % 8 == 7) {
+                out.push_back(char(byte));
+                byte = 0;
+            }
+        }
+        if (bitArray.size() % 8) {
+            out.push_back(char(byte));
+        }
+    }
+    return out;
+}
+
+std::unique_ptr<BloomFilter> BloomFilter::decode(cb::const_char_buffer data) {
+    size_t offset = 0;
+    uint64_t version, encodedType, size, hashes, keys;
+    if (!readUint64(data, offset, version) ||
+        version != bloomFilterEncodingVersion ||
+        !readUint64(data, offset, encodedType) ||
+        encodedType > uint64_t(Type::Blocked) ||
+        !readUint64(data, offset, size) || !readUint64(data, offset, hashes) ||
+        !readUint64(data, offset, keys)) {
+        return {};
+    }
+
+    if (Type(encodedType) == Type::Blocked && size % bitsPerBlock != 0) {
+        return {};
+    }
+
+    // Check the payload length before allocating anything sized from the
+    // (untrusted) header.
+    const size_t expected =
+            Type(encodedType) == Type::Blocked
+                    ? (size / bitsPerBlock) * wordsPerBlock * sizeof(uint64_t)
+                    : (size + 7) / 8;
+    if (data.size() - offset != expected) {
+        return {};
+    }
+
+    std::unique_ptr<BloomFilter> filter(
+            new BloomFilter(Type(encodedType), size, hashes, BFILTER_ENABLED));
+    filter->keyCounter = keys;
+    if (filter->type == Type::Blocked) {
+        for (size_t i = 0; i < filter->numBlocks * wordsPerBlock; i++) {
+            readUint64(data, offset, filter->blocks[i]);
+        }
+    } else {
+        for (size_t i = 0; i < size; i++) {
+            const auto byte = uint8_t(data.data()[offset + i / 8]);
+            filter->bitArray[i] = (byte >> (i % 8)) & 1;
+        }
+    }
+    return filter;
+}
+
+std::string to_string(BloomFilter::Type type) {
+    switch (type) {
+    case BloomFilter::Type::BitArray:
+        return "bitarray";
+    case BloomFilter::Type::Blocked:
+        return "blocked";
+    }
+    return "<invalid>(" + std::to_string(int(type)) + ")";
+}
@@ -18,6 +18,7 @@
 #include <boost/optional/optional_io.hpp>
 #include <gsl.h>
 #include <platform/checked_snprintf.h>
+#include <algorithm>
 #include <string>
 #include <utility>
 #include <vector>
@@ -218,8 +219,10 @@ QueueDirtyStatus Checkpoint::queueDirty(const queued_item& qi,
                 // Reduce the size of the checkpoint by the size of the
                 // item being removed.
                 queuedItemsMemUsage -= ((*currPos)->size());
-                // Remove the existing item for the same key from the list.
-                toWrite.erase(currPos.getUnderlyingIterator());
+                // Remove the existing item for the same key from the queue,
+                // leaving a null element (skipped by iterators) in its place.
+                currPos.getUnderlyingIterator()->reset();
+                ++numNullItems;
             } else {
                 // The old item has been expelled, but we can continue to use
                 // this checkpoint in most cases. If the previous op was a
@@ -282,6 +285,12 @@ QueueDirtyStatus Checkpoint::queueDirty(const queued_item& qi,
         }
     }
 
+    // Once most of the queue is de-duplicated items, reclaim their space.
+    if (numNullItems > CheckpointQueue::ChunkSize &&
+        numNullItems * 2 > toWrite.size()) {
+        compactQueue(*checkpointManager);
+    }
+
     // Notify flusher if in case queued item is a checkpoint meta item or
     // vbpersist state.
     if (qi->getOperation() == queue_op::checkpoint_start ||
@@ -329,8 +338,6 @@ ExpelResult Checkpoint::expelItems(CheckpointCursor& expelUpToAndIncluding) {
     // items are deallocated within this function allowing memOverhead to be
     // tracked.
     {
-        CheckpointQueue expelledItems(trackingAllocator);
-
         ChkptQueueIterator iterator = expelUpToAndIncluding.currentPos;
 
         // Record the seqno of the last item to be expelled.
@@ -348,44 +355,42 @@ ExpelResult Checkpoint::expelItems(CheckpointCursor& expelUpToAndIncluding) {
         iterator.getUnderlyingIterator()->swap(*dummy);
 
         /*
-         * Move from (and including) the first item in the checkpoint queue upto
-         * (but not including) the item pointed to by iterator.  The item
+         * Expel from (and including) the first item in the checkpoint queue
+         * upto (but not including) the item pointed to by iterator.  The item
          * pointed to by iterator is now the new dummy item for the checkpoint
          * queue.
          */
-        expelledItems.splice(expelledItems.begin(),
-                             toWrite,
-                             begin().getUnderlyingIterator(),
-                             iterator.getUnderlyingIterator());
-
-        if (getState() == CHECKPOINT_OPEN) {
-            // Whilst cp is open invalidate item
-            for (const auto& expelled : expelledItems) {
-                if (!expelled->isCheckPointMetaItem()) {
-                    auto itr = keyIndex.find(
-                            {expelled->getKey(),
-                             expelled->isCommitted()
-                                     ? CheckpointIndexKeyNamespace::Committed
-                                     : CheckpointIndexKeyNamespace::Prepared});
-                    Expects(itr != keyIndex.end());
-                    itr->second.invalidate(end());
-                }
+        const auto expelEnd = iterator.getUnderlyingIterator();
+        for (auto itr = toWrite.begin(); itr != expelEnd; ++itr) {
+            const auto& expelled = *itr;
+            if (!expelled) {
+                // De-duplicated away already.
+                --numNullItems;
+                continue;
             }
-        }
 
-        /*
-         * Reduce the queuedItems memory usage by the size of the items
-         * being expelled from memory, and record the expelled amount in the
-         * result.
-         */
-        const auto addSize = [](size_t a, queued_item qi) {
-            return a + qi->size();
-        };
+            if (getState() == CHECKPOINT_OPEN &&
+                !expelled->isCheckPointMetaItem()) {
+                // Whilst cp is open invalidate item
+                auto index = keyIndex.find(
+                        {expelled->getKey(),
+                         expelled->isCommitted()
+                                 ? CheckpointIndexKeyNamespace::Committed
+                                 : CheckpointIndexKeyNamespace::Prepared});
+                Expects(index != keyIndex.end());
+                index->second.invalidate(end());
+            }
 
-        expelResult.estimateOfFreeMemory = std::accumulate(
-                expelledItems.begin(), expelledItems.end(), 0, addSize);
+            /*
+             * Record the expelled amount in the result, by which the
+             * queuedItems memory usage is reduced below.
+             */
+            expelResult.estimateOfFreeMemory += expelled->size();
+            ++expelResult.expelCount;
+        }
         queuedItemsMemUsage -= expelResult.estimateOfFreeMemory;
-        expelResult.expelCount = expelledItems.size();
+
+        toWrite.erase_front(expelEnd);
     }
 
     expelResult.estimateOfFreeMemory +=
@@ -393,6 +398,59 @@ ExpelResult Checkpoint::expelItems(CheckpointCursor& expelUpToAndIncluding) {
     return expelResult;
 }
 
+void Checkpoint::compactQueue(CheckpointManager& checkpointManager) {
+    // The cursors in this checkpoint, in queue order, to move along with the
+    // items they point to.
+    std::vector<std::pair<size_t, CheckpointCursor*>> cursors;
+    for (auto& cursor : checkpointManager.connCursors) {
+        if ((*(cursor.second->currentCheckpoint)).get() == this) {
+            cursors.emplace_back(cursor.second->currentPos.getUnderlyingIterator()
+                                         .getPosition(),
+                                 cursor.second.get());
+        }
+    }
+    std::sort(cursors.begin(), cursors.end());
+    auto nextCursor = cursors.begin();
+
+    toWrite.remove_if(
+            [](const queued_item& qi) { return !qi; },
+            [this, &cursors, &nextCursor](size_t oldPosition,
+                                          CheckpointQueue::iterator newPos) {
+                const ChkptQueueIterator pos(toWrite, newPos);
+                for (; nextCursor != cursors.end() &&
+                       nextCursor->first == oldPosition;
+                     ++nextCursor) {
+                    nextCursor->second->currentPos = pos;
+                }
+
+                // Every item with a key has an entry in one of the indexes,
+                // which is re-pointed at it. (For meta items sharing a key
+                // the last one wins, as it did when they were queued.)
+                const auto& qi = *newPos;
+                if (qi->getKey().size() == 0) {
+                    return;
+                }
+                if (qi->isCheckPointMetaItem()) {
+                    auto index = metaKeyIndex.find(qi->getKey());
+                    if (index != metaKeyIndex.end()) {
+                        index->second.position = pos;
+                    }
+                } else {
+                    auto index = keyIndex.find(
+                            {qi->getKey(),
+                             qi->isCommitted()
+                                     ? CheckpointIndexKeyNamespace::Committed
+                                     : CheckpointIndexKeyNamespace::Prepared});
+                    Expects(index != keyIndex.end());
+                    index->second.position = pos;
+                }
+            });
+
+    // All cursors point at items, so must have been moved.
+    Expects(nextCursor == cursors.end());
+    numNullItems = 0;
+}
+
 int64_t Checkpoint::getMutationId(const CheckpointCursor& cursor) const {
     if ((*cursor.currentPos)->isCheckPointMetaItem()) {
         auto cursor_item_idx =
@@ -489,7 +547,8 @@ std::ostream& operator <<(std::ostream& os, const Checkpoint& c) {
        << " toWrite:" << c.getWriteQueueAllocatorBytes()
        << " keyIndex:" << c.getKeyIndexAllocatorBytes()
        << " hcs:" << c.getHighCompletedSeqno() << " items:[" << std::endl;
-    for (const auto& e : c.toWrite) {
+    for (auto itr = c.begin(); itr != c.end(); ++itr) {
+        const auto& e = *itr;
         os << "\t{" << e->getBySeqno() << "," << to_string(e->getOperation());
         e->isDeleted() ? os << "[d]," : os << ",";
         os << e->getKey() << "," << e->size() << ",";
@@ -19,9 +19,11 @@
 
 #include "checkpoint_iterator.h"
 #include "checkpoint_types.h"
+#include "chunked_queue.h"
 #include "ep_types.h"
 #include "item.h"
 #include "monotonic.h"
+#include "open_hash_map.h"
 
 #include <boost/optional.hpp>
 #include <folly/Synchronized.h>
@@ -47,6 +49,8 @@
 #define DEFAULT_MAX_CHECKPOINTS 2
 #define MAX_CHECKPOINTS_UPPER_BOUND 5
 
+#define DEFAULT_EXPEL_EAGER_MIN_ITEMS 1000
+
 /**
  * The state of a given checkpoint.
  */
@@ -57,10 +61,12 @@ enum checkpoint_state {
 
 const char* to_string(enum checkpoint_state);
 
-// List is used for queueing mutations as vector incurs shift operations for
-// de-duplication.  We template the list on a queued_item and our own
-// memory allocator which allows memory usage to be tracked.
-typedef std::list<queued_item, MemoryTrackingAllocator<queued_item>>
+// A ChunkedQueue is used for queueing mutations; it gives stable positions
+// for cursors without a list node per item. De-duplicated items are reset to
+// null in place (and skipped by ChkptQueueIterator) rather than erased. We
+// template the queue on a queued_item and our own memory allocator which
+// allows memory usage to be tracked.
+typedef ChunkedQueue<queued_item, MemoryTrackingAllocator<queued_item>>
         CheckpointQueue;
 
 // Iterator for the Checkpoint queue.  The iterator is templated on the
@@ -74,6 +80,8 @@ struct index_entry {
     /**
      * Invalidate the given index_entry (as part of expelling) to ensure that
      * we use it correctly if we were expelling from the open checkpoint.
+     * The position must not be used after this (end() moves on as items are
+     * queued) - only whether the item was a SyncWrite.
      *
      * @param itr Checkpoint::end()
      */
@@ -140,26 +148,27 @@ public:
 } // namespace std
 
 /**
- * The checkpoint index maps a key to a checkpoint index_entry.
+ * The checkpoint index maps a key to a checkpoint index_entry. It is an open
+ * addressing table so that indexing a new key does not need an allocation.
  */
-using checkpoint_index = std::unordered_map<
-        CheckpointIndexKey,
-        index_entry,
-        std::hash<CheckpointIndexKey>,
-        std::equal_to<CheckpointIndexKey>,
-        MemoryTrackingAllocator<
-                std::pair<const CheckpointIndexKey, index_entry>>>;
+using checkpoint_index =
+        OpenHashMap<CheckpointIndexKey,
+                    index_entry,
+                    std::hash<CheckpointIndexKey>,
+                    std::equal_to<CheckpointIndexKey>,
+                    MemoryTrackingAllocator<
+                            std::pair<CheckpointIndexKey, index_entry>>>;
 
 /**
  * The meta_checkpoint_index does not hold items that care about durability so
  * we do not need to store the Prepare/Committed namespace.
  */
-using meta_checkpoint_index = std::unordered_map<
+using meta_checkpoint_index = OpenHashMap<
         StoredDocKey,
         index_entry,
         std::hash<StoredDocKey>,
         std::equal_to<StoredDocKey>,
-        MemoryTrackingAllocator<std::pair<const StoredDocKey, index_entry>>>;
+        MemoryTrackingAllocator<std::pair<StoredDocKey, index_entry>>>;
 
 class Checkpoint;
 class CheckpointManager;
@@ -711,6 +720,13 @@ private:
      */
     int64_t getMutationId(const CheckpointCursor& item) const;
 
+    /**
+     * Remove the null (de-duplicated) items from toWrite, freeing the space
+     * they occupy, and move the cursors in this checkpoint and the index
+     * entries to the new positions of their items.
+     */
+    void compactQueue(CheckpointManager& checkpointManager);
+
     EPStats& stats;
     uint64_t                       checkpointId;
     uint64_t                       snapStartSeqno;
@@ -733,6 +749,8 @@ private:
     // Allocator used for tracking memory used by keyIndex and metaKeyIndex
     checkpoint_index::allocator_type keyIndexTrackingAllocator;
     CheckpointQueue toWrite;
+    /// Number of null (de-duplicated) items in toWrite.
+    size_t numNullItems = 0;
     checkpoint_index               keyIndex;
     /* Index for meta keys like "dummy_key" */
     meta_checkpoint_index metaKeyIndex;
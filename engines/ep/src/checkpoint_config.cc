@@ -37,6 +37,8 @@ public:
             config.setCheckpointMaxItems(value);
         } else if (key.compare("max_checkpoints") == 0) {
             config.setMaxCheckpoints(value);
+        } else if (key.compare("chk_expel_eager_min_items") == 0) {
+            config.setExpelEagerMinItems(value);
         }
     }
 
@@ -45,6 +47,8 @@ public:
             config.allowItemNumBasedNewCheckpoint(value);
         } else if (key.compare("keep_closed_chks") == 0) {
             config.allowKeepClosedCheckpoints(value);
+        } else if (key.compare("chk_expel_eager") == 0) {
+            config.allowExpelEager(value);
         }
     }
 
@@ -58,7 +62,9 @@ CheckpointConfig::CheckpointConfig()
       maxCheckpoints(DEFAULT_MAX_CHECKPOINTS),
       itemNumBasedNewCheckpoint(true),
       keepClosedCheckpoints(false),
-      persistenceEnabled(true) { /* empty */
+      persistenceEnabled(true),
+      expelEager(false),
+      expelEagerMinItems(DEFAULT_EXPEL_EAGER_MIN_ITEMS) { /* empty */
 }
 
 CheckpointConfig::CheckpointConfig(rel_time_t period,
@@ -72,7 +78,9 @@ CheckpointConfig::CheckpointConfig(rel_time_t period,
       maxCheckpoints(max_ckpts),
       itemNumBasedNewCheckpoint(item_based_new_ckpt),
       keepClosedCheckpoints(keep_closed_ckpts),
-      persistenceEnabled(persistence_enabled) {
+      persistenceEnabled(persistence_enabled),
+      expelEager(false),
+      expelEagerMinItems(DEFAULT_EXPEL_EAGER_MIN_ITEMS) {
 }
 
 CheckpointConfig::CheckpointConfig(EventuallyPersistentEngine& e) {
@@ -83,6 +91,8 @@ CheckpointConfig::CheckpointConfig(EventuallyPersistentEngine& e) {
     itemNumBasedNewCheckpoint = config.isItemNumBasedNewChk();
     keepClosedCheckpoints = config.isKeepClosedChks();
     persistenceEnabled = config.getBucketType() == "persistent";
+    expelEager = config.isChkExpelEager();
+    expelEagerMinItems = config.getChkExpelEagerMinItems();
 }
 
 void CheckpointConfig::addConfigChangeListener(
@@ -103,6 +113,12 @@ void CheckpointConfig::addConfigChangeListener(
     configuration.addValueChangedListener(
             "keep_closed_chks",
             std::make_unique<ChangeListener>(engine.getCheckpointConfig()));
+    configuration.addValueChangedListener(
+            "chk_expel_eager",
+            std::make_unique<ChangeListener>(engine.getCheckpointConfig()));
+    configuration.addValueChangedListener(
+            "chk_expel_eager_min_items",
+            std::make_unique<ChangeListener>(engine.getCheckpointConfig()));
 }
 
 bool CheckpointConfig::validateCheckpointMaxItemsParam(
@@ -62,6 +62,14 @@ public:
         return persistenceEnabled;
     }
 
+    bool isExpelEager() const {
+        return expelEager;
+    }
+
+    size_t getExpelEagerMinItems() const {
+        return expelEagerMinItems;
+    }
+
 protected:
     friend class CheckpointConfigChangeListener;
     friend class EventuallyPersistentEngine;
@@ -82,6 +90,14 @@ protected:
         keepClosedCheckpoints = value;
     }
 
+    void allowExpelEager(bool value) {
+        expelEager = value;
+    }
+
+    void setExpelEagerMinItems(size_t value) {
+        expelEagerMinItems = value;
+    }
+
     static void addConfigChangeListener(EventuallyPersistentEngine& engine);
 
 private:
@@ -104,4 +120,11 @@ private:
 
     // Flag indicating if persistence is enabled.
     bool persistenceEnabled;
+
+    // Flag indicating if items should be expelled from a checkpoint as soon
+    // as all cursors have moved past them.
+    bool expelEager;
+    // Number of items fetched from the oldest checkpoint between eager
+    // expels.
+    size_t expelEagerMinItems;
 };
@@ -60,6 +60,11 @@ public:
         }
     }
 
+    /// Construct an iterator at the given position of the container.
+    CheckpointIterator(std::reference_wrapper<C> c, typename C::iterator it)
+        : container(c), iter(it) {
+    }
+
     auto operator++() {
         moveForward();
 
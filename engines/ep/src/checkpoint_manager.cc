@@ -46,7 +46,7 @@ CheckpointManager::CheckpointManager(EPStats& st,
       lastBySeqno(lastSeqno),
       pCursorPreCheckpointId(0),
       flusherCB(cb) {
-    LockHolder lh(queueLock);
+    WriteLockHolder lh(queueLock);
 
     lastBySeqno.setLabel("CheckpointManager(" + vbucketId.to_string() +
                          ")::lastBySeqno");
@@ -66,33 +66,35 @@ CheckpointManager::CheckpointManager(EPStats& st,
     }
 }
 
-uint64_t CheckpointManager::getOpenCheckpointId_UNLOCKED(const LockHolder& lh) {
+uint64_t CheckpointManager::getOpenCheckpointId_UNLOCKED(
+        const WriteLockHolder& lh) {
     return getOpenCheckpoint_UNLOCKED(lh).getId();
 }
 
 uint64_t CheckpointManager::getOpenCheckpointId() {
-    LockHolder lh(queueLock);
-    return getOpenCheckpointId_UNLOCKED(lh);
+    ReadLockHolder lh(queueLock);
+    return getOpenCheckpoint_UNLOCKED(lh).getId();
 }
 
 uint64_t CheckpointManager::getLastClosedCheckpointId_UNLOCKED(
-        const LockHolder& lh) {
+        const WriteLockHolder& lh) {
     auto id = getOpenCheckpointId_UNLOCKED(lh);
     return id > 0 ? (id - 1) : 0;
 }
 
 uint64_t CheckpointManager::getLastClosedCheckpointId() {
-    LockHolder lh(queueLock);
-    return getLastClosedCheckpointId_UNLOCKED(lh);
+    ReadLockHolder lh(queueLock);
+    const auto id = getOpenCheckpoint_UNLOCKED(lh).getId();
+    return id > 0 ? (id - 1) : 0;
 }
 
 void CheckpointManager::setOpenCheckpointId(uint64_t id) {
-    LockHolder lh(queueLock);
+    WriteLockHolder lh(queueLock);
     setOpenCheckpointId_UNLOCKED(lh, id);
 }
 
-void CheckpointManager::setOpenCheckpointId_UNLOCKED(const LockHolder& lh,
-                                                     uint64_t id) {
+void CheckpointManager::setOpenCheckpointId_UNLOCKED(
+        const WriteLockHolder& lh, uint64_t id) {
     auto& openCkpt = getOpenCheckpoint_UNLOCKED(lh);
 
     // Update the checkpoint_start item with the new Id.
@@ -124,7 +126,7 @@ void CheckpointManager::setOpenCheckpointId_UNLOCKED(const LockHolder& lh,
 }
 
 Checkpoint& CheckpointManager::getOpenCheckpoint_UNLOCKED(
-        const LockHolder&) const {
+        const WriteLockHolder&) const {
     // During its lifetime, the checkpointList can only be in one of the
     // following states:
     //
@@ -139,6 +141,11 @@ Checkpoint& CheckpointManager::getOpenCheckpoint_UNLOCKED(
     return *checkpointList.back();
 }
 
+const Checkpoint& CheckpointManager::getOpenCheckpoint_UNLOCKED(
+        const ReadLockHolder&) const {
+    return *checkpointList.back();
+}
+
 void CheckpointManager::addNewCheckpoint_UNLOCKED(uint64_t id) {
     addNewCheckpoint_UNLOCKED(
             id, lastBySeqno, lastBySeqno, {}, CheckpointType::Memory);
@@ -252,12 +259,14 @@ void CheckpointManager::addOpenCheckpoint(
 
 CursorRegResult CheckpointManager::registerCursorBySeqno(
         const std::string& name, uint64_t startBySeqno) {
-    LockHolder lh(queueLock);
+    WriteLockHolder lh(queueLock);
     return registerCursorBySeqno_UNLOCKED(lh, name, startBySeqno);
 }
 
 CursorRegResult CheckpointManager::registerCursorBySeqno_UNLOCKED(
-        const LockHolder& lh, const std::string& name, uint64_t startBySeqno) {
+        const WriteLockHolder& lh,
+        const std::string& name,
+        uint64_t startBySeqno) {
     const auto& openCkpt = getOpenCheckpoint_UNLOCKED(lh);
     if (openCkpt.getHighSeqno() < startBySeqno) {
         throw std::invalid_argument(
@@ -339,7 +348,7 @@ CursorRegResult CheckpointManager::registerCursorBySeqno_UNLOCKED(
 }
 
 bool CheckpointManager::removeCursor(CheckpointCursor* cursor) {
-    LockHolder lh(queueLock);
+    WriteLockHolder lh(queueLock);
     return removeCursor_UNLOCKED(cursor);
 }
 
@@ -390,7 +399,7 @@ bool CheckpointManager::removeCursor_UNLOCKED(CheckpointCursor* cursor) {
 }
 
 bool CheckpointManager::isCheckpointCreationForHighMemUsage_UNLOCKED(
-        const LockHolder& lh, const VBucket& vbucket) {
+        const WriteLockHolder& lh, const VBucket& vbucket) {
     bool forceCreation = false;
     auto memoryUsed = static_cast<double>(stats.getEstimatedTotalMemoryUsed());
 
@@ -418,7 +427,7 @@ size_t CheckpointManager::removeClosedUnrefCheckpoints(
     // returns).
     CheckpointList unrefCheckpointList;
     {
-        LockHolder lh(queueLock);
+        WriteLockHolder lh(queueLock);
         uint64_t oldCheckpointId = 0;
         bool canCreateNewCheckpoint = false;
         if (checkpointList.size() < checkpointConfig.getMaxCheckpoints() ||
@@ -506,7 +515,7 @@ size_t CheckpointManager::removeClosedUnrefCheckpoints(
 ExpelResult CheckpointManager::expelUnreferencedCheckpointItems() {
     ExpelResult expelResult;
     {
-        LockHolder lh(queueLock);
+        WriteLockHolder lh(queueLock);
 
         Checkpoint* oldestCheckpoint = checkpointList.front().get();
 
@@ -597,12 +606,14 @@ ExpelResult CheckpointManager::expelUnreferencedCheckpointItems() {
     }
 
     stats.itemsExpelledFromCheckpoints.fetch_add(expelResult.expelCount);
+    stats.memFreedByCheckpointItemExpel.fetch_add(
+            expelResult.estimateOfFreeMemory);
 
     return expelResult;
 }
 
 std::vector<Cursor> CheckpointManager::getListOfCursorsToDrop() {
-    LockHolder lh(queueLock);
+    WriteLockHolder lh(queueLock);
 
     Checkpoint* persistentCheckpoint =
             (persistenceCursor == nullptr)
@@ -646,7 +657,7 @@ std::vector<Cursor> CheckpointManager::getListOfCursorsToDrop() {
 }
 
 bool CheckpointManager::hasClosedCheckpointWhichCanBeRemoved() const {
-    LockHolder lh(queueLock);
+    ReadLockHolder lh(queueLock);
     // Check oldest checkpoint; if closed and contains no cursors then
     // we can remove it (and possibly additional old-but-not-oldest
     // checkpoints).
@@ -656,7 +667,7 @@ bool CheckpointManager::hasClosedCheckpointWhichCanBeRemoved() const {
 }
 
 void CheckpointManager::updateStatsForNewQueuedItem_UNLOCKED(
-        const LockHolder& lh, VBucket& vb, const queued_item& qi) {
+        const WriteLockHolder& lh, VBucket& vb, const queued_item& qi) {
     ++stats.totalEnqueued;
     if (checkpointConfig.isPersistenceEnabled()) {
         ++stats.diskQueueSize;
@@ -677,7 +688,7 @@ bool CheckpointManager::queueDirty(
                  "seqno",
                  qi->getBySeqno());
 
-    LockHolder lh(queueLock);
+    WriteLockHolder lh(queueLock);
 
     bool canCreateNewCheckpoint = false;
     if (checkpointList.size() < checkpointConfig.getMaxCheckpoints() ||
@@ -787,7 +798,7 @@ void CheckpointManager::queueSetVBState(VBucket& vb) {
     auto vbstate = vb.getTransitionState();
 
     // Take lock to serialize use of {lastBySeqno} and to queue op.
-    LockHolder lh(queueLock);
+    WriteLockHolder lh(queueLock);
 
     // Create the setVBState operation, and enqueue it.
     queued_item item = createCheckpointItem(/*id*/0, vbucketId,
@@ -830,7 +841,9 @@ CheckpointManager::ItemsForCursor CheckpointManager::getItemsForCursor(
                  "CheckpointManager::getItemsForCursor",
                  "vbid",
                  vbucketId.get());
-    LockHolder lh(queueLock);
+    // Only reads the checkpoints (and moves the caller's own cursor), so
+    // other cursors can fetch items concurrently.
+    ReadLockHolder lh(queueLock);
     if (!cursorPtr) {
         EP_LOG_WARN("getItemsForCursor(): Caller had a null cursor {}",
                     vbucketId);
@@ -839,6 +852,11 @@ CheckpointManager::ItemsForCursor CheckpointManager::getItemsForCursor(
 
     auto& cursor = *cursorPtr;
 
+    // Only a cursor in the oldest checkpoint can be the one holding back
+    // the items which can be expelled.
+    const bool inOldestCheckpoint =
+            cursor.currentCheckpoint == checkpointList.begin();
+
     // Fetch whole checkpoints; as long as we don't exceed the approx item
     // limit.
     ItemsForCursor result((*cursor.currentCheckpoint)->getCheckpointType(),
@@ -916,6 +934,25 @@ CheckpointManager::ItemsForCursor CheckpointManager::getItemsForCursor(
 
     cursor.numVisits++;
 
+    lh.unlock();
+
+    if (checkpointConfig.isExpelEager() && inOldestCheckpoint &&
+        itemCount > 0) {
+        // Release the items every cursor has now moved past, rather than
+        // waiting for checkpoint memory usage to trigger the
+        // ClosedUnrefCheckpointRemoverTask. A no-op if other cursors are
+        // still behind this one.
+        // Expelling takes the queueLock exclusively, so only do so once
+        // cursors have fetched a batch of items. If concurrent fetches cross
+        // the threshold together, only one of them expels.
+        const size_t minItems = checkpointConfig.getExpelEagerMinItems();
+        if (itemsFetchedSinceEagerExpel.fetch_add(itemCount) + itemCount >=
+                    minItems &&
+            itemsFetchedSinceEagerExpel.exchange(0) >= minItems) {
+            expelUnreferencedCheckpointItems();
+        }
+    }
+
     return result;
 }
 
@@ -942,17 +979,17 @@ void CheckpointManager::notifyFlusher() {
 }
 
 void CheckpointManager::setBySeqno(int64_t seqno) {
-    LockHolder lh(queueLock);
+    WriteLockHolder lh(queueLock);
     lastBySeqno = seqno;
 }
 
 int64_t CheckpointManager::getHighSeqno() const {
-    LockHolder lh(queueLock);
+    ReadLockHolder lh(queueLock);
     return lastBySeqno;
 }
 
 int64_t CheckpointManager::nextBySeqno() {
-    LockHolder lh(queueLock);
+    WriteLockHolder lh(queueLock);
     return ++lastBySeqno;
 }
 
@@ -961,7 +998,7 @@ void CheckpointManager::dump() const {
 }
 
 void CheckpointManager::clear(VBucket& vb, uint64_t seqno) {
-    LockHolder lh(queueLock);
+    WriteLockHolder lh(queueLock);
     clear_UNLOCKED(vb.getState(), seqno);
 
     // Reset the disk write queue size stat for the vbucket
@@ -1041,13 +1078,12 @@ bool CheckpointManager::moveCursorToNextCheckpoint(CheckpointCursor &cursor) {
 }
 
 size_t CheckpointManager::getNumOpenChkItems() const {
-    LockHolder lh(queueLock);
+    ReadLockHolder lh(queueLock);
     return getOpenCheckpoint_UNLOCKED(lh).getNumItems();
 }
 
-uint64_t CheckpointManager::checkOpenCheckpoint_UNLOCKED(const LockHolder& lh,
-                                                         bool forceCreation,
-                                                         bool timeBound) {
+uint64_t CheckpointManager::checkOpenCheckpoint_UNLOCKED(
+        const WriteLockHolder& lh, bool forceCreation, bool timeBound) {
     int checkpoint_id = 0;
 
     const auto& openCkpt = getOpenCheckpoint_UNLOCKED(lh);
@@ -1073,7 +1109,8 @@ uint64_t CheckpointManager::checkOpenCheckpoint_UNLOCKED(const LockHolder& lh,
 
 size_t CheckpointManager::getNumItemsForCursor(
         const CheckpointCursor* cursor) const {
-    LockHolder lh(queueLock);
+    // Exclusive, as the cursor's owner may be advancing it under a shared lock.
+    WriteLockHolder lh(queueLock);
     return getNumItemsForCursor_UNLOCKED(cursor);
 }
 
@@ -1101,7 +1138,7 @@ size_t CheckpointManager::getNumItemsForCursor_UNLOCKED(
 }
 
 void CheckpointManager::clear(vbucket_state_t vbState) {
-    LockHolder lh(queueLock);
+    WriteLockHolder lh(queueLock);
     clear_UNLOCKED(vbState, lastBySeqno);
 }
 
@@ -1121,7 +1158,7 @@ bool CheckpointManager::isLastMutationItemInCheckpoint(
 }
 
 void CheckpointManager::setBackfillPhase(uint64_t start, uint64_t end) {
-    LockHolder lh(queueLock);
+    WriteLockHolder lh(queueLock);
     setOpenCheckpointId_UNLOCKED(lh, 0);
     auto& openCkpt = getOpenCheckpoint_UNLOCKED(lh);
     openCkpt.setSnapshotStartSeqno(start);
@@ -1133,7 +1170,7 @@ void CheckpointManager::createSnapshot(
         uint64_t snapEndSeqno,
         boost::optional<uint64_t> highCompletedSeqno,
         CheckpointType checkpointType) {
-    LockHolder lh(queueLock);
+    WriteLockHolder lh(queueLock);
 
     auto& openCkpt = getOpenCheckpoint_UNLOCKED(lh);
     const auto openCkptId = openCkpt.getId();
@@ -1158,7 +1195,7 @@ void CheckpointManager::createSnapshot(
 }
 
 void CheckpointManager::resetSnapshotRange() {
-    LockHolder lh(queueLock);
+    WriteLockHolder lh(queueLock);
 
     checkpointList.back()->setSnapshotStartSeqno(
             static_cast<uint64_t>(lastBySeqno));
@@ -1168,7 +1205,7 @@ void CheckpointManager::resetSnapshotRange() {
 
 void CheckpointManager::updateCurrentSnapshot(uint64_t snapEnd,
                                               CheckpointType checkpointType) {
-    LockHolder lh(queueLock);
+    WriteLockHolder lh(queueLock);
 
     auto& ckpt = getOpenCheckpoint_UNLOCKED(lh);
     ckpt.setSnapshotEndSeqno(snapEnd);
@@ -1176,7 +1213,7 @@ void CheckpointManager::updateCurrentSnapshot(uint64_t snapEnd,
 }
 
 snapshot_info_t CheckpointManager::getSnapshotInfo() {
-    LockHolder lh(queueLock);
+    ReadLockHolder lh(queueLock);
 
     const auto& openCkpt = getOpenCheckpoint_UNLOCKED(lh);
 
@@ -1201,7 +1238,7 @@ snapshot_info_t CheckpointManager::getSnapshotInfo() {
 }
 
 uint64_t CheckpointManager::getOpenSnapshotStartSeqno() const {
-    LockHolder lh(queueLock);
+    ReadLockHolder lh(queueLock);
     const auto& openCkpt = getOpenCheckpoint_UNLOCKED(lh);
 
     return openCkpt.getSnapshotStartSeqno();
@@ -1252,7 +1289,7 @@ queued_item CheckpointManager::createCheckpointItem(uint64_t id,
 }
 
 uint64_t CheckpointManager::createNewCheckpoint() {
-    LockHolder lh(queueLock);
+    WriteLockHolder lh(queueLock);
 
     const auto& openCkpt = getOpenCheckpoint_UNLOCKED(lh);
 
@@ -1265,16 +1302,26 @@ uint64_t CheckpointManager::createNewCheckpoint() {
 }
 
 uint64_t CheckpointManager::getPersistenceCursorPreChkId() {
-    LockHolder lh(queueLock);
+    ReadLockHolder lh(queueLock);
     return pCursorPreCheckpointId;
 }
 
+uint64_t CheckpointManager::getPersistenceCursorChkId() {
+    ReadLockHolder lh(queueLock);
+    return (*persistenceCursor->currentCheckpoint)->getId();
+}
+
 void CheckpointManager::itemsPersisted() {
-    LockHolder lh(queueLock);
+    WriteLockHolder lh(queueLock);
     auto itr = persistenceCursor->currentCheckpoint;
     pCursorPreCheckpointId = ((*itr)->getId() > 0) ? (*itr)->getId() - 1 : 0;
 }
 
+void CheckpointManager::itemsPersisted(uint64_t cursorChkId) {
+    WriteLockHolder lh(queueLock);
+    pCursorPreCheckpointId = (cursorChkId > 0) ? cursorChkId - 1 : 0;
+}
+
 size_t CheckpointManager::getMemoryUsage_UNLOCKED() const {
     size_t memUsage = 0;
     for (const auto& checkpoint : checkpointList) {
@@ -1292,12 +1339,12 @@ size_t CheckpointManager::getMemoryOverhead_UNLOCKED() const {
 }
 
 size_t CheckpointManager::getMemoryUsage() const {
-    LockHolder lh(queueLock);
+    ReadLockHolder lh(queueLock);
     return getMemoryUsage_UNLOCKED();
 }
 
 size_t CheckpointManager::getMemoryUsageOfUnrefCheckpoints() const {
-    LockHolder lh(queueLock);
+    ReadLockHolder lh(queueLock);
 
     size_t memUsage = 0;
     for (const auto& checkpoint : checkpointList) {
@@ -1311,13 +1358,13 @@ size_t CheckpointManager::getMemoryUsageOfUnrefCheckpoints() const {
 }
 
 size_t CheckpointManager::getMemoryOverhead() const {
-    LockHolder lh(queueLock);
+    ReadLockHolder lh(queueLock);
     return getMemoryOverhead_UNLOCKED();
 }
 
 void CheckpointManager::addStats(const AddStatFn& add_stat,
                                  const void* cookie) {
-    LockHolder lh(queueLock);
+    WriteLockHolder lh(queueLock);
     char buf[256];
 
     try {
@@ -24,6 +24,7 @@
 #include "queue_op.h"
 
 #include <boost/optional.hpp>
+#include <folly/SharedMutex.h>
 #include <memcached/engine_common.h>
 #include <memcached/vbucket.h>
 #include <memory>
@@ -210,6 +211,9 @@ public:
      * Note: It is only valid to fetch complete checkpoints; as such we cannot
      * limit to a precise number of items.
      *
+     * Items for different cursors can be fetched concurrently, but a given
+     * cursor must only be read from by one thread at a time.
+     *
      * @param cursor CheckpointCursor to read items from and advance
      * @param[in/out] items container which items will be appended to.
      * @param approxLimit Approximate number of items to add.
@@ -309,11 +313,24 @@ public:
      */
     uint64_t getPersistenceCursorPreChkId();
 
+    /**
+     * Get id of the checkpoint where the persistence cursor is currently
+     * walking.
+     */
+    uint64_t getPersistenceCursorChkId();
+
     /**
      * Update the checkpoint manager persistence cursor checkpoint offset
      */
     void itemsPersisted();
 
+    /**
+     * Update the persistence cursor checkpoint offset as if the cursor were
+     * in the given checkpoint; for when the cursor has already read further
+     * items than have been persisted.
+     */
+    void itemsPersisted(uint64_t cursorChkId);
+
     /**
      * Return memory consumption of all the checkpoints managed
      */
@@ -397,6 +414,9 @@ public:
             runGetItemsHook;
 
 protected:
+    using WriteLockHolder = folly::SharedMutex::WriteHolder;
+    using ReadLockHolder = folly::SharedMutex::ReadHolder;
+
     /**
      * Advance the given cursor. Protected as it's valid to call this from
      * getItemsForCursor but not from anywhere else (as it will return an entire
@@ -406,17 +426,17 @@ protected:
      */
     bool incrCursor(CheckpointCursor& cursor);
 
-    uint64_t getOpenCheckpointId_UNLOCKED(const LockHolder& lh);
+    uint64_t getOpenCheckpointId_UNLOCKED(const WriteLockHolder& lh);
 
-    uint64_t getLastClosedCheckpointId_UNLOCKED(const LockHolder& lh);
+    uint64_t getLastClosedCheckpointId_UNLOCKED(const WriteLockHolder& lh);
 
-    void setOpenCheckpointId_UNLOCKED(const LockHolder& lh, uint64_t id);
+    void setOpenCheckpointId_UNLOCKED(const WriteLockHolder& lh, uint64_t id);
 
     // Helper method for queueing methods - update the global and per-VBucket
     // stats after queueing a new item to a checkpoint.
-    // Must be called with queueLock held (LockHolder passed in as argument to
-    // 'prove' this).
-    void updateStatsForNewQueuedItem_UNLOCKED(const LockHolder& lh,
+    // Must be called with queueLock held exclusively (WriteLockHolder passed
+    // in as argument to 'prove' this).
+    void updateStatsForNewQueuedItem_UNLOCKED(const WriteLockHolder& lh,
                                               VBucket& vb,
                                               const queued_item& qi);
 
@@ -431,7 +451,7 @@ protected:
 
     bool removeCursor_UNLOCKED(CheckpointCursor* cursor);
 
-    CursorRegResult registerCursorBySeqno_UNLOCKED(const LockHolder& lh,
+    CursorRegResult registerCursorBySeqno_UNLOCKED(const WriteLockHolder& lh,
                                                    const std::string& name,
                                                    uint64_t startBySeqno);
 
@@ -442,7 +462,9 @@ protected:
     /*
      * @return a reference to the open checkpoint
      */
-    Checkpoint& getOpenCheckpoint_UNLOCKED(const LockHolder& lh) const;
+    Checkpoint& getOpenCheckpoint_UNLOCKED(const WriteLockHolder& lh) const;
+    const Checkpoint& getOpenCheckpoint_UNLOCKED(
+            const ReadLockHolder& lh) const;
 
     /*
      * Closes the current open checkpoint and adds a new open checkpoint to
@@ -498,14 +520,14 @@ protected:
      * @return the previous open checkpoint Id if we create the new open checkpoint. Otherwise
      * return 0.
      */
-    uint64_t checkOpenCheckpoint_UNLOCKED(const LockHolder& lh,
+    uint64_t checkOpenCheckpoint_UNLOCKED(const WriteLockHolder& lh,
                                           bool forceCreation,
                                           bool timeBound);
 
     bool isLastMutationItemInCheckpoint(CheckpointCursor &cursor);
 
-    bool isCheckpointCreationForHighMemUsage_UNLOCKED(const LockHolder& lh,
-                                                      const VBucket& vbucket);
+    bool isCheckpointCreationForHighMemUsage_UNLOCKED(
+            const WriteLockHolder& lh, const VBucket& vbucket);
 
     void resetCursors(bool resetPersistenceCursor = true);
 
@@ -515,7 +537,18 @@ protected:
 
     EPStats                 &stats;
     CheckpointConfig        &checkpointConfig;
-    mutable std::mutex       queueLock;
+    /**
+     * Guards the checkpoints and cursors. Held exclusively to modify them
+     * (queueing items, creating / removing checkpoints and cursors), and
+     * shared to read them. A client may also advance its own cursor under a
+     * shared lock (see getItemsForCursor), as each cursor is only ever read
+     * from by one client at a time; this lets the flusher and DCP streams
+     * fetch items concurrently, only excluding the frontend writers.
+     *
+     * Writer priority means a steady stream of cursor reads cannot starve
+     * queueDirty.
+     */
+    mutable folly::SharedMutex queueLock;
     const Vbid vbucketId;
 
     // Total number of items (including meta items) in /all/ checkpoints managed
@@ -524,6 +557,10 @@ protected:
     Monotonic<int64_t>       lastBySeqno;
     uint64_t                 pCursorPreCheckpointId;
 
+    // Items fetched by cursors in the oldest checkpoint since it was last
+    // eagerly expelled (see CheckpointConfig::getExpelEagerMinItems).
+    std::atomic<size_t> itemsFetchedSinceEagerExpel{0};
+
     /**
      * connCursors: stores all known CheckpointCursor objects which are held via
      * shared_ptr. When a client creates a cursor we store the shared_ptr and
@@ -0,0 +1,268 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2019 Couchbase, Inc
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+/**
+ * A FIFO queue which stores its elements contiguously in fixed-size chunks,
+ * used for the Checkpoint queue.
+ *
+ * Elements can only be added at the back and removed from the front, which
+ * means (unlike std::deque) iterators are stable: an iterator remains valid
+ * until the element it refers to is removed. Elements in the middle of the
+ * queue are "removed" by the owner resetting them to a null value (which
+ * CheckpointIterator skips), and reclaimed in bulk by remove_if().
+ *
+ * Compared with std::list this avoids an allocation per element (a chunk is
+ * allocated every ChunkSize elements) and iteration walks contiguous memory.
+ *
+ * The queue always has a chunk with space for the next element, so that
+ * end() is a valid position which becomes the position of the next element
+ * pushed.
+ */
+template <typename T, typename Allocator = std::allocator<T>>
+class ChunkedQueue {
+    struct Chunk;
+
+public:
+    static constexpr size_t ChunkSize = 64;
+
+    using value_type = T;
+    using size_type = size_t;
+    using difference_type = ptrdiff_t;
+    using pointer = T*;
+    using reference = T&;
+    using allocator_type = Allocator;
+
+    class iterator {
+    public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = T;
+        using difference_type = ptrdiff_t;
+        using pointer = T*;
+        using reference = T&;
+
+        iterator() = default;
+
+        reference operator*() const {
+            return chunk->at(index);
+        }
+
+        pointer operator->() const {
+            return &chunk->at(index);
+        }
+
+        iterator& operator++() {
+            if (++index == ChunkSize) {
+                chunk = chunk->next;
+                index = 0;
+            }
+            return *this;
+        }
+
+        iterator operator++(int) {
+            auto before = *this;
+            operator++();
+            return before;
+        }
+
+        iterator& operator--() {
+            if (index == 0) {
+                chunk = chunk->prev;
+                index = ChunkSize;
+            }
+            --index;
+            return *this;
+        }
+
+        iterator operator--(int) {
+            auto before = *this;
+            operator--();
+            return before;
+        }
+
+        bool operator==(const iterator& other) const {
+            return chunk == other.chunk && index == other.index;
+        }
+
+        bool operator!=(const iterator& other) const {
+            return !operator==(other);
+        }
+
+        /**
+         * @returns the position of the element in the queue. Positions
+         * increase from front to back and are not re-used as elements are
+         * removed from the front (but are by remove_if).
+         */
+        size_t getPosition() const {
+            return chunk->base + index;
+        }
+
+    private:
+        friend class ChunkedQueue;
+
+        iterator(Chunk* chunk, size_t index) : chunk(chunk), index(index) {
+        }
+
+        Chunk* chunk = nullptr;
+        size_t index = 0;
+    };
+
+    explicit ChunkedQueue(const Allocator& alloc) : chunkAllocator(alloc) {
+        head.chunk = tail.chunk = allocateChunk(nullptr, 0);
+    }
+
+    ChunkedQueue(const ChunkedQueue&) = delete;
+    ChunkedQueue& operator=(const ChunkedQueue&) = delete;
+
+    ~ChunkedQueue() {
+        erase_front(end());
+        freeChunk(head.chunk);
+    }
+
+    iterator begin() {
+        return head;
+    }
+
+    iterator end() {
+        return tail;
+    }
+
+    /// @returns the number of elements, including any null elements.
+    size_t size() const {
+        return tail.getPosition() - head.getPosition();
+    }
+
+    bool empty() const {
+        return head == tail;
+    }
+
+    void push_back(const T& value) {
+        new (&tail.chunk->at(tail.index)) T(value);
+        if (tail.index + 1 == ChunkSize) {
+            tail.chunk->next = allocateChunk(tail.chunk, tail.getPosition() + 1);
+        }
+        ++tail;
+    }
+
+    /**
+     * Remove the elements from the front of the queue up to (but not
+     * including) pos, freeing any chunks no longer in use.
+     */
+    void erase_front(iterator pos) {
+        while (head != pos) {
+            head.chunk->at(head.index).~T();
+            if (++head.index == ChunkSize) {
+                Chunk* old = head.chunk;
+                head.chunk = old->next;
+                head.chunk->prev = nullptr;
+                head.index = 0;
+                freeChunk(old);
+            }
+        }
+    }
+
+    /**
+     * Remove the elements for which pred returns true, moving the remaining
+     * elements towards the front of the queue and freeing any chunks no
+     * longer in use. Invalidates all iterators; moved(oldPosition,
+     * newIterator) is called for each remaining element, in order.
+     */
+    template <typename Pred, typename Moved>
+    void remove_if(Pred pred, Moved moved) {
+        iterator out = head;
+        for (iterator in = head; in != tail; ++in) {
+            if (pred(*in)) {
+                continue;
+            }
+            if (out != in) {
+                *out = std::move(*in);
+            }
+            moved(in.getPosition(), out);
+            ++out;
+        }
+
+        for (iterator it = out; it != tail; ++it) {
+            it->~T();
+        }
+        Chunk* unused = out.chunk->next;
+        out.chunk->next = nullptr;
+        while (unused) {
+            Chunk* next = unused->next;
+            freeChunk(unused);
+            unused = next;
+        }
+        tail = out;
+    }
+
+    allocator_type get_allocator() const {
+        return allocator_type(chunkAllocator);
+    }
+
+    /**
+     * @returns the number of bytes a queue allocates to hold the given number
+     * of elements (including null elements) pushed since it was last empty.
+     */
+    static constexpr size_t getBytesForElements(size_t elements) {
+        return ((elements / ChunkSize) + 1) * sizeof(Chunk);
+    }
+
+private:
+    struct Chunk {
+        T& at(size_t i) {
+            return *reinterpret_cast<T*>(&slots[i]);
+        }
+
+        Chunk* prev;
+        Chunk* next;
+        /// Position of slots[0] in the queue.
+        size_t base;
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type
+                slots[ChunkSize];
+    };
+
+    using ChunkAllocator = typename std::allocator_traits<
+            Allocator>::template rebind_alloc<Chunk>;
+
+    Chunk* allocateChunk(Chunk* prev, size_t base) {
+        Chunk* chunk = chunkAllocator.allocate(1);
+        chunk->prev = prev;
+        chunk->next = nullptr;
+        chunk->base = base;
+        return chunk;
+    }
+
+    void freeChunk(Chunk* chunk) {
+        chunkAllocator.deallocate(chunk, 1);
+    }
+
+    ChunkAllocator chunkAllocator;
+    /// The first element.
+    iterator head;
+    /// One past the last element; always has space in its chunk.
+    iterator tail;
+};
+
+template <typename T, typename Allocator>
+constexpr size_t ChunkedQueue<T, Allocator>::ChunkSize;
@@ -0,0 +1,183 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2019 Couchbase, Inc
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+
+#include "couch-kvstore/couch-fs-deferred-sync.h"
+
+std::unique_ptr<DeferredSyncOps> getCouchstoreDeferredSyncOps(
+        FileOpsInterface& base_ops) {
+    return std::make_unique<DeferredSyncOps>(base_ops);
+}
+
+DeferredSyncOps::~DeferredSyncOps() {
+    couchstore_error_info_t errinfo;
+    syncDeferred(&errinfo);
+    // Don't leak any files whose sync failed.
+    for (auto* df : deferred) {
+        release(*df);
+    }
+}
+
+couchstore_error_t DeferredSyncOps::syncDeferred(
+        couchstore_error_info_t* errinfo) {
+    auto result = COUCHSTORE_SUCCESS;
+    auto it = deferred.begin();
+    for (; it != deferred.end(); ++it) {
+        auto* df = *it;
+        if (df->syncPending) {
+            result = wrapped_ops.sync(errinfo, df->orig_handle);
+            if (result != COUCHSTORE_SUCCESS) {
+                break;
+            }
+            df->syncPending = false;
+        }
+        df->listed = false;
+        release(*df);
+    }
+    deferred.erase(deferred.begin(), it);
+    return result;
+}
+
+void DeferredSyncOps::release(DeferredSyncFile& df) {
+    if (df.closed) {
+        couchstore_error_info_t errinfo;
+        wrapped_ops.close(&errinfo, df.orig_handle);
+        df.closed = false;
+    }
+    if (df.destroyed) {
+        wrapped_ops.destructor(df.orig_handle);
+        delete &df;
+    }
+}
+
+couch_file_handle DeferredSyncOps::constructor(
+        couchstore_error_info_t* errinfo) {
+    auto* df = new DeferredSyncFile(wrapped_ops.constructor(errinfo));
+    return reinterpret_cast<couch_file_handle>(df);
+}
+
+couchstore_error_t DeferredSyncOps::open(couchstore_error_info_t* errinfo,
+                                         couch_file_handle* h,
+                                         const char* path,
+                                         int flags) {
+    auto* df = reinterpret_cast<DeferredSyncFile*>(*h);
+    return wrapped_ops.open(errinfo, &df->orig_handle, path, flags);
+}
+
+couchstore_error_t DeferredSyncOps::close(couchstore_error_info_t* errinfo,
+                                          couch_file_handle h) {
+    auto* df = reinterpret_cast<DeferredSyncFile*>(h);
+    if (df->syncPending) {
+        // Keep the file open for its deferred sync.
+        df->closed = true;
+        return COUCHSTORE_SUCCESS;
+    }
+    return wrapped_ops.close(errinfo, df->orig_handle);
+}
+
+couchstore_error_t DeferredSyncOps::set_periodic_sync(couch_file_handle h,
+                                                      uint64_t period_bytes) {
+    auto* df = reinterpret_cast<DeferredSyncFile*>(h);
+    return wrapped_ops.set_periodic_sync(df->orig_handle, period_bytes);
+}
+
+couchstore_error_t DeferredSyncOps::set_tracing_enabled(couch_file_handle h) {
+    auto* df = reinterpret_cast<DeferredSyncFile*>(h);
+    return wrapped_ops.set_tracing_enabled(df->orig_handle);
+}
+
+couchstore_error_t DeferredSyncOps::set_write_validation_enabled(
+        couch_file_handle h) {
+    auto* df = reinterpret_cast<DeferredSyncFile*>(h);
+    return wrapped_ops.set_write_validation_enabled(df->orig_handle);
+}
+
+couchstore_error_t DeferredSyncOps::set_mprotect_enabled(couch_file_handle h) {
+    auto* df = reinterpret_cast<DeferredSyncFile*>(h);
+    return wrapped_ops.set_mprotect_enabled(df->orig_handle);
+}
+
+ssize_t DeferredSyncOps::pread(couchstore_error_info_t* errinfo,
+                               couch_file_handle h,
+                               void* buf,
+                               size_t sz,
+                               cs_off_t off) {
+    auto* df = reinterpret_cast<DeferredSyncFile*>(h);
+    return wrapped_ops.pread(errinfo, df->orig_handle, buf, sz, off);
+}
+
+ssize_t DeferredSyncOps::pwrite(couchstore_error_info_t* errinfo,
+                                couch_file_handle h,
+                                const void* buf,
+                                size_t sz,
+                                cs_off_t off) {
+    auto* df = reinterpret_cast<DeferredSyncFile*>(h);
+    if (df->syncPending) {
+        // Everything written before the requested sync must be durable
+        // before anything written after it (e.g. the header).
+        auto result = wrapped_ops.sync(errinfo, df->orig_handle);
+        if (result != COUCHSTORE_SUCCESS) {
+            return result;
+        }
+        df->syncPending = false;
+    }
+    return wrapped_ops.pwrite(errinfo, df->orig_handle, buf, sz, off);
+}
+
+cs_off_t DeferredSyncOps::goto_eof(couchstore_error_info_t* errinfo,
+                                   couch_file_handle h) {
+    auto* df = reinterpret_cast<DeferredSyncFile*>(h);
+    return wrapped_ops.goto_eof(errinfo, df->orig_handle);
+}
+
+couchstore_error_t DeferredSyncOps::sync(couchstore_error_info_t* errinfo,
+                                         couch_file_handle h) {
+    auto* df = reinterpret_cast<DeferredSyncFile*>(h);
+    if (!deferring) {
+        df->syncPending = false;
+        return wrapped_ops.sync(errinfo, df->orig_handle);
+    }
+    df->syncPending = true;
+    if (!df->listed) {
+        df->listed = true;
+        deferred.push_back(df);
+    }
+    return COUCHSTORE_SUCCESS;
+}
+
+couchstore_error_t DeferredSyncOps::advise(couchstore_error_info_t* errinfo,
+                                           couch_file_handle h,
+                                           cs_off_t offs,
+                                           cs_off_t len,
+                                           couchstore_file_advice_t adv) {
+    auto* df = reinterpret_cast<DeferredSyncFile*>(h);
+    return wrapped_ops.advise(errinfo, df->orig_handle, offs, len, adv);
+}
+
+FileOpsInterface::FHStats* DeferredSyncOps::get_stats(couch_file_handle h) {
+    auto* df = reinterpret_cast<DeferredSyncFile*>(h);
+    return wrapped_ops.get_stats(df->orig_handle);
+}
+
+void DeferredSyncOps::destructor(couch_file_handle h) {
+    auto* df = reinterpret_cast<DeferredSyncFile*>(h);
+    if (df->listed) {
+        df->destroyed = true;
+        return;
+    }
+    wrapped_ops.destructor(df->orig_handle);
+    delete df;
+}
@@ -0,0 +1,140 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2019 Couchbase, Inc
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+#pragma once
+
+#include <libcouchstore/couch_db.h>
+
+#include <memory>
+#include <vector>
+
+class DeferredSyncOps;
+
+/**
+ * Returns an instance of DeferredSyncOps wrapping the given FileOps
+ * implementation.
+ */
+std::unique_ptr<DeferredSyncOps> getCouchstoreDeferredSyncOps(
+        FileOpsInterface& base_ops);
+
+/**
+ * FileOpsInterface implementation used by the flusher's commits, which can
+ * defer the final sync of each commit so that the commits of several
+ * vBuckets (each in its own file) become durable together, at the end of a
+ * group commit.
+ *
+ * couchstore syncs twice per commit: once after writing the documents and
+ * tree nodes, so they are durable before the header which refers to them is
+ * written, and once after writing the header. While deferring, a sync only
+ * marks the file as needing one; the data-before-header ordering is kept by
+ * performing a marked sync before the next write to the file. As a commit's
+ * header is its last write, its header sync (and closing the file) is
+ * deferred until syncDeferred().
+ *
+ * Not thread-safe: used only by the flusher of the owning KVStore.
+ */
+class DeferredSyncOps : public FileOpsInterface {
+public:
+    explicit DeferredSyncOps(FileOpsInterface& ops) : wrapped_ops(ops) {
+    }
+
+    /// Syncs and releases any files still deferred.
+    ~DeferredSyncOps() override;
+
+    /**
+     * Enable or disable deferring syncs. Syncs already deferred remain so
+     * until syncDeferred().
+     */
+    void setDeferring(bool defer) {
+        deferring = defer;
+    }
+
+    bool isDeferring() const {
+        return deferring;
+    }
+
+    /// @returns the number of files with a deferred sync or close.
+    size_t getNumDeferred() const {
+        return deferred.size();
+    }
+
+    /**
+     * Perform the deferred syncs, then any close / destruction of those
+     * files which was deferred. If a sync fails that file and any not yet
+     * synced remain deferred, so the call can be retried.
+     */
+    couchstore_error_t syncDeferred(couchstore_error_info_t* errinfo);
+
+    couch_file_handle constructor(couchstore_error_info_t* errinfo) override;
+    couchstore_error_t open(couchstore_error_info_t* errinfo,
+                            couch_file_handle* handle,
+                            const char* path,
+                            int oflag) override;
+    couchstore_error_t close(couchstore_error_info_t* errinfo,
+                             couch_file_handle handle) override;
+    couchstore_error_t set_periodic_sync(couch_file_handle handle,
+                                         uint64_t period_bytes) override;
+    couchstore_error_t set_tracing_enabled(couch_file_handle handle) override;
+    couchstore_error_t set_write_validation_enabled(
+            couch_file_handle handle) override;
+    couchstore_error_t set_mprotect_enabled(couch_file_handle handle) override;
+
+    ssize_t pread(couchstore_error_info_t* errinfo,
+                  couch_file_handle handle,
+                  void* buf,
+                  size_t nbytes,
+                  cs_off_t offset) override;
+    ssize_t pwrite(couchstore_error_info_t* errinfo,
+                   couch_file_handle handle,
+                   const void* buf,
+                   size_t nbytes,
+                   cs_off_t offset) override;
+    cs_off_t goto_eof(couchstore_error_info_t* errinfo,
+                      couch_file_handle handle) override;
+    couchstore_error_t sync(couchstore_error_info_t* errinfo,
+                            couch_file_handle handle) override;
+    couchstore_error_t advise(couchstore_error_info_t* errinfo,
+                              couch_file_handle handle,
+                              cs_off_t offset,
+                              cs_off_t len,
+                              couchstore_file_advice_t advice) override;
+    FHStats* get_stats(couch_file_handle handle) override;
+    void destructor(couch_file_handle handle) override;
+
+protected:
+    struct DeferredSyncFile {
+        explicit DeferredSyncFile(couch_file_handle orig_handle)
+            : orig_handle(orig_handle) {
+        }
+
+        couch_file_handle orig_handle;
+        /// A sync was requested and not yet performed.
+        bool syncPending = false;
+        /// In the deferred list.
+        bool listed = false;
+        /// close() / destructor() were called while listed.
+        bool closed = false;
+        bool destroyed = false;
+    };
+
+    /// Perform a deferred close / destruction of the file.
+    void release(DeferredSyncFile& df);
+
+    FileOpsInterface& wrapped_ops;
+    bool deferring = false;
+    /// Files with a deferred sync, in the order they were first deferred.
+    std::vector<DeferredSyncFile*> deferred;
+};
@@ -0,0 +1,144 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2019 Couchbase, Inc
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+
+#include "couch-kvstore/couch-fs-readahead.h"
+#include "kvstore_config.h"
+
+std::unique_ptr<FileOpsInterface> getCouchstoreReadAheadOps(
+        const KVStoreConfig& config, FileOpsInterface& base_ops) {
+    return std::make_unique<ReadAheadOps>(config, base_ops);
+}
+
+couch_file_handle ReadAheadOps::constructor(couchstore_error_info_t* errinfo) {
+    auto* rf = new ReadAheadFile(wrapped_ops.constructor(errinfo));
+    return reinterpret_cast<couch_file_handle>(rf);
+}
+
+couchstore_error_t ReadAheadOps::open(couchstore_error_info_t* errinfo,
+                                      couch_file_handle* h,
+                                      const char* path,
+                                      int flags) {
+    auto* rf = reinterpret_cast<ReadAheadFile*>(*h);
+    rf->window_start = 0;
+    rf->window_end = 0;
+    auto result = wrapped_ops.open(errinfo, &rf->orig_handle, path, flags);
+    if (result == COUCHSTORE_SUCCESS &&
+        config.getBackfillReadAheadBytes() != 0) {
+        // Advice is only a hint; ignore any failure.
+        wrapped_ops.advise(errinfo,
+                           rf->orig_handle,
+                           0,
+                           0,
+                           COUCHSTORE_FILE_ADVICE_SEQUENTIAL);
+    }
+    return result;
+}
+
+couchstore_error_t ReadAheadOps::close(couchstore_error_info_t* errinfo,
+                                       couch_file_handle h) {
+    auto* rf = reinterpret_cast<ReadAheadFile*>(h);
+    return wrapped_ops.close(errinfo, rf->orig_handle);
+}
+
+couchstore_error_t ReadAheadOps::set_periodic_sync(couch_file_handle h,
+                                                   uint64_t period_bytes) {
+    auto* rf = reinterpret_cast<ReadAheadFile*>(h);
+    return wrapped_ops.set_periodic_sync(rf->orig_handle, period_bytes);
+}
+
+couchstore_error_t ReadAheadOps::set_tracing_enabled(couch_file_handle h) {
+    auto* rf = reinterpret_cast<ReadAheadFile*>(h);
+    return wrapped_ops.set_tracing_enabled(rf->orig_handle);
+}
+
+couchstore_error_t ReadAheadOps::set_write_validation_enabled(
+        couch_file_handle h) {
+    auto* rf = reinterpret_cast<ReadAheadFile*>(h);
+    return wrapped_ops.set_write_validation_enabled(rf->orig_handle);
+}
+
+couchstore_error_t ReadAheadOps::set_mprotect_enabled(couch_file_handle h) {
+    auto* rf = reinterpret_cast<ReadAheadFile*>(h);
+    return wrapped_ops.set_mprotect_enabled(rf->orig_handle);
+}
+
+ssize_t ReadAheadOps::pread(couchstore_error_info_t* errinfo,
+                            couch_file_handle h,
+                            void* buf,
+                            size_t sz,
+                            cs_off_t off) {
+    auto* rf = reinterpret_cast<ReadAheadFile*>(h);
+    const auto window = cs_off_t(config.getBackfillReadAheadBytes());
+    if (window != 0) {
+        const cs_off_t end = off + cs_off_t(sz);
+        const bool outside = off < rf->window_start || off >= rf->window_end;
+        // Once the reads reach the second half of the window, advise the
+        // next window from here.
+        const bool secondHalf = end > rf->window_end - window / 2;
+        if (outside || secondHalf) {
+            rf->window_start = off;
+            rf->window_end = off + window;
+            wrapped_ops.advise(errinfo,
+                               rf->orig_handle,
+                               off,
+                               window,
+                               COUCHSTORE_FILE_ADVICE_WILLNEED);
+        }
+    }
+    return wrapped_ops.pread(errinfo, rf->orig_handle, buf, sz, off);
+}
+
+ssize_t ReadAheadOps::pwrite(couchstore_error_info_t* errinfo,
+                             couch_file_handle h,
+                             const void* buf,
+                             size_t sz,
+                             cs_off_t off) {
+    auto* rf = reinterpret_cast<ReadAheadFile*>(h);
+    return wrapped_ops.pwrite(errinfo, rf->orig_handle, buf, sz, off);
+}
+
+cs_off_t ReadAheadOps::goto_eof(couchstore_error_info_t* errinfo,
+                                couch_file_handle h) {
+    auto* rf = reinterpret_cast<ReadAheadFile*>(h);
+    return wrapped_ops.goto_eof(errinfo, rf->orig_handle);
+}
+
+couchstore_error_t ReadAheadOps::sync(couchstore_error_info_t* errinfo,
+                                      couch_file_handle h) {
+    auto* rf = reinterpret_cast<ReadAheadFile*>(h);
+    return wrapped_ops.sync(errinfo, rf->orig_handle);
+}
+
+couchstore_error_t ReadAheadOps::advise(couchstore_error_info_t* errinfo,
+                                        couch_file_handle h,
+                                        cs_off_t offs,
+                                        cs_off_t len,
+                                        couchstore_file_advice_t adv) {
+    auto* rf = reinterpret_cast<ReadAheadFile*>(h);
+    return wrapped_ops.advise(errinfo, rf->orig_handle, offs, len, adv);
+}
+
+FileOpsInterface::FHStats* ReadAheadOps::get_stats(couch_file_handle h) {
+    auto* rf = reinterpret_cast<ReadAheadFile*>(h);
+    return wrapped_ops.get_stats(rf->orig_handle);
+}
+
+void ReadAheadOps::destructor(couch_file_handle h) {
+    auto* rf = reinterpret_cast<ReadAheadFile*>(h);
+    wrapped_ops.destructor(rf->orig_handle);
+    delete rf;
+}
@@ -0,0 +1,105 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2019 Couchbase, Inc
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+#pragma once
+
+#include <libcouchstore/couch_db.h>
+
+#include <memory>
+
+class KVStoreConfig;
+
+/**
+ * Returns an instance of ReadAheadOps wrapping the given FileOps
+ * implementation, reading the read-ahead window size from config.
+ */
+std::unique_ptr<FileOpsInterface> getCouchstoreReadAheadOps(
+        const KVStoreConfig& config, FileOpsInterface& base_ops);
+
+/**
+ * FileOpsInterface implementation used for by-seqno scans (DCP backfill),
+ * which asks the OS to read ahead of the scan so that disk I/O overlaps
+ * with the scan's callbacks delivering items to the DCP streams.
+ *
+ * A by-seqno scan reads the data file mostly forwards (documents and the
+ * leaves of the by-seqno tree are written in seqno order), so when a file
+ * is opened it is advised as SEQUENTIAL, and reads are tracked against a
+ * window of KVStoreConfig::getBackfillReadAheadBytes() which has been
+ * advised WILLNEED (prompting asynchronous readahead into the page cache).
+ * The window is double buffered: once reads reach its second half the next
+ * window is advised from the read position, so the kernel fills the next
+ * half while the current one is consumed. A read outside the window (e.g.
+ * of an interior tree node) starts a new window there.
+ *
+ * A window size of zero disables the advice.
+ */
+class ReadAheadOps : public FileOpsInterface {
+public:
+    ReadAheadOps(const KVStoreConfig& config, FileOpsInterface& ops)
+        : config(config), wrapped_ops(ops) {
+    }
+
+    couch_file_handle constructor(couchstore_error_info_t* errinfo) override;
+    couchstore_error_t open(couchstore_error_info_t* errinfo,
+                            couch_file_handle* handle,
+                            const char* path,
+                            int oflag) override;
+    couchstore_error_t close(couchstore_error_info_t* errinfo,
+                             couch_file_handle handle) override;
+    couchstore_error_t set_periodic_sync(couch_file_handle handle,
+                                         uint64_t period_bytes) override;
+    couchstore_error_t set_tracing_enabled(couch_file_handle handle) override;
+    couchstore_error_t set_write_validation_enabled(
+            couch_file_handle handle) override;
+    couchstore_error_t set_mprotect_enabled(couch_file_handle handle) override;
+
+    ssize_t pread(couchstore_error_info_t* errinfo,
+                  couch_file_handle handle,
+                  void* buf,
+                  size_t nbytes,
+                  cs_off_t offset) override;
+    ssize_t pwrite(couchstore_error_info_t* errinfo,
+                   couch_file_handle handle,
+                   const void* buf,
+                   size_t nbytes,
+                   cs_off_t offset) override;
+    cs_off_t goto_eof(couchstore_error_info_t* errinfo,
+                      couch_file_handle handle) override;
+    couchstore_error_t sync(couchstore_error_info_t* errinfo,
+                            couch_file_handle handle) override;
+    couchstore_error_t advise(couchstore_error_info_t* errinfo,
+                              couch_file_handle handle,
+                              cs_off_t offset,
+                              cs_off_t len,
+                              couchstore_file_advice_t advice) override;
+    FHStats* get_stats(couch_file_handle handle) override;
+    void destructor(couch_file_handle handle) override;
+
+protected:
+    struct ReadAheadFile {
+        explicit ReadAheadFile(couch_file_handle orig_handle)
+            : orig_handle(orig_handle) {
+        }
+
+        couch_file_handle orig_handle;
+        /// Range most recently advised WILLNEED.
+        cs_off_t window_start = 0;
+        cs_off_t window_end = 0;
+    };
+
+    const KVStoreConfig& config;
+    FileOpsInterface& wrapped_ops;
+};
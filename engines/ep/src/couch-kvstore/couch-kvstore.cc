@@ -312,6 +312,8 @@ static constexpr const char* droppedCollectionsName =
         "_local/collections/dropped";
 } // namespace Collections
 
+static constexpr const char* bloomFilterName = "_local/bloomfilter";
+
 CouchKVStore::CouchKVStore(KVStoreConfig& config)
     : CouchKVStore(config, *couchstore_get_default_file_ops()) {
 }
@@ -331,6 +333,9 @@ CouchKVStore::CouchKVStore(KVStoreConfig& config,
     statCollectingFileOps = getCouchstoreStatsOps(st.fsStats, base_ops);
     statCollectingFileOpsCompaction = getCouchstoreStatsOps(
         st.fsStatsCompaction, base_ops);
+    readAheadFileOps =
+            getCouchstoreReadAheadOps(configuration, *statCollectingFileOps);
+    deferredSyncFileOps = getCouchstoreDeferredSyncOps(*statCollectingFileOps);
 
     // init db file map with default revision number, 1
     numDbFiles = configuration.getMaxVBuckets();
@@ -1380,6 +1385,25 @@ bool CouchKVStore::commit(Collections::VB::Flush& collectionsFlush) {
     return !intransaction;
 }
 
+bool CouchKVStore::setDeferCommitSync(bool defer) {
+    deferredSyncFileOps->setDeferring(defer);
+    return defer;
+}
+
+bool CouchKVStore::syncDeferredCommits() {
+    couchstore_error_info_t errinfo;
+    auto errCode = deferredSyncFileOps->syncDeferred(&errinfo);
+    if (errCode != COUCHSTORE_SUCCESS) {
+        logger.warn(
+                "CouchKVStore::syncDeferredCommits: sync error:{}, "
+                "files remaining:{}",
+                couchstore_strerror(errCode),
+                deferredSyncFileOps->getNumDeferred());
+        return false;
+    }
+    return true;
+}
+
 bool CouchKVStore::getStat(const char* name, size_t& value)  {
     if (strcmp("failure_compaction", name) == 0) {
         value = st.numCompactionFailure.load();
@@ -1444,8 +1468,10 @@ ScanContext* CouchKVStore::initScanContext(
         DocumentFilter options,
         ValueFilter valOptions) {
     DbHolder db(*this);
-    couchstore_error_t errorCode =
-            openDB(vbid, db, COUCHSTORE_OPEN_FLAG_RDONLY);
+    couchstore_error_t errorCode = openDB(vbid,
+                                          db,
+                                          COUCHSTORE_OPEN_FLAG_RDONLY,
+                                          readAheadFileOps.get());
     if (errorCode != COUCHSTORE_SUCCESS) {
         logger.warn(
                 "CouchKVStore::initScanContext: openDB error:{}, "
@@ -2184,7 +2210,10 @@ couchstore_error_t CouchKVStore::saveDocs(Vbid vbid,
     couchstore_error_t errCode;
     DbInfo info;
     DbHolder db(*this);
-    errCode = openDB(vbid, db, COUCHSTORE_OPEN_FLAG_CREATE);
+    errCode = openDB(vbid,
+                     db,
+                     COUCHSTORE_OPEN_FLAG_CREATE,
+                     deferredSyncFileOps.get());
     if (errCode != COUCHSTORE_SUCCESS) {
         logger.warn(
                 "CouchKVStore::saveDocs: openDB error:{}, {}, rev:{}, "
@@ -3243,6 +3272,56 @@ Collections::KVStore::Manifest CouchKVStore::getCollectionsManifest(Vbid vbid) {
             dropped.getLocalDoc() ? dropped.getBuffer() : empty);
 }
 
+bool CouchKVStore::persistBloomFilter(Vbid vbid,
+                                      const PersistedBloomFilter& filter) {
+    if (isReadOnly()) {
+        throw std::logic_error(
+                "CouchKVStore::persistBloomFilter: Not valid on a read-only "
+                "object.");
+    }
+
+    DbHolder db(*this);
+    couchstore_error_t errCode = openDB(vbid, db, 0);
+    if (errCode != COUCHSTORE_SUCCESS) {
+        // openDB would of logged any critical error
+        return false;
+    }
+
+    const auto value = filter.encode();
+    errCode = writeLocalDoc(*db.getDb(), bloomFilterName, value); // logs
+    if (errCode != COUCHSTORE_SUCCESS) {
+        return false;
+    }
+
+    errCode = couchstore_commit(db);
+    if (errCode != COUCHSTORE_SUCCESS) {
+        logger.warn(
+                "CouchKVStore::persistBloomFilter: couchstore_commit "
+                "error:{} [{}], {}, rev:{}",
+                couchstore_strerror(errCode),
+                couchkvstore_strerrno(db, errCode),
+                vbid,
+                db.getFileRev());
+        return false;
+    }
+    return true;
+}
+
+PersistedBloomFilter CouchKVStore::getBloomFilter(Vbid vbid) {
+    DbHolder db(*this);
+    couchstore_error_t errCode = openDB(vbid, db, COUCHSTORE_OPEN_FLAG_RDONLY);
+    if (errCode != COUCHSTORE_SUCCESS) {
+        return {};
+    }
+
+    auto lDoc = readLocalDoc(*db.getDb(), bloomFilterName);
+    if (!lDoc.getLocalDoc()) {
+        return {};
+    }
+    return PersistedBloomFilter::decode(
+            {lDoc.getLocalDoc()->json.buf, lDoc.getLocalDoc()->json.size});
+}
+
 std::vector<Collections::KVStore::DroppedCollection>
 CouchKVStore::getDroppedCollections(Vbid vbid) {
     DbHolder db(*this);
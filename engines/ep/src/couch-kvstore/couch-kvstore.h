@@ -18,6 +18,8 @@
 
 #include "atomicqueue.h"
 #include "configuration.h"
+#include "couch-kvstore/couch-fs-deferred-sync.h"
+#include "couch-kvstore/couch-fs-readahead.h"
 #include "couch-kvstore/couch-fs-stats.h"
 #include "couch-kvstore/couch-kvstore-metadata.h"
 #include "kvstore.h"
@@ -162,6 +164,10 @@ public:
      */
     bool commit(Collections::VB::Flush& collectionsFlush) override;
 
+    bool setDeferCommitSync(bool defer) override;
+
+    bool syncDeferredCommits() override;
+
     /**
      * Rollback a transaction (unless not currently in one).
      */
@@ -391,6 +397,18 @@ public:
     std::vector<Collections::KVStore::DroppedCollection> getDroppedCollections(
             Vbid vbid) override;
 
+    /**
+     * CouchKVStore implements this method as a write and commit of 1 _local
+     * document
+     */
+    bool persistBloomFilter(Vbid vbid,
+                            const PersistedBloomFilter& filter) override;
+
+    /**
+     * CouchKVStore implements this method as a read of 1 _local document
+     */
+    PersistedBloomFilter getBloomFilter(Vbid vbid) override;
+
 protected:
     /**
      * Internal RAII class for managing a Db* and having it closed when
@@ -806,6 +824,20 @@ protected:
      */
     std::unique_ptr<FileOpsInterface> statCollectingFileOpsCompaction;
 
+    /**
+     * FileOpsInterface implementation for couchstore used by by-seqno scans,
+     * which advises the OS to read ahead of the scan. Wraps
+     * statCollectingFileOps.
+     */
+    std::unique_ptr<FileOpsInterface> readAheadFileOps;
+
+    /**
+     * FileOpsInterface implementation for couchstore used by the flusher's
+     * commits, which can defer their final sync for a group commit. Wraps
+     * statCollectingFileOps.
+     */
+    std::unique_ptr<DeferredSyncOps> deferredSyncFileOps;
+
     /* deleted docs in each file, indexed by vBucket. RelaxedAtomic
        to allow stats access witout lock */
     std::vector<cb::RelaxedAtomic<size_t>> cachedDeleteCount;
@@ -19,8 +19,10 @@
 
 #include "checkpoint.h"
 #include "checkpoint_manager.h"
+#include "dcp/dcpconnmap.h"
 #include "dcp/producer.h"
 #include "dcp/response.h"
+#include "ep_engine.h"
 #include "ep_time.h"
 #include "kv_bucket.h"
 #include "statwriter.h"
@@ -957,6 +959,36 @@ static bool shouldModifyItem(const queued_item& item,
     return false;
 }
 
+void ActiveStream::compressValue(const Item& item, Item& finalItem) {
+    // The compressed value can only be shared with other streams if this
+    // stream didn't prune it.
+    const bool shareable =
+            finalItem.getValue().get() == item.getValue().get();
+    auto& cache = engine->getDcpConnMap().getCompressedValueCache();
+    if (shareable) {
+        auto compressed = cache.find(item);
+        if (compressed) {
+            finalItem.replaceValue(compressed.get());
+            finalItem.setDataType(finalItem.getDataType() |
+                                  PROTOCOL_BINARY_DATATYPE_SNAPPY);
+            return;
+        }
+    }
+
+    if (!finalItem.compressValue()) {
+        log(spdlog::level::level_enum::warn,
+            "{} Failed to snappy compress an uncompressed "
+            "value",
+            logPrefix);
+        return;
+    }
+
+    // compressValue leaves values which don't compress unchanged
+    if (shareable && mcbp::datatype::is_snappy(finalItem.getDataType())) {
+        cache.insert(item, finalItem.getValue());
+    }
+}
+
 std::unique_ptr<DcpResponse> ActiveStream::makeResponseFromItem(
         const queued_item& item, SendCommitSyncWriteAs sendCommitSyncWriteAs) {
     // Note: This function is hot - it is called for every item to be
@@ -1023,12 +1055,7 @@ std::unique_ptr<DcpResponse> ActiveStream::makeResponseFromItem(
             if (isSnappyEnabled()) {
                 if (isForceValueCompressionEnabled()) {
                     if (!mcbp::datatype::is_snappy(finalItem->getDataType())) {
-                        if (!finalItem->compressValue()) {
-                            log(spdlog::level::level_enum::warn,
-                                "{} Failed to snappy compress an uncompressed "
-                                "value",
-                                logPrefix);
-                        }
+                        compressValue(*item, *finalItem);
                     }
                 }
             } else {
@@ -283,6 +283,13 @@ protected:
 
     std::unique_ptr<DcpResponse> nextQueuedItem();
 
+    /**
+     * Snappy-compress finalItem's value (a copy of item, possibly pruned),
+     * sharing the compressed value with other streams sending the same item
+     * via the DcpConnMap's CompressedValueCache.
+     */
+    void compressValue(const Item& item, Item& finalItem);
+
     /**
      * Create a DcpResponse message to send to the replica from the given item.
      *
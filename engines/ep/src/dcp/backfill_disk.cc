@@ -17,6 +17,7 @@
 
 #include "dcp/active_stream_impl.h"
 #include "dcp/backfill_disk.h"
+#include "dcp/dcpconnmap.h"
 #include "ep_engine.h"
 #include "kv_bucket.h"
 #include "vbucket.h"
@@ -143,7 +144,6 @@ DCPBackfillDisk::DCPBackfillDisk(EventuallyPersistentEngine& e,
                                  uint64_t endSeqno)
     : DCPBackfill(s, startSeqno, endSeqno),
       engine(e),
-      scanCtx(nullptr),
       state(backfill_state_init) {
 }
 
@@ -199,7 +199,6 @@ backfill_status_t DCPBackfillDisk::create() {
         return backfill_snooze;
     }
 
-    KVStore* kvstore = engine.getKVBucket()->getROUnderlying(vbid);
     ValueFilter valFilter = ValueFilter::VALUES_DECOMPRESSED;
     if (stream->isKeyOnly()) {
         valFilter = ValueFilter::KEYS_ONLY;
@@ -209,10 +208,26 @@ backfill_status_t DCPBackfillDisk::create() {
         }
     }
 
-    auto cb = std::make_shared<DiskCallback>(stream);
-    auto cl = std::make_shared<CacheCallback>(engine, stream);
-    scanCtx = kvstore->initScanContext(
-            cb, cl, vbid, startSeqno, DocumentFilter::ALL_ITEMS, valFilter);
+    const bool shareScans =
+            engine.getConfiguration().isDcpBackfillSharedScans();
+    if (shareScans) {
+        auto joined = engine.getDcpConnMap().getSharedBackfillScans().join(
+                stream, startSeqno, endSeqno, valFilter);
+        if (joined.first) {
+            sharedScan = std::move(joined.first);
+            subscriber = std::move(joined.second);
+            stream->log(spdlog::level::level_enum::debug,
+                        "({}) Backfill joined an existing disk scan",
+                        vbid);
+            transitionState(backfill_state_scanning);
+            return backfill_success;
+        }
+    }
+
+    sharedScan = std::make_shared<SharedBackfillScan>(engine, vbid, valFilter);
+    subscriber = std::make_shared<SharedBackfillScan::Subscriber>(
+            engine, stream, startSeqno);
+    const ScanContext* scanCtx = sharedScan->open(subscriber, startSeqno);
 
     // Check startSeqno against the purge-seqno of the opened datafile.
     // 1) A normal stream request would of checked inside streamRequest, but
@@ -230,11 +245,12 @@ backfill_status_t DCPBackfillDisk::create() {
         if (scanCtx) {
             log << " startSeqno:" << startSeqno
                 << " < purgeSeqno:" << scanCtx->purgeSeqno;
-            kvstore->destroyScanContext(scanCtx);
             status = END_STREAM_ROLLBACK;
         } else {
             log << " failed to create scan";
         }
+        subscriber.reset();
+        sharedScan.reset();
         log << ". The vbucket state:";
         if (vb) {
             log << VBucket::toString(vb->getState());
@@ -250,6 +266,11 @@ backfill_status_t DCPBackfillDisk::create() {
         stream->markDiskSnapshot(startSeqno,
                                  scanCtx->maxSeqno,
                                  scanCtx->persistedCompletedSeqno);
+        if (shareScans) {
+            // Only now the snapshot is marked can other streams join.
+            engine.getDcpConnMap().getSharedBackfillScans().add(vbid,
+                                                                sharedScan);
+        }
         transitionState(backfill_state_scanning);
     }
 
@@ -262,17 +283,18 @@ backfill_status_t DCPBackfillDisk::scan() {
         return complete(true);
     }
 
-    Vbid vbid = stream->getVBucket();
-
     if (!(stream->isActive())) {
         return complete(true);
     }
 
-    KVStore* kvstore = engine.getKVBucket()->getROUnderlying(vbid);
-    scan_error_t error = kvstore->scan(scanCtx);
-
-    if (error == scan_again) {
+    switch (sharedScan->scan(*subscriber)) {
+    case SharedBackfillScan::Status::Again:
         return backfill_success;
+    case SharedBackfillScan::Status::Blocked:
+        // Don't spin on a scan another stream is holding up.
+        return backfill_snooze;
+    case SharedBackfillScan::Status::Done:
+        break;
     }
 
     transitionState(backfill_state_completing);
@@ -281,10 +303,13 @@ backfill_status_t DCPBackfillDisk::scan() {
 }
 
 backfill_status_t DCPBackfillDisk::complete(bool cancelled) {
-    /* we want to destroy kv store context irrespective of a premature complete
-       or not */
-    KVStore* kvstore = engine.getKVBucket()->getROUnderlying(getVBucketId());
-    kvstore->destroyScanContext(scanCtx);
+    /* we want to leave the scan irrespective of a premature complete or not;
+       the kv store context is destroyed once no stream is reading it */
+    if (subscriber) {
+        subscriber->active = false;
+        subscriber.reset();
+    }
+    sharedScan.reset();
 
     auto stream = streamPtr.lock();
     if (!stream) {
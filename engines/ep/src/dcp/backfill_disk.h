@@ -19,11 +19,11 @@
 
 #include "callbacks.h"
 #include "dcp/backfill.h"
+#include "dcp/shared_backfill_scan.h"
 
 #include <mutex>
 
 class EventuallyPersistentEngine;
-class ScanContext;
 class VBucket;
 
 /* The possible states of the DCPBackfillDisk */
@@ -86,7 +86,8 @@ public:
 private:
     /**
      * Creates a scan context with the KV Store to read items in the sequential
-     * order from the disk. Backfill snapshot range is decided here.
+     * order from the disk, or joins another stream's scan of the vBucket.
+     * Backfill snapshot range is decided here.
      */
     backfill_status_t create();
 
@@ -100,7 +101,8 @@ private:
 
     /**
      * Handles the completion of the backfill.
-     * Destroys the scan context, indicates the completion to the stream.
+     * Leaves the scan (destroying the scan context if no other stream is
+     * reading it), indicates the completion to the stream.
      *
      * @param cancelled indicates the if backfill finished fully or was
      *                  cancelled in between; for debug
@@ -120,7 +122,8 @@ private:
      */
     EventuallyPersistentEngine& engine;
 
-    ScanContext* scanCtx;
+    std::shared_ptr<SharedBackfillScan> sharedScan;
+    std::shared_ptr<SharedBackfillScan::Subscriber> subscriber;
     backfill_state_t state;
     std::mutex lock;
 };
@@ -110,7 +110,8 @@ backfill_status_t DCPBackfillMemoryBuffered::create() {
 
     /* Create range read cursor */
     try {
-        auto rangeItrOptional = evb->makeRangeIterator(true /*isBackfill*/);
+        auto rangeItrOptional =
+                evb->makeRangeIterator(true /*isBackfill*/, startSeqno);
         if (rangeItrOptional) {
             rangeItr = std::move(*rangeItrOptional);
         } else {
@@ -146,7 +147,8 @@ backfill_status_t DCPBackfillMemoryBuffered::create() {
         return backfill_finished;
     }
 
-    /* Advance the cursor till start, mark snapshot and update backfill
+    /* Advance the cursor till start (the iterator was created at startSeqno,
+       so normally it is already there), mark snapshot and update backfill
        remaining count */
     while (rangeItr.curr() != rangeItr.end()) {
         if (static_cast<uint64_t>((*rangeItr).getBySeqno()) >= startSeqno) {
@@ -0,0 +1,91 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2019 Couchbase, Inc
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+
+#include "dcp/compressed_value_cache.h"
+
+#include "item.h"
+#include "statwriter.h"
+
+constexpr size_t CompressedValueCache::NumShards;
+
+CompressedValueCache::CompressedValueCache(size_t maxSize)
+    : maxShardSize(maxSize / NumShards), numHits(0), numMisses(0) {
+}
+
+value_t CompressedValueCache::find(const Item& item) {
+    if (maxShardSize == 0) {
+        return {};
+    }
+    const auto key = makeKey(item);
+    auto& shard = getShard(key);
+    std::lock_guard<std::mutex> lh(shard.mutex);
+    auto it = shard.map.find(key);
+    if (it == shard.map.end()) {
+        ++numMisses;
+        return {};
+    }
+    ++numHits;
+    return it->second;
+}
+
+void CompressedValueCache::insert(const Item& item, const value_t& compressed) {
+    const size_t bytes = compressed->getSize();
+    if (bytes > maxShardSize) {
+        return;
+    }
+    const auto key = makeKey(item);
+    auto& shard = getShard(key);
+    std::lock_guard<std::mutex> lh(shard.mutex);
+    if (!shard.map.emplace(key, compressed).second) {
+        // Another stream compressed the same item first.
+        return;
+    }
+    shard.order.push_back(key);
+    shard.size += bytes;
+
+    while (shard.size > maxShardSize) {
+        auto it = shard.map.find(shard.order.front());
+        shard.size -= it->second->getSize();
+        shard.map.erase(it);
+        shard.order.pop_front();
+    }
+}
+
+size_t CompressedValueCache::getSize() const {
+    size_t size = 0;
+    for (auto& shard : shards) {
+        std::lock_guard<std::mutex> lh(const_cast<Shard&>(shard).mutex);
+        size += shard.size;
+    }
+    return size;
+}
+
+void CompressedValueCache::addStats(const AddStatFn& add_stat,
+                                    const void* c) const {
+    add_casted_stat("ep_dcp_compression_cache_hits", numHits, add_stat, c);
+    add_casted_stat("ep_dcp_compression_cache_misses", numMisses, add_stat, c);
+    add_casted_stat(
+            "ep_dcp_compression_cache_mem_used", getSize(), add_stat, c);
+}
+
+CompressedValueCache::Key CompressedValueCache::makeKey(const Item& item) {
+    return {item.getVBucketId(), item.getBySeqno(), item.getCas()};
+}
+
+CompressedValueCache::Shard& CompressedValueCache::getShard(const Key& key) {
+    return shards[KeyHash()(key) % NumShards];
+}
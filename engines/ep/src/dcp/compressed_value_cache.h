@@ -0,0 +1,106 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2019 Couchbase, Inc
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+#pragma once
+
+#include "blob.h"
+
+#include <memcached/engine_common.h>
+#include <memcached/vbucket.h>
+#include <relaxed_atomic.h>
+
+#include <array>
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+
+class Item;
+
+/**
+ * A bounded cache of snappy-compressed item values, shared by all the
+ * ActiveStreams of a bucket which have force_value_compression enabled.
+ *
+ * When several streams (for example a replica and a number of XDCR
+ * connections) read the same items from a checkpoint, each would otherwise
+ * compress every value itself; with the cache only the first stream pays for
+ * the compression and the others share the compressed Blob.
+ *
+ * Entries are identified by the item's vBucket, seqno and CAS, and are
+ * evicted oldest-first once the cache exceeds its maximum size.
+ */
+class CompressedValueCache {
+public:
+    /**
+     * @param maxSize the maximum number of bytes of compressed values to
+     *        hold; zero disables the cache.
+     */
+    explicit CompressedValueCache(size_t maxSize);
+
+    /**
+     * @returns the compressed value of the given (uncompressed) item, or an
+     *          empty value_t if not cached.
+     */
+    value_t find(const Item& item);
+
+    /**
+     * Record the compressed value of the given (uncompressed) item.
+     */
+    void insert(const Item& item, const value_t& compressed);
+
+    size_t getSize() const;
+
+    void addStats(const AddStatFn& add_stat, const void* c) const;
+
+private:
+    struct Key {
+        bool operator==(const Key& other) const {
+            return vbid == other.vbid && seqno == other.seqno &&
+                   cas == other.cas;
+        }
+
+        Vbid vbid;
+        int64_t seqno;
+        uint64_t cas;
+    };
+
+    struct KeyHash {
+        size_t operator()(const Key& key) const {
+            return std::hash<int64_t>()(key.seqno) ^
+                   (size_t(key.vbid.get()) << 48);
+        }
+    };
+
+    struct Shard {
+        std::mutex mutex;
+        std::unordered_map<Key, value_t, KeyHash> map;
+        /// Keys in insertion order, for eviction.
+        std::deque<Key> order;
+        /// Bytes of the values in map.
+        size_t size = 0;
+    };
+
+    static constexpr size_t NumShards = 16;
+
+    static Key makeKey(const Item& item);
+
+    Shard& getShard(const Key& key);
+
+    const size_t maxShardSize;
+    std::array<Shard, NumShards> shards;
+
+    cb::RelaxedAtomic<size_t> numHits;
+    cb::RelaxedAtomic<size_t> numMisses;
+};
@@ -53,6 +53,7 @@ class DcpConsumerTask : public GlobalTask {
 public:
     DcpConsumerTask(EventuallyPersistentEngine* e,
                     std::shared_ptr<DcpConsumer> c,
+                    size_t processor,
                     double sleeptime = 1,
                     bool completeBeforeShutdown = true)
         : GlobalTask(e,
@@ -60,8 +61,13 @@ public:
                      sleeptime,
                      completeBeforeShutdown),
           consumerPtr(c),
+          processor(processor),
           description("DcpConsumerTask, processing buffered items for " +
-                      c->getName()) {
+                      c->getName() +
+                      (c->getNumProcessors() > 1
+                               ? " (processor " + std::to_string(processor) +
+                                         ")"
+                               : "")) {
     }
 
     ~DcpConsumerTask() {
@@ -83,7 +89,8 @@ public:
         }
 
         double sleepFor = 0.0;
-        enum process_items_error_t state = consumer->processBufferedItems();
+        enum process_items_error_t state =
+                consumer->processBufferedItems(processor);
         switch (state) {
             case all_processed:
                 sleepFor = INT_MAX;
@@ -101,30 +108,30 @@ public:
         // Check if we've been notified of more work to do - if not then sleep;
         // if so then wakeup and re-run the task.
         // Note: The order of the wakeUp / snooze here is *critical* - another
-        // thread may concurrently notify us (set processorNotification=true)
+        // thread may concurrently notify us (set the notification flag)
         // while we are performing the checks, so we need to ensure we don't
         // loose a wakeup as that would result in this Task sleeping forever
         // (and DCP hanging).
         // To prevent this, we perform an initial check of notifiedProcessor(),
         // which if false we initially sleep, and then check a second time.
-        // We could race if the other actor sets processorNotification=true
+        // We could race if the other actor sets the notification flag
         // between the second `if(consumer->notifiedProcessor)` and us calling
         // `wakeUp()`; but that's essentially a benign race as it will just
         // result in wakeUp() being called twice which is benign.
-        if (consumer->notifiedProcessor(false)) {
+        if (consumer->notifiedProcessor(processor, false)) {
             wakeUp();
             state = more_to_process;
         } else {
             snooze(sleepFor);
             // Check if the processor was notified again,
             // in which case the task should wake immediately.
-            if (consumer->notifiedProcessor(false)) {
+            if (consumer->notifiedProcessor(processor, false)) {
                 wakeUp();
                 state = more_to_process;
             }
         }
 
-        consumer->setProcessorTaskState(state);
+        consumer->setProcessorTaskState(processor, state);
 
         return true;
     }
@@ -140,9 +147,11 @@ public:
     }
 
 private:
-    /* we have one task per consumer. the task only needs a reference to the
-       consumer object and does not own it. Hence std::weak_ptr should be used*/
+    /* we have one task per consumer Processor. the task only needs a
+       reference to the consumer object and does not own it. Hence
+       std::weak_ptr should be used*/
     const std::weak_ptr<DcpConsumer> consumerPtr;
+    const size_t processor;
     const std::string description;
 };
 
@@ -154,9 +163,7 @@ DcpConsumer::DcpConsumer(EventuallyPersistentEngine& engine,
       lastMessageTime(ep_current_time()),
       engine(engine),
       opaqueCounter(0),
-      processorTaskId(0),
-      processorTaskState(all_processed),
-      processorNotification(false),
+      processors(engine.getConfiguration().getDcpConsumerProcessorTasks()),
       backoffs(0),
       dcpNoopTxInterval(engine.getConfiguration().getDcpNoopTxInterval()),
       pendingSendStreamEndOnClientStreamClose(true),
@@ -206,7 +213,9 @@ DcpConsumer::~DcpConsumer() {
 void DcpConsumer::cancelTask() {
     bool exp = true;
     if (processorTaskRunning.compare_exchange_strong(exp, false)) {
-        ExecutorPool::get()->cancel(processorTaskId);
+        for (auto& processor : processors) {
+            ExecutorPool::get()->cancel(processor.taskId);
+        }
     }
 }
 
@@ -297,13 +306,15 @@ ENGINE_ERROR_CODE DcpConsumer::addStream(uint32_t opaque,
         }
     }
 
-    /* We need 'Processor' task only when we have a stream. Hence create it
-     only once when the first stream is added */
+    /* We need 'Processor' tasks only when we have a stream. Hence create
+     them only once when the first stream is added */
     bool exp = false;
     if (processorTaskRunning.compare_exchange_strong(exp, true)) {
-        ExTask task = std::make_shared<DcpConsumerTask>(
-                &engine, shared_from_this(), 1);
-        processorTaskId = ExecutorPool::get()->schedule(task);
+        for (size_t ii = 0; ii < processors.size(); ++ii) {
+            ExTask task = std::make_shared<DcpConsumerTask>(
+                    &engine, shared_from_this(), ii, 1);
+            processors[ii].taskId = ExecutorPool::get()->schedule(task);
+        }
     }
 
     stream = makePassiveStream(engine_,
@@ -981,6 +992,7 @@ bool DcpConsumer::handleResponse(const protocol_binary_response_header* resp) {
                 supportsSyncReplication.store(SyncReplication::SyncReplication);
             }
         }
+        flowControl.handleControlResponse(opaque);
         return true;
     } else if (opcode == cb::mcbp::ClientOpcode::GetErrorMap) {
         auto status = resp->response.getStatus();
@@ -1091,14 +1103,26 @@ void DcpConsumer::addStats(const AddStatFn& add_stat, const void* c) {
     }
 
     addStat("total_backoffs", backoffs, add_stat, c);
-    addStat("processor_task_state", getProcessorTaskStatusStr(), add_stat, c);
     flowControl.addStats(add_stat, c);
 
-    vbReady.addStats(getName() + ":dcp_buffered_ready_queue_", add_stat, c);
-    addStat("processor_notification",
-            processorNotification.load(),
-            add_stat,
-            c);
+    // With more than one Processor, the stats of each are suffixed with its
+    // index.
+    for (size_t ii = 0; ii < processors.size(); ++ii) {
+        const std::string suffix =
+                processors.size() > 1 ? "_" + std::to_string(ii) : "";
+        addStat("processor_task_state" + suffix,
+                getProcessorTaskStatusStr(ii),
+                add_stat,
+                c);
+        processors[ii].vbReady.addStats(
+                getName() + ":dcp_buffered_ready_queue" + suffix + "_",
+                add_stat,
+                c);
+        addStat("processor_notification" + suffix,
+                processors[ii].notification.load(),
+                add_stat,
+                c);
+    }
 
     addStat("synchronous_replication", isSyncReplicationEnabled(), add_stat, c);
 }
@@ -1112,6 +1136,7 @@ process_items_error_t DcpConsumer::drainStreamsBufferedItems(
     process_items_error_t rval = all_processed;
     uint32_t bytesProcessed = 0;
     size_t iterations = 0;
+    auto& vbReady = getProcessor(stream->getVBucket()).vbReady;
     do {
         switch (engine_.getReplicationThrottle().getStatus()) {
         case ReplicationThrottle::Status::Pause:
@@ -1159,8 +1184,9 @@ process_items_error_t DcpConsumer::drainStreamsBufferedItems(
     return rval;
 }
 
-process_items_error_t DcpConsumer::processBufferedItems() {
+process_items_error_t DcpConsumer::processBufferedItems(size_t processor) {
     process_items_error_t process_ret = all_processed;
+    auto& vbReady = processors.at(processor).vbReady;
     Vbid vbucket = Vbid(0);
     while (vbReady.popFront(vbucket)) {
         auto stream = findStream(vbucket);
@@ -1195,23 +1221,26 @@ process_items_error_t DcpConsumer::processBufferedItems() {
 }
 
 void DcpConsumer::notifyVbucketReady(Vbid vbucket) {
-    if (vbReady.pushUnique(vbucket) &&
-        notifiedProcessor(true)) {
-        ExecutorPool::get()->wake(processorTaskId);
+    const size_t ii = vbucket.get() % processors.size();
+    if (processors[ii].vbReady.pushUnique(vbucket) &&
+        notifiedProcessor(ii, true)) {
+        ExecutorPool::get()->wake(processors[ii].taskId);
     }
 }
 
-bool DcpConsumer::notifiedProcessor(bool to) {
+bool DcpConsumer::notifiedProcessor(size_t processor, bool to) {
     bool inverse = !to;
-    return processorNotification.compare_exchange_strong(inverse, to);
+    return processors.at(processor).notification.compare_exchange_strong(
+            inverse, to);
 }
 
-void DcpConsumer::setProcessorTaskState(enum process_items_error_t to) {
-    processorTaskState = to;
+void DcpConsumer::setProcessorTaskState(size_t processor,
+                                        enum process_items_error_t to) {
+    processors.at(processor).taskState = to;
 }
 
-std::string DcpConsumer::getProcessorTaskStatusStr() {
-    switch (processorTaskState.load()) {
+std::string DcpConsumer::getProcessorTaskStatusStr(size_t processor) {
+    switch (processors.at(processor).taskState.load()) {
         case all_processed:
             return "ALL_PROCESSED";
         case more_to_process:
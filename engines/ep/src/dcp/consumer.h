@@ -31,6 +31,7 @@
 
 #include <list>
 #include <map>
+#include <vector>
 #include <engines/ep/src/collections/collections_types.h>
 
 class DcpResponse;
@@ -264,7 +265,11 @@ public:
 
     void closeStreamDueToVbStateChange(Vbid vbucket, vbucket_state_t state);
 
-    process_items_error_t processBufferedItems();
+    /**
+     * Process the buffered messages of the ready vBuckets in the partition
+     * of the given 'Processor' task.
+     */
+    process_items_error_t processBufferedItems(size_t processor = 0);
 
     uint64_t incrOpaqueCounter();
 
@@ -280,11 +285,17 @@ public:
 
     void taskCancelled();
 
-    bool notifiedProcessor(bool to);
+    bool notifiedProcessor(size_t processor, bool to);
+
+    void setProcessorTaskState(size_t processor,
+                               enum process_items_error_t to);
 
-    void setProcessorTaskState(enum process_items_error_t to);
+    std::string getProcessorTaskStatusStr(size_t processor);
 
-    std::string getProcessorTaskStatusStr();
+    /// @returns the number of 'Processor' tasks of this consumer.
+    size_t getNumProcessors() const {
+        return processors.size();
+    }
 
     /**
      * Check if the enough bytes have been removed from the flow control
@@ -533,11 +544,30 @@ protected:
     /* Reference to the ep engine; need to create the 'Processor' task */
     EventuallyPersistentEngine& engine;
     uint64_t opaqueCounter;
-    size_t processorTaskId;
-    std::atomic<enum process_items_error_t> processorTaskState;
 
-    VBReadyQueue vbReady;
-    std::atomic<bool> processorNotification;
+    /**
+     * The state of one of the consumer's 'Processor' tasks. vBuckets are
+     * partitioned between the tasks by vbid, so the buffered messages of a
+     * vBucket are always processed in order by the same task while those of
+     * different vBuckets can be processed in parallel.
+     */
+    struct Processor {
+        size_t taskId = 0;
+        std::atomic<enum process_items_error_t> taskState{all_processed};
+        VBReadyQueue vbReady;
+        std::atomic<bool> notification{false};
+    };
+
+    /// @returns the Processor whose partition the vBucket is in.
+    Processor& getProcessor(Vbid vbucket) {
+        return processors[vbucket.get() % processors.size()];
+    }
+
+    /**
+     * The 'Processor' tasks; the number is fixed when the consumer is
+     * created, from 'dcp_consumer_processor_tasks'.
+     */
+    std::vector<Processor> processors;
 
     std::mutex readyMutex;
     std::list<Vbid> ready;
@@ -597,7 +627,7 @@ protected:
     } getErrorMapState;
     bool producerIsVersion5orHigher;
 
-    /* Indicates if the 'Processor' task is running */
+    /* Indicates if the 'Processor' tasks are running */
     std::atomic<bool> processorTaskRunning;
 
     FlowControl flowControl;
@@ -45,7 +45,9 @@ private:
 
 DcpConnMap::DcpConnMap(EventuallyPersistentEngine &e)
     : ConnMap(e),
-      aggrDcpConsumerBufferSize(0) {
+      aggrDcpConsumerBufferSize(0),
+      compressedValueCache(
+              e.getConfiguration().getDcpCompressionCacheSize()) {
     backfills.numActiveSnoozing = 0;
     updateMaxActiveSnoozingBackfills(engine.getEpStats().getMaxDataSize());
     minCompressionRatioForProducer.store(
@@ -540,6 +542,8 @@ void DcpConnMap::addStats(const AddStatFn& add_stat, const void* c) {
     LockHolder lh(connsLock);
     add_casted_stat("ep_dcp_dead_conn_count", deadConnections.size(), add_stat,
                     c);
+    compressedValueCache.addStats(add_stat, c);
+    sharedBackfillScans.addStats(add_stat, c);
 }
 
 void DcpConnMap::updateMinCompressionRatioForProducers(float value) {
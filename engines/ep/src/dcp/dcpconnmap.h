@@ -18,6 +18,8 @@
 #pragma once
 
 #include "connmap.h"
+#include "dcp/compressed_value_cache.h"
+#include "dcp/shared_backfill_scan.h"
 
 #include <memcached/engine.h>
 #include <platform/sized_buffer.h>
@@ -147,6 +149,14 @@ public:
 
     float getMinCompressionRatio();
 
+    CompressedValueCache& getCompressedValueCache() {
+        return compressedValueCache;
+    }
+
+    SharedBackfillScanMap& getSharedBackfillScans() {
+        return sharedBackfillScans;
+    }
+
     std::shared_ptr<ConnHandler> findByName(const std::string& name);
 
     bool isConnections() {
@@ -232,5 +242,11 @@ protected:
     /* Total memory used by all DCP consumer buffers */
     std::atomic<size_t> aggrDcpConsumerBufferSize;
 
+    /* Values compressed for streams with force_value_compression */
+    CompressedValueCache compressedValueCache;
+
+    /* Disk backfill scans which other streams may join */
+    SharedBackfillScanMap sharedBackfillScans;
+
     class DcpConfigChangeListener;
 };
@@ -21,6 +21,8 @@
 #include "dcp/consumer.h"
 #include "ep_engine.h"
 
+#include <algorithm>
+
 DcpFlowControlManager::DcpFlowControlManager(EventuallyPersistentEngine &engine)
     : engine_(engine)
 {
@@ -39,6 +41,15 @@ bool DcpFlowControlManager::isEnabled() const
     return false;
 }
 
+bool DcpFlowControlManager::isAdaptive() const {
+    return false;
+}
+
+size_t DcpFlowControlManager::adaptBufferSize(DcpConsumer* consumerConn,
+                                              size_t) {
+    return consumerConn->getFlowControlBufSize();
+}
+
 void DcpFlowControlManager::setBufSizeWithinBounds(DcpConsumer *consumerConn,
                                                    size_t &bufSize)
 {
@@ -223,3 +234,75 @@ void DcpFlowControlManagerAggressive::resizeBuffers_UNLOCKED(size_t bufferSize)
         iter.second->setFlowControlBufSize(bufferSize);
     }
 }
+
+DcpFlowControlManagerAdaptive::DcpFlowControlManagerAdaptive(
+        EventuallyPersistentEngine& engine)
+    : DcpFlowControlManager(engine), aggrBufferSize(0) {
+}
+
+DcpFlowControlManagerAdaptive::~DcpFlowControlManagerAdaptive() = default;
+
+size_t DcpFlowControlManagerAdaptive::newConsumerConn(
+        DcpConsumer* consumerConn) {
+    if (consumerConn == nullptr) {
+        throw std::invalid_argument(
+                "DcpFlowControlManagerAdaptive::newConsumerConn: resp is NULL");
+    }
+    /* Start at the min size; the connection grows its buffer once it has
+       measured its drain rate and round trip time */
+    const size_t bufferSize = engine_.getConfiguration().getDcpConnBufferSize();
+
+    std::lock_guard<std::mutex> lh(bufferSizesMutex);
+    bufferSizes[consumerConn->getCookie()] = bufferSize;
+    aggrBufferSize += bufferSize;
+    return bufferSize;
+}
+
+void DcpFlowControlManagerAdaptive::handleDisconnect(DcpConsumer* consumerConn) {
+    std::lock_guard<std::mutex> lh(bufferSizesMutex);
+    auto iter = bufferSizes.find(consumerConn->getCookie());
+    if (iter != bufferSizes.end()) {
+        aggrBufferSize -= iter->second;
+        bufferSizes.erase(iter);
+    }
+}
+
+bool DcpFlowControlManagerAdaptive::isEnabled() const {
+    return true;
+}
+
+bool DcpFlowControlManagerAdaptive::isAdaptive() const {
+    return true;
+}
+
+size_t DcpFlowControlManagerAdaptive::adaptBufferSize(DcpConsumer* consumerConn,
+                                                      size_t bufSize) {
+    /* Make sure that the flow control buffer size is within a max and min
+     range */
+    setBufSizeWithinBounds(consumerConn, bufSize);
+
+    std::lock_guard<std::mutex> lh(bufferSizesMutex);
+    auto iter = bufferSizes.find(consumerConn->getCookie());
+    if (iter == bufferSizes.end()) {
+        return consumerConn->getFlowControlBufSize();
+    }
+
+    /* Only grow into what is left of the aggregate threshold */
+    const size_t current = iter->second;
+    const double threshold =
+            static_cast<double>(engine_.getConfiguration()
+                                        .getDcpConnBufferSizeAggrMemThreshold()) /
+            100;
+    const size_t limit = threshold * engine_.getEpStats().getMaxDataSize();
+    const size_t others = aggrBufferSize - current;
+    if (bufSize > current && others + bufSize > limit) {
+        bufSize = std::max(current, limit > others ? limit - others : 0);
+    }
+
+    aggrBufferSize = others + bufSize;
+    iter->second = bufSize;
+    EP_LOG_DEBUG("{} Conn flow control buffer is {}",
+                 consumerConn->logHeader(),
+                 bufSize);
+    return bufSize;
+}
@@ -51,6 +51,14 @@ public:
     /* Will indicate if flow control is enabled */
     virtual bool isEnabled(void) const;
 
+    /* Will indicate if connections should measure their drain rate and round
+       trip time and adapt their buffer size with adaptBufferSize() */
+    virtual bool isAdaptive() const;
+
+    /* To be called by an adaptive connection which wants a flow control
+       buffer of bufSize. Returns the size of flow control buffer granted */
+    virtual size_t adaptBufferSize(DcpConsumer* consumerConn, size_t bufSize);
+
 protected:
     void setBufSizeWithinBounds(DcpConsumer *consumerConn, size_t &bufSize);
 
@@ -130,3 +138,39 @@ private:
     /* Fraction of memQuota for all dcp consumer connection buffers */
     std::atomic<double> dcpConnBufferSizeAggrFrac;
 };
+
+/**
+ * In this policy each flow control buffer is sized from the connection's
+ * measured bandwidth-delay product: the rate at which the consumer processes
+ * (drains) the buffer times the round trip time to the producer, with 2x
+ * headroom. A connection starts with the min value (10 MB); a window-limited
+ * high-latency connection then grows (by up to 2x per measurement) until the
+ * link or the consumer becomes the bottleneck, and a slow or idle consumer
+ * shrinks back towards the min value. Sizes are kept within the min and max
+ * values, and growth is limited so that the aggregate of all buffers stays
+ * within a threshold (10%) of bucket memory.
+ */
+class DcpFlowControlManagerAdaptive : public DcpFlowControlManager {
+public:
+    DcpFlowControlManagerAdaptive(EventuallyPersistentEngine& engine);
+
+    ~DcpFlowControlManagerAdaptive();
+
+    size_t newConsumerConn(DcpConsumer* consumerConn) override;
+
+    void handleDisconnect(DcpConsumer* consumerConn) override;
+
+    bool isEnabled() const override;
+
+    bool isAdaptive() const override;
+
+    size_t adaptBufferSize(DcpConsumer* consumerConn, size_t bufSize) override;
+
+private:
+    /* Mutex to ensure bufferSizes and aggrBufferSize are consistent */
+    std::mutex bufferSizesMutex;
+    /* Flow control buffer size of each DCP Consumer */
+    std::map<const void*, size_t> bufferSizes;
+    /* Total of bufferSizes */
+    size_t aggrBufferSize;
+};
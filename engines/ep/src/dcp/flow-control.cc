@@ -23,6 +23,16 @@
 #include "ep_time.h"
 #include "objectregistry.h"
 
+/* How often an adaptive connection re-measures its drain rate */
+static const std::chrono::seconds adaptInterval(1);
+/* How often an adaptive connection re-sends its buffer size, to re-measure
+   the round trip time when the size has not changed */
+static const std::chrono::seconds rttRefreshInterval(10);
+/* How long a round trip time sample may be the minimum used for the
+   bandwidth-delay product; a few refresh intervals, so a longer path is
+   picked up once the window has passed */
+static const std::chrono::seconds rttWindow(30);
+
 FlowControl::FlowControl(EventuallyPersistentEngine &engine,
                          DcpConsumer* consumer) :
     consumerConn(consumer),
@@ -30,9 +40,15 @@ FlowControl::FlowControl(EventuallyPersistentEngine &engine,
     pendingControl(true),
     lastBufferAck(ep_current_time()),
     ackedBytes(0),
-    freedBytes(0)
+    freedBytes(0),
+    controlOpaque(0),
+    rttMicros(0),
+    drainRate(0),
+    lastAdapt(std::chrono::steady_clock::now()),
+    processedAtLastAdapt(0)
 {
     enabled = engine.getDcpFlowControlManager().isEnabled();
+    adaptive = enabled && engine.getDcpFlowControlManager().isAdaptive();
     if (enabled) {
         bufferSize =
                     engine.getDcpFlowControlManager().newConsumerConn(consumer);
@@ -48,14 +64,19 @@ ENGINE_ERROR_CODE FlowControl::handleFlowCtl(
                                     struct dcp_message_producers* producers)
 {
     if (enabled) {
+        if (adaptive) {
+            maybeAdaptBufferSize();
+        }
         ENGINE_ERROR_CODE ret;
         uint32_t ackable_bytes = freedBytes.load();
         std::unique_lock<std::mutex> lh(bufferSizeLock);
         if (pendingControl) {
             pendingControl = false;
             std::string buf_size(std::to_string(bufferSize));
-            lh.unlock();
             uint64_t opaque = consumerConn->incrOpaqueCounter();
+            controlOpaque = uint32_t(opaque);
+            controlSentTime = std::chrono::steady_clock::now();
+            lh.unlock();
             const std::string &controlMsgKey = consumerConn->getControlMsgKey();
             NonBucketAllocationGuard guard;
             ret = producers->control(opaque, controlMsgKey, buf_size);
@@ -107,6 +128,87 @@ void FlowControl::setFlowControlBufSize(uint32_t newSize)
     }
 }
 
+void FlowControl::handleControlResponse(uint32_t opaque) {
+    const auto now = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lh(bufferSizeLock);
+    if (!adaptive || opaque != controlOpaque) {
+        return;
+    }
+    controlOpaque = 0;
+    addRttSample_UNLOCKED(
+            std::chrono::duration_cast<std::chrono::microseconds>(
+                    now - controlSentTime)
+                    .count(),
+            now);
+}
+
+void FlowControl::addRttSample_UNLOCKED(
+        uint64_t sampleMicros, std::chrono::steady_clock::time_point now) {
+    while (!rttSamples.empty() && rttSamples.back().second >= sampleMicros) {
+        rttSamples.pop_back();
+    }
+    rttSamples.emplace_back(now, sampleMicros);
+    while (rttSamples.front().first + rttWindow < now) {
+        rttSamples.pop_front();
+    }
+    rttMicros = rttSamples.front().second;
+}
+
+void FlowControl::maybeAdaptBufferSize() {
+    maybeAdaptBufferSize(std::chrono::steady_clock::now());
+}
+
+void FlowControl::maybeAdaptBufferSize(
+        std::chrono::steady_clock::time_point now) {
+    std::unique_lock<std::mutex> lh(bufferSizeLock);
+    if (now - lastAdapt < adaptInterval) {
+        return;
+    }
+
+    const auto elapsed =
+            std::chrono::duration_cast<std::chrono::microseconds>(now -
+                                                                  lastAdapt)
+                    .count();
+    const uint64_t processed = ackedBytes.load() + freedBytes.load();
+    const uint64_t bytes = processed > processedAtLastAdapt
+                                   ? processed - processedAtLastAdapt
+                                   : 0;
+    lastAdapt = now;
+    processedAtLastAdapt = processed;
+    const uint64_t sample = bytes * 1000000 / elapsed;
+    const uint64_t rate = (drainRate.load() + sample) / 2;
+    drainRate = rate;
+
+    const uint64_t rtt = rttMicros.load();
+    if (rtt == 0) {
+        return;
+    }
+
+    /* Twice the bandwidth-delay product: when the buffer limits throughput
+       the drain rate is about bufferSize / rtt, so the buffer doubles until
+       the link or the consumer is the bottleneck. With the minimum rtt, a
+       buffer which is already too large (and so adds queueing delay to the
+       samples) doesn't grow itself further */
+    const uint64_t wanted = 2 * rate * rtt / 1000000;
+    const uint64_t current = bufferSize.load();
+    /* Ignore changes of less than 10% */
+    if (wanted * 10 < current * 9 || wanted * 10 > current * 11) {
+        lh.unlock();
+        const size_t granted =
+                engine_.getDcpFlowControlManager().adaptBufferSize(
+                        consumerConn, wanted);
+        lh.lock();
+        if (granted != bufferSize) {
+            bufferSize = granted;
+            pendingControl = true;
+            return;
+        }
+    }
+    if (now - controlSentTime > rttRefreshInterval) {
+        pendingControl = true;
+    }
+}
+
 bool FlowControl::isBufferSufficientlyDrained() {
     std::lock_guard<std::mutex> lh(bufferSizeLock);
     return isBufferSufficientlyDrained_UNLOCKED(freedBytes.load());
@@ -120,4 +222,8 @@ void FlowControl::addStats(const AddStatFn& add_stat, const void* c) {
     consumerConn->addStat("total_acked_bytes", ackedBytes, add_stat, c);
     consumerConn->addStat("max_buffer_bytes", bufferSize, add_stat, c);
     consumerConn->addStat("unacked_bytes", freedBytes, add_stat, c);
+    if (adaptive) {
+        consumerConn->addStat("round_trip_time_us", rttMicros, add_stat, c);
+        consumerConn->addStat("drain_rate_bytes", drainRate, add_stat, c);
+    }
 }
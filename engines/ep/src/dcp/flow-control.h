@@ -21,6 +21,10 @@
 
 #include <relaxed_atomic.h>
 
+#include <chrono>
+#include <deque>
+#include <utility>
+
 class DcpConsumer;
 class EventuallyPersistentEngine;
 
@@ -45,6 +49,10 @@ public:
 
     void setFlowControlBufSize(uint32_t newSize);
 
+    /* To be called when the producer responds to a control message; used to
+       measure the round trip time */
+    void handleControlResponse(uint32_t opaque);
+
     bool isBufferSufficientlyDrained();
 
     void addStats(const AddStatFn& add_stat, const void* c);
@@ -54,10 +62,23 @@ public:
     }
 
 private:
+    friend class FlowControlTest;
+
     void setBufSizeWithinBounds(size_t &bufSize);
 
     bool isBufferSufficientlyDrained_UNLOCKED(uint32_t ackable_bytes);
 
+    /* With an adaptive flow control policy, update the drain rate and
+       (at most once per adaptInterval) resize the buffer to the measured
+       bandwidth-delay product */
+    void maybeAdaptBufferSize();
+    void maybeAdaptBufferSize(std::chrono::steady_clock::time_point now);
+
+    /* Add a round trip time sample, taken at the given time, to the
+       windowed minimum. Caller must hold bufferSizeLock */
+    void addRttSample_UNLOCKED(uint64_t sampleMicros,
+                               std::chrono::steady_clock::time_point now);
+
     /* Associated consumer connection handler */
     DcpConsumer* consumerConn;
 
@@ -85,4 +106,32 @@ private:
 
     /* Bytes processed from the flow control buffer */
     std::atomic<uint64_t> freedBytes;
+
+    /* Indicates if the buffer size is adapted to the measured drain rate
+       and round trip time */
+    bool adaptive;
+
+    /* Opaque and send time of the last control msg, to measure the round
+       trip time from its response */
+    uint32_t controlOpaque;
+    std::chrono::steady_clock::time_point controlSentTime;
+
+    /* Minimum round trip time of the control msgs sent in the last
+       rttWindow, in microseconds; 0 until measured. Using the minimum
+       rather than an average keeps the queueing delay the buffer itself
+       causes out of the bandwidth-delay product (as BBR does) */
+    cb::RelaxedAtomic<uint64_t> rttMicros;
+
+    /* The round trip time samples which may yet become the windowed
+       minimum: ordered by time and by increasing RTT, as a sample is
+       dropped once a later one is no greater */
+    std::deque<std::pair<std::chrono::steady_clock::time_point, uint64_t>>
+            rttSamples;
+
+    /* Smoothed bytes processed per second */
+    cb::RelaxedAtomic<uint64_t> drainRate;
+
+    /* When the drain rate was last measured, and the bytes processed then */
+    std::chrono::steady_clock::time_point lastAdapt;
+    uint64_t processedAtLastAdapt;
 };
@@ -0,0 +1,258 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2019 Couchbase, Inc
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+
+#include "dcp/shared_backfill_scan.h"
+
+#include "dcp/active_stream.h"
+#include "dcp/backfill_disk.h"
+#include "ep_engine.h"
+#include "item.h"
+#include "kv_bucket.h"
+#include "statwriter.h"
+
+/// Passes each CacheLookup of the scan to the SharedBackfillScan.
+class SharedBackfillScan::CacheFanOut : public StatusCallback<CacheLookup> {
+public:
+    explicit CacheFanOut(SharedBackfillScan& scan) : scan(scan) {
+    }
+
+    void callback(CacheLookup& lookup) override {
+        setStatus(scan.deliverFromCache(lookup));
+    }
+
+private:
+    SharedBackfillScan& scan;
+};
+
+/// Passes each GetValue of the scan to the SharedBackfillScan.
+class SharedBackfillScan::DiskFanOut : public StatusCallback<GetValue> {
+public:
+    explicit DiskFanOut(SharedBackfillScan& scan) : scan(scan) {
+    }
+
+    void callback(GetValue& val) override {
+        setStatus(scan.deliverFromDisk(val));
+    }
+
+private:
+    SharedBackfillScan& scan;
+};
+
+SharedBackfillScan::Subscriber::Subscriber(EventuallyPersistentEngine& e,
+                                           std::shared_ptr<ActiveStream> stream,
+                                           uint64_t startSeqno)
+    : cacheCallback(std::make_unique<CacheCallback>(e, stream)),
+      diskCallback(std::make_unique<DiskCallback>(stream)),
+      startSeqno(startSeqno) {
+}
+
+SharedBackfillScan::Subscriber::~Subscriber() = default;
+
+bool SharedBackfillScan::Subscriber::wants(int64_t seqno) const {
+    return active && seqno >= int64_t(startSeqno) && seqno > lastSeqno;
+}
+
+SharedBackfillScan::SharedBackfillScan(EventuallyPersistentEngine& e,
+                                       Vbid vbid,
+                                       ValueFilter valFilter)
+    : engine(e), vbid(vbid), valFilter(valFilter) {
+}
+
+SharedBackfillScan::~SharedBackfillScan() {
+    if (scanCtx) {
+        engine.getKVBucket()->getROUnderlying(vbid)->destroyScanContext(
+                scanCtx);
+    }
+}
+
+const ScanContext* SharedBackfillScan::open(
+        const std::shared_ptr<Subscriber>& subscriber, uint64_t startSeqno) {
+    std::lock_guard<std::mutex> lh(mutex);
+    subscribers.push_back(subscriber);
+
+    KVStore* kvstore = engine.getKVBucket()->getROUnderlying(vbid);
+    scanCtx = kvstore->initScanContext(std::make_shared<DiskFanOut>(*this),
+                                       std::make_shared<CacheFanOut>(*this),
+                                       vbid,
+                                       startSeqno,
+                                       DocumentFilter::ALL_ITEMS,
+                                       valFilter);
+    return scanCtx;
+}
+
+std::shared_ptr<SharedBackfillScan::Subscriber> SharedBackfillScan::join(
+        std::shared_ptr<ActiveStream> stream,
+        uint64_t startSeqno,
+        uint64_t endSeqno,
+        ValueFilter valFilter) {
+    // Don't wait for a chunk of the scan in progress: that would hold the
+    // caller's DCPBackfillDisk lock while the scan delivers items to other
+    // streams (which take their BackfillManager's lock, which can be held
+    // while cancelling a DCPBackfillDisk). The stream scans on its own.
+    std::unique_lock<std::mutex> lh(mutex, std::try_to_lock);
+    if (!lh || !scanCtx || finished || valFilter != this->valFilter) {
+        return {};
+    }
+
+    // The scan must not have read past the stream's start, and must read at
+    // least up to its end. As in DCPBackfillDisk::create, the stream cannot
+    // start at or below the purge-seqno unless it starts from the beginning.
+    if (startSeqno < scanCtx->startSeqno ||
+        int64_t(startSeqno) <= scanCtx->lastReadSeqno ||
+        endSeqno > scanCtx->maxSeqno ||
+        (startSeqno != 1 && startSeqno <= scanCtx->purgeSeqno)) {
+        return {};
+    }
+
+    // Mark the snapshot while holding the mutex, so it is sent before any
+    // item the scan delivers to the new subscriber.
+    stream->setBackfillRemaining(scanCtx->documentCount);
+    stream->markDiskSnapshot(
+            startSeqno, scanCtx->maxSeqno, scanCtx->persistedCompletedSeqno);
+
+    auto subscriber = std::make_shared<Subscriber>(engine, stream, startSeqno);
+    subscribers.push_back(subscriber);
+    return subscriber;
+}
+
+SharedBackfillScan::Status SharedBackfillScan::scan(const Subscriber& caller) {
+    // If another subscriber is running the scan, let the caller try again
+    // later rather than block (see join()).
+    std::unique_lock<std::mutex> lh(mutex, std::try_to_lock);
+    if (!lh) {
+        return Status::Blocked;
+    }
+    if (finished) {
+        return Status::Done;
+    }
+
+    pausedBy = nullptr;
+    KVStore* kvstore = engine.getKVBucket()->getROUnderlying(vbid);
+    if (kvstore->scan(scanCtx) != scan_again) {
+        finished = true;
+        return Status::Done;
+    }
+
+    // If the caller's own buffer is full its BackfillManager won't run it
+    // again until the buffer drains. Paused on anyone else's buffer, the
+    // caller can only re-deliver the same item and pause again.
+    if (pausedBy && pausedBy != &caller) {
+        return Status::Blocked;
+    }
+    return Status::Again;
+}
+
+ENGINE_ERROR_CODE SharedBackfillScan::deliverFromCache(CacheLookup& lookup) {
+    const int64_t seqno = lookup.getBySeqno();
+    bool fromDisk = false;
+    for (auto& subscriber : subscribers) {
+        if (!subscriber->wants(seqno)) {
+            continue;
+        }
+        subscriber->cacheCallback->callback(lookup);
+        switch (subscriber->cacheCallback->getStatus()) {
+        case ENGINE_KEY_EEXISTS:
+            subscriber->lastSeqno = seqno;
+            break;
+        case ENGINE_ENOMEM:
+            // Pause the scan; it resumes from this item, which subscribers
+            // before this one have already accepted.
+            pausedBy = subscriber.get();
+            return ENGINE_ENOMEM;
+        default:
+            fromDisk = true;
+            break;
+        }
+    }
+    return fromDisk ? ENGINE_SUCCESS : ENGINE_KEY_EEXISTS;
+}
+
+ENGINE_ERROR_CODE SharedBackfillScan::deliverFromDisk(GetValue& val) {
+    if (!val.item) {
+        throw std::invalid_argument(
+                "SharedBackfillScan::deliverFromDisk: val is NULL");
+    }
+    const int64_t seqno = val.item->getBySeqno();
+
+    std::vector<Subscriber*> wanting;
+    for (auto& subscriber : subscribers) {
+        if (subscriber->wants(seqno)) {
+            wanting.push_back(subscriber.get());
+        }
+    }
+
+    for (size_t ii = 0; ii < wanting.size(); ++ii) {
+        auto* subscriber = wanting[ii];
+        // Each stream takes ownership of the Item it is given, so all but
+        // the last get a copy (which shares the value).
+        const bool last = ii + 1 == wanting.size();
+        GetValue gv(last ? std::move(val.item)
+                         : std::make_unique<Item>(*val.item),
+                    val.getStatus(),
+                    val.getId(),
+                    val.isPartial(),
+                    val.getNRUValue());
+        subscriber->diskCallback->callback(gv);
+        if (subscriber->diskCallback->getStatus() == ENGINE_ENOMEM) {
+            // Pause the scan; it re-reads this item when it resumes.
+            pausedBy = subscriber;
+            return ENGINE_ENOMEM;
+        }
+        subscriber->lastSeqno = seqno;
+    }
+    return ENGINE_SUCCESS;
+}
+
+std::pair<std::shared_ptr<SharedBackfillScan>,
+          std::shared_ptr<SharedBackfillScan::Subscriber>>
+SharedBackfillScanMap::join(std::shared_ptr<ActiveStream> stream,
+                            uint64_t startSeqno,
+                            uint64_t endSeqno,
+                            ValueFilter valFilter) {
+    std::shared_ptr<SharedBackfillScan> scan;
+    {
+        std::lock_guard<std::mutex> lh(mutex);
+        auto it = scans.find(stream->getVBucket());
+        if (it == scans.end()) {
+            return {};
+        }
+        scan = it->second.lock();
+        if (!scan) {
+            scans.erase(it);
+            return {};
+        }
+    }
+
+    auto subscriber = scan->join(stream, startSeqno, endSeqno, valFilter);
+    if (!subscriber) {
+        return {};
+    }
+    ++numJoined;
+    return {scan, subscriber};
+}
+
+void SharedBackfillScanMap::add(Vbid vbid,
+                                std::shared_ptr<SharedBackfillScan> scan) {
+    std::lock_guard<std::mutex> lh(mutex);
+    scans[vbid] = scan;
+}
+
+void SharedBackfillScanMap::addStats(const AddStatFn& add_stat,
+                                     const void* c) const {
+    add_casted_stat(
+            "ep_dcp_backfill_scans_joined", getNumJoined(), add_stat, c);
+}
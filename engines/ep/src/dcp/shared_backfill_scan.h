@@ -0,0 +1,179 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2019 Couchbase, Inc
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+#pragma once
+
+#include "kvstore.h"
+
+#include <memcached/engine_common.h>
+#include <memcached/vbucket.h>
+#include <relaxed_atomic.h>
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+class ActiveStream;
+class CacheCallback;
+class DiskCallback;
+class EventuallyPersistentEngine;
+
+/**
+ * A by-seqno disk scan of a vBucket which delivers the items read to one or
+ * more ActiveStreams.
+ *
+ * Each DCPBackfillDisk subscribes its stream to a SharedBackfillScan; the
+ * first creates the scan and others (typically streams of other producers
+ * backfilling the same vBucket after a rebalance) may join it while it has
+ * not yet read past their start seqno, instead of scanning the same file
+ * again. Any of the subscribed DCPBackfillDisks may run the next chunk of the
+ * scan; the items are passed to every subscriber's CacheCallback /
+ * DiskCallback, so each stream applies its own collection filter and
+ * backfill buffer limits as for an unshared scan.
+ *
+ * If any subscriber's buffer is full the scan pauses (and resumes from the
+ * same item); subscribers which already accepted that item skip it on
+ * resume. The other subscribers' backfills are told the scan is blocked, so
+ * they snooze rather than re-run it until that buffer drains.
+ */
+class SharedBackfillScan {
+public:
+    /// The outcome of scan() for the subscriber which called it.
+    enum class Status {
+        /// The scan has more items to read.
+        Again,
+        /// The scan cannot make progress for now: another subscriber is
+        /// reading a chunk, or the scan is paused on another subscriber's
+        /// full buffer.
+        Blocked,
+        /// The scan has finished (or failed).
+        Done
+    };
+
+    /// A stream reading from the scan.
+    struct Subscriber {
+        Subscriber(EventuallyPersistentEngine& e,
+                   std::shared_ptr<ActiveStream> stream,
+                   uint64_t startSeqno);
+        ~Subscriber();
+
+        /// @returns true if the item with the given seqno should be sent.
+        bool wants(int64_t seqno) const;
+
+        std::unique_ptr<CacheCallback> cacheCallback;
+        std::unique_ptr<DiskCallback> diskCallback;
+        const uint64_t startSeqno;
+        /// Seqno of the last item this subscriber accepted.
+        int64_t lastSeqno = 0;
+        /// Cleared when the subscriber's backfill completes or is cancelled.
+        std::atomic<bool> active{true};
+    };
+
+    SharedBackfillScan(EventuallyPersistentEngine& e,
+                       Vbid vbid,
+                       ValueFilter valFilter);
+
+    ~SharedBackfillScan();
+
+    /**
+     * Add the first subscriber and create the scan context, starting at
+     * startSeqno.
+     *
+     * @return the scan context (owned by this object), or nullptr if it could
+     *         not be created.
+     */
+    const ScanContext* open(const std::shared_ptr<Subscriber>& subscriber,
+                            uint64_t startSeqno);
+
+    /**
+     * Add a subscriber to an open scan, if it has not yet read past
+     * startSeqno and will read up to endSeqno. The stream's disk snapshot
+     * is marked before any items can be delivered to it. Fails if a chunk of
+     * the scan is in progress.
+     *
+     * @return the subscriber, or nullptr if the stream cannot join.
+     */
+    std::shared_ptr<Subscriber> join(std::shared_ptr<ActiveStream> stream,
+                                     uint64_t startSeqno,
+                                     uint64_t endSeqno,
+                                     ValueFilter valFilter);
+
+    /**
+     * Read the next chunk of the scan (if not already finished by another
+     * subscriber).
+     *
+     * @param caller the subscriber whose backfill is running the scan
+     */
+    Status scan(const Subscriber& caller);
+
+private:
+    class CacheFanOut;
+    class DiskFanOut;
+
+    /// Deliver an item found in memory; returns the CacheLookup status.
+    ENGINE_ERROR_CODE deliverFromCache(CacheLookup& lookup);
+
+    /// Deliver an item read from disk; returns the GetValue status.
+    ENGINE_ERROR_CODE deliverFromDisk(GetValue& val);
+
+    EventuallyPersistentEngine& engine;
+    const Vbid vbid;
+    const ValueFilter valFilter;
+
+    /// Serialises running the scan and changing the subscribers.
+    std::mutex mutex;
+    ScanContext* scanCtx = nullptr;
+    bool finished = false;
+    /// The subscriber whose full buffer paused the last chunk, if any.
+    const Subscriber* pausedBy = nullptr;
+    std::vector<std::shared_ptr<Subscriber>> subscribers;
+};
+
+/**
+ * The SharedBackfillScans which may be joined, at most one per vBucket.
+ */
+class SharedBackfillScanMap {
+public:
+    /**
+     * Join the scan of the stream's vBucket, if there is one the stream can
+     * join.
+     *
+     * @return the scan and subscriber; both are null if not joined.
+     */
+    std::pair<std::shared_ptr<SharedBackfillScan>,
+              std::shared_ptr<SharedBackfillScan::Subscriber>>
+    join(std::shared_ptr<ActiveStream> stream,
+         uint64_t startSeqno,
+         uint64_t endSeqno,
+         ValueFilter valFilter);
+
+    /// Make a newly opened scan available for other streams to join.
+    void add(Vbid vbid, std::shared_ptr<SharedBackfillScan> scan);
+
+    /// @returns the number of backfills which have joined a scan.
+    size_t getNumJoined() const {
+        return numJoined;
+    }
+
+    void addStats(const AddStatFn& add_stat, const void* c) const;
+
+private:
+    std::mutex mutex;
+    std::unordered_map<Vbid, std::weak_ptr<SharedBackfillScan>> scans;
+    cb::RelaxedAtomic<size_t> numJoined{0};
+};
@@ -58,7 +58,7 @@ bool DefragmentVisitor::visit(const HashTable::HashBucketLock& lh,
         // should be good enough.
         if (v.getValue()->getAge() >= age_threshold &&
             v.getValue().refCount() < 2) {
-            v.reallocate();
+            currentVb->ht.unlocked_reallocateValue(lh, v);
             defrag_count++;
         } else {
             v.getValue()->incrementAge();
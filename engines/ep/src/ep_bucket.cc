@@ -174,7 +174,11 @@ bool BloomFilterCallback::initTempFilter(Vbid vbucketId) {
         estimated_count = initial_estimation;
     }
 
-    vb->initTempFilter(estimated_count, config.getBfilterFpProb());
+    vb->initTempFilter(estimated_count,
+                       config.getBfilterFpProb(),
+                       config.getBfilterType() == "blocked"
+                               ? BloomFilter::Type::Blocked
+                               : BloomFilter::Type::BitArray);
 
     return true;
 }
@@ -221,6 +225,10 @@ public:
                                   size_t value) override {
         if (key == "flusher_batch_split_trigger") {
             bucket.setFlusherBatchSplitTrigger(value);
+        } else if (key == "bg_fetcher_coalesce_window_us") {
+            bucket.setBgFetcherCoalesceWindow(std::chrono::microseconds(value));
+        } else if (key == "flusher_group_commit_time_ms") {
+            bucket.setFlusherGroupCommitTime(value);
         } else if (key == "alog_sleep_time") {
             bucket.setAccessScannerSleeptime(value, false);
         } else if (key == "alog_task_time") {
@@ -240,6 +248,8 @@ public:
             }
         } else if (key == "retain_erroneous_tombstones") {
             bucket.setRetainErroneousTombstones(value);
+        } else if (key == "flusher_pipeline_enabled") {
+            bucket.setFlusherPipelineEnabled(value);
         } else  {
             EP_LOG_WARN("Failed to change value for unknown variable, {}", key);
         }
@@ -268,6 +278,20 @@ EPBucket::EPBucket(EventuallyPersistentEngine& theEngine)
             "flusher_batch_split_trigger",
             std::make_unique<ValueChangedListener>(*this));
 
+    flusherGroupCommitTime = config.getFlusherGroupCommitTimeMs();
+    config.addValueChangedListener(
+            "flusher_group_commit_time_ms",
+            std::make_unique<ValueChangedListener>(*this));
+
+    flusherPipelineEnabled = config.isFlusherPipelineEnabled();
+    config.addValueChangedListener(
+            "flusher_pipeline_enabled",
+            std::make_unique<ValueChangedListener>(*this));
+
+    config.addValueChangedListener(
+            "bg_fetcher_coalesce_window_us",
+            std::make_unique<ValueChangedListener>(*this));
+
     retainErroneousTombstones = config.isRetainErroneousTombstones();
     config.addValueChangedListener(
            "retain_erroneous_tombstones",
@@ -301,6 +325,21 @@ void EPBucket::deinitialize() {
     stopFlusher();
     stopBgFetcher();
 
+    // With the flusher stopped nothing more will be persisted, so the bloom
+    // filters persisted now remain valid for the next warmup.
+    if (!stats.forceShutdown &&
+        engine.getConfiguration().isBfilterEnabled()) {
+        size_t persisted = 0;
+        for (const auto vbid : vbMap.getBuckets()) {
+            auto vb = getLockedVBucket(vbid);
+            if (vb && persistBloomFilter(vb)) {
+                ++persisted;
+            }
+        }
+        EP_LOG_INFO("EPBucket::deinitialize: persisted {} bloom filter(s)",
+                    persisted);
+    }
+
     stopWarmup();
     KVBucket::deinitialize();
 }
@@ -334,7 +373,7 @@ static bool canDeDuplicate(Item* lastFlushed, Item& candidate) {
     return true;
 }
 
-std::pair<bool, size_t> EPBucket::flushVBucket(Vbid vbid) {
+std::pair<bool, size_t> EPBucket::flushVBucket(Vbid vbid, GroupCommit* group) {
     TRACE_EVENT1("ep-engine", "EPBucket::flushVBucket", "vbid", vbid.get());
 
     int items_flushed = 0;
@@ -370,7 +409,9 @@ std::pair<bool, size_t> EPBucket::flushVBucket(Vbid vbid) {
                         "Retry in 1 sec ...");
                 std::this_thread::sleep_for(std::chrono::seconds(1));
             }
-            rwUnderlying->optimizeWrites(items);
+            if (!toFlush.writesOptimized) {
+                rwUnderlying->optimizeWrites(items);
+            }
 
             Item *prev = NULL;
 
@@ -628,49 +669,14 @@ std::pair<bool, size_t> EPBucket::flushVBucket(Vbid vbid) {
             }
 
             if (vb->rejectQueue.empty()) {
-                // only update the snapshot range if items were flushed, i.e.
-                // don't appear to be in a snapshot when you have no data for it
-                if (range) {
-                    vb->setPersistedSnapshot(*range);
-                }
-                uint64_t highSeqno = rwUnderlying->getLastPersistedSeqno(vbid);
-                if (highSeqno > 0 && highSeqno != vb->getPersistenceSeqno()) {
-                    vb->setPersistenceSeqno(highSeqno);
+                if (group) {
+                    // Notified once the group's commits are durable.
+                    if (range) {
+                        group->flushed[vbid] = {vb.getVB(), range};
+                    }
+                } else {
+                    notifyFlushCommitted(*vb, *rwUnderlying, range);
                 }
-
-                // Notify the local DM that the Flusher has run. Persistence
-                // could unblock some pending Prepares in the DM.
-                // If it is the case, this call updates the High Prepared Seqno
-                // for this node.
-                // In the case of a Replica node, that could trigger a SeqnoAck
-                // to the Active.
-                //
-                // Note: This is a NOP if the there's no Prepare queued in DM.
-                //     We could notify the DM only if strictly required (i.e.,
-                //     only when the Flusher has persisted up to the snap-end
-                //     mutation of an in-memory snapshot, see HPS comments in
-                //     PassiveDM for details), but that requires further work.
-                //     The main problem is that in general a flush-batch does
-                //     not coincide with in-memory snapshots (ie, we don't
-                //     persist at snapshot boundaries). So, the Flusher could
-                //     split a single in-memory snapshot into multiple
-                //     flush-batches. That may happen at Replica, e.g.:
-                //
-                //     1) received snap-marker [1, 2]
-                //     2) received 1:PRE
-                //     3) flush-batch {1:PRE}
-                //     4) received 2:mutation
-                //     5) flush-batch {2:mutation}
-                //
-                //     In theory we need to notify the DM only at step (5) and
-                //     only if the the snapshot contains at least 1 Prepare
-                //     (which is the case in our example), but the problem is
-                //     that the Flusher doesn't know about 1:PRE at step (5).
-                //
-                //     So, given that here we are executing in a slow bg-thread
-                //     (write+sync to disk), then we can just afford to calling
-                //     back to the DM unconditionally.
-                vb->notifyPersistenceToDurabilityMonitor();
             }
 
             auto flush_end = std::chrono::steady_clock::now();
@@ -696,14 +702,16 @@ std::pair<bool, size_t> EPBucket::flushVBucket(Vbid vbid) {
         }
 
         if (vb->rejectQueue.empty()) {
-            vb->checkpointManager->itemsPersisted();
-            uint64_t seqno = vb->getPersistenceSeqno();
-            uint64_t chkid =
-                    vb->checkpointManager->getPersistenceCursorPreChkId();
-            vb->notifyHighPriorityRequests(
-                    engine, seqno, HighPriorityVBNotify::Seqno);
-            vb->notifyHighPriorityRequests(
-                    engine, chkid, HighPriorityVBNotify::ChkPersistence);
+            if (group) {
+                // Record the vBucket even if no items were flushed (keeping
+                // the range of an earlier flush of the same vBucket).
+                auto& flushed = group->flushed[vbid];
+                if (flushed.vb != vb.getVB()) {
+                    flushed = {vb.getVB(), {}};
+                }
+            } else {
+                notifyFlushPersisted(*vb);
+            }
         } else {
             return {true, items_flushed};
         }
@@ -712,10 +720,132 @@ std::pair<bool, size_t> EPBucket::flushVBucket(Vbid vbid) {
     return {moreAvailable, items_flushed};
 }
 
+void EPBucket::prepareFlush(Vbid vbid) {
+    TRACE_EVENT1("ep-engine", "EPBucket::prepareFlush", "vbid", vbid.get());
+
+    // Don't wait for the flusher (or anything else) holding the vBucket.
+    auto vb = getLockedVBucket(vbid, std::try_to_lock);
+    if (!vb.owns_lock() || !vb || vb->hasPreparedItemsToPersist()) {
+        return;
+    }
+
+    const auto chkId = vb->checkpointManager->getPersistenceCursorChkId();
+    auto toFlush = vb->getItemsToPersist(flusherBatchSplitTrigger);
+    if (toFlush.items.empty()) {
+        return;
+    }
+    toFlush.preparedFromChkId = chkId;
+    getRWUnderlying(vbid)->optimizeWrites(toFlush.items);
+    toFlush.writesOptimized = true;
+    vb->setPreparedItemsToPersist(std::move(toFlush));
+}
+
+void EPBucket::notifyFlushCommitted(
+        VBucket& vb,
+        KVStore& rwUnderlying,
+        const boost::optional<snapshot_range_t>& range) {
+    // only update the snapshot range if items were flushed, i.e.
+    // don't appear to be in a snapshot when you have no data for it
+    if (range) {
+        vb.setPersistedSnapshot(*range);
+    }
+    uint64_t highSeqno = rwUnderlying.getLastPersistedSeqno(vb.getId());
+    if (highSeqno > 0 && highSeqno != vb.getPersistenceSeqno()) {
+        vb.setPersistenceSeqno(highSeqno);
+    }
+
+    // Notify the local DM that the Flusher has run. Persistence
+    // could unblock some pending Prepares in the DM.
+    // If it is the case, this call updates the High Prepared Seqno
+    // for this node.
+    // In the case of a Replica node, that could trigger a SeqnoAck
+    // to the Active.
+    //
+    // Note: This is a NOP if the there's no Prepare queued in DM.
+    //     We could notify the DM only if strictly required (i.e.,
+    //     only when the Flusher has persisted up to the snap-end
+    //     mutation of an in-memory snapshot, see HPS comments in
+    //     PassiveDM for details), but that requires further work.
+    //     The main problem is that in general a flush-batch does
+    //     not coincide with in-memory snapshots (ie, we don't
+    //     persist at snapshot boundaries). So, the Flusher could
+    //     split a single in-memory snapshot into multiple
+    //     flush-batches. That may happen at Replica, e.g.:
+    //
+    //     1) received snap-marker [1, 2]
+    //     2) received 1:PRE
+    //     3) flush-batch {1:PRE}
+    //     4) received 2:mutation
+    //     5) flush-batch {2:mutation}
+    //
+    //     In theory we need to notify the DM only at step (5) and
+    //     only if the the snapshot contains at least 1 Prepare
+    //     (which is the case in our example), but the problem is
+    //     that the Flusher doesn't know about 1:PRE at step (5).
+    //
+    //     So, given that here we are executing in a slow bg-thread
+    //     (write+sync to disk), then we can just afford to calling
+    //     back to the DM unconditionally.
+    vb.notifyPersistenceToDurabilityMonitor();
+}
+
+void EPBucket::notifyFlushPersisted(VBucket& vb) {
+    vb.itemsPersisted();
+    uint64_t seqno = vb.getPersistenceSeqno();
+    uint64_t chkid = vb.checkpointManager->getPersistenceCursorPreChkId();
+    vb.notifyHighPriorityRequests(engine, seqno, HighPriorityVBNotify::Seqno);
+    vb.notifyHighPriorityRequests(
+            engine, chkid, HighPriorityVBNotify::ChkPersistence);
+}
+
+bool EPBucket::completeGroupCommit(GroupCommit& group) {
+    TRACE_EVENT1("ep-engine",
+                 "EPBucket::completeGroupCommit",
+                 "vbuckets",
+                 group.flushed.size());
+    {
+        BlockTimer timer(
+                &stats.diskCommitHisto, "disk_commit", stats.timingLog);
+        if ((preGroupCommitSyncHook && !preGroupCommitSyncHook()) ||
+            !group.kvstore.syncDeferredCommits()) {
+            ++stats.commitFailed;
+            EP_LOG_WARN(
+                    "EPBucket::completeGroupCommit: "
+                    "kvstore.syncDeferredCommits failed!!!");
+            return false;
+        }
+    }
+    group.kvstore.setDeferCommitSync(false);
+
+    for (const auto& flushed : group.flushed) {
+        auto vb = getLockedVBucket(flushed.first);
+        // Skip a vBucket which was deleted (or re-created) since it was
+        // flushed - its persistence is no longer that of the flush. As in
+        // flushVBucket, the vBucket is notified by its next flush if any
+        // items were rejected.
+        if (!vb || vb.getVB() != flushed.second.vb ||
+            !vb->rejectQueue.empty()) {
+            continue;
+        }
+        notifyFlushCommitted(*vb, group.kvstore, flushed.second.range);
+        notifyFlushPersisted(*vb);
+    }
+    group.flushed.clear();
+    return true;
+}
+
 void EPBucket::setFlusherBatchSplitTrigger(size_t limit) {
     flusherBatchSplitTrigger = limit;
 }
 
+void EPBucket::setFlusherGroupCommitTime(size_t ms) {
+    flusherGroupCommitTime = ms;
+}
+
+void EPBucket::setFlusherPipelineEnabled(bool enabled) {
+    flusherPipelineEnabled = enabled;
+}
+
 void EPBucket::commit(KVStore& kvstore,
                       Collections::VB::Flush& collectionsFlush) {
     BlockTimer timer(&stats.diskCommitHisto, "disk_commit", stats.timingLog);
@@ -810,6 +940,12 @@ bool EPBucket::startBgFetcher() {
     return true;
 }
 
+void EPBucket::setBgFetcherCoalesceWindow(std::chrono::microseconds window) {
+    for (const auto& shard : vbMap.shards) {
+        shard->getBgFetcher()->setCoalesceWindow(window);
+    }
+}
+
 void EPBucket::stopBgFetcher() {
     for (const auto& shard : vbMap.shards) {
         BgFetcher* bgfetcher = shard->getBgFetcher();
@@ -1036,9 +1172,14 @@ bool EPBucket::doCompact(const CompactionConfig& config,
             engine.decrementSessionCtr();
         } else {
             compactInternal(config, purgeSeqno);
+            persistBloomFilter(vb);
         }
     } else {
         compactInternal(config, purgeSeqno);
+        auto vb = getLockedVBucket(vbid);
+        if (vb) {
+            persistBloomFilter(vb);
+        }
     }
 
     updateCompactionTasks(vbid);
@@ -1050,6 +1191,23 @@ bool EPBucket::doCompact(const CompactionConfig& config,
     return false;
 }
 
+bool EPBucket::persistBloomFilter(LockedVBucketPtr& vb) {
+    if (!engine.getConfiguration().isBfilterEnabled()) {
+        return false;
+    }
+
+    auto filter = vb->snapshotFilter();
+    if (!filter) {
+        return false;
+    }
+
+    auto* rwUnderlying = getRWUnderlying(vb->getId());
+    PersistedBloomFilter persisted;
+    persisted.highSeqno = rwUnderlying->getLastPersistedSeqno(vb->getId());
+    persisted.filter = filter->encode();
+    return rwUnderlying->persistBloomFilter(vb->getId(), persisted);
+}
+
 void EPBucket::updateCompactionTasks(Vbid db_file_id) {
     LockHolder lh(compactionLock);
     bool erased = false, woke = false;
@@ -1383,7 +1541,8 @@ RollbackResult EPBucket::doRollback(Vbid vbid, uint64_t rollbackSeqno) {
 }
 
 void EPBucket::rollbackUnpersistedItems(VBucket& vb, int64_t rollbackSeqno) {
-    std::vector<queued_item> items;
+    // Include any items taken from the checkpoints ahead of the flush.
+    auto items = vb.discardPreparedItemsToPersist();
     vb.checkpointManager->getNextItemsForPersistence(items);
     for (const auto& item : items) {
         if (item->getBySeqno() > rollbackSeqno &&
@@ -19,6 +19,35 @@
 
 #include "kv_bucket.h"
 
+#include <functional>
+#include <map>
+
+/**
+ * The vBuckets flushed by one of the flusher's group commits, whose commits
+ * are made durable (and their persistence notified) together by
+ * EPBucket::completeGroupCommit.
+ */
+struct GroupCommit {
+    explicit GroupCommit(KVStore& kvstore) : kvstore(kvstore) {
+    }
+
+    /// The shard's KVStore, which is deferring the sync of its commits.
+    KVStore& kvstore;
+
+    struct Flushed {
+        /// The vBucket flushed; its persistence is only notified if it is
+        /// still the vBucket of that id (it wasn't deleted or re-created
+        /// since).
+        VBucketPtr vb;
+        /// The snapshot range flushed by the latest flush of the vBucket, if
+        /// it flushed any items.
+        boost::optional<snapshot_range_t> range;
+    };
+
+    /// The vBuckets flushed as part of the group.
+    std::map<Vbid, Flushed> flushed;
+};
+
 /**
  * Eventually Persistent Bucket
  *
@@ -47,8 +76,50 @@ public:
      *         moreToFlush - true if there are still items remaining for this
      *         vBucket.
      *         flushCount - the number of items flushed.
+     * @param group If non-null, the flush is part of the given group commit:
+     *        its persistence is only notified by completeGroupCommit().
      */
-    std::pair<bool, size_t> flushVBucket(Vbid vbid);
+    std::pair<bool, size_t> flushVBucket(Vbid vbid,
+                                         GroupCommit* group = nullptr);
+
+    /**
+     * Obtain (and order) the next batch of items to flush for the given
+     * vBucket ahead of its flush, so that it is built while the flusher is
+     * writing another vBucket. Does nothing if the vBucket is locked or
+     * already has a prepared batch.
+     */
+    void prepareFlush(Vbid vbid);
+
+    bool isFlusherPipelineEnabled() const {
+        return flusherPipelineEnabled;
+    }
+
+    void setFlusherPipelineEnabled(bool enabled);
+
+    /**
+     * Make the commits of the given group durable, stop deferring the sync
+     * of the KVStore's commits and notify the persistence of each flushed
+     * vBucket.
+     *
+     * @return false if the sync failed; the group is left as is (nothing is
+     *         notified) so the caller can retry.
+     */
+    bool completeGroupCommit(GroupCommit& group);
+
+    // Testing hook - if non-empty, called by completeGroupCommit() before
+    // syncing the group's commits; returning false fails the sync.
+    std::function<bool()> preGroupCommitSyncHook;
+
+    /**
+     * @returns the maximum time, in milliseconds, the flusher may defer the
+     *          sync of its commits to sync the commits of several vBuckets
+     *          together; zero if group commit is disabled.
+     */
+    size_t getFlusherGroupCommitTime() const {
+        return flusherGroupCommitTime;
+    }
+
+    void setFlusherGroupCommitTime(size_t ms);
 
     /**
      * Set the number of flusher items which can be included in a
@@ -79,6 +150,9 @@ public:
     /// Stops the background fetcher for each shard.
     void stopBgFetcher();
 
+    /// Sets the coalescing window of the background fetcher of each shard.
+    void setBgFetcherCoalesceWindow(std::chrono::microseconds window);
+
     ENGINE_ERROR_CODE scheduleCompaction(Vbid vbid,
                                          const CompactionConfig& c,
                                          const void* ck) override;
@@ -191,6 +265,15 @@ public:
 
     void warmupCompleted();
 
+    /**
+     * Persist a snapshot of the vBucket's bloom filter (see
+     * VBucket::snapshotFilter), for warmup to load on restart.
+     * Requires a locked vBucket so it cannot race with the flusher.
+     *
+     * @return true if a filter was persisted
+     */
+    bool persistBloomFilter(LockedVBucketPtr& vb);
+
 protected:
     // During the warmup phase we might want to enable external traffic
     // at a given point in time.. The LoadStorageKvPairCallback will be
@@ -201,6 +284,20 @@ protected:
 
     void flushOneDelOrSet(const queued_item& qi, VBucketPtr& vb);
 
+    /**
+     * Update the vBucket's persisted snapshot and seqno after a commit has
+     * been made durable, and notify its DurabilityMonitor.
+     *
+     * @param range The snapshot range flushed, if any items were flushed.
+     */
+    void notifyFlushCommitted(VBucket& vb,
+                              KVStore& rwUnderlying,
+                              const boost::optional<snapshot_range_t>& range);
+
+    /// Notify the checkpoint manager and high priority requests of the
+    /// vBucket's persistence.
+    void notifyFlushPersisted(VBucket& vb);
+
     /**
      * Compaction of a database file
      *
@@ -228,6 +325,15 @@ protected:
      */
     std::atomic<size_t> flusherBatchSplitTrigger;
 
+    /**
+     * Max time (ms) the flusher may defer the sync of commits to group them.
+     * Atomic for the same reason as flusherBatchSplitTrigger.
+     */
+    std::atomic<size_t> flusherGroupCommitTime;
+
+    /// Should the flusher prepare the next vBucket's batch while flushing?
+    std::atomic<bool> flusherPipelineEnabled;
+
     /**
      * Indicates whether erroneous tombstones need to retained or not during
      * compaction
@@ -296,6 +296,32 @@ cb::EngineErrorItemPair EventuallyPersistentEngine::get(
     return cb::makeEngineErrorItemPair(cb::engine_errc(ret), itm, this);
 }
 
+std::vector<cb::EngineErrorItemPair> EventuallyPersistentEngine::get_multi(
+        gsl::not_null<const void*> cookie,
+        const std::vector<std::pair<DocKey, Vbid>>& keys,
+        DocStateFilter documentStateFilter) {
+    get_options_t options = static_cast<get_options_t>(QUEUE_BG_FETCH |
+                                                       HONOR_STATES |
+                                                       TRACK_REFERENCE |
+                                                       DELETE_TEMP |
+                                                       HIDE_LOCKED_CAS |
+                                                       TRACK_STATISTICS);
+
+    switch (documentStateFilter) {
+    case DocStateFilter::Alive:
+        break;
+    case DocStateFilter::Deleted:
+        // Not supported by get() either (see above); leave it to get() to
+        // report the error
+        return {};
+    case DocStateFilter::AliveOrDeleted:
+        options = static_cast<get_options_t>(options | GET_DELETED_VALUE);
+        break;
+    }
+
+    return acquireEngine(this)->getMultiInner(cookie, keys, options);
+}
+
 cb::EngineErrorItemPair EventuallyPersistentEngine::get_if(
         gsl::not_null<const void*> cookie,
         const DocKey& key,
@@ -575,8 +601,14 @@ cb::mcbp::Status EventuallyPersistentEngine::setFlushParam(
             getConfiguration().setExpPagerStime(std::stoull(val));
         } else if (key == "exp_pager_initial_run_time") {
             getConfiguration().setExpPagerInitialRunTime(std::stoll(val));
+        } else if (key == "bg_fetcher_coalesce_window_us") {
+            getConfiguration().setBgFetcherCoalesceWindowUs(std::stoull(val));
         } else if (key == "flusher_batch_split_trigger") {
             getConfiguration().setFlusherBatchSplitTrigger(std::stoll(val));
+        } else if (key == "flusher_group_commit_time_ms") {
+            getConfiguration().setFlusherGroupCommitTimeMs(std::stoull(val));
+        } else if (key == "flusher_pipeline_enabled") {
+            getConfiguration().setFlusherPipelineEnabled(cb_stob(val));
         } else if (key == "getl_default_timeout") {
             getConfiguration().setGetlDefaultTimeout(std::stoull(val));
         } else if (key == "getl_max_timeout") {
@@ -604,6 +636,8 @@ cb::mcbp::Status EventuallyPersistentEngine::setFlushParam(
             getConfiguration().setBfilterFpProb(std::stof(val));
         } else if (key == "bfilter_key_count") {
             getConfiguration().setBfilterKeyCount(std::stoull(val));
+        } else if (key == "bfilter_type") {
+            getConfiguration().setBfilterType(val);
         } else if (key == "pager_active_vb_pcnt") {
             getConfiguration().setPagerActiveVbPcnt(std::stoull(val));
         } else if (key == "pager_sleep_time_ms") {
@@ -639,6 +673,10 @@ cb::mcbp::Status EventuallyPersistentEngine::setFlushParam(
             size_t value = std::stoull(val);
             getConfiguration().setNumNonioThreads(value);
             ExecutorPool::get()->setNumNonIO(value);
+        } else if (key == "executor_work_stealing") {
+            bool value = cb_stob(val);
+            getConfiguration().setExecutorWorkStealing(value);
+            ExecutorPool::get()->setWorkStealing(value);
         } else if (key == "bfilter_enabled") {
             getConfiguration().setBfilterEnabled(cb_stob(val));
         } else if (key == "bfilter_residency_threshold") {
@@ -669,6 +707,12 @@ cb::mcbp::Status EventuallyPersistentEngine::setFlushParam(
             getConfiguration().setCompactionWriteQueueCap(std::stoull(val));
         } else if (key == "chk_expel_enabled") {
             getConfiguration().setChkExpelEnabled(cb_stob(val));
+        } else if (key == "chk_expel_eager") {
+            getConfiguration().setChkExpelEager(cb_stob(val));
+        } else if (key == "chk_expel_eager_min_items") {
+            getConfiguration().setChkExpelEagerMinItems(std::stoull(val));
+        } else if (key == "dcp_backfill_readahead_size") {
+            getConfiguration().setDcpBackfillReadaheadSize(std::stoull(val));
         } else if (key == "dcp_min_compression_ratio") {
             getConfiguration().setDcpMinCompressionRatio(std::stof(val));
         } else if (key == "dcp_noop_mandatory_for_v5_features") {
@@ -2116,6 +2160,9 @@ ENGINE_ERROR_CODE EventuallyPersistentEngine::initialize(const char* config) {
     } else if (!flowCtlPolicy.compare("aggressive")) {
         dcpFlowControlManager_ =
                 std::make_unique<DcpFlowControlManagerAggressive>(*this);
+    } else if (!flowCtlPolicy.compare("adaptive")) {
+        dcpFlowControlManager_ =
+                std::make_unique<DcpFlowControlManagerAdaptive>(*this);
     } else {
         /* Flow control is not enabled */
         dcpFlowControlManager_ = std::make_unique<DcpFlowControlManager>(*this);
@@ -2317,6 +2364,63 @@ ENGINE_ERROR_CODE EventuallyPersistentEngine::get(const void* cookie,
     return ret;
 }
 
+std::vector<cb::EngineErrorItemPair>
+EventuallyPersistentEngine::getMultiInner(
+        const void* cookie,
+        const std::vector<std::pair<DocKey, Vbid>>& keys,
+        get_options_t options) {
+    // In degraded mode get() remaps misses to TMPFAIL; let it do so.
+    if (isDegradedMode()) {
+        return {};
+    }
+
+    // The batch is traced as a single GET span of the cookie which issued
+    // it (the first GET of the pipeline).
+    const auto start = std::chrono::steady_clock::now();
+    TracerStopwatch tracer(cookie, cb::tracing::TraceCode::GET);
+    tracer.start(start);
+
+    auto values = kvBucket->getMulti(keys, options);
+
+    std::vector<cb::EngineErrorItemPair> ret;
+    ret.reserve(values.size());
+    size_t served = 0;
+    for (auto& gv : values) {
+        switch (gv.getStatus()) {
+        case ENGINE_SUCCESS:
+            if (options & TRACK_STATISTICS) {
+                ++stats->numOpsGet;
+            }
+            ret.push_back(cb::makeEngineErrorItemPair(
+                    cb::engine_errc::success, gv.item.release(), this));
+            ++served;
+            break;
+        case ENGINE_KEY_ENOENT:
+            ret.push_back(
+                    cb::makeEngineErrorItemPair(cb::engine_errc::no_such_key));
+            ++served;
+            break;
+        default:
+            // Retried with get(), which records its own timings.
+            ret.push_back(
+                    cb::makeEngineErrorItemPair(cb::engine_errc::would_block));
+            break;
+        }
+    }
+
+    const auto stop = std::chrono::steady_clock::now();
+    tracer.stop(stop);
+    if (served) {
+        // Each served GET is recorded with an equal share of the batch time.
+        stats->getCmdHisto.add(
+                std::chrono::duration_cast<std::chrono::microseconds>(
+                        stop - start) /
+                        served,
+                served);
+    }
+    return ret;
+}
+
 cb::EngineErrorItemPair EventuallyPersistentEngine::getAndTouchInner(
         const void* cookie, const DocKey& key, Vbid vbucket, uint32_t exptime) {
     auto* handle = reinterpret_cast<EngineIface*>(this);
@@ -2771,6 +2875,10 @@ ENGINE_ERROR_CODE EventuallyPersistentEngine::doEngineStats(
     add_casted_stat("ep_items_expelled_from_checkpoints",
                     epstats.itemsExpelledFromCheckpoints,
                     add_stat, cookie);
+    add_casted_stat("ep_mem_freed_by_checkpoint_item_expel",
+                    epstats.memFreedByCheckpointItemExpel,
+                    add_stat,
+                    cookie);
     add_casted_stat("ep_items_rm_from_checkpoints",
                     epstats.itemsRemovedFromCheckpoints,
                     add_stat, cookie);
@@ -3972,6 +4080,8 @@ ENGINE_ERROR_CODE EventuallyPersistentEngine::doTimingStats(
                     cookie);
     add_casted_stat("item_pager", stats->itemPagerHisto, add_stat, cookie);
     add_casted_stat("expiry_pager", stats->expiryPagerHisto, add_stat, cookie);
+    add_casted_stat(
+            "ht_resize_stall", stats->htResizeStallHisto, add_stat, cookie);
 
     add_casted_stat("storage_age", stats->dirtyAgeHisto, add_stat, cookie);
 
@@ -4125,6 +4235,11 @@ ENGINE_ERROR_CODE EventuallyPersistentEngine::doWorkloadStats(
                          "ep_workload:num_sleepers");
         add_casted_stat(statname, numSleepers, add_stat, cookie);
 
+        checked_snprintf(statname, sizeof(statname),
+                         "ep_workload:stolen_tasks");
+        add_casted_stat(
+                statname, expool->getNumStolenTasks(), add_stat, cookie);
+
         expool->doTaskQStat(ObjectRegistry::getCurrentEngine(),
                             cookie, add_stat);
 
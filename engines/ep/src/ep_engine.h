@@ -131,6 +131,10 @@ public:
                                 const DocKey& key,
                                 Vbid vbucket,
                                 DocStateFilter documentStateFilter) override;
+    std::vector<cb::EngineErrorItemPair> get_multi(
+            gsl::not_null<const void*> cookie,
+            const std::vector<std::pair<DocKey, Vbid>>& keys,
+            DocStateFilter documentStateFilter) override;
     cb::EngineErrorItemPair get_if(
             gsl::not_null<const void*> cookie,
             const DocKey& key,
@@ -432,6 +436,16 @@ public:
                           Vbid vbucket,
                           get_options_t options);
 
+    /**
+     * Look up a batch of keys (see get_multi). The time taken is recorded
+     * in the GET trace span of the cookie, and amortised over the keys
+     * served into getCmdHisto.
+     */
+    std::vector<cb::EngineErrorItemPair> getMultiInner(
+            const void* cookie,
+            const std::vector<std::pair<DocKey, Vbid>>& keys,
+            get_options_t options);
+
     /**
      * Fetch an item only if the specified filter predicate returns true.
      *
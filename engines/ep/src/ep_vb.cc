@@ -260,8 +260,10 @@ void EPVBucket::notifyAllPendingConnsFailed(EventuallyPersistentEngine& e) {
         for (auto& bgf : pendingBGFetches) {
             vb_bgfetch_item_ctx_t& bg_itm_ctx = bgf.second;
             for (auto& bgitem : bg_itm_ctx.bgfetched_list) {
-                toNotify[bgitem->cookie] = ENGINE_NOT_MY_VBUCKET;
-                e.storeEngineSpecific(bgitem->cookie, nullptr);
+                if (bgitem->cookie) {
+                    toNotify[bgitem->cookie] = ENGINE_NOT_MY_VBUCKET;
+                    e.storeEngineSpecific(bgitem->cookie, nullptr);
+                }
                 ++num_of_deleted_pending_fetches;
             }
         }
@@ -645,7 +647,7 @@ void EPVBucket::bgFetch(const DocKey& key,
             std::make_unique<VBucketBGFetchItem>(cookie, isMeta),
             getShard()->getBgFetcher());
     if (getShard()) {
-        getShard()->getBgFetcher()->notifyBGEvent();
+        getShard()->getBgFetcher()->notifyBGEvent(getId());
     }
     EP_LOG_DEBUG("Queued a background fetch, now at {}",
                  uint64_t(bgfetch_size));
@@ -305,8 +305,8 @@ EphemeralVBucket::inMemoryBackfill(uint64_t start, uint64_t end) {
 }
 
 boost::optional<SequenceList::RangeIterator>
-EphemeralVBucket::makeRangeIterator(bool isBackfill) {
-    return seqList->makeRangeIterator(isBackfill);
+EphemeralVBucket::makeRangeIterator(bool isBackfill, seqno_t startSeqno) {
+    return seqList->makeRangeIterator(isBackfill, startSeqno);
 }
 bool EphemeralVBucket::isKeyLogicallyDeleted(const DocKey& key,
                                              int64_t bySeqno) {
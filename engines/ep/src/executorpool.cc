@@ -138,6 +138,7 @@ ExecutorPool *ExecutorPool::get(void) {
                                    config.getNumWriterThreads(),
                                    config.getNumAuxioThreads(),
                                    config.getNumNonioThreads());
+            tmp->setWorkStealing(config.isExecutorWorkStealing());
             instance.store(tmp);
         }
     }
@@ -218,6 +219,11 @@ TaskQueue *ExecutorPool::_nextTask(ExecutorThread &t, uint8_t tick) {
             return checkQ;
         }
         if (toggle || checkQ == checkNextQ) {
+            if (workStealing) {
+                if (TaskQueue* stolenQ = _stealTask(t)) {
+                    return stolenQ;
+                }
+            }
             TaskQueue *sleepQ = getSleepQ(myq);
             if (sleepQ->sleepThenFetchNextTask(t)) {
                 return sleepQ;
@@ -232,6 +238,46 @@ TaskQueue *ExecutorPool::_nextTask(ExecutorThread &t, uint8_t tick) {
     return NULL;
 }
 
+TaskQueue* ExecutorPool::_stealTask(ExecutorThread& t) {
+    for (size_t i = 1; i < numTaskSets; i++) {
+        const auto type = task_type_t((t.taskType + i) % numTaskSets);
+        if (!_canSteal(t.taskType, type)) {
+            continue;
+        }
+        if (!_canBeStolenFrom(type)) {
+            // An idle thread of that type will pick up any task due
+            continue;
+        }
+        // The high priority queue first, as in _nextTask. Queues without a
+        // ready task are skipped without taking their lock.
+        for (auto* q : {isHiPrioQset ? hpTaskQ[type] : nullptr,
+                        isLowPrioQset ? lpTaskQ[type] : nullptr}) {
+            if (q && q->fetchNextTask(t)) {
+                ++numStolenTasks;
+                return q;
+            }
+        }
+    }
+    return nullptr;
+}
+
+void ExecutorPool::wakeStealers(task_type_t type, size_t& numToWake) {
+    // Whether the tasks may be stolen is checked by the woken threads
+    // themselves (the thread which just fetched a task isn't counted as
+    // busy yet)
+    if (!workStealing || numToWake == 0) {
+        return;
+    }
+    // Start with the sleeping threads of the type itself (which may not
+    // have been woken, if they sleep on the other priority's queue)
+    for (size_t i = 0; i < numTaskSets && numToWake; i++) {
+        const auto thief = task_type_t((type + i) % numTaskSets);
+        if (_canSteal(thief, type)) {
+            getSleepQ(thief)->doWake(numToWake);
+        }
+    }
+}
+
 TaskQueue *ExecutorPool::nextTask(ExecutorThread &t, uint8_t tick) {
     NonBucketAllocationGuard guard;
     TaskQueue *tq = _nextTask(t, tick);
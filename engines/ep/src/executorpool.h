@@ -62,6 +62,19 @@
  * ExecutorPool::snooze(size_t taskId, double toSleep)
  *   The pool's snooze method will locate the task matching taskId and adjust
  *   its wakeTime to account for the toSleep value.
+ *
+ * === Work stealing ===
+ *
+ * When enabled (setWorkStealing()) a thread which finds no ready task in the
+ * queues of its own type may run a ready task from the queues of another
+ * type, if all of that type's threads are busy. Tasks are only stolen
+ * between the IO types (READER, WRITER and AUXIO); NONIO threads neither
+ * steal nor are stolen from. The task is taken from its own TaskQueue (so
+ * the priority order within the queue is kept), is rescheduled back into it
+ * and is counted as work of its own type. When a task is scheduled or woken
+ * and none of the threads of its type are sleeping, threads of the types
+ * which may steal it are woken to pick it up. Note that this allows more
+ * tasks of a type to run concurrently than there are threads of that type.
  */
 #pragma once
 
@@ -110,6 +123,29 @@ public:
         return isHiPrioQset ? hpTaskQ[curTaskType] : lpTaskQ[curTaskType];
     }
 
+    /**
+     * Wake up to numToWake sleeping threads (of the given type first, then
+     * of the other types to steal) to run the ready task(s) of the given
+     * type, if work stealing is enabled.
+     *
+     * @param type the task type which has more ready tasks than idle threads
+     * @param numToWake the number of threads to wake; decremented by the
+     *        number woken
+     */
+    void wakeStealers(task_type_t type, size_t& numToWake);
+
+    void setWorkStealing(bool enabled) {
+        workStealing.store(enabled);
+    }
+
+    bool isWorkStealing() const {
+        return workStealing.load();
+    }
+
+    size_t getNumStolenTasks() const {
+        return numStolenTasks.load();
+    }
+
     bool cancel(size_t taskId, bool eraseTask=false);
 
     bool stopTaskGroup(task_gid_t taskGID, task_type_t qidx, bool force);
@@ -209,6 +245,33 @@ protected:
     virtual ~ExecutorPool(void);
 
     TaskQueue* _nextTask(ExecutorThread &t, uint8_t tick);
+
+    /**
+     * Fetch a ready task for the given (idle) thread from the queues of the
+     * other task types whose threads are all busy.
+     *
+     * @return the queue the task was taken from, or nullptr if none found
+     */
+    TaskQueue* _stealTask(ExecutorThread& t);
+
+    /**
+     * May threads of other types steal the given type's tasks? Yes if all
+     * of its threads are busy, or if it has ready tasks which none of its
+     * threads have picked up yet.
+     */
+    bool _canBeStolenFrom(task_type_t type) const {
+        return curWorkers[type] >= numWorkers[type] || numReadyTasks[type] > 0;
+    }
+
+    /**
+     * May threads of type thief run tasks of type victim? Only within the
+     * IO types (READER, WRITER and AUXIO) - an IO task stalling a NONIO
+     * thread (or the other way around) would delay latency-sensitive
+     * tasks, and the thread counts of each class are sized separately.
+     */
+    static bool _canSteal(task_type_t thief, task_type_t victim) {
+        return (thief == NONIO_TASK_IDX) == (victim == NONIO_TASK_IDX);
+    }
     bool _cancel(size_t taskId, bool eraseTask=false);
     bool _wake(size_t taskId);
     virtual bool _startWorkers(void);
@@ -258,6 +321,11 @@ protected:
     std::vector<std::atomic<uint16_t>> numWorkers; // and limit it to the value set here
     std::vector<std::atomic<size_t>> numReadyTasks; // number of ready tasks per task set
 
+    // May idle threads run the tasks of other task types?
+    std::atomic<bool> workStealing{false};
+    // Number of tasks run by a thread of another type
+    std::atomic<size_t> numStolenTasks{0};
+
     // Set of all known task owners
     std::set<void *> taskOwners;
 
@@ -85,7 +85,11 @@ void ExecutorThread::run() {
 
         updateCurrentTime();
         if (TaskQueue *q = manager->nextTask(*this, tick)) {
-            manager->startWork(taskType);
+            // Account the work against the task's own type, which differs
+            // from this thread's if the task was stolen
+            const auto workType =
+                    GlobalTask::getTaskType(currentTask->getTaskId());
+            manager->startWork(workType);
             EventuallyPersistentEngine *engine = currentTask->getEngine();
 
             // Not all tasks are associated with an engine, only switch
@@ -95,7 +99,7 @@ void ExecutorThread::run() {
             }
 
             if (currentTask->isdead()) {
-                manager->doneWork(taskType);
+                manager->doneWork(workType);
                 manager->cancel(currentTask->uid, true);
                 continue;
             }
@@ -129,8 +133,7 @@ void ExecutorThread::run() {
             // ConnNotifierCallback tasks involved in MB-25822 and that we aim
             // to debug. We consider 1 second a sensible schedule overhead
             // limit for NON_IO tasks.
-            if (GlobalTask::getTaskType(currentTask->getTaskId()) ==
-                        task_type_t::NONIO_TASK_IDX &&
+            if (workType == task_type_t::NONIO_TASK_IDX &&
                 scheduleOverhead > std::chrono::seconds(1)) {
                 auto description = currentTask->getDescription();
                 EP_LOG_WARN(
@@ -190,7 +193,7 @@ void ExecutorThread::run() {
                         currentTask->getId(),
                         to_ns_since_epoch(currentTask->getWaketime()).count());
             }
-            manager->doneWork(taskType);
+            manager->doneWork(workType);
         }
     }
     // Thread is about to terminate - disassociate it from any engine.
@@ -214,7 +214,9 @@ bool Flusher::step(GlobalTask *task) {
         // in the loop below) then that will cause the task to be re-awoken.
         task->snooze(INT_MAX);
 
-        flushVB();
+        if (!flushGroup()) {
+            flushVB();
+        }
 
         if (_state == State::Running) {
             /// If there's still work to do for this shard, wake up the Flusher
@@ -253,11 +255,34 @@ bool Flusher::step(GlobalTask *task) {
 
 void Flusher::completeFlush() {
     while(!canSnooze()) {
-        flushVB();
+        if (!flushGroup()) {
+            flushVB();
+        }
     }
 }
 
-void Flusher::flushVB(void) {
+bool Flusher::flushGroup() {
+    const auto groupTime = store->getFlusherGroupCommitTime();
+    auto* kvstore = shard->getRWUnderlying();
+    if (groupTime == 0 || !kvstore->setDeferCommitSync(true)) {
+        return false;
+    }
+
+    TRACE_EVENT0("ep-engine", "Flusher::flushGroup");
+    GroupCommit group(*kvstore);
+    const auto deadline = std::chrono::steady_clock::now() +
+                          std::chrono::milliseconds(groupTime);
+    do {
+        flushVB(&group);
+    } while (!canSnooze() && std::chrono::steady_clock::now() < deadline);
+    while (!store->completeGroupCommit(group)) {
+        EP_LOG_WARN("Flusher::flushGroup: Retry in 1 sec...");
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+    }
+    return true;
+}
+
+void Flusher::flushVB(GroupCommit* group) {
     TRACE_EVENT0("ep-engine", "Flusher::flushVB");
 
     // If the low-priority vBucket queue is empty, see if there's any
@@ -293,7 +318,8 @@ void Flusher::flushVB(void) {
     } else if (!hpVbs.empty()) {
         Vbid vbid = hpVbs.front();
         hpVbs.pop();
-        if (store->flushVBucket(vbid).first) {
+        prepareNext(vbid);
+        if (store->flushVBucket(vbid, group).first) {
             // More items still available, add vbid back to pending set.
             hpVbs.push(vbid);
         }
@@ -303,9 +329,24 @@ void Flusher::flushVB(void) {
         }
         Vbid vbid = lpVbs.front();
         lpVbs.pop();
-        if (store->flushVBucket(vbid).first) {
+        prepareNext(vbid);
+        if (store->flushVBucket(vbid, group).first) {
             // More items still available, add vbid back to pending set.
             lpVbs.push(vbid);
         }
     }
 }
+
+void Flusher::prepareNext(Vbid flushing) {
+    if (!store->isFlusherPipelineEnabled() ||
+        (prepareTask && !prepareTask->isdead())) {
+        return;
+    }
+    const auto& queue = hpVbs.empty() ? lpVbs : hpVbs;
+    if (queue.empty() || queue.front() == flushing) {
+        return;
+    }
+    prepareTask =
+            std::make_shared<FlushBatchPrepareTask>(*store, queue.front());
+    ExecutorPool::get()->schedule(prepareTask);
+}
@@ -29,6 +29,7 @@
 
 class EPBucket;
 class KVShard;
+struct GroupCommit;
 
 /**
  * Manage persistence of data for an EPBucket.
@@ -76,7 +77,23 @@ private:
 
     bool transitionState(State to);
     bool validTransition(State to) const;
-    void flushVB();
+    void flushVB(GroupCommit* group = nullptr);
+
+    /**
+     * If group commit is enabled, flush vBuckets until there is nothing left
+     * to flush or the group commit time has elapsed, then make their commits
+     * durable together.
+     *
+     * @return false if group commit is disabled (nothing was flushed).
+     */
+    bool flushGroup();
+
+    /**
+     * If the flusher pipeline is enabled, prepare the next queued vBucket's
+     * flush batch on a separate task while the flusher writes the given
+     * one. At most one batch is prepared at a time.
+     */
+    void prepareNext(Vbid flushing);
     void completeFlush();
     void initialize();
     void schedule_UNLOCKED();
@@ -101,6 +118,8 @@ private:
     bool doHighPriority;
     size_t numHighPriority;
     std::atomic<bool> pendingMutation;
+    // The FlushBatchPrepareTask most recently scheduled.
+    ExTask prepareTask;
 
     KVShard *shard;
 
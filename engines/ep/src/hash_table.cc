@@ -19,6 +19,7 @@
 
 #include "ep_time.h"
 #include "item.h"
+#include "read_epoch.h"
 #include "stats.h"
 #include "stored_value_factories.h"
 
@@ -60,6 +61,44 @@ static const ssize_t prime_size_table[] = {
  */
 static const double freqCounterIncFactor = 0.012;
 
+/**
+ * A lock's retired StoredValues / values are reclaimed (those which no
+ * optimistic reader can still be reading freed) once it holds this many of
+ * them, or this many bytes.
+ */
+static const size_t retiredReclaimCount = 32;
+static const size_t retiredReclaimBytes = 64 * 1024;
+
+static size_t roundUpToMultiple(size_t n, size_t multiple) {
+    return ((n + multiple - 1) / multiple) * multiple;
+}
+
+/**
+ * Acquires (and on destruction releases) all of a HashTable's lock stripes.
+ * Equivalent of MultiLockHolder for cache-line padded mutexes.
+ */
+class StripeLockHolder {
+public:
+    explicit StripeLockHolder(
+            std::vector<folly::CachelinePadded<HashTable::StripeMutex>>& locks)
+        : mutexes(locks) {
+        for (auto& m : mutexes) {
+            m->lock();
+        }
+    }
+
+    ~StripeLockHolder() {
+        for (auto& m : mutexes) {
+            m->unlock();
+        }
+    }
+
+private:
+    std::vector<folly::CachelinePadded<HashTable::StripeMutex>>& mutexes;
+
+    DISALLOW_COPY_AND_ASSIGN(StripeLockHolder);
+};
+
 std::string to_string(MutationStatus status) {
     switch (status) {
     case MutationStatus::NotFound:
@@ -82,6 +121,16 @@ std::string to_string(MutationStatus status) {
     return "<invalid>(" + std::to_string(int(status)) + ")";
 }
 
+std::string to_string(HashTable::Layout layout) {
+    switch (layout) {
+    case HashTable::Layout::Chained:
+        return "chained";
+    case HashTable::Layout::Tagged:
+        return "tagged";
+    }
+    return "<invalid>(" + std::to_string(int(layout)) + ")";
+}
+
 std::ostream& operator<<(std::ostream& os, const HashTable::Position& pos) {
     os << "{lock:" << pos.lock << " bucket:" << pos.hash_bucket << "/" << pos.ht_size << "}";
     return os;
@@ -136,10 +185,20 @@ StoredValue* HashTable::FindUpdateResult::selectSVToModify(const Item& itm) {
 HashTable::HashTable(EPStats& st,
                      std::unique_ptr<AbstractStoredValueFactory> svFactory,
                      size_t initialSize,
-                     size_t locks)
-    : initialSize(initialSize),
-      size(initialSize),
+                     size_t locks,
+                     Layout layout,
+                     ResizeMode resizeMode)
+    : initialSize(resizeMode == ResizeMode::Incremental
+                          ? roundUpToMultiple(initialSize, locks)
+                          : initialSize),
+      size(this->initialSize),
+      layout(layout),
+      resizeMode(resizeMode),
+      oldSize(0),
+      nextOldBucket(0),
       mutexes(locks),
+      optimisticReads(svFactory->supportsOptimisticReads()),
+      retired(locks),
       stats(st),
       valFact(std::move(svFactory)),
       visitors(0),
@@ -149,6 +208,9 @@ HashTable::HashTable(EPStats& st,
       maxDeletedRevSeqno(0),
       probabilisticCounter(freqCounterIncFactor) {
     values.resize(size);
+    if (layout == Layout::Tagged) {
+        tags.resize(size);
+    }
     activeState = true;
 }
 
@@ -177,8 +239,10 @@ void HashTable::clear(bool deactivate) {
                     "non-active object");
         }
     }
-    MultiLockHolder mlh(mutexes);
+    StripeLockHolder slh(mutexes);
+    blockOptimisticReads();
     clear_UNLOCKED(deactivate);
+    unblockOptimisticReads();
 }
 
 void HashTable::clear_UNLOCKED(bool deactivate) {
@@ -197,6 +261,28 @@ void HashTable::clear_UNLOCKED(bool deactivate) {
             values[i] = std::move(v->getNext());
         }
     }
+    for (auto& chain : oldValues) {
+        while (chain) {
+            auto v = std::move(chain);
+            clearedMemSize += v->size();
+            clearedValSize += v->valuelen();
+            chain = std::move(v->getNext());
+        }
+    }
+    if (isResizing()) {
+        // Nothing left to migrate - complete the resize.
+        stats.coreLocal.get()->memOverhead.fetch_sub(memorySize());
+        table_type().swap(oldValues);
+        oldSize = 0;
+        stats.coreLocal.get()->memOverhead.fetch_add(memorySize());
+    }
+    std::fill(tags.begin(), tags.end(), 0);
+    // No optimistic reader can be running (see clear()), so everything
+    // retired may be freed.
+    for (auto& list : retired) {
+        list->entries.clear();
+        list->bytes = 0;
+    }
 
     stats.coreLocal.get()->currentSize.fetch_sub(clearedMemSize -
                                                  clearedValSize);
@@ -254,6 +340,15 @@ void HashTable::resize(size_t newSize) {
                 "non-active object");
     }
 
+    std::lock_guard<std::mutex> guard(resizeMutex);
+    if (resizeMode == ResizeMode::Incremental) {
+        if (isResizing()) {
+            // Previous resize still in progress.
+            return;
+        }
+        newSize = roundUpToMultiple(newSize, mutexes.size());
+    }
+
     // Due to the way hashing works, we can't fit anything larger than
     // an int.
     if (newSize > static_cast<size_t>(std::numeric_limits<int>::max())) {
@@ -268,7 +363,13 @@ void HashTable::resize(size_t newSize) {
     TRACE_EVENT2(
             "HashTable", "resize", "size", size.load(), "newSize", newSize);
 
-    MultiLockHolder mlh(mutexes);
+    // Get a place for the new items. Allocated before acquiring the locks, as
+    // for large tables zero-filling the new vector is not cheap.
+    table_type newValues(newSize);
+    tag_table_type newTags(layout == Layout::Tagged ? newSize : 0);
+
+    const auto start = std::chrono::steady_clock::now();
+    StripeLockHolder slh(mutexes);
     if (visitors.load() > 0) {
         // Do not allow a resize while any visitors are actually
         // processing.  The next attempt will have to pick it up.  New
@@ -277,25 +378,47 @@ void HashTable::resize(size_t newSize) {
         return;
     }
 
-    // Get a place for the new items.
-    table_type newValues(newSize);
+    // The vector of buckets is replaced (and freed) below.
+    blockOptimisticReads();
 
     stats.coreLocal.get()->memOverhead.fetch_sub(memorySize());
     ++numResizes;
 
+    if (resizeMode == ResizeMode::Incremental) {
+        // Swap in the new (empty) table; the elements are migrated later.
+        oldValues = std::move(values);
+        oldSize.store(size);
+        nextOldBucket.store(0);
+        size.store(newSize);
+        values = std::move(newValues);
+        tags = std::move(newTags);
+        // Optimistic reads are not made until the resize has completed.
+        unblockOptimisticReads();
+
+        stats.coreLocal.get()->memOverhead.fetch_add(memorySize());
+        stats.htResizeStallHisto.add(
+                std::chrono::duration_cast<std::chrono::microseconds>(
+                        std::chrono::steady_clock::now() - start));
+        return;
+    }
+
     // Set the new size so all the hashy stuff works.
-    size_t oldSize = size;
+    size_t prevSize = size;
     size.store(newSize);
 
     // Move existing records into the new space.
-    for (size_t i = 0; i < oldSize; i++) {
+    for (size_t i = 0; i < prevSize; i++) {
         while (values[i]) {
             // unlink the front element from the hash chain at values[i].
             auto v = std::move(values[i]);
             values[i] = std::move(v->getNext());
 
             // And re-link it into the correct place in newValues.
-            int newBucket = getBucketForHash(v->getKey().hash());
+            const auto hash = v->getKey().hash();
+            int newBucket = getBucketForHash(hash);
+            if (!newTags.empty()) {
+                newTags[newBucket] |= getTagForHash(hash);
+            }
             v->setNext(std::move(newValues[newBucket]));
             newValues[newBucket] = std::move(v);
         }
@@ -303,8 +426,89 @@ void HashTable::resize(size_t newSize) {
 
     // Finally assign the new table to values.
     values = std::move(newValues);
+    tags = std::move(newTags);
+    unblockOptimisticReads();
 
     stats.coreLocal.get()->memOverhead.fetch_add(memorySize());
+    stats.htResizeStallHisto.add(
+            std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::steady_clock::now() - start));
+}
+
+bool HashTable::continueResize(size_t maxBuckets) {
+    std::lock_guard<std::mutex> guard(resizeMutex);
+    for (size_t i = 0; i < maxBuckets && isResizing(); ++i) {
+        const size_t oldBucket = nextOldBucket++;
+        const auto start = std::chrono::steady_clock::now();
+        {
+            std::lock_guard<StripeMutex> lh(
+                    *mutexes[oldBucket % mutexes.size()]);
+            // Check under the lock - clear() may have completed the resize.
+            if (oldBucket < oldSize) {
+                unlocked_migrateBucket(oldBucket);
+            }
+        }
+        stats.htResizeStallHisto.add(
+                std::chrono::duration_cast<std::chrono::microseconds>(
+                        std::chrono::steady_clock::now() - start));
+
+        if (nextOldBucket >= oldSize) {
+            completeIncrementalResize();
+        }
+    }
+    return !isResizing();
+}
+
+void HashTable::unlocked_migrateBucket(size_t oldBucket) {
+    auto& chain = oldValues[oldBucket];
+    while (chain) {
+        // unlink the front element from the old hash chain.
+        auto v = std::move(chain);
+        chain = std::move(v->getNext());
+
+        // And re-link it into the correct place in values.
+        const auto hash = v->getKey().hash();
+        int newBucket = getBucketForHash(hash);
+        if (!tags.empty()) {
+            tags[newBucket] |= getTagForHash(hash);
+        }
+        v->setNext(std::move(values[newBucket]));
+        values[newBucket] = std::move(v);
+    }
+}
+
+void HashTable::migrateBucketsForLock(size_t lock) {
+    if (!isResizing()) {
+        return;
+    }
+    for (size_t oldBucket = lock; oldBucket < oldSize;
+         oldBucket += mutexes.size()) {
+        std::lock_guard<StripeMutex> lh(*mutexes[lock]);
+        if (oldBucket < oldSize) {
+            unlocked_migrateBucket(oldBucket);
+        }
+    }
+}
+
+void HashTable::completeIncrementalResize() {
+    table_type retired;
+    {
+        const auto start = std::chrono::steady_clock::now();
+        StripeLockHolder slh(mutexes);
+        if (!isResizing()) {
+            return;
+        }
+        // All buckets have been migrated by continueResize() (which is
+        // serialised by resizeMutex), therefore oldValues is empty.
+        stats.coreLocal.get()->memOverhead.fetch_sub(memorySize());
+        retired.swap(oldValues);
+        oldSize.store(0);
+        stats.coreLocal.get()->memOverhead.fetch_add(memorySize());
+        stats.htResizeStallHisto.add(
+                std::chrono::duration_cast<std::chrono::microseconds>(
+                        std::chrono::steady_clock::now() - start));
+    }
+    // retired (now all nullptr) freed here, outside of the locks.
 }
 
 HashTable::FindInnerResult HashTable::findInner(const DocKey& key) {
@@ -313,11 +517,20 @@ HashTable::FindInnerResult HashTable::findInner(const DocKey& key) {
                 "HashTable::find: Cannot call on a "
                 "non-active object");
     }
-    HashBucketLock hbl = getLockedBucket(key);
-    // Scan through all elements in the hash bucket chain looking for Committed
-    // and Pending items with the same key.
+    const auto hash = key.hash();
+    HashBucketLock hbl = getLockedBucketForHash(hash);
     StoredValue* foundCmt = nullptr;
     StoredValue* foundPend = nullptr;
+
+    // If the bucket's tag doesn't include this key's tag then the chain cannot
+    // contain the key - skip scanning it.
+    if (!tags.empty() &&
+        !(tags[hbl.getBucketNum()] & getTagForHash(hash))) {
+        return {std::move(hbl), foundCmt, foundPend};
+    }
+
+    // Scan through all elements in the hash bucket chain looking for Committed
+    // and Pending items with the same key.
     for (StoredValue* v = values[hbl.getBucketNum()].get().get(); v;
          v = v->getNext().get().get()) {
         if (v->hasKey(key)) {
@@ -341,7 +554,9 @@ std::unique_ptr<Item> HashTable::getRandomKey(long rnd) {
     std::unique_ptr<Item> ret;
 
     do {
-        ret = getRandomKeyFromSlot(curr++);
+        auto optimistic = getRandomKeyFromSlotOptimistic(curr);
+        ret = optimistic ? std::move(*optimistic) : getRandomKeyFromSlot(curr);
+        curr++;
         if (curr == size) {
             curr = 0;
         }
@@ -391,7 +606,9 @@ HashTable::UpdateResult HashTable::unlocked_updateStoredValue(
     const auto preProps = valueStats.prologue(&v);
 
     /* setValue() will mark v as undeleted if required */
+    auto oldValue = v.getValue();
     v.setValue(itm);
+    unlocked_retireValue(hbl.getBucketNum(), std::move(oldValue), v);
     updateFreqCounter(v);
 
     valueStats.epilogue(preProps, &v);
@@ -420,6 +637,9 @@ StoredValue* HashTable::unlocked_addNewStoredValue(const HashBucketLock& hbl,
 
     valueStats.epilogue(emptyProperties, v.get().get());
 
+    if (!tags.empty()) {
+        tags[hbl.getBucketNum()] |= getTagForHash(itm.getKey().hash());
+    }
     values[hbl.getBucketNum()] = std::move(v);
     return values[hbl.getBucketNum()].get().get();
 }
@@ -562,6 +782,9 @@ HashTable::unlocked_replaceByCopy(const HashBucketLock& hbl,
     const auto emptyProperties = valueStats.prologue(nullptr);
     valueStats.epilogue(emptyProperties, newSv.get().get());
 
+    if (!tags.empty()) {
+        tags[hbl.getBucketNum()] |= getTagForHash(vToCopy.getKey().hash());
+    }
     values[hbl.getBucketNum()] = std::move(newSv);
     return {values[hbl.getBucketNum()].get().get(), std::move(releasedSv)};
 }
@@ -583,6 +806,7 @@ HashTable::DeleteResult HashTable::unlocked_softDelete(
     case CommittedState::CommittedViaMutation:
     case CommittedState::CommittedViaPrepare:
         const auto preProps = valueStats.prologue(&v);
+        auto oldValue = v.getValue();
 
         if (onlyMarkDeleted) {
             v.markDeleted(delSource);
@@ -594,6 +818,7 @@ HashTable::DeleteResult HashTable::unlocked_softDelete(
             // isn't mis-interpreted for a SyncDelete.
             v.setCommitted(CommittedState::CommittedViaMutation);
         }
+        unlocked_retireValue(hbl.getBucketNum(), std::move(oldValue), v);
 
         valueStats.epilogue(preProps, &v);
         return {DeletionStatus::Success, &v};
@@ -666,6 +891,101 @@ HashTable::FindROResult HashTable::findForRead(
     return {sv, std::move(result.lock)};
 }
 
+HashTable::OptimisticReadResult HashTable::findForReadOptimistic(
+        const DocKey& key,
+        Vbid vbid,
+        TrackReference trackReference,
+        ForGetReplicaOp fetchRequestedForReplicaItem,
+        bool hideLockedCas,
+        StoredValue::IncludeValue includeValue) {
+    if (!optimisticReads) {
+        return {};
+    }
+
+    OptimisticReadResult result;
+    {
+        // Nothing we read can be freed until the guard is released.
+        ReadEpoch::Guard guard;
+        if (!isActive() || optimisticReadsBlocked.load() || isResizing()) {
+            return {};
+        }
+
+        const int bucket = getBucketForHash(key.hash());
+        const auto& mutex = *mutexes[bucket % mutexes.size()];
+        const auto version = mutex.getVersion();
+        if (version & 1) {
+            // A writer holds the lock.
+            return {};
+        }
+
+        // As findInner(); however a writer may be modifying the chain as we
+        // follow it, so give up as soon as the version changes.
+        const StoredValue* committed = nullptr;
+        const StoredValue* pending = nullptr;
+        for (const StoredValue* v = values[bucket].get().get(); v;
+             v = v->getNext().get().get()) {
+            if (mutex.getVersion() != version) {
+                return {};
+            }
+            if (v->hasKey(key)) {
+                if (v->isPending() || v->isCompleted()) {
+                    pending = v;
+                } else {
+                    committed = v;
+                }
+            }
+        }
+
+        // Anything needing more than a copy of the item (see findForRead()
+        // and VBucket::fetchValidValue()) is left to the locked path.
+        if (fetchRequestedForReplicaItem == ForGetReplicaOp::No && pending &&
+            pending->isPreparedMaybeVisible()) {
+            return {};
+        }
+        if (!committed || committed->isDeleted() || committed->isTempItem() ||
+            !committed->isResident() ||
+            committed->isExpired(ep_real_time())) {
+            return {};
+        }
+        // Tracking the reference only changes the StoredValue of a key whose
+        // frequency counter isn't yet saturated or whose NRU isn't yet at
+        // the minimum. For a hot key it doesn't change anything.
+        if (trackReference == TrackReference::Yes &&
+            (committed->getFreqCounterValue() !=
+                     std::numeric_limits<uint8_t>::max() ||
+             committed->getNRUValue() > MIN_NRU_VALUE)) {
+            return {};
+        }
+
+        try {
+            result.item = committed->toItem(
+                    vbid,
+                    (hideLockedCas &&
+                     committed->isLocked(ep_current_time()))
+                            ? StoredValue::HideLockedCas::Yes
+                            : StoredValue::HideLockedCas::No,
+                    includeValue);
+        } catch (const std::exception&) {
+            // Copied the StoredValue while it was being changed (e.g. it
+            // became a prepare) - the version check would fail anyway.
+            return {};
+        }
+        result.nru = committed->getNRUValue();
+
+        // Check no writer changed the stripe while we were reading it.
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (mutex.getVersion() != version) {
+            return {};
+        }
+    }
+
+    if (trackReference == TrackReference::Yes) {
+        // As updateFreqCounter() for a saturated counter.
+        frequencyCounterSaturated();
+    }
+    return result;
+}
+
 HashTable::FindResult HashTable::findForWrite(const DocKey& key,
                                               WantsDeleted wantsDeleted) {
     auto result = findInner(key);
@@ -784,7 +1104,70 @@ HashTable::FindResult HashTable::findItem(const Item& item) {
 }
 
 void HashTable::unlocked_del(const HashBucketLock& hbl, StoredValue* value) {
-    unlocked_release(hbl, value).reset();
+    unlocked_retire(hbl.getBucketNum(), unlocked_release(hbl, value));
+}
+
+void HashTable::unlocked_retire(int bucket_num, StoredValue::UniquePtr v) {
+    if (!optimisticReads || !v) {
+        // No reader can be reading it; free it now.
+        return;
+    }
+    const auto lock = bucket_num % mutexes.size();
+    auto& list = *retired[lock];
+    const size_t bytes = v->size();
+    list.entries.push_back(
+            {ReadEpoch::retireEpoch(), bytes, std::move(v), value_t{}});
+    list.bytes += bytes;
+    unlocked_reclaim(lock);
+}
+
+void HashTable::unlocked_retireValue(int bucket_num,
+                                     value_t oldValue,
+                                     const StoredValue& v) {
+    if (!optimisticReads || !oldValue ||
+        oldValue.get().get() == v.getValue().get().get()) {
+        return;
+    }
+    const auto lock = bucket_num % mutexes.size();
+    auto& list = *retired[lock];
+    const size_t bytes = oldValue->getSize();
+    list.entries.push_back(
+            {ReadEpoch::retireEpoch(), bytes, nullptr, std::move(oldValue)});
+    list.bytes += bytes;
+    unlocked_reclaim(lock);
+}
+
+void HashTable::unlocked_reclaim(size_t lock) {
+    auto& list = *retired[lock];
+    if (list.entries.empty()) {
+        return;
+    }
+    // Entries are in order of epoch; free those no reader can be reading.
+    // Checking the epoch already known to be safe is cheap; only scan the
+    // readers (advance the epoch) once enough has been retired.
+    auto reclaimable = ReadEpoch::lastReclaimable();
+    if (list.entries.front().epoch > reclaimable &&
+        (list.entries.size() >= retiredReclaimCount ||
+         list.bytes >= retiredReclaimBytes)) {
+        reclaimable = ReadEpoch::advance();
+    }
+    while (!list.entries.empty() &&
+           list.entries.front().epoch <= reclaimable) {
+        list.bytes -= list.entries.front().bytes;
+        list.entries.pop_front();
+    }
+}
+
+void HashTable::blockOptimisticReads() {
+    if (!optimisticReads) {
+        return;
+    }
+    optimisticReadsBlocked.store(true);
+    ReadEpoch::synchronize();
+}
+
+void HashTable::unblockOptimisticReads() {
+    optimisticReadsBlocked.store(false);
 }
 
 StoredValue::UniquePtr HashTable::unlocked_release(
@@ -814,6 +1197,7 @@ StoredValue::UniquePtr HashTable::unlocked_release(
                 "HashTable::unlocked_release_base: StoredValue to be released "
                 "not found in HashTable; possibly HashTable leak");
     }
+    unlocked_rebuildTag(hbl.getBucketNum());
 
     // Update statistics for the item which is now gone.
     const auto preProps = valueStats.prologue(released.get().get());
@@ -838,7 +1222,9 @@ MutationStatus HashTable::insertFromWarmup(const Item& itm,
         // in markNotResident.
         if (keyMetaDataOnly) {
             const auto preProps = valueStats.prologue(v);
+            auto oldValue = v->getValue();
             v->markNotResident();
+            unlocked_retireValue(hbl.getBucketNum(), std::move(oldValue), *v);
             valueStats.epilogue(preProps, v);
         }
     } else {
@@ -883,26 +1269,41 @@ MutationStatus HashTable::insertFromWarmup(const Item& itm,
 
 bool HashTable::reallocateStoredValue(StoredValue&& sv) {
     // Search the chain and reallocate
-    for (StoredValue::UniquePtr* curr =
-                 &values[getBucketForHash(sv.getKey().hash())];
+    const int bucket_num = getBucketForHash(sv.getKey().hash());
+    for (StoredValue::UniquePtr* curr = &values[bucket_num];
          curr->get().get();
          curr = &curr->get()->getNext()) {
         if (&sv == curr->get().get()) {
             auto newSv = valFact->copyStoredValue(sv, std::move(sv.getNext()));
             curr->swap(newSv);
+            // newSv now owns the original StoredValue.
+            unlocked_retire(bucket_num, std::move(newSv));
             return true;
         }
     }
     return false;
 }
 
+void HashTable::unlocked_reallocateValue(const HashBucketLock& hbl,
+                                         StoredValue& v) {
+    auto oldValue = v.getValue();
+    v.reallocate();
+    unlocked_retireValue(hbl.getBucketNum(), std::move(oldValue), v);
+}
+
 void HashTable::dump() const {
     std::cerr << *this << std::endl;
 }
 
 nlohmann::json HashTable::dumpStoredValuesAsJson() const {
-    MultiLockHolder mlh(mutexes);
+    StripeLockHolder slh(mutexes);
     auto obj = nlohmann::json::array();
+    for (const auto& chain : oldValues) {
+        for (StoredValue* sv = chain.get().get(); sv != nullptr;
+             sv = sv->getNext().get().get()) {
+            obj.push_back(*sv);
+        }
+    }
     for (const auto& chain : values) {
         if (chain) {
             for (StoredValue* sv = chain.get().get(); sv != nullptr;
@@ -921,7 +1322,10 @@ void HashTable::storeCompressedBuffer(cb::const_char_buffer buf,
                                       StoredValue& v) {
     const auto preProps = valueStats.prologue(&v);
 
+    auto oldValue = v.getValue();
     v.storeCompressedBuffer(buf);
+    unlocked_retireValue(
+            getBucketForHash(v.getKey().hash()), std::move(oldValue), v);
 
     valueStats.epilogue(preProps, &v);
 }
@@ -941,15 +1345,17 @@ void HashTable::visitDepth(HashTableDepthVisitor &visitor) {
     // Acquire one (any) of the mutexes before incrementing {visitors}, this
     // prevents any race between this visitor and the HashTable resizer.
     // See comments in pauseResumeVisit() for further details.
-    std::unique_lock<std::mutex> lh(mutexes[0]);
+    std::unique_lock<StripeMutex> lh(*mutexes[0]);
     VisitorTracker vt(&visitors);
     lh.unlock();
 
     for (int l = 0; l < static_cast<int>(mutexes.size()); l++) {
+        // Ensure all elements guarded by this lock are in the current table.
+        migrateBucketsForLock(l);
         for (int i = l; i < static_cast<int>(size); i+= mutexes.size()) {
             // (re)acquire mutex on each HashBucket, to minimise any impact
             // on front-end threads.
-            LockHolder lh(mutexes[l]);
+            std::lock_guard<StripeMutex> lh(*mutexes[l]);
 
             size_t depth = 0;
             StoredValue* p = values[i].get().get();
@@ -998,7 +1404,7 @@ HashTable::Position HashTable::pauseResumeVisit(HashTableVisitor& visitor,
     // inside the inner for() loop. To prevent this race, we explicitly acquire
     // (any) mutex, increment {visitors} and then release the mutex. This
     //avoids the race as if visitors >0 then Resizer will not attempt to resize.
-    std::unique_lock<std::mutex> lh(mutexes[0]);
+    std::unique_lock<StripeMutex> lh(*mutexes[0]);
     VisitorTracker vt(&visitors);
     lh.unlock();
 
@@ -1010,6 +1416,10 @@ HashTable::Position HashTable::pauseResumeVisit(HashTableVisitor& visitor,
 
         // If the bucket position is *this* lock, then start from the
         // recorded bucket (as long as we haven't resized).
+        // Ensure all elements guarded by this lock are in the current table
+        // before visiting it.
+        migrateBucketsForLock(lock);
+
         hash_bucket = lock;
         if (start_pos.lock == lock &&
             start_pos.ht_size == size &&
@@ -1027,7 +1437,7 @@ HashTable::Position HashTable::pauseResumeVisit(HashTableVisitor& visitor,
             // around the HashBucket visit then we need to release it before
             // tearDownHashBucketVisit() is called.
             {
-                HashBucketLock lh(hash_bucket, mutexes[lock]);
+                HashBucketLock lh(hash_bucket, *mutexes[lock]);
 
                 StoredValue* v = values[hash_bucket].get().get();
                 while (!paused && v) {
@@ -1060,7 +1470,7 @@ HashTable::Position HashTable::endPosition() const  {
     return HashTable::Position(size, mutexes.size(), size);
 }
 
-bool HashTable::unlocked_ejectItem(const HashTable::HashBucketLock&,
+bool HashTable::unlocked_ejectItem(const HashTable::HashBucketLock& hbl,
                                    StoredValue*& vptr,
                                    EvictionPolicy policy) {
     if (vptr == nullptr) {
@@ -1077,7 +1487,9 @@ bool HashTable::unlocked_ejectItem(const HashTable::HashBucketLock&,
 
     switch (policy) {
     case EvictionPolicy::Value: {
+        auto oldValue = vptr->getValue();
         vptr->ejectValue();
+        unlocked_retireValue(hbl.getBucketNum(), std::move(oldValue), *vptr);
         ++stats.numValueEjects;
         valueStats.epilogue(preProps, vptr);
         break;
@@ -1088,6 +1500,7 @@ bool HashTable::unlocked_ejectItem(const HashTable::HashBucketLock&,
         auto removed = hashChainRemoveFirst(
                 values[bucket_num],
                 [vptr](const StoredValue* v) { return v == vptr; });
+        unlocked_rebuildTag(bucket_num);
 
         if (removed->isResident()) {
             ++stats.numValueEjects;
@@ -1095,6 +1508,7 @@ bool HashTable::unlocked_ejectItem(const HashTable::HashBucketLock&,
         valueStats.epilogue(preProps, nullptr);
 
         updateMaxDeletedRevSeqno(vptr->getRevSeqno());
+        unlocked_retire(bucket_num, std::move(removed));
         break;
     }
     }
@@ -1105,6 +1519,26 @@ bool HashTable::unlocked_ejectItem(const HashTable::HashBucketLock&,
 
 std::unique_ptr<Item> HashTable::getRandomKeyFromSlot(int slot) {
     auto lh = getLockedBucket(slot);
+    if (isResizing()) {
+        // Migrate every old bucket which may hold elements belonging in this
+        // slot, so they can be found. A key with hash h is in old bucket
+        // (h mod oldSize) and belongs in slot (h mod size), so the old
+        // buckets feeding the slot are those congruent to it modulo
+        // gcd(size, oldSize). As both sizes are multiples of the number of
+        // ht_locks, those buckets are all guarded by the lock we hold (see
+        // ResizeMode::Incremental).
+        size_t a = size;
+        size_t b = oldSize;
+        while (b != 0) {
+            const size_t r = a % b;
+            a = b;
+            b = r;
+        }
+        for (size_t oldBucket = slot % a; oldBucket < oldSize;
+             oldBucket += a) {
+            unlocked_migrateBucket(oldBucket);
+        }
+    }
     for (StoredValue* v = values[slot].get().get(); v;
             v = v->getNext().get().get()) {
         if (!v->isTempItem() && !v->isDeleted() && v->isResident() &&
@@ -1116,8 +1550,50 @@ std::unique_ptr<Item> HashTable::getRandomKeyFromSlot(int slot) {
     return nullptr;
 }
 
+boost::optional<std::unique_ptr<Item>>
+HashTable::getRandomKeyFromSlotOptimistic(int slot) {
+    if (!optimisticReads) {
+        return {};
+    }
+
+    // See findForReadOptimistic().
+    ReadEpoch::Guard guard;
+    if (!isActive() || optimisticReadsBlocked.load() || isResizing() ||
+        size_t(slot) >= size) {
+        return {};
+    }
+    const auto& mutex = *mutexes[slot % mutexes.size()];
+    const auto version = mutex.getVersion();
+    if (version & 1) {
+        return {};
+    }
+
+    std::unique_ptr<Item> item;
+    for (const StoredValue* v = values[slot].get().get(); v;
+         v = v->getNext().get().get()) {
+        if (mutex.getVersion() != version) {
+            return {};
+        }
+        if (!v->isTempItem() && !v->isDeleted() && v->isResident() &&
+            v->isCommitted()) {
+            try {
+                item = v->toItem(Vbid(0));
+            } catch (const std::exception&) {
+                return {};
+            }
+            break;
+        }
+    }
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (mutex.getVersion() != version) {
+        return {};
+    }
+    return std::move(item);
+}
+
 bool HashTable::unlocked_restoreValue(
-        const std::unique_lock<std::mutex>& htLock,
+        const std::unique_lock<StripeMutex>& htLock,
         const Item& itm,
         StoredValue& v) {
     if (!htLock || !isActive() || v.isResident()) {
@@ -1126,16 +1602,20 @@ bool HashTable::unlocked_restoreValue(
 
     const auto preProps = valueStats.prologue(&v);
 
+    auto oldValue = v.getValue();
     v.restoreValue(itm);
+    unlocked_retireValue(
+            getBucketForHash(v.getKey().hash()), std::move(oldValue), v);
 
     valueStats.epilogue(preProps, &v);
 
     return true;
 }
 
-void HashTable::unlocked_restoreMeta(const std::unique_lock<std::mutex>& htLock,
-                                     const Item& itm,
-                                     StoredValue& v) {
+void HashTable::unlocked_restoreMeta(
+        const std::unique_lock<StripeMutex>& htLock,
+        const Item& itm,
+        StoredValue& v) {
     if (!htLock) {
         throw std::invalid_argument(
                 "HashTable::unlocked_restoreMeta: htLock "
@@ -1155,6 +1635,18 @@ void HashTable::unlocked_restoreMeta(const std::unique_lock<std::mutex>& htLock,
     valueStats.epilogue(preProps, &v);
 }
 
+void HashTable::unlocked_rebuildTag(int bucket_num) {
+    if (tags.empty()) {
+        return;
+    }
+    tag_type tag = 0;
+    for (StoredValue* v = values[bucket_num].get().get(); v;
+         v = v->getNext().get().get()) {
+        tag |= getTagForHash(v->getKey().hash());
+    }
+    tags[bucket_num] = tag;
+}
+
 uint8_t HashTable::generateFreqValue(uint8_t counter) {
     return probabilisticCounter.generateValue(counter);
 }
@@ -1164,8 +1656,14 @@ void HashTable::updateFreqCounter(StoredValue& v) {
     // value.  Because a probabilistic counter is used the new
     // value will either be the same or an increment of the
     // current value.
-    auto updatedFreqCounterValue = generateFreqValue(v.getFreqCounterValue());
-    v.setFreqCounterValue(updatedFreqCounterValue);
+    const auto freqCounterValue = v.getFreqCounterValue();
+    auto updatedFreqCounterValue = generateFreqValue(freqCounterValue);
+    // Only write back if the counter changed - the vast majority of calls for
+    // a frequently accessed (hot) key don't change it, and skipping the store
+    // avoids dirtying the StoredValue's cache line on every read.
+    if (updatedFreqCounterValue != freqCounterValue) {
+        v.setFreqCounterValue(updatedFreqCounterValue);
+    }
 
     if (updatedFreqCounterValue == std::numeric_limits<uint8_t>::max()) {
         // Invoke the registered callback function which
@@ -1184,6 +1682,12 @@ std::ostream& operator<<(std::ostream& os, const HashTable& ht) {
        << " numSystemItems:" << ht.getNumSystemItems()
        << " numPreparedSW:" << ht.getNumPreparedSyncWrites()
        << " values: " << std::endl;
+    for (const auto& chain : ht.oldValues) {
+        for (StoredValue* sv = chain.get().get(); sv != nullptr;
+             sv = sv->getNext().get().get()) {
+            os << "    " << *sv << std::endl;
+        }
+    }
     for (const auto& chain : ht.values) {
         if (chain) {
             for (StoredValue* sv = chain.get().get(); sv != nullptr;
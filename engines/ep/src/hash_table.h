@@ -21,10 +21,15 @@
 #include "stored-value.h"
 #include "storeddockey.h"
 
+#include <boost/optional.hpp>
+#include <folly/CachelinePadded.h>
 #include <platform/non_negative_counter.h>
 
 #include <array>
+#include <atomic>
+#include <deque>
 #include <functional>
+#include <mutex>
 
 class AbstractStoredValueFactory;
 class HashTableVisitor;
@@ -84,7 +89,8 @@ enum class DeletionDurability : uint8_t {};
  * It supports a limited degree of concurrent access - the underlying
  * HashTable buckets are guarded by N ht_locks; where N is typically of the
  * order of the number of CPUs. Essentially ht bucket B is guarded by
- * mutex B mod N.
+ * mutex B mod N. Each mutex occupies its own cache line, so accesses to
+ * buckets guarded by different mutexes do not interfere with each other.
  *
  * StoredValue objects can have their value (Blob object) ejected, making the
  * value non-resident. Such StoredValues are still in the HashTable, and their
@@ -139,11 +145,43 @@ enum class DeletionDurability : uint8_t {};
  * bucket; then chaining is used (StoredValue::chain_next_or_replacement) to
  * handle any collisions.
  *
+ * Optionally (Layout::Tagged) the HashTable also maintains a compact array of
+ * per-bucket tags, parallel to the vector of buckets. Each tag is a 16-bit
+ * summary of the key hashes present in that bucket's chain (one bit per key,
+ * selected by bits of the hash which are not used to select the bucket).
+ * Tags for 32 buckets pack into a single cache line, so a lookup for a key
+ * which is not present can usually be rejected by reading just the tag,
+ * without dereferencing (and pulling into cache) any StoredValue in the
+ * chain. Tags are only read / modified while holding the bucket's lock.
+ *
  * The HashTable can be resized if it grows too full - this is done by
  * acquiring all the ht_locks, and then allocating a new vector of buckets and
  * re-hashing all elements into the new table. While resizing is occuring all
  * other access to the HashTable is blocked.
  *
+ * Alternatively (ResizeMode::Incremental) resizing only takes all ht_locks
+ * briefly to swap in the new (empty) vector of buckets; the old vector is
+ * retained and its buckets are migrated to the new vector one at a time -
+ * either when a key hashing to an old bucket is accessed (see
+ * getLockedBucketForHash()), or by continueResize() (driven by the
+ * HashtableResizerTask). To allow a single ht_lock to guard both a key's old
+ * and new bucket, in this mode the number of buckets is always a multiple of
+ * the number of ht_locks - so the lock for a key is (hash mod N) irrespective
+ * of the table size.
+ *
+ * Reads of Committed items can also be made without acquiring the ht_lock
+ * (see findForReadOptimistic()). Each ht_lock is paired with a version which
+ * is odd while the lock is held (a sequence lock); an optimistic reader
+ * copies the item from the chain and then checks that the version didn't
+ * change while it was reading - if it did the read is retried under the lock.
+ * So that the reader can never access freed memory, StoredValues unlinked
+ * from the chain (and values dropped from StoredValues) are not freed
+ * immediately but retired to a per-lock list, and only freed once no
+ * optimistic reader can still be reading them (see ReadEpoch). Changes to the
+ * table itself (resize, clear) wait for any optimistic readers to finish.
+ * Optimistic reads aren't supported if the StoredValues are also owned
+ * outside of the HashTable (OrderedStoredValues in Ephemeral buckets).
+ *
  * Support for holding both Committed and Pending items requires that we
  * can represent having for each key, either:
  *  1. No item present
@@ -166,6 +204,27 @@ public:
     using DatatypeCombo = std::array<cb::NonNegativeCounter<size_t>,
                                      mcbp::datatype::highest + 1>;
 
+    /**
+     * Layout of the HashTable buckets (see class comment for details).
+     */
+    enum class Layout : uint8_t {
+        /// Vector of StoredValue chains only.
+        Chained,
+        /// Vector of StoredValue chains plus a per-bucket tag array, allowing
+        /// lookups to skip chains which cannot contain the key.
+        Tagged,
+    };
+
+    /**
+     * How the HashTable is resized (see class comment for details).
+     */
+    enum class ResizeMode : uint8_t {
+        /// Rehash all elements under all locks.
+        Blocking,
+        /// Migrate buckets incrementally, one lock at a time.
+        Incremental,
+    };
+
     /**
      * Represents a position within the hashtable.
      *
@@ -378,6 +437,51 @@ public:
         EPStats& epStats;
     };
 
+    /**
+     * Mutex guarding a stripe of hash buckets, paired with a version which
+     * is odd while the mutex is held (a sequence lock). Readers which don't
+     * acquire the mutex (see findForReadOptimistic()) compare the version
+     * before and after reading to detect a concurrent modification.
+     */
+    class StripeMutex {
+    public:
+        void lock() {
+            mutex.lock();
+            beginWrite();
+        }
+
+        bool try_lock() {
+            if (!mutex.try_lock()) {
+                return false;
+            }
+            beginWrite();
+            return true;
+        }
+
+        void unlock() {
+            version.store(version.load(std::memory_order_relaxed) + 1,
+                          std::memory_order_release);
+            mutex.unlock();
+        }
+
+        /// @return the current version; odd if the stripe may be modified.
+        uint64_t getVersion() const {
+            return version.load(std::memory_order_acquire);
+        }
+
+    private:
+        void beginWrite() {
+            version.store(version.load(std::memory_order_relaxed) + 1,
+                          std::memory_order_relaxed);
+            // Order the (odd) version before any modification made under the
+            // mutex.
+            std::atomic_thread_fence(std::memory_order_release);
+        }
+
+        std::mutex mutex;
+        std::atomic<uint64_t> version{0};
+    };
+
     /**
      * Represents a locked hash bucket that provides RAII semantics for the lock
      *
@@ -389,7 +493,7 @@ public:
         HashBucketLock()
             : bucketNum(-1) {}
 
-        HashBucketLock(int bucketNum, std::mutex& mutex)
+        HashBucketLock(int bucketNum, StripeMutex& mutex)
             : bucketNum(bucketNum), htLock(mutex) {
         }
 
@@ -411,17 +515,17 @@ public:
             return bucketNum;
         }
 
-        const std::unique_lock<std::mutex>& getHTLock() const {
+        const std::unique_lock<StripeMutex>& getHTLock() const {
             return htLock;
         }
 
-        std::unique_lock<std::mutex>& getHTLock() {
+        std::unique_lock<StripeMutex>& getHTLock() {
             return htLock;
         }
 
     private:
         int bucketNum;
-        std::unique_lock<std::mutex> htLock;
+        std::unique_lock<StripeMutex> htLock;
     };
 
     /**
@@ -431,18 +535,31 @@ public:
      * @param svFactory Factory to use for constructing stored values
      * @param initialSize the number of hash table buckets to initially create.
      * @param locks the number of locks in the hash table
+     * @param layout the bucket layout to use
+     * @param resizeMode how the hash table should be resized
      */
     HashTable(EPStats& st,
               std::unique_ptr<AbstractStoredValueFactory> svFactory,
               size_t initialSize,
-              size_t locks);
+              size_t locks,
+              Layout layout = Layout::Chained,
+              ResizeMode resizeMode = ResizeMode::Blocking);
 
     ~HashTable();
 
     size_t memorySize() {
         return sizeof(HashTable)
             + (size * sizeof(StoredValue*))
-            + (mutexes.size() * sizeof(std::mutex));
+            + (oldValues.size() * sizeof(StoredValue*))
+            + (tags.size() * sizeof(tag_type))
+            + (mutexes.size() * sizeof(lock_type));
+    }
+
+    /**
+     * Get the bucket layout of this hash table.
+     */
+    Layout getLayout() const {
+        return layout;
     }
 
     /**
@@ -589,9 +706,35 @@ public:
 
     /**
      * Resize to the specified size.
+     *
+     * In ResizeMode::Incremental the size is rounded up to a multiple of the
+     * number of locks, and this only starts the resize - the buckets are
+     * subsequently migrated on access and by continueResize(). If an
+     * incremental resize is already in progress this is a no-op.
      */
     void resize(size_t to);
 
+    /**
+     * Migrate up to the given number of buckets of an in-progress incremental
+     * resize to the new table, acquiring the lock of each bucket in turn.
+     * Completes the resize once all buckets have been migrated.
+     *
+     * @param maxBuckets maximum number of buckets to migrate
+     * @return true if no resize is in progress (any resize has completed).
+     */
+    bool continueResize(size_t maxBuckets);
+
+    /**
+     * @return true if an incremental resize is in progress.
+     */
+    bool isResizing() const {
+        return oldSize != 0;
+    }
+
+    ResizeMode getResizeMode() const {
+        return resizeMode;
+    }
+
     /**
      * Result of the findForRead() method.
      */
@@ -633,6 +776,49 @@ public:
             WantsDeleted wantsDeleted = WantsDeleted::No,
             ForGetReplicaOp fetchRequestedForReplicaItem = ForGetReplicaOp::No);
 
+    /**
+     * Result of the findForReadOptimistic() method.
+     */
+    struct OptimisticReadResult {
+        /// Copy of the found item; nullptr if the caller must use
+        /// findForRead() instead.
+        std::unique_ptr<Item> item;
+        /// NRU value of the StoredValue the item was copied from.
+        uint8_t nru = 0;
+    };
+
+    /**
+     * Copy a Committed, non-deleted, resident and unexpired item for
+     * read-only access *without* acquiring the hash bucket lock.
+     *
+     * The chain is read optimistically, and the copy only returned if the
+     * version of the bucket's lock shows no writer modified it meanwhile.
+     * This avoids every reader of a frequently accessed (hot) key bouncing
+     * the same mutex cache line between CPUs.
+     *
+     * No item is returned - and the caller should fall back to findForRead()
+     * - if the read conflicted with a writer; if the key doesn't have an
+     * item as above (missing, deleted, temporary, non-resident, expired or
+     * blocked by a PreparedMaybeVisible SyncWrite); or if the read would need
+     * to modify the StoredValue (tracking the reference of a key whose
+     * frequency counter isn't saturated), as that needs the lock.
+     *
+     * @param key The key of the item to find
+     * @param vbid The vBucket to set in the returned item
+     * @param trackReference Should this lookup update referenced status
+     * @param fetchRequestedForReplicaItem are we finding the item for a
+     *        GET_REPLICA op
+     * @param hideLockedCas Should the CAS be hidden if the item is locked?
+     * @param includeValue Should the item include the value?
+     */
+    OptimisticReadResult findForReadOptimistic(
+            const DocKey& key,
+            Vbid vbid,
+            TrackReference trackReference,
+            ForGetReplicaOp fetchRequestedForReplicaItem,
+            bool hideLockedCas,
+            StoredValue::IncludeValue includeValue);
+
     /**
      * Result of the findFor...() methods which return a non-const result.
      */
@@ -1189,7 +1375,7 @@ public:
      *
      * @return true if restored; else false
      */
-    bool unlocked_restoreValue(const std::unique_lock<std::mutex>& htLock,
+    bool unlocked_restoreValue(const std::unique_lock<StripeMutex>& htLock,
                                const Item& itm,
                                StoredValue& v);
 
@@ -1202,7 +1388,7 @@ public:
      * @param itm the Item whose metadata is being restored
      * @param v corresponding StoredValue
      */
-    void unlocked_restoreMeta(const std::unique_lock<std::mutex>& htLock,
+    void unlocked_restoreMeta(const std::unique_lock<StripeMutex>& htLock,
                               const Item& itm,
                               StoredValue& v);
 
@@ -1256,6 +1442,15 @@ public:
      */
     bool reallocateStoredValue(StoredValue&& v);
 
+    /**
+     * 'Defragment' the value of the StoredValue - reallocate the Blob, which
+     * has the effect of repacking the underlying allocators memory pool.
+     *
+     * @param hbl HashBucketLock that must be held
+     * @param v The StoredValue whose value is to be reallocated
+     */
+    void unlocked_reallocateValue(const HashBucketLock& hbl, StoredValue& v);
+
     /**
      * Dump a representation of the HashTable to stderr.
      */
@@ -1272,6 +1467,36 @@ private:
     // The container for actually holding the StoredValues.
     using table_type = std::vector<StoredValue::UniquePtr>;
 
+    // Lock guarding a stripe of buckets. Each lock is padded to its own cache
+    // line so threads accessing buckets guarded by different (but adjacent)
+    // locks don't contend on the same cache line.
+    using lock_type = folly::CachelinePadded<StripeMutex>;
+
+    /**
+     * A StoredValue unlinked from a chain, or a value dropped from a
+     * StoredValue, which an optimistic reader may still be reading.
+     */
+    struct Retired {
+        /// ReadEpoch it may be freed after.
+        uint64_t epoch;
+        /// Bytes held (counted in RetiredList::bytes).
+        size_t bytes;
+        StoredValue::UniquePtr storedValue;
+        value_t value;
+    };
+
+    // Retired objects of a stripe, in order of epoch. Guarded by the
+    // stripe's lock.
+    struct RetiredList {
+        std::deque<Retired> entries;
+        // Bytes (StoredValue and value sizes) held by entries.
+        size_t bytes = 0;
+    };
+
+    // Per-bucket summary of the hashes of the keys in a bucket's chain.
+    using tag_type = uint16_t;
+    using tag_table_type = std::vector<tag_type>;
+
     friend class StoredValue;
     friend std::ostream& operator<<(std::ostream& os, const HashTable& ht);
 
@@ -1285,7 +1510,7 @@ private:
      * @return HashBucektLock which contains a lock and the hash bucket number
      */
     inline HashBucketLock getLockedBucket(int bucket) {
-        return HashBucketLock(bucket, mutexes[mutexForBucket(bucket)]);
+        return HashBucketLock(bucket, *mutexes[mutexForBucket(bucket)]);
     }
 
     /**
@@ -1303,8 +1528,14 @@ private:
                         "Cannot call on a non-active object");
             }
             int bucket = getBucketForHash(h);
-            HashBucketLock rv(bucket, mutexes[mutexForBucket(bucket)]);
+            HashBucketLock rv(bucket, *mutexes[mutexForBucket(bucket)]);
             if (bucket == getBucketForHash(h)) {
+                if (isResizing()) {
+                    // Ensure any elements which hash to the same bucket are
+                    // in the new table. The old bucket is guarded by the
+                    // same lock (see ResizeMode::Incremental).
+                    unlocked_migrateBucket(getOldBucketForHash(h));
+                }
                 return rv;
             }
         }
@@ -1356,8 +1587,31 @@ private:
     // in `values`
     std::atomic<size_t> size;
     table_type values;
+    // Bucket layout; if Tagged then `tags` has one element per bucket,
+    // otherwise it is empty.
+    const Layout layout;
+    tag_table_type tags;
+
+    const ResizeMode resizeMode;
+    // During an incremental resize, the previous table whose buckets have not
+    // yet all been migrated to `values`; empty otherwise.
+    table_type oldValues;
+    // Number of buckets in oldValues; zero if no resize is in progress.
+    std::atomic<size_t> oldSize;
+    // Next bucket in oldValues to be migrated by continueResize().
+    std::atomic<size_t> nextOldBucket;
+    // Serialises resize() and continueResize(). Acquired before (and never
+    // while holding) any of the mutexes.
+    std::mutex resizeMutex;
     // Mutable so that we can make dumpStoredValuesAsJson const
-    mutable std::vector<std::mutex> mutexes;
+    mutable std::vector<lock_type> mutexes;
+    // Can StoredValues be read without the lock (see findForReadOptimistic)?
+    const bool optimisticReads;
+    // Set while the table itself (rather than the buckets of a stripe) is
+    // being changed; optimistic reads must take the lock.
+    std::atomic<bool> optimisticReadsBlocked{false};
+    // One per lock; see Retired.
+    std::vector<folly::CachelinePadded<RetiredList>> retired;
     EPStats&             stats;
     std::unique_ptr<AbstractStoredValueFactory> valFact;
     std::atomic<size_t>       visitors;
@@ -1389,6 +1643,44 @@ private:
         return abs(h % static_cast<int>(size));
     }
 
+    int getOldBucketForHash(int h) {
+        return abs(h % static_cast<int>(oldSize));
+    }
+
+    /**
+     * Move all elements of the given bucket of oldValues to their bucket in
+     * values. Must be called with the lock for the bucket held.
+     */
+    void unlocked_migrateBucket(size_t oldBucket);
+
+    /**
+     * Migrate all buckets of oldValues guarded by the given lock, acquiring
+     * the lock for each bucket in turn. No-op if not resizing.
+     */
+    void migrateBucketsForLock(size_t lock);
+
+    /**
+     * Complete an in-progress incremental resize, once all buckets have been
+     * migrated. Must be called with resizeMutex held.
+     */
+    void completeIncrementalResize();
+
+    /**
+     * Returns the tag bit for the given hash. Uses the top bits of a
+     * multiplicative (Fibonacci) hash of h, so the tag is independent of the
+     * bucket index (which is derived from h modulo size).
+     */
+    static tag_type getTagForHash(uint32_t h) {
+        return tag_type(1) << ((h * 2654435769u) >> 28);
+    }
+
+    /**
+     * Recalculate the tag of the given bucket from the keys in its chain.
+     * Must be called with the bucket lock held after removing an element
+     * from the bucket; no-op if the HashTable isn't Layout::Tagged.
+     */
+    void unlocked_rebuildTag(int bucket_num);
+
     inline size_t mutexForBucket(size_t bucket_num) {
         if (!isActive()) {
             throw std::logic_error("HashTable::mutexForBucket: Cannot call on a "
@@ -1399,6 +1691,46 @@ private:
 
     std::unique_ptr<Item> getRandomKeyFromSlot(int slot);
 
+    /**
+     * Copy a resident, Committed item from the given slot without acquiring
+     * its lock (see findForReadOptimistic()).
+     *
+     * @return the item (nullptr if there is none) if the read didn't
+     *         conflict with a writer; else no value.
+     */
+    boost::optional<std::unique_ptr<Item>> getRandomKeyFromSlotOptimistic(
+            int slot);
+
+    /**
+     * Free the given StoredValue, which has been unlinked from the given
+     * bucket - once no optimistic reader can still be reading it.
+     */
+    void unlocked_retire(int bucket_num, StoredValue::UniquePtr v);
+
+    /**
+     * Free the value the given StoredValue (in the given bucket) had before
+     * it was changed - once no optimistic reader can still be reading it.
+     * No-op if the value wasn't changed.
+     */
+    void unlocked_retireValue(int bucket_num,
+                              value_t oldValue,
+                              const StoredValue& v);
+
+    /**
+     * Free the retired objects of the given lock which no optimistic reader
+     * can still be reading.
+     */
+    void unlocked_reclaim(size_t lock);
+
+    /**
+     * Stop optimistic reads (waiting for any in progress to finish) so the
+     * table may be changed; must be called with all of the locks held.
+     */
+    void blockOptimisticReads();
+
+    /// Allow optimistic reads again after blockOptimisticReads().
+    void unblockOptimisticReads();
+
     /** Searches for the first element in the specified hashChain which matches
      * predicate p, and unlinks it from the chain.
      *
@@ -1458,6 +1790,8 @@ private:
 
 std::ostream& operator<<(std::ostream& os, const HashTable& ht);
 
+std::string to_string(HashTable::Layout layout);
+
 /**
  * Base class for visiting a hash table.
  */
@@ -33,7 +33,17 @@ public:
 
     void visitBucket(const VBucketPtr& vb) override {
         vb->ht.resize();
+
+        // For incremental resizing, migrate all buckets of any in-progress
+        // resize. Each bucket is migrated under just its own lock, so
+        // frontend operations are only blocked (briefly) if they access a
+        // bucket as it is being migrated.
+        while (!vb->ht.continueResize(migrateChunkSize)) {
+        }
     }
+
+private:
+    static const size_t migrateChunkSize = 1024;
 };
 
 HashtableResizerTask::HashtableResizerTask(KVBucketIface& s, double sleepTime)
@@ -48,9 +58,9 @@ bool HashtableResizerTask::run(void) {
     TRACE_EVENT0("ep-engine/task", "HashtableResizerTask");
     auto pv = std::make_unique<ResizingVisitor>();
 
-    // [per-VBucket Task] While a Hashtable is resizing no user
-    // requests can be performed (the resizing process needs to
-    // acquire all HT locks). As such we are sensitive to the duration
+    // [per-VBucket Task] While a Hashtable is resizing (in blocking
+    // mode) no user requests can be performed (the resizing process needs
+    // to acquire all HT locks). As such we are sensitive to the duration
     // of this task - we want to log anything which has a
     // non-negligible impact on frontend operations.
     const auto maxExpectedDurationForVisitorTask =
@@ -29,6 +29,7 @@
 #include "kv_bucket.h"
 #include "kv_bucket_iface.h"
 #include "paging_visitor.h"
+#include "vbucket.h"
 
 #include <platform/platform_time.h>
 
@@ -95,6 +96,20 @@ bool ItemPager::run(void) {
 
         ++stats.pagerRuns;
 
+        Configuration& cfg = engine.getConfiguration();
+
+        if (cfg.isChkExpelEager() && current > lower) {
+            // Expelling checkpoint items which every cursor has already
+            // processed costs nothing in cache hit ratio, so try that before
+            // evicting any values.
+            current -= expelCheckpointItems(size_t(current - lower));
+            if (current <= lower) {
+                doEvict = false;
+                available->store(true);
+                return true;
+            }
+        }
+
         double toKill = (current - static_cast<double>(lower)) / current;
 
         EP_LOG_DEBUG("Using {} bytes of memory, paging out {} of items.",
@@ -102,7 +117,6 @@ bool ItemPager::run(void) {
                      (toKill * 100.0));
 
         // compute active vbuckets evicition bias factor
-        Configuration& cfg = engine.getConfiguration();
         size_t activeEvictPerc = cfg.getPagerActiveVbPcnt();
         double bias = static_cast<double>(activeEvictPerc) / 50;
 
@@ -158,6 +172,28 @@ bool ItemPager::run(void) {
     return true;
 }
 
+size_t ItemPager::expelCheckpointItems(size_t amountToClear) {
+    KVBucket* kvBucket = engine.getKVBucket();
+    size_t memoryCleared = 0;
+    for (const auto& it :
+         kvBucket->getVBuckets().getVBucketsSortedByChkMgrMem()) {
+        if (memoryCleared >= amountToClear) {
+            break;
+        }
+        VBucketPtr vb = kvBucket->getVBucket(it.first);
+        if (!vb) {
+            continue;
+        }
+        memoryCleared += vb->checkpointManager
+                                 ->expelUnreferencedCheckpointItems()
+                                 .estimateOfFreeMemory;
+    }
+    EP_LOG_DEBUG("ItemPager expelled checkpoint items, estimated to have "
+                 "recovered {} bytes.",
+                 memoryCleared);
+    return memoryCleared;
+}
+
 void ItemPager::scheduleNow() {
     bool expected = false;
     if (notified.compare_exchange_strong(expected, true)) {
@@ -74,6 +74,16 @@ public:
     void scheduleNow();
 
 private:
+    /**
+     * Expel checkpoint items which all cursors have already moved past,
+     * visiting the vBuckets with the most checkpoint memory first.
+     *
+     * @param amountToClear stop once this many bytes are estimated to be
+     *        freed
+     * @return estimate of the number of bytes freed
+     */
+    size_t expelCheckpointItems(size_t amountToClear);
+
     EventuallyPersistentEngine& engine;
     EPStats& stats;
     std::shared_ptr<std::atomic<bool>> available;
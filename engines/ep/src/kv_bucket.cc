@@ -986,7 +986,10 @@ ENGINE_ERROR_CODE KVBucket::setVBucketState_UNLOCKED(
             // Initialize bloom filters upon vbucket creation during
             // bucket creation and rebalance
             newvb->createFilter(config.getBfilterKeyCount(),
-                                config.getBfilterFpProb());
+                                config.getBfilterFpProb(),
+                                config.getBfilterType() == "blocked"
+                                        ? BloomFilter::Type::Blocked
+                                        : BloomFilter::Type::BitArray);
         }
 
         // The first checkpoint for active vbucket should start with id 2.
@@ -1431,7 +1434,10 @@ void KVBucket::completeBGFetchMulti(
             auto* fetched_item = item.second;
             ENGINE_ERROR_CODE status = vb->completeBGFetchForSingleItem(
                     key, *fetched_item, startTime);
-            engine.notifyIOComplete(fetched_item->cookie, status);
+            // Fetches queued by getMulti() have no cookie to notify.
+            if (fetched_item->cookie) {
+                engine.notifyIOComplete(fetched_item->cookie, status);
+            }
         }
         EP_LOG_DEBUG(
                 "EP Store completes {} of batched background fetch "
@@ -1443,8 +1449,10 @@ void KVBucket::completeBGFetchMulti(
                         .count());
     } else {
         for (const auto& item : fetchedItems) {
-            engine.notifyIOComplete(item.second->cookie,
-                                    ENGINE_NOT_MY_VBUCKET);
+            if (item.second->cookie) {
+                engine.notifyIOComplete(item.second->cookie,
+                                        ENGINE_NOT_MY_VBUCKET);
+            }
         }
         EP_LOG_WARN(
                 "EP Store completes {} of batched background fetch for "
@@ -1519,6 +1527,57 @@ GetValue KVBucket::getInternal(const DocKey& key,
     }
 }
 
+std::vector<GetValue> KVBucket::getMulti(
+        const std::vector<std::pair<DocKey, Vbid>>& keys,
+        get_options_t options) {
+    std::vector<GetValue> results;
+    results.reserve(keys.size());
+    for (size_t ii = 0; ii < keys.size(); ++ii) {
+        results.emplace_back(nullptr, ENGINE_EWOULDBLOCK);
+    }
+
+    // Group the keys per vBucket so each vBucket is looked up (and its state
+    // lock acquired) once for all of its keys.
+    std::map<Vbid, std::vector<size_t>> keysPerVBucket;
+    for (size_t ii = 0; ii < keys.size(); ++ii) {
+        keysPerVBucket[keys[ii].second].push_back(ii);
+    }
+
+    for (const auto& entry : keysPerVBucket) {
+        VBucketPtr vb = getVBucket(entry.first);
+        if (!vb) {
+            continue;
+        }
+
+        // Anything but an active vBucket needs the cookie (to be parked in
+        // pendingOps, or to report not-my-vbucket); leave those to get().
+        folly::SharedMutex::ReadHolder rlh(vb->getStateLock());
+        if ((options & HONOR_STATES) &&
+            vb->getState() != vbucket_state_active) {
+            continue;
+        }
+
+        for (auto index : entry.second) {
+            auto cHandle = vb->lockCollections(keys[index].first);
+            if (!cHandle.valid()) {
+                continue;
+            }
+
+            // No cookie: any background fetch queued here completes without
+            // a notification, the caller retries with get() instead. The
+            // vBucket's fetches are queued back-to-back, so the BgFetcher
+            // normally reads them from disk in a single KVStore::getMulti.
+            results[index] = vb->getInternal(nullptr,
+                                             engine,
+                                             options,
+                                             VBucket::GetKeyOnly::No,
+                                             cHandle);
+        }
+    }
+
+    return results;
+}
+
 GetValue KVBucket::getRandomKey() {
     size_t max = vbMap.getSize();
 
@@ -2022,6 +2081,7 @@ void KVBucket::reset() {
         auto vb = getLockedVBucket(vbid);
         if (vb) {
             vb->ht.clear();
+            vb->discardPreparedItemsToPersist();
             vb->checkpointManager->clear(vb->getState());
             vb->resetStats();
             vb->setPersistedSnapshot({0, 0});
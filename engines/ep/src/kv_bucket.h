@@ -127,6 +127,10 @@ public:
         return getInternal(key, vbucket, cookie, ForGetReplicaOp::No, options);
     }
 
+    std::vector<GetValue> getMulti(
+            const std::vector<std::pair<DocKey, Vbid>>& keys,
+            get_options_t options) override;
+
     GetValue getRandomKey() override;
 
     GetValue getReplica(const DocKey& key,
@@ -141,6 +141,22 @@ public:
                          const void* cookie,
                          get_options_t options) = 0;
 
+    /**
+     * Retrieve a batch of values without blocking (see
+     * EngineIface::get_multi). Keys are grouped per vbucket, and values which
+     * have to be read from disk are queued as background fetches which
+     * don't notify any cookie.
+     *
+     * @param keys    the keys to fetch, along with their vbuckets
+     * @param options options specified for retrieval
+     *
+     * @return a GetValue per key (in the order of keys); ENGINE_EWOULDBLOCK
+     *         for any key which should be retried with get()
+     */
+    virtual std::vector<GetValue> getMulti(
+            const std::vector<std::pair<DocKey, Vbid>>& keys,
+            get_options_t options) = 0;
+
     /**
      * Retrieve a value randomly from the store.
      *
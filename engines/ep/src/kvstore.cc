@@ -581,6 +581,28 @@ void KVStore::prepareToCreate(Vbid vbid) {
     prepareToCreateImpl(vbid);
 }
 
+std::string PersistedBloomFilter::encode() const {
+    std::string out;
+    out.reserve(sizeof(uint64_t) + filter.size());
+    const uint64_t seqno = htonll(highSeqno);
+    out.append(reinterpret_cast<const char*>(&seqno), sizeof(seqno));
+    out.append(filter);
+    return out;
+}
+
+PersistedBloomFilter PersistedBloomFilter::decode(cb::const_char_buffer data) {
+    PersistedBloomFilter rv;
+    if (data.size() < sizeof(uint64_t)) {
+        return rv;
+    }
+    uint64_t seqno;
+    std::memcpy(&seqno, data.data(), sizeof(seqno));
+    rv.highSeqno = ntohll(seqno);
+    rv.filter.assign(data.data() + sizeof(seqno),
+                     data.size() - sizeof(seqno));
+    return rv;
+}
+
 void KVStore::resetCachedVBState(Vbid vbid) {
     vbucket_state* state = getVBucketState(vbid);
     if (state) {
@@ -22,6 +22,7 @@
 #include "collections/kvstore.h"
 
 #include <memcached/engine_common.h>
+#include <platform/sized_buffer.h>
 #include <utilities/hdrhistogram.h>
 
 #include <relaxed_atomic.h>
@@ -135,6 +136,34 @@ struct compaction_ctx {
     uint64_t highCompletedSeqno = 0;
 };
 
+/**
+ * A vBucket's BloomFilter as persisted alongside its data, see
+ * KVStore::persistBloomFilter().
+ */
+struct PersistedBloomFilter {
+    /**
+     * Encode for storing as a single document: highSeqno (network byte
+     * order) followed by filter.
+     */
+    std::string encode() const;
+
+    /**
+     * Decode a document created by encode().
+     * @return the decoded value, or an empty PersistedBloomFilter (no filter)
+     *         if data is too short.
+     */
+    static PersistedBloomFilter decode(cb::const_char_buffer data);
+
+    /**
+     * The persisted high seqno of the vBucket when the filter was persisted.
+     * The filter is only valid while no later seqno has been persisted.
+     */
+    uint64_t highSeqno = 0;
+
+    /// The filter, as encoded by BloomFilter::encode(). Empty if none.
+    std::string filter;
+};
+
 struct kvstats_ctx {
     kvstats_ctx(Collections::VB::Flush& collectionsFlush)
         : collectionsFlush(collectionsFlush) {
@@ -589,6 +618,28 @@ public:
      */
     virtual bool commit(Collections::VB::Flush& collectionsFlush) = 0;
 
+    /**
+     * Enable or disable deferring the final sync of each commit. While
+     * enabled, commit() may return before its writes are durable, and
+     * syncDeferredCommits() must be called before they are relied on. Used
+     * by the flusher to sync the commits of several vBuckets together.
+     *
+     * @return true if commits are deferring their sync; false if not
+     *         (including if the KVStore does not support it).
+     */
+    virtual bool setDeferCommitSync(bool defer) {
+        return false;
+    }
+
+    /**
+     * Sync the writes of the commits which deferred their sync.
+     *
+     * @return false if the sync fails (it can be retried)
+     */
+    virtual bool syncDeferredCommits() {
+        return true;
+    }
+
     /**
      * Rollback the current transaction.
      */
@@ -712,6 +763,32 @@ public:
      */
     virtual bool compactDB(compaction_ctx *c) = 0;
 
+    /**
+     * Persist the given BloomFilter for the vBucket, replacing any previously
+     * persisted one. The caller must ensure no flush of the vBucket runs
+     * concurrently.
+     *
+     * @param vbid vBucket the filter belongs to
+     * @param filter the filter to persist
+     * @return true if persisted; false on error or if the KVStore doesn't
+     *         support persisting BloomFilters.
+     */
+    virtual bool persistBloomFilter(Vbid vbid,
+                                    const PersistedBloomFilter& filter) {
+        return false;
+    }
+
+    /**
+     * Read the BloomFilter last persisted for the vBucket.
+     *
+     * @param vbid vBucket to read the filter of
+     * @return the persisted filter; with an empty filter if there is none
+     *         (or the KVStore doesn't support persisting BloomFilters).
+     */
+    virtual PersistedBloomFilter getBloomFilter(Vbid vbid) {
+        return {};
+    }
+
     /**
      * Return the database file id from the compaction request
      * @param compact_req request structure for compaction
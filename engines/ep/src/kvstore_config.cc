@@ -31,6 +31,9 @@ public:
         if (key == "fsync_after_every_n_bytes_written") {
             config.setPeriodicSyncBytes(value);
         }
+        if (key == "dcp_backfill_readahead_size") {
+            config.setBackfillReadAheadBytes(value);
+        }
     }
     void booleanValueChanged(const std::string& key, bool value) override {
         if (key == "couchstore_tracing") {
@@ -70,6 +73,10 @@ KVStoreConfig::KVStoreConfig(Configuration& config, uint16_t shardid)
     config.addValueChangedListener(
             "couchstore_mprotect",
             std::make_unique<ConfigChangeListener>(*this));
+    setBackfillReadAheadBytes(config.getDcpBackfillReadaheadSize());
+    config.addValueChangedListener(
+            "dcp_backfill_readahead_size",
+            std::make_unique<ConfigChangeListener>(*this));
 }
 
 KVStoreConfig::KVStoreConfig(uint16_t _maxVBuckets,
@@ -86,7 +93,8 @@ KVStoreConfig::KVStoreConfig(uint16_t _maxVBuckets,
       buffered(true),
       couchstoreTracingEnabled(false),
       couchstoreWriteValidationEnabled(false),
-      couchstoreMprotectEnabled(false) {
+      couchstoreMprotectEnabled(false),
+      backfillReadAheadBytes(0) {
 }
 
 KVStoreConfig::~KVStoreConfig() = default;
@@ -121,6 +121,14 @@ public:
         return couchstoreMprotectEnabled;
     }
 
+    uint64_t getBackfillReadAheadBytes() const {
+        return backfillReadAheadBytes;
+    }
+
+    void setBackfillReadAheadBytes(uint64_t bytes) {
+        backfillReadAheadBytes = bytes;
+    }
+
 private:
     class ConfigChangeListener;
 
@@ -148,4 +156,6 @@ private:
     std::atomic_bool couchstoreWriteValidationEnabled;
     /* enbale mprotect of couchstore internal io buffer */
     std::atomic_bool couchstoreMprotectEnabled;
+    /* bytes to read ahead of by-seqno scans; zero disables */
+    std::atomic<uint64_t> backfillReadAheadBytes;
 };
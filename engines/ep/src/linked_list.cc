@@ -23,6 +23,8 @@
 #include <memcached/vbucket.h>
 #include <mutex>
 
+const seqno_t BasicLinkedList::seqnoIndexInterval = 64;
+
 BasicLinkedList::BasicLinkedList(Vbid vbucketId, EPStats& st)
     : SequenceList(),
       readRange(0, 0),
@@ -79,6 +81,7 @@ SequenceList::UpdateStatus BasicLinkedList::updateListElem(
     /* Since there is no other reads or writes happenning in this range, we can
        move the item to the end of the list */
     auto it = seqList.iterator_to(v);
+    unindexListElem(writeLock, it);
     /* If the list is being updated at 'pausedPurgePoint', then we must save
        the new 'pausedPurgePoint' */
     if (pausedPurgePoint == it) {
@@ -105,6 +108,7 @@ BasicLinkedList::rangeRead(seqno_t start, seqno_t end) {
     /* Allows only 1 rangeRead for now */
     std::lock_guard<std::mutex> lckGd(rangeReadLock);
 
+    OrderedLL::iterator startIt;
     {
         std::lock_guard<std::mutex> listWriteLg(getListWriteLock());
         std::lock_guard<SpinLock> lh(rangeLock);
@@ -125,12 +129,16 @@ BasicLinkedList::rangeRead(seqno_t start, seqno_t end) {
         end = std::min(end, static_cast<seqno_t>(highSeqno));
         end = std::max(end, static_cast<seqno_t>(highestDedupedSeqno));
         readRange = SeqRange(1, end);
+
+        /* Skip the items before start */
+        startIt = seek(listWriteLg, start);
     }
 
     /* Read items in the range */
     std::vector<UniqueItemPtr> items;
 
-    for (const auto& osv : seqList) {
+    for (auto it = startIt; it != seqList.end(); ++it) {
+        const auto& osv = *it;
         int64_t currSeqno(osv.getBySeqno());
 
         if (currSeqno > end || currSeqno < 0) {
@@ -202,6 +210,13 @@ void BasicLinkedList::updateHighSeqno(std::lock_guard<std::mutex>& listWriteLg,
                 std::to_string(v.getBySeqno()) + " which is < 1");
     }
     highSeqno = v.getBySeqno();
+
+    /* Index the element if it is far enough past the last indexed one */
+    if (v.seqno_hook.is_linked() &&
+        (seqnoIndex.empty() ||
+         v.getBySeqno() >= seqnoIndex.rbegin()->first + seqnoIndexInterval)) {
+        seqnoIndex.emplace(v.getBySeqno(), const_cast<OrderedStoredValue*>(&v));
+    }
 }
 
 void BasicLinkedList::updateHighestDedupedSeqno(
@@ -403,8 +418,8 @@ std::mutex& BasicLinkedList::getListWriteLock() const {
 }
 
 boost::optional<SequenceList::RangeIterator> BasicLinkedList::makeRangeIterator(
-        bool isBackfill) {
-    auto pRangeItr = RangeIteratorLL::create(*this, isBackfill);
+        bool isBackfill, seqno_t startSeqno) {
+    auto pRangeItr = RangeIteratorLL::create(*this, isBackfill, startSeqno);
     return pRangeItr ? RangeIterator(std::move(pRangeItr))
                      : boost::optional<SequenceList::RangeIterator>{};
 }
@@ -433,6 +448,7 @@ OrderedLL::iterator BasicLinkedList::purgeListElem(OrderedLL::iterator it,
     StoredValue::UniquePtr purged(&*it);
     {
         std::lock_guard<std::mutex> lckGd(getListWriteLock());
+        unindexListElem(lckGd, it);
         it = seqList.erase(it);
     }
 
@@ -456,17 +472,50 @@ OrderedLL::iterator BasicLinkedList::purgeListElem(OrderedLL::iterator it,
     return it;
 }
 
+OrderedLL::iterator BasicLinkedList::seek(
+        std::lock_guard<std::mutex>& listWriteLg, seqno_t seqno) {
+    /* Start from the highest indexed element at or before seqno */
+    auto it = seqList.begin();
+    auto indexIt = seqnoIndex.upper_bound(seqno);
+    if (indexIt != seqnoIndex.begin()) {
+        it = seqList.iterator_to(*std::prev(indexIt)->second);
+    }
+    while (it != seqList.end() && it->getBySeqno() < seqno) {
+        ++it;
+    }
+    return it;
+}
+
+void BasicLinkedList::unindexListElem(std::lock_guard<std::mutex>& listWriteLg,
+                                      OrderedLL::iterator it) {
+    auto indexIt = seqnoIndex.find(it->getBySeqno());
+    if (indexIt == seqnoIndex.end() || indexIt->second != &*it) {
+        return;
+    }
+    seqnoIndex.erase(indexIt);
+
+    /* Index the next element in its place, to keep the distance between
+       indexed elements bounded */
+    auto next = std::next(it);
+    if (next != seqList.end() && next->getBySeqno() > 0) {
+        seqnoIndex.emplace(next->getBySeqno(), &*next);
+    }
+}
+
 std::unique_ptr<BasicLinkedList::RangeIteratorLL>
-BasicLinkedList::RangeIteratorLL::create(BasicLinkedList& ll, bool isBackfill) {
+BasicLinkedList::RangeIteratorLL::create(BasicLinkedList& ll,
+                                         bool isBackfill,
+                                         seqno_t startSeqno) {
     /* Note: cannot use std::make_unique because the constructor of
        RangeIteratorLL is private */
     std::unique_ptr<BasicLinkedList::RangeIteratorLL> pRangeItr(
-            new BasicLinkedList::RangeIteratorLL(ll, isBackfill));
+            new BasicLinkedList::RangeIteratorLL(ll, isBackfill, startSeqno));
     return pRangeItr->tryLater() ? nullptr : std::move(pRangeItr);
 }
 
 BasicLinkedList::RangeIteratorLL::RangeIteratorLL(BasicLinkedList& ll,
-                                                  bool isBackfill)
+                                                  bool isBackfill,
+                                                  seqno_t startSeqno)
     : list(ll),
       /* Try to get range read lock, do not block */
       readLockHolder(list.rangeReadLock, std::try_to_lock),
@@ -488,11 +537,24 @@ BasicLinkedList::RangeIteratorLL::RangeIteratorLL(BasicLinkedList& ll,
         return;
     }
 
-    /* Iterator to the beginning of linked list */
-    currIt = list.seqList.begin();
+    /* Iterator to the first item at or after startSeqno. If there is none,
+       iterate over the whole list as the caller skips the items before
+       startSeqno anyway */
+    currIt = list.seek(listWriteLg, startSeqno);
+    if (currIt == list.seqList.end()) {
+        currIt = list.seqList.begin();
+    }
 
-    /* Number of items that can be iterated over */
+    /* Number of items that can be iterated over. When starting part way
+       through the list this is an upper bound, as the seqnos of the items
+       are unique */
     numRemaining = list.seqList.size();
+    if (currIt != list.seqList.begin()) {
+        numRemaining = std::min(
+                numRemaining,
+                uint64_t(list.seqList.back().getBySeqno() -
+                         currIt->getBySeqno() + 1));
+    }
 
     /* The minimum seqno in the iterator that must be read to get a consistent
        read snapshot */
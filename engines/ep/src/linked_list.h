@@ -31,6 +31,8 @@
 #include <platform/non_negative_counter.h>
 #include <relaxed_atomic.h>
 
+#include <map>
+
 /* This option will configure "list" to use the member hook */
 using MemberHookOption =
         boost::intrusive::member_hook<OrderedStoredValue,
@@ -143,6 +145,13 @@ private:
  * 'writeLock' and 'rangeLock' are held for short durations, typically for
  * single list element writes and reads.
  * 'rangeReadLock' is held for longer duration on the list (for entire range).
+ *
+ * Seeking:
+ * =======
+ * As the list is in seqno order, a sparse index of it by seqno (in effect a
+ * single express lane of a skiplist) lets range reads and range iterators
+ * start at a given seqno in O(log n), rather than walking the list from its
+ * beginning.
  */
 class BasicLinkedList : public SequenceList {
 public:
@@ -203,7 +212,7 @@ public:
     std::mutex& getListWriteLock() const override;
 
     boost::optional<SequenceList::RangeIterator> makeRangeIterator(
-            bool isBackfill) override;
+            bool isBackfill, seqno_t startSeqno = 0) override;
 
     void dump() const override;
 
@@ -255,9 +264,41 @@ protected:
        list */
     cb::RelaxedAtomic<size_t> staleMetaDataSize;
 
+    /**
+     * Sparse index of the list elements by seqno. An element is added when
+     * its seqno is at least seqnoIndexInterval above the highest indexed
+     * seqno; when an indexed element is moved or purged, the element after
+     * it takes its place, so there are normally fewer than
+     * seqnoIndexInterval elements between consecutive indexed ones.
+     *
+     * Guarded by writeLock.
+     */
+    std::map<seqno_t, OrderedStoredValue*> seqnoIndex;
+
+    static const seqno_t seqnoIndexInterval;
+
 private:
     OrderedLL::iterator purgeListElem(OrderedLL::iterator it, bool isStale);
 
+    /**
+     * Returns an iterator to the first element with a seqno >= seqno, or
+     * seqList.end() if there is none.
+     *
+     * @param listWriteLg Write lock of the sequenceList from getListWriteLock()
+     */
+    OrderedLL::iterator seek(std::lock_guard<std::mutex>& listWriteLg,
+                             seqno_t seqno);
+
+    /**
+     * Removes the element from seqnoIndex (if it is indexed) before it is
+     * moved or removed from the list.
+     *
+     * @param listWriteLg Write lock of the sequenceList from getListWriteLock()
+     * @param it element to be unlinked
+     */
+    void unindexListElem(std::lock_guard<std::mutex>& listWriteLg,
+                         OrderedLL::iterator it);
+
     /**
      * We need to keep track of the highest seqno separately because there is a
      * small window wherein the last element of the list (though in correct
@@ -324,12 +365,15 @@ private:
          * @param ll ref to the linkedlist on which the iterator is created
          * @param isBackfill indicates if the iterator is for backfill (for
          *                   debug)
+         * @param startSeqno the iterator starts at the first item with a seqno
+         *                   >= startSeqno (or the first item if there is none)
          *
          * @return Non-null pointer on success, or null if a RangeIteratorLL
          *         already exists.
          */
         static std::unique_ptr<RangeIteratorLL> create(BasicLinkedList& ll,
-                                                       bool isBackfill);
+                                                       bool isBackfill,
+                                                       seqno_t startSeqno);
 
         ~RangeIteratorLL();
 
@@ -363,7 +407,9 @@ private:
     private:
         /* We have a private constructor because we want to create the iterator
            optionally, that is, only when it is possible to get a read lock */
-        RangeIteratorLL(BasicLinkedList& ll, bool isBackfill);
+        RangeIteratorLL(BasicLinkedList& ll,
+                        bool isBackfill,
+                        seqno_t startSeqno);
 
         /**
          * Indicates if the client should try creating the iterator at a later
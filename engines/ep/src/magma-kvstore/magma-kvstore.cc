@@ -219,6 +219,7 @@ static const Slice manifestKey = {"_collections/manifest"};
 static const Slice openCollectionsKey = {"_collections/open"};
 static const Slice openScopesKey = {"_scopes/open"};
 static const Slice droppedCollectionsKey = {"_collections/dropped"};
+static const Slice bloomFilterKey = {"_bloomfilter"};
 
 /**
  * Class representing a document to be persisted in Magma.
@@ -2369,6 +2370,59 @@ MagmaKVStore::getDroppedCollections(Vbid vbid) {
              dropped.length()});
 }
 
+bool MagmaKVStore::persistBloomFilter(Vbid vbid,
+                                      const PersistedBloomFilter& filter) {
+    auto kvHandle = getMagmaKVHandle(vbid);
+
+    if (!cachedMagmaInfo[vbid.get()]) {
+        // Nothing has been persisted for the vBucket yet.
+        return false;
+    }
+
+    std::unique_ptr<Magma::CommitBatch> batch;
+    auto status = magma->NewCommitBatch(
+            vbid.get(),
+            batch,
+            static_cast<Magma::KVStoreRevision>(
+                    cachedMagmaInfo[vbid.get()]->kvstoreRev));
+    if (!status) {
+        logger->warn(
+                "MagmaKVStore::persistBloomFilter failed creating "
+                "commitBatch for {} status:{}",
+                vbid,
+                status.String());
+        return false;
+    }
+
+    auto value = filter.encode();
+    status = setLocalDoc(*batch, bloomFilterKey, value);
+    if (status) {
+        status = magma->ExecuteCommitBatch(std::move(batch));
+    }
+    if (status) {
+        status = magma->SyncCommitBatches(commitPointEveryBatch);
+    }
+    if (!status) {
+        logger->warn("MagmaKVStore::persistBloomFilter {} status:{}",
+                     vbid,
+                     status.String());
+        return false;
+    }
+    return true;
+}
+
+PersistedBloomFilter MagmaKVStore::getBloomFilter(Vbid vbid) {
+    auto kvHandle = getMagmaKVHandle(vbid);
+
+    Status status;
+    std::string value;
+    std::tie(status, value) = readLocalDoc(vbid, bloomFilterKey);
+    if (!status) {
+        return {};
+    }
+    return PersistedBloomFilter::decode({value.data(), value.size()});
+}
+
 Status MagmaKVStore::updateCollectionsMeta(
         Vbid vbid,
         Magma::CommitBatch& commitBatch,
@@ -295,6 +295,17 @@ public:
     std::vector<Collections::KVStore::DroppedCollection> getDroppedCollections(
             Vbid vbid) override;
 
+    /**
+     * Write the filter to the local db in a commit batch of its own
+     */
+    bool persistBloomFilter(Vbid vbid,
+                            const PersistedBloomFilter& filter) override;
+
+    /**
+     * Read the filter from the local db
+     */
+    PersistedBloomFilter getBloomFilter(Vbid vbid) override;
+
     /**
      * This function maintains the set of open collections, adding newly opened
      * collections and removing those which are dropped. To validate the
@@ -17,9 +17,11 @@
 
 #include <fcntl.h>
 #include <platform/dirutils.h>
+#include <platform/memorymap.h>
 #include <platform/strerror.h>
 #include <sys/stat.h>
 #include <algorithm>
+#include <limits>
 #include <string>
 #include <system_error>
 #include <utility>
@@ -541,6 +543,12 @@ void MutationLog::open(bool _readOnly) {
         throw ReadException(e.what());
     }
     if (size && size < static_cast<int64_t>(MIN_LOG_HEADER_SIZE)) {
+        if (readOnly) {
+            // Don't reset a file which is only being read; other readers
+            // may have it open.
+            close();
+            throw ShortReadException();
+        }
         try {
             EP_LOG_WARN("WARNING: Corrupted access log '{}'", getLogFile());
             reset();
@@ -569,6 +577,17 @@ void MutationLog::open(bool _readOnly) {
         if (!readOnly) {
             headerBlock.setRdwr(1);
             updateInitialBlock();
+        } else {
+            try {
+                mappedFile = std::make_unique<cb::io::MemoryMappedFile>(
+                        logPath.c_str(),
+                        cb::io::MemoryMappedFile::Mode::RDONLY);
+            } catch (const std::exception& e) {
+                // Not fatal; the blocks are read from the file instead.
+                EP_LOG_WARN("Failed to memory-map log '{}': {}",
+                            getLogFile(),
+                            e.what());
+            }
         }
     }
 
@@ -591,6 +610,7 @@ void MutationLog::close() {
         updateInitialBlock();
     }
 
+    mappedFile.reset();
     doClose(file);
     file = INVALID_FILE_VALUE;
 }
@@ -724,17 +744,25 @@ void MutationLog::writeEntry(MutationLogEntry *mle) {
 
 MutationLog::iterator::iterator(const MutationLog* l, bool e)
     : log(l),
-      offset(l->header().blockSize() * l->header().blockCount()),
+      offset(blockOffset(l, 0)),
+      endOffset(std::numeric_limits<off_t>::max()),
       items(0),
       isEnd(e) {
 }
 
+off_t MutationLog::iterator::blockOffset(const MutationLog* l, size_t block) {
+    // The data blocks follow the header block(s).
+    return off_t(l->header().blockSize()) *
+           (l->header().blockCount() + block);
+}
+
 MutationLog::iterator::iterator(const MutationLog::iterator& mit)
     : log(mit.log),
       entryBuf(mit.entryBuf),
       buf(mit.buf),
       p(buf.begin() + (mit.p - mit.buf.begin())),
       offset(mit.offset),
+      endOffset(mit.endOffset),
       items(mit.items),
       isEnd(mit.isEnd) {
 }
@@ -746,6 +774,7 @@ MutationLog::iterator& MutationLog::iterator::operator=(const MutationLog::itera
     buf = other.buf;
     p = buf.begin() + (other.p - other.buf.begin());
     offset = other.offset;
+    endOffset = other.endOffset;
     items = other.items;
     isEnd = other.isEnd;
 
@@ -946,8 +975,26 @@ void MutationLog::iterator::nextBlock() {
                 "log is enabled and not open");
     }
 
+    if (offset >= endOffset) {
+        isEnd = true;
+        return;
+    }
+
     buf.resize(log->header().blockSize());
-    ssize_t bytesread = pread(log->fd(), buf.data(), buf.size(), offset);
+    ssize_t bytesread;
+    if (log->mappedFile) {
+        // Copy the block from the mapping; the same as a pread but without
+        // the system call per block.
+        const auto content = log->mappedFile->content();
+        const size_t available =
+                size_t(offset) < content.size() ? content.size() - offset : 0;
+        bytesread = std::min(available, buf.size());
+        std::copy_n(reinterpret_cast<const uint8_t*>(content.data()) + offset,
+                    bytesread,
+                    buf.begin());
+    } else {
+        bytesread = pread(log->fd(), buf.data(), buf.size(), offset);
+    }
     if (bytesread < 1) {
         isEnd = true;
         return;
@@ -985,6 +1032,28 @@ void MutationLog::iterator::nextBlock() {
     prepItem();
 }
 
+MutationLog::iterator MutationLog::begin(size_t firstBlock, size_t lastBlock) {
+    iterator it(this);
+    it.offset = iterator::blockOffset(this, firstBlock);
+    it.endOffset = iterator::blockOffset(this, lastBlock);
+    it.nextBlock();
+    return it;
+}
+
+size_t MutationLog::getNumBlocks() const {
+    int64_t size;
+    try {
+        size = getFileSize(file);
+    } catch (std::system_error& e) {
+        throw ReadException(e.what());
+    }
+    const auto start = iterator::blockOffset(this, 0);
+    if (size <= start) {
+        return 0;
+    }
+    return (size - start) / headerBlock.blockSize();
+}
+
 void MutationLog::resetCounts(size_t *items) {
     for (int i(0); i < int(MutationLogType::NumberOfTypes); ++i) {
         itemsLogged[i] = items[i];
@@ -54,6 +54,12 @@
 #include <vector>
 
 
+namespace cb {
+namespace io {
+class MemoryMappedFile;
+}
+} // namespace cb
+
 #define ML_BUFLEN (128 * 1024 * 1024)
 
 #ifdef WIN32
@@ -230,6 +236,11 @@ public:
         return file != INVALID_FILE_VALUE;
     }
 
+    /// @returns true if the log is open read-only and memory-mapped.
+    bool isMapped() const {
+        return mappedFile != nullptr;
+    }
+
     LogHeaderBlock header() const {
         return headerBlock;
     }
@@ -253,7 +264,11 @@ public:
     /**
      * Open and initialize the log.
      *
-     * This typically happens automatically.
+     * This typically happens automatically. A log opened read-only is also
+     * memory-mapped (if possible), so iterating over it reads the blocks from
+     * the mapping rather than with a read call per block; several readers
+     * (each with their own read-only MutationLog) can then share the file's
+     * pages.
      */
     void open(bool _readOnly = false);
 
@@ -392,6 +407,9 @@ public:
 
         iterator(const MutationLog* l, bool e=false);
 
+        /// @returns the offset of the given (data) block in the log
+        static off_t blockOffset(const MutationLog* l, size_t block);
+
         /// @returns the length of the entry the iterator is currently at
         size_t getCurrentEntryLen() const;
         void nextBlock();
@@ -409,6 +427,8 @@ public:
         std::vector<uint8_t> buf;
         std::vector<uint8_t>::const_iterator p;
         off_t              offset;
+        /// Offset at which iteration stops (the end of the log by default)
+        off_t              endOffset;
         uint16_t           items;
         bool               isEnd;
     };
@@ -422,6 +442,13 @@ public:
         return it;
     }
 
+    /**
+     * An iterator over the entries of the (data) blocks [firstBlock,
+     * lastBlock) of the log file; it compares equal to end() once past
+     * lastBlock. Lets several readers each read their own part of the log.
+     */
+    iterator begin(size_t firstBlock, size_t lastBlock);
+
     /**
      * An iterator pointing at the end of the log file.
      */
@@ -429,6 +456,9 @@ public:
         return iterator(this, true);
     }
 
+    /// @returns the number of (data) blocks in the open log file.
+    size_t getNumBlocks() const;
+
     //! Items logged by type.
     std::atomic<size_t> itemsLogged[int(MutationLogType::NumberOfTypes)];
     //! Flush time histogram.
@@ -465,6 +495,8 @@ private:
     std::unique_ptr<uint8_t[]> blockBuffer;
     uint8_t            syncConfig;
     bool               readOnly;
+    /// Mapping of the whole file, when opened read-only.
+    std::unique_ptr<cb::io::MemoryMappedFile> mappedFile;
 
     friend std::ostream& operator<<(std::ostream& os, const MutationLog& mlog);
 
@@ -0,0 +1,288 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2019 Couchbase, Inc
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+/**
+ * An insert-only hash map using open addressing (linear probing), used for
+ * the Checkpoint key indexes.
+ *
+ * Entries are stored inline in a single array of slots, with a parallel
+ * array of one-byte tags (0 for an empty slot, otherwise 7 bits of the
+ * hash), so a lookup is normally one hash computation and a scan of adjacent
+ * tags with no pointer chasing; and adding an entry only allocates when the
+ * table grows. Unlike std::unordered_map, iterators and references are
+ * invalidated when the table grows.
+ *
+ * Entries cannot be erased, as the Checkpoint indexes only ever grow (until
+ * the Checkpoint is destroyed). The subset of the std::unordered_map
+ * interface they use is provided.
+ */
+template <class Key,
+          class T,
+          class Hash = std::hash<Key>,
+          class KeyEqual = std::equal_to<Key>,
+          class Allocator = std::allocator<std::pair<Key, T>>>
+class OpenHashMap {
+public:
+    using key_type = Key;
+    using mapped_type = T;
+    using value_type = std::pair<Key, T>;
+    using size_type = size_t;
+    using allocator_type = Allocator;
+
+    template <class V>
+    class Iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = std::remove_const_t<V>;
+        using difference_type = ptrdiff_t;
+        using pointer = V*;
+        using reference = V&;
+
+        Iterator() = default;
+
+        /// Allow conversion from iterator to const_iterator.
+        template <class U>
+        Iterator(const Iterator<U>& other)
+            : tag(other.tag), end(other.end), slot(other.slot) {
+        }
+
+        reference operator*() const {
+            return *slot;
+        }
+
+        pointer operator->() const {
+            return slot;
+        }
+
+        Iterator& operator++() {
+            ++tag;
+            ++slot;
+            skipEmpty();
+            return *this;
+        }
+
+        Iterator operator++(int) {
+            auto before = *this;
+            operator++();
+            return before;
+        }
+
+        bool operator==(const Iterator& other) const {
+            return tag == other.tag;
+        }
+
+        bool operator!=(const Iterator& other) const {
+            return tag != other.tag;
+        }
+
+    private:
+        friend class OpenHashMap;
+        template <class U>
+        friend class Iterator;
+
+        Iterator(const uint8_t* tag, const uint8_t* end, V* slot)
+            : tag(tag), end(end), slot(slot) {
+        }
+
+        void skipEmpty() {
+            while (tag != end && *tag == 0) {
+                ++tag;
+                ++slot;
+            }
+        }
+
+        const uint8_t* tag = nullptr;
+        const uint8_t* end = nullptr;
+        V* slot = nullptr;
+    };
+
+    using iterator = Iterator<value_type>;
+    using const_iterator = Iterator<const value_type>;
+
+    explicit OpenHashMap(const Allocator& alloc) : slotAllocator(alloc) {
+    }
+
+    OpenHashMap(const OpenHashMap&) = delete;
+    OpenHashMap& operator=(const OpenHashMap&) = delete;
+
+    ~OpenHashMap() {
+        release();
+    }
+
+    iterator begin() {
+        iterator it(tags, tags + capacity, slots);
+        it.skipEmpty();
+        return it;
+    }
+
+    iterator end() {
+        return iterator(tags + capacity, tags + capacity, slots + capacity);
+    }
+
+    const_iterator begin() const {
+        return const_cast<OpenHashMap*>(this)->begin();
+    }
+
+    const_iterator end() const {
+        return const_cast<OpenHashMap*>(this)->end();
+    }
+
+    size_t size() const {
+        return count;
+    }
+
+    bool empty() const {
+        return count == 0;
+    }
+
+    iterator find(const Key& key) {
+        if (capacity == 0) {
+            return end();
+        }
+        const auto h = mix(key);
+        const auto tag = toTag(h);
+        for (size_t i = toIndex(h);; i = (i + 1) & (capacity - 1)) {
+            if (tags[i] == 0) {
+                return end();
+            }
+            if (tags[i] == tag && KeyEqual()(slots[i].first, key)) {
+                return makeIterator(i);
+            }
+        }
+    }
+
+    const_iterator find(const Key& key) const {
+        return const_cast<OpenHashMap*>(this)->find(key);
+    }
+
+    /**
+     * Insert the given key and value if the key is not already present.
+     * @returns the iterator to the element with the key, and true if it was
+     *          inserted.
+     */
+    template <class K, class V>
+    std::pair<iterator, bool> emplace(K&& key, V&& value) {
+        // Grow at a load factor of 3/4.
+        if ((count + 1) * 4 > capacity * 3) {
+            rehash(capacity ? capacity * 2 : MinCapacity);
+        }
+        const auto h = mix(key);
+        const auto tag = toTag(h);
+        size_t i = toIndex(h);
+        for (; tags[i] != 0; i = (i + 1) & (capacity - 1)) {
+            if (tags[i] == tag && KeyEqual()(slots[i].first, key)) {
+                return {makeIterator(i), false};
+            }
+        }
+        new (&slots[i]) value_type(std::forward<K>(key), std::forward<V>(value));
+        tags[i] = tag;
+        ++count;
+        return {makeIterator(i), true};
+    }
+
+    allocator_type get_allocator() const {
+        return allocator_type(slotAllocator);
+    }
+
+private:
+    using SlotAllocator = typename std::allocator_traits<
+            Allocator>::template rebind_alloc<value_type>;
+    using TagAllocator = typename std::allocator_traits<
+            Allocator>::template rebind_alloc<uint8_t>;
+
+    static constexpr size_t MinCapacity = 8;
+
+    /// Spread the (possibly weak) hash over all 64 bits.
+    static uint64_t mix(const Key& key) {
+        return uint64_t(Hash()(key)) * 0x9E3779B97F4A7C15ull;
+    }
+
+    static uint8_t toTag(uint64_t h) {
+        return uint8_t(0x80 | (h >> 57));
+    }
+
+    size_t toIndex(uint64_t h) const {
+        // Use the high bits, which the multiplication mixes best.
+        return size_t(h >> 32) & (capacity - 1);
+    }
+
+    iterator makeIterator(size_t i) {
+        return iterator(tags + i, tags + capacity, slots + i);
+    }
+
+    void rehash(size_t newCapacity) {
+        uint8_t* oldTags = tags;
+        value_type* oldSlots = slots;
+        const size_t oldCapacity = capacity;
+
+        TagAllocator tagAllocator(slotAllocator);
+        tags = tagAllocator.allocate(newCapacity);
+        std::memset(tags, 0, newCapacity);
+        slots = slotAllocator.allocate(newCapacity);
+        capacity = newCapacity;
+
+        for (size_t i = 0; i < oldCapacity; ++i) {
+            if (oldTags[i] == 0) {
+                continue;
+            }
+            size_t j = toIndex(mix(oldSlots[i].first));
+            while (tags[j] != 0) {
+                j = (j + 1) & (capacity - 1);
+            }
+            new (&slots[j]) value_type(std::move(oldSlots[i]));
+            tags[j] = oldTags[i];
+            oldSlots[i].~value_type();
+        }
+
+        if (oldCapacity) {
+            tagAllocator.deallocate(oldTags, oldCapacity);
+            slotAllocator.deallocate(oldSlots, oldCapacity);
+        }
+    }
+
+    void release() {
+        if (capacity == 0) {
+            return;
+        }
+        for (size_t i = 0; i < capacity; ++i) {
+            if (tags[i] != 0) {
+                slots[i].~value_type();
+            }
+        }
+        TagAllocator(slotAllocator).deallocate(tags, capacity);
+        slotAllocator.deallocate(slots, capacity);
+    }
+
+    SlotAllocator slotAllocator;
+    uint8_t* tags = nullptr;
+    value_type* slots = nullptr;
+    /// Number of slots; zero or a power of two.
+    size_t capacity = 0;
+    /// Number of elements.
+    size_t count = 0;
+};
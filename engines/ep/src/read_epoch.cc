@@ -0,0 +1,149 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2019 Couchbase, Inc
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+
+#include "read_epoch.h"
+
+#include "objectregistry.h"
+
+#include <folly/CachelinePadded.h>
+
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+/// Epoch recorded by a thread which isn't in a read-side critical section.
+constexpr uint64_t idleEpoch = std::numeric_limits<uint64_t>::max();
+
+std::atomic<uint64_t> globalEpoch{1};
+
+/// Result of the last advance(). Once safe to free, an object stays safe to
+/// free - so it doesn't matter if a concurrent advance() overwrites this
+/// with an older epoch.
+std::atomic<uint64_t> reclaimableEpoch{0};
+
+/// The epoch a thread's reader started in (or idleEpoch).
+using Record = folly::CachelinePadded<std::atomic<uint64_t>>;
+
+/// The records of all threads which have entered a critical section.
+struct Registry {
+    std::mutex mutex;
+    std::vector<Record*> records;
+};
+
+Registry& getRegistry() {
+    // Intentionally leaked - threads may exit (and unregister) after static
+    // destructors have run.
+    static Registry* registry = [] {
+        NonBucketAllocationGuard guard;
+        return new Registry;
+    }();
+    return *registry;
+}
+
+/// Registers the calling thread's record on first use; unregisters it on
+/// thread exit.
+struct ThreadRecord {
+    ThreadRecord() {
+        NonBucketAllocationGuard guard;
+        record = new Record(idleEpoch);
+        auto& registry = getRegistry();
+        std::lock_guard<std::mutex> lh(registry.mutex);
+        registry.records.push_back(record);
+    }
+
+    ~ThreadRecord() {
+        NonBucketAllocationGuard guard;
+        auto& registry = getRegistry();
+        {
+            std::lock_guard<std::mutex> lh(registry.mutex);
+            registry.records.erase(std::remove(registry.records.begin(),
+                                               registry.records.end(),
+                                               record),
+                                   registry.records.end());
+        }
+        delete record;
+    }
+
+    Record* record;
+    /// Nesting depth of Guards on this thread.
+    int depth = 0;
+};
+
+thread_local ThreadRecord threadRecord;
+
+/**
+ * @return the oldest epoch any reader is in; or the given (current) epoch if
+ *         there are no readers.
+ */
+uint64_t oldestReader(uint64_t epoch) {
+    // Order the caller's unlinks / epoch increment before reading the
+    // records; pairs with the fence in Guard::Guard.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    auto& registry = getRegistry();
+    std::lock_guard<std::mutex> lh(registry.mutex);
+    for (auto* record : registry.records) {
+        epoch = std::min(epoch, (*record)->load(std::memory_order_acquire));
+    }
+    return epoch;
+}
+
+} // anonymous namespace
+
+ReadEpoch::Guard::Guard() {
+    if (threadRecord.depth++ == 0) {
+        auto& epoch = **threadRecord.record;
+        epoch.store(globalEpoch.load(std::memory_order_relaxed),
+                    std::memory_order_relaxed);
+        // Order the announcement before the reads in the critical section.
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+}
+
+ReadEpoch::Guard::~Guard() {
+    if (--threadRecord.depth == 0) {
+        (*threadRecord.record)->store(idleEpoch, std::memory_order_release);
+    }
+}
+
+uint64_t ReadEpoch::retireEpoch() {
+    // Order the unlink before reading the epoch: a reader which announces
+    // the returned epoch (or later) cannot find the object.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    return globalEpoch.load(std::memory_order_relaxed) + 1;
+}
+
+uint64_t ReadEpoch::advance() {
+    const auto epoch = oldestReader(globalEpoch.fetch_add(1) + 1);
+    reclaimableEpoch.store(epoch, std::memory_order_relaxed);
+    return epoch;
+}
+
+uint64_t ReadEpoch::lastReclaimable() {
+    return reclaimableEpoch.load(std::memory_order_relaxed);
+}
+
+void ReadEpoch::synchronize() {
+    const auto epoch = globalEpoch.fetch_add(1) + 1;
+    while (oldestReader(epoch) < epoch) {
+        std::this_thread::yield();
+    }
+}
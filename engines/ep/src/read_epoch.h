@@ -0,0 +1,79 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2019 Couchbase, Inc
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+/**
+ * Epoch-based reclamation for objects read without holding the lock which
+ * guards them (see HashTable::findForReadOptimistic).
+ *
+ * A reader brackets its lock-free accesses with a ReadEpoch::Guard, which
+ * announces the global epoch the reader started in. A writer which unlinks
+ * an object (under the lock) doesn't free it immediately; it stamps it with
+ * ReadEpoch::retireEpoch() and holds on to it until ReadEpoch::advance()
+ * reports that no reader which started before the unlink is still reading.
+ *
+ * Readers only write to their own (thread-local, cache-line sized) record,
+ * so concurrent readers don't contend with each other. Writers pay for the
+ * scan of all reader records, but only when reclaiming a batch of objects.
+ */
+class ReadEpoch {
+public:
+    /**
+     * RAII guard for a read-side critical section. Objects retired after
+     * the guard was created are not freed until it is destroyed. Guards may
+     * be nested (only the outermost one has any effect).
+     */
+    class Guard {
+    public:
+        Guard();
+        ~Guard();
+
+        Guard(const Guard&) = delete;
+        Guard& operator=(const Guard&) = delete;
+    };
+
+    /**
+     * @return the epoch to stamp an object with, after unlinking it (so no
+     *         new reader can find it).
+     */
+    static uint64_t retireEpoch();
+
+    /**
+     * Advance the global epoch.
+     *
+     * @return the oldest epoch a reader may still be reading in; objects
+     *         stamped with an epoch no greater than this may be freed.
+     */
+    static uint64_t advance();
+
+    /**
+     * @return the epoch advance() last returned - objects stamped with an
+     *         epoch no greater than this may be freed - without scanning the
+     *         readers.
+     */
+    static uint64_t lastReclaimable();
+
+    /**
+     * Wait until all readers which are currently in a critical section have
+     * left it. Used before changes which can't be detected by the readers
+     * (e.g. freeing a whole table); expensive, so only for rare operations.
+     */
+    static void synchronize();
+};
@@ -74,7 +74,8 @@ protected:
      * (c) Reading all the items from the iterator results in point-in-time
      *     snapshot.
      * (d) Only 1 iterator can be created for now.
-     * (e) Currently iterator can be created only from start till end
+     * (e) Iterator reads till the end of the list, from the start or from a
+     *     given seqno
      */
     class RangeIteratorImpl {
     public:
@@ -425,12 +426,15 @@ public:
      * the SequenceList, new range iterator will not be allowed
      *
      * @param isBackfill indicates if the iterator is for backfill (for debug)
+     * @param startSeqno the iterator starts at the first item with a seqno
+     *                   >= startSeqno (or at the first item, if there is
+     *                   none)
      *
      * @return range iterator object when possible
      *         null when not possible
      */
     virtual boost::optional<SequenceList::RangeIterator> makeRangeIterator(
-            bool isBackfill) = 0;
+            bool isBackfill, seqno_t startSeqno = 0) = 0;
 
     /**
      * Debug - prints a representation of the list to stderr.
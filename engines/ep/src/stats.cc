@@ -68,6 +68,7 @@ EPStats::EPStats()
       expiryPagerRuns(0),
       freqDecayerRuns(0),
       itemsExpelledFromCheckpoints(0),
+      memFreedByCheckpointItemExpel(0),
       itemsRemovedFromCheckpoints(0),
       numValueEjects(0),
       numFailedEjects(0),
@@ -288,6 +289,7 @@ void EPStats::reset() {
     expiryPagerRuns.store(0);
     freqDecayerRuns.store(0);
     itemsExpelledFromCheckpoints.store(0);
+    memFreedByCheckpointItemExpel.store(0);
     itemsRemovedFromCheckpoints.store(0);
     numValueEjects.store(0);
     numFailedEjects.store(0);
@@ -324,6 +326,7 @@ void EPStats::reset() {
     checkpointRemoverHisto.reset();
     itemPagerHisto.reset();
     expiryPagerHisto.reset();
+    htResizeStallHisto.reset();
     getVbucketCmdHisto.reset();
     setVbucketCmdHisto.reset();
     delVbucketCmdHisto.reset();
@@ -372,6 +375,7 @@ size_t EPStats::getMemFootPrint() const {
            checkpointRemoverHisto.getMemFootPrint() +
            itemPagerHisto.getMemFootPrint() +
            expiryPagerHisto.getMemFootPrint() +
+           htResizeStallHisto.getMemFootPrint() +
            getVbucketCmdHisto.getMemFootPrint() +
            setVbucketCmdHisto.getMemFootPrint() +
            delVbucketCmdHisto.getMemFootPrint() +
@@ -236,6 +236,8 @@ public:
     Counter freqDecayerRuns;
     //! The number items expelled from checkpoints
     Counter itemsExpelledFromCheckpoints;
+    //! Estimated amount of memory freed by expelling checkpoint items
+    Counter memFreedByCheckpointItemExpel;
     //! Number of items removed from closed unreferenced checkpoints.
     Counter itemsRemovedFromCheckpoints;
     //! Number of times a value is ejected
@@ -328,6 +330,10 @@ public:
     Hdr1sfMicroSecHistogram itemPagerHisto;
     //! Histogram of expiry pager run times
     Hdr1sfMicroSecHistogram expiryPagerHisto;
+    //! Histogram of durations HashTable resizing blocked access to (part of)
+    //! a HashTable - the whole resize for a blocking resize; each all-lock
+    //! phase and each bucket migration for an incremental resize.
+    Hdr1sfMicroSecHistogram htResizeStallHisto;
 
     //! Percentage of memory in use before we throttle replication input
     std::atomic<double> replicationThrottleThreshold;
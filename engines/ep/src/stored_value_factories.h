@@ -54,6 +54,16 @@ public:
      */
     virtual StoredValue::UniquePtr copyStoredValue(const StoredValue& other,
                                                    StoredValue::UniquePtr next) = 0;
+
+    /**
+     * @return true if the StoredValues created may be read without holding
+     *         the HashTable lock (see HashTable::findForReadOptimistic).
+     *         Not possible if they are also owned (and freed) outside of the
+     *         HashTable.
+     */
+    virtual bool supportsOptimisticReads() const {
+        return true;
+    }
 };
 
 /**
@@ -101,6 +111,14 @@ public:
     StoredValue::UniquePtr copyStoredValue(
             const StoredValue& other, StoredValue::UniquePtr next) override;
 
+    /**
+     * OrderedStoredValues are also linked into (and released by) the
+     * Ephemeral sequence list.
+     */
+    bool supportsOptimisticReads() const override {
+        return false;
+    }
+
 private:
     EPStats* stats;
 };
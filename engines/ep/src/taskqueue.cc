@@ -23,7 +23,10 @@
 #include <cmath>
 
 TaskQueue::TaskQueue(ExecutorPool *m, task_type_t t, const char *nm) :
-    name(nm), queueType(t), manager(m), sleepers(0)
+    name(nm), queueType(t), manager(m), sleepers(0),
+    nextReadyTime(std::chrono::steady_clock::time_point::max()
+                          .time_since_epoch()
+                          .count())
 {
     // EMPTY
 }
@@ -58,6 +61,17 @@ ExTask TaskQueue::_popReadyTask(void) {
     return t;
 }
 
+void TaskQueue::_updateNextReadyTime() {
+    auto next = std::chrono::steady_clock::time_point::max();
+    if (!readyQueue.empty() || !pendingQueue.empty()) {
+        next = std::chrono::steady_clock::time_point::min();
+    } else {
+        next = futureQueue.nextWaketime();
+    }
+    nextReadyTime.store(next.time_since_epoch().count(),
+                        std::memory_order_release);
+}
+
 void TaskQueue::doWake(size_t &numToWake) {
     LockHolder lh(mutex);
     _doWake_UNLOCKED(numToWake);
@@ -82,9 +96,7 @@ bool TaskQueue::_doSleep(ExecutorThread &t,
 
     // Determine the time point to wake this thread - either "forever" if the
     // futureQueue is empty, or the earliest wake time in the futureQueue.
-    const auto wakeTime = futureQueue.empty()
-                                  ? std::chrono::steady_clock::time_point::max()
-                                  : futureQueue.top()->getWaketime();
+    const auto wakeTime = futureQueue.nextWaketime();
 
     if (t.getCurTime() < wakeTime && manager->trySleep(queueType)) {
         // Atomically switch from running to sleeping; iff we were previously
@@ -121,23 +133,36 @@ bool TaskQueue::_doSleep(ExecutorThread &t,
 }
 
 bool TaskQueue::_sleepThenFetchNextTask(ExecutorThread& t) {
-    std::unique_lock<std::mutex> lh(mutex);
-    if (!_doSleep(t, lh)) {
-        return false; // shutting down
+    size_t numToWake = 0;
+    bool ret;
+    {
+        std::unique_lock<std::mutex> lh(mutex);
+        if (!_doSleep(t, lh)) {
+            return false; // shutting down
+        }
+        ret = _fetchNextTaskInner(t, lh, numToWake);
     }
-    return _fetchNextTaskInner(t, lh);
+    manager->wakeStealers(queueType, numToWake);
+    return ret;
 }
 
 bool TaskQueue::_fetchNextTask(ExecutorThread& t) {
-    std::unique_lock<std::mutex> lh(mutex);
-    return _fetchNextTaskInner(t, lh);
+    size_t numToWake = 0;
+    bool ret;
+    {
+        std::unique_lock<std::mutex> lh(mutex);
+        ret = _fetchNextTaskInner(t, lh, numToWake);
+    }
+    manager->wakeStealers(queueType, numToWake);
+    return ret;
 }
 
 bool TaskQueue::_fetchNextTaskInner(ExecutorThread& t,
-                                    const std::unique_lock<std::mutex>&) {
+                                    const std::unique_lock<std::mutex>&,
+                                    size_t& numToWake) {
     bool ret = false;
 
-    size_t numToWake = _moveReadyTasks(t.getCurTime());
+    numToWake = _moveReadyTasks(t.getCurTime());
 
     if (!readyQueue.empty() && readyQueue.top()->isdead()) {
         t.setCurrentTask(_popReadyTask()); // clean out dead tasks first
@@ -153,12 +178,18 @@ bool TaskQueue::_fetchNextTaskInner(ExecutorThread& t,
     } else { // Let the task continue waiting in pendingQueue
         numToWake = numToWake ? numToWake - 1 : 0; // 1 fewer task ready
     }
+    _updateNextReadyTime();
 
+    // Any tasks left for which we have no sleeping threads may be picked up
+    // by threads of other types (see ExecutorPool::wakeStealers)
     _doWake_UNLOCKED(numToWake);
     return ret;
 }
 
 bool TaskQueue::fetchNextTask(ExecutorThread& thread) {
+    if (!mayHaveReadyTask(thread.getCurTime())) {
+        return false;
+    }
     NonBucketAllocationGuard guard;
     return _fetchNextTask(thread);
 }
@@ -174,17 +205,8 @@ size_t TaskQueue::_moveReadyTasks(
         return 0;
     }
 
-    size_t numReady = 0;
-    while (!futureQueue.empty()) {
-        ExTask tid = futureQueue.top();
-        if (tid->getWaketime() <= tv) {
-            futureQueue.pop();
-            readyQueue.push(tid);
-            numReady++;
-        } else {
-            break;
-        }
-    }
+    const size_t numReady = futureQueue.popReady(
+            tv, [this](ExTask tid) { readyQueue.push(std::move(tid)); });
 
     manager->addWork(numReady, queueType);
 
@@ -205,7 +227,8 @@ std::chrono::steady_clock::time_point TaskQueue::_reschedule(ExTask& task) {
     LockHolder lh(mutex);
 
     futureQueue.push(task);
-    return futureQueue.top()->getWaketime();
+    _updateNextReadyTime();
+    return futureQueue.nextWaketime();
 }
 
 std::chrono::steady_clock::time_point TaskQueue::reschedule(ExTask& task) {
@@ -226,6 +249,7 @@ void TaskQueue::_schedule(ExTask &task) {
         task->setState(TASK_RUNNING, TASK_DEAD);
 
         futureQueue.push(task);
+        _updateNextReadyTime();
 
         EP_LOG_TRACE("{}: Schedule a task \"{}\" id {}",
                      name,
@@ -238,6 +262,8 @@ void TaskQueue::_schedule(ExTask &task) {
     if (this != sleepQ) {
         sleepQ->doWake(numToWake);
     }
+    // None of our threads are idle; let a thread of another type help
+    manager->wakeStealers(queueType, numToWake);
 }
 
 void TaskQueue::schedule(ExTask &task) {
@@ -286,6 +312,7 @@ void TaskQueue::_wake(ExTask &task) {
             futureQueue.push(tid);
             notReady.pop();
         }
+        _updateNextReadyTime();
 
         _doWake_UNLOCKED(readyCount);
         sleepQ = manager->getSleepQ(queueType);
@@ -293,6 +320,14 @@ void TaskQueue::_wake(ExTask &task) {
     if (this != sleepQ) {
         sleepQ->doWake(readyCount);
     }
+    // None of our threads are idle; let a thread of another type help
+    manager->wakeStealers(queueType, readyCount);
+}
+
+void TaskQueue::snooze(ExTask& task, const double secs) {
+    LockHolder lh(mutex);
+    futureQueue.snooze(task, secs);
+    _updateNextReadyTime();
 }
 
 void TaskQueue::wake(ExTask &task) {
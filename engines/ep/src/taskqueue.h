@@ -15,10 +15,11 @@
  */
 #pragma once
 
-#include "futurequeue.h"
 #include "syncobject.h"
 #include "task_type.h"
+#include "timer_wheel.h"
 
+#include <atomic>
 #include <chrono>
 #include <list>
 #include <queue>
@@ -35,12 +36,13 @@ public:
     void schedule(ExTask &task);
 
     /**
-     * Reschedules the given task, adding it onto the futureQueue (sorted by
-     * each task's waketime.
+     * Reschedules the given task, adding it onto the futureQueue (keyed by
+     * each task's waketime).
      *
      * @param task Task to reschedule.
-     * @return The waketime of the earliest (next) task in the futureQueue -
-     *         note this isn't necessarily the same as `task`.
+     * @return The (lower bound of the) waketime of the earliest (next) task
+     *         in the futureQueue - note this isn't necessarily the same as
+     *         `task`.
      */
     std::chrono::steady_clock::time_point reschedule(ExTask& task);
 
@@ -51,10 +53,20 @@ public:
     /**
      * Fetch the next task to be run from the task queues, updating
      * thread::currentTask with the next task to run (if one found).
+     * Returns without taking the lock if no task can be ready yet.
      * @returns true if there is a task to run, otherwise false.
      */
     bool fetchNextTask(ExecutorThread& thread);
 
+    /**
+     * Check (without taking the lock) if a task in this queue may be ready
+     * to run at the given time.
+     */
+    bool mayHaveReadyTask(std::chrono::steady_clock::time_point now) const {
+        return now.time_since_epoch().count() >=
+               nextReadyTime.load(std::memory_order_acquire);
+    }
+
     /**
      * Sleeps until the next task is ready to run, waking up when ready and
      * updating thread::currentTask with the task to run.
@@ -76,9 +88,7 @@ public:
 
     size_t getPendingQueueSize();
 
-    void snooze(ExTask& task, const double secs) {
-        futureQueue.snooze(task, secs);
-    }
+    void snooze(ExTask& task, const double secs);
 
 private:
     void _schedule(ExTask &task);
@@ -87,12 +97,14 @@ private:
     bool _sleepThenFetchNextTask(ExecutorThread& t);
     bool _fetchNextTask(ExecutorThread& thread);
     bool _fetchNextTaskInner(ExecutorThread& t,
-                             const std::unique_lock<std::mutex>& lh);
+                             const std::unique_lock<std::mutex>& lh,
+                             size_t& numToWake);
     void _wake(ExTask &task);
     bool _doSleep(ExecutorThread &thread, std::unique_lock<std::mutex>& lock);
     void _doWake_UNLOCKED(size_t &numToWake);
     size_t _moveReadyTasks(const std::chrono::steady_clock::time_point tv);
     ExTask _popReadyTask(void);
+    void _updateNextReadyTime();
 
     SyncObject mutex;
     const std::string name;
@@ -104,8 +116,18 @@ private:
     std::priority_queue<ExTask, std::deque<ExTask>,
                         CompareByPriority> readyQueue;
 
-    // sorted by waketime. Guarded by `mutex`.
-    FutureQueue<> futureQueue;
+    // keyed by waketime. Guarded by `mutex`.
+    TimerWheel futureQueue;
 
     std::list<ExTask> pendingQueue;
+
+    /**
+     * The earliest time a task in this queue may be ready to run (as
+     * steady_clock ticks): min() if the readyQueue or pendingQueue has a
+     * task, otherwise the next waketime of the futureQueue (max() if it is
+     * empty). Written under `mutex` whenever the queues
+     * change, and read without it so that threads looking for work don't
+     * contend on the lock of queues with nothing to run.
+     */
+    std::atomic<std::chrono::steady_clock::rep> nextReadyTime;
 };
@@ -33,6 +33,23 @@ bool FlusherTask::run() {
     return flusher->step(this);
 }
 
+FlushBatchPrepareTask::FlushBatchPrepareTask(EPBucket& bucket, Vbid vbid)
+    : GlobalTask(&bucket.getEPEngine(),
+                 TaskId::FlushBatchPrepareTask,
+                 0,
+                 false /* completeBeforeShutdown */),
+      bucket(bucket),
+      vbid(vbid) {
+    desc = "Preparing flush batch for " + vbid.to_string();
+}
+
+bool FlushBatchPrepareTask::run() {
+    TRACE_EVENT1(
+            "ep-engine/task", "FlushBatchPrepareTask", "vbid", vbid.get());
+    bucket.prepareFlush(vbid);
+    return false;
+}
+
 CompactTask::CompactTask(EPBucket& bucket,
                          const CompactionConfig& c,
                          uint64_t purgeSeqno,
@@ -78,17 +95,19 @@ bool StatSnap::run() {
 }
 
 MultiBGFetcherTask::MultiBGFetcherTask(EventuallyPersistentEngine* e,
-                                       BgFetcher* b)
+                                       BgFetcher* b,
+                                       size_t partition)
     : GlobalTask(e,
                  TaskId::MultiBGFetcherTask,
                  /*sleeptime*/ INT_MAX,
                  /*completeBeforeShutdown*/ false),
-      bgfetcher(b) {
+      bgfetcher(b),
+      partition(partition) {
 }
 
 bool MultiBGFetcherTask::run() {
     TRACE_EVENT0("ep-engine/task", "MultiBGFetcherTask");
-    return bgfetcher->run(this);
+    return bgfetcher->run(this, partition);
 }
 
 bool VKeyStatBGFetchTask::run() {
@@ -34,6 +34,7 @@ TASK(Warmup, READER_TASK_IDX, 0)
 TASK(WarmupInitialize, READER_TASK_IDX, 0)
 TASK(WarmupCreateVBuckets, READER_TASK_IDX, 0)
 TASK(WarmupLoadingCollectionCounts, READER_TASK_IDX, 0)
+TASK(WarmupLoadingBloomFilters, READER_TASK_IDX, 0)
 TASK(WarmupEstimateDatabaseItemCount, READER_TASK_IDX, 0)
 TASK(WarmupLoadPreparedSyncWrites, READER_TASK_IDX, 0)
 TASK(WarmupPopulateVBucketMap, READER_TASK_IDX, 0)
@@ -69,6 +70,7 @@ TASK(ExpiredItemPager, NONIO_TASK_IDX, 1)
 TASK(ItemPagerVisitor, NONIO_TASK_IDX, 1)
 TASK(ExpiredItemPagerVisitor, NONIO_TASK_IDX, 1)
 TASK(DcpConsumerTask, NONIO_TASK_IDX, 2)
+TASK(FlushBatchPrepareTask, NONIO_TASK_IDX, 2)
 TASK(DurabilityCompletionTask, NONIO_TASK_IDX, 1)
 TASK(DurabilityTimeoutTask, NONIO_TASK_IDX, 1)
 TASK(DurabilityTimeoutVisitor, NONIO_TASK_IDX, 1)
@@ -65,6 +65,31 @@ private:
     std::string desc;
 };
 
+/**
+ * A task which prepares the next flush batch of a vBucket while the Flusher
+ * is writing another (see EPBucket::prepareFlush).
+ */
+class FlushBatchPrepareTask : public GlobalTask {
+public:
+    FlushBatchPrepareTask(EPBucket& bucket, Vbid vbid);
+
+    bool run();
+
+    std::string getDescription() {
+        return desc;
+    }
+
+    std::chrono::microseconds maxExpectedDuration() {
+        // Obtaining and sorting up to flusher_batch_split_trigger items.
+        return std::chrono::milliseconds(100);
+    }
+
+private:
+    EPBucket& bucket;
+    const Vbid vbid;
+    std::string desc;
+};
+
 /**
  * A task for compacting a vbucket db file
  */
@@ -132,7 +157,13 @@ private:
 class BgFetcher;
 class MultiBGFetcherTask : public GlobalTask {
 public:
-    MultiBGFetcherTask(EventuallyPersistentEngine* e, BgFetcher* b);
+    /**
+     * @param partition The index of the BgFetcher's partition of vBuckets
+     *        this task fetches for.
+     */
+    MultiBGFetcherTask(EventuallyPersistentEngine* e,
+                       BgFetcher* b,
+                       size_t partition = 0);
 
     bool run();
 
@@ -153,6 +184,7 @@ public:
 
 private:
     BgFetcher *bgfetcher;
+    const size_t partition;
 };
 
 /**
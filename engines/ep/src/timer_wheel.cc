@@ -0,0 +1,200 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2019 Couchbase, Inc
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+
+#include "timer_wheel.h"
+
+#include <folly/lang/Bits.h>
+
+#include <algorithm>
+#include <limits>
+
+static_assert(TimerWheel::SlotsPerLevel == 64,
+              "TimerWheel::occupied uses a 64-bit mask per level");
+
+constexpr std::chrono::milliseconds TimerWheel::Resolution;
+constexpr int TimerWheel::LevelBits;
+constexpr size_t TimerWheel::SlotsPerLevel;
+constexpr size_t TimerWheel::Levels;
+
+TimerWheel::TimerWheel()
+    : curTick(toTick(std::chrono::steady_clock::now())) {
+}
+
+void TimerWheel::push(ExTask task) {
+    if (index.count(task->getId())) {
+        erase(task->getId());
+    }
+    insert(std::move(task));
+}
+
+bool TimerWheel::updateWaketime(const ExTask& task, time_point newTime) {
+    task->updateWaketime(newTime);
+    if (!index.count(task->getId())) {
+        return false;
+    }
+    erase(task->getId());
+    insert(task);
+    return true;
+}
+
+bool TimerWheel::snooze(const ExTask& task, const double secs) {
+    task->snooze(secs);
+    if (!index.count(task->getId())) {
+        return false;
+    }
+    erase(task->getId());
+    insert(task);
+    return true;
+}
+
+TimerWheel::time_point TimerWheel::nextWaketime() const {
+    // Tasks in the due list (or the first level 0 slot) are all earlier than
+    // any other, so take the exact minimum of those.
+    auto earliest = [](const std::vector<ExTask>& tasks) {
+        auto next = time_point::max();
+        for (const auto& task : tasks) {
+            next = std::min(next, task->getWaketime());
+        }
+        return next;
+    };
+
+    if (!slots[DueSlot].empty()) {
+        return earliest(slots[DueSlot]);
+    }
+
+    size_t level;
+    const uint64_t tick = nextEventTick(level);
+    if (tick == std::numeric_limits<uint64_t>::max()) {
+        return time_point::max();
+    }
+    if (level == 0) {
+        return earliest(slots[tick % SlotsPerLevel]);
+    }
+    // Somewhere in a higher level slot (or the overflow list); the start of
+    // the slot is the earliest it can be.
+    return time_point(Resolution * int64_t(tick));
+}
+
+uint64_t TimerWheel::toTick(time_point tp) {
+    const auto ticks = tp.time_since_epoch() / Resolution;
+    return ticks > 0 ? uint64_t(ticks) : 0;
+}
+
+void TimerWheel::insert(ExTask task) {
+    const uint64_t tick = toTick(task->getWaketime());
+    size_t slot = OverflowSlot;
+    if (tick <= curTick) {
+        slot = DueSlot;
+    } else {
+        // The lowest level whose slots cover both tick and curTick in one
+        // rotation.
+        for (size_t level = 0; level < Levels; ++level) {
+            const auto shift = LevelBits * level;
+            if ((tick >> (shift + LevelBits)) ==
+                (curTick >> (shift + LevelBits))) {
+                const auto digit = (tick >> shift) & (SlotsPerLevel - 1);
+                slot = level * SlotsPerLevel + digit;
+                occupied[level] |= uint64_t(1) << digit;
+                break;
+            }
+        }
+    }
+
+    auto& tasks = slots[slot];
+    index[task->getId()] = {uint32_t(slot), uint32_t(tasks.size())};
+    tasks.push_back(std::move(task));
+}
+
+void TimerWheel::erase(size_t id) {
+    auto it = index.find(id);
+    const auto loc = it->second;
+    index.erase(it);
+
+    // Fill the hole with the last task of the slot.
+    auto& tasks = slots[loc.slot];
+    if (loc.pos + 1 != tasks.size()) {
+        tasks[loc.pos] = std::move(tasks.back());
+        index[tasks[loc.pos]->getId()].pos = loc.pos;
+    }
+    tasks.pop_back();
+
+    if (tasks.empty() && loc.slot < WheelSlots) {
+        occupied[loc.slot / SlotsPerLevel] &=
+                ~(uint64_t(1) << (loc.slot % SlotsPerLevel));
+    }
+}
+
+void TimerWheel::cascade(size_t slot) {
+    std::vector<ExTask> tasks;
+    tasks.swap(slots[slot]);
+    if (slot < WheelSlots) {
+        occupied[slot / SlotsPerLevel] &=
+                ~(uint64_t(1) << (slot % SlotsPerLevel));
+    }
+    // Placed relative to curTick, none of the tasks can land back in `slot`.
+    for (auto& task : tasks) {
+        insert(std::move(task));
+    }
+}
+
+void TimerWheel::advance(uint64_t target) {
+    while (curTick < target) {
+        size_t level;
+        const uint64_t next = nextEventTick(level);
+        if (next > target) {
+            curTick = target;
+            return;
+        }
+        curTick = next;
+
+        const auto topShift = LevelBits * Levels;
+        if ((curTick & ((uint64_t(1) << topShift) - 1)) == 0) {
+            cascade(OverflowSlot);
+        }
+        // Cascade every slot starting at this tick, highest level first.
+        for (size_t ii = Levels; ii-- > 0;) {
+            const auto shift = LevelBits * ii;
+            if (curTick & ((uint64_t(1) << shift) - 1)) {
+                continue;
+            }
+            const auto digit = (curTick >> shift) & (SlotsPerLevel - 1);
+            if (occupied[ii] & (uint64_t(1) << digit)) {
+                cascade(ii * SlotsPerLevel + digit);
+            }
+        }
+    }
+}
+
+uint64_t TimerWheel::nextEventTick(size_t& level) const {
+    // Every level 0 slot is earlier than every level 1 slot, and so on.
+    for (size_t ii = 0; ii < Levels; ++ii) {
+        if (occupied[ii]) {
+            const auto shift = LevelBits * ii;
+            const uint64_t digit = folly::findFirstSet(occupied[ii]) - 1;
+            const uint64_t block = (curTick >> (shift + LevelBits))
+                                   << (shift + LevelBits);
+            level = ii;
+            return block + (digit << shift);
+        }
+    }
+    if (!slots[OverflowSlot].empty()) {
+        const auto topShift = LevelBits * Levels;
+        level = Levels;
+        return ((curTick >> topShift) + 1) << topShift;
+    }
+    return std::numeric_limits<uint64_t>::max();
+}
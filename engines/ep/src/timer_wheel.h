@@ -0,0 +1,169 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2019 Couchbase, Inc
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+
+/*
+ * TimerWheel holds the ExTask objects of a TaskQueue which are waiting for
+ * their wakeTime, in a hierarchical timing wheel.
+ *
+ * Time is divided into ticks of Resolution; the wheel has Levels levels of
+ * SlotsPerLevel slots, level L slots each covering SlotsPerLevel^L ticks. A
+ * task is placed in the lowest level slot which covers its wakeTime without
+ * covering the current tick. As time advances the slots reached are
+ * "cascaded" - their tasks re-placed into lower levels - until they land in
+ * the due list: tasks whose tick has been reached, which are checked against
+ * their exact wakeTime before being returned as ready.
+ *
+ * Compared with a heap (see FutureQueue) this makes push, wake (setting the
+ * wakeTime to now) and snooze O(1) - the heap has to search for the task and
+ * rebuild itself - and each task is cascaded at most Levels times before it
+ * is ready. Tasks beyond the range of the wheel (including those snoozed
+ * "forever") are held in an overflow list which is re-placed each time the
+ * wheel completes a top-level rotation.
+ *
+ * A task is only held once; pushing a task which is already in the wheel
+ * moves it to its current wakeTime.
+ *
+ * TimerWheel is not thread-safe - it is guarded by the owning TaskQueue's
+ * mutex.
+ */
+
+#pragma once
+
+#include "globaltask.h"
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+class TimerWheel {
+public:
+    using time_point = std::chrono::steady_clock::time_point;
+
+    /// Duration of one tick of the wheel.
+    static constexpr std::chrono::milliseconds Resolution{1};
+    static constexpr int LevelBits = 6;
+    static constexpr size_t SlotsPerLevel = size_t(1) << LevelBits;
+    /// With 1ms ticks, 4 levels cover ~4.6 hours.
+    static constexpr size_t Levels = 4;
+
+    TimerWheel();
+
+    /**
+     * Add the task to the wheel at its current wakeTime, moving it if it
+     * is already present.
+     */
+    void push(ExTask task);
+
+    /**
+     * Update the wakeTime of task, and move it within the wheel.
+     * @returns true if 'task' is in the TimerWheel.
+     */
+    bool updateWaketime(const ExTask& task, time_point newTime);
+
+    /**
+     * snooze the task (by altering its wakeTime), and move it within the
+     * wheel.
+     * @returns true if 'task' is in the TimerWheel.
+     */
+    bool snooze(const ExTask& task, const double secs);
+
+    /**
+     * Remove all tasks whose wakeTime is at or before 'now', passing each to
+     * the given callback.
+     * @returns the number of tasks removed.
+     */
+    template <typename Callback>
+    size_t popReady(time_point now, Callback&& callback) {
+        advance(toTick(now));
+
+        size_t count = 0;
+        auto& due = slots[DueSlot];
+        size_t ii = 0;
+        while (ii < due.size()) {
+            if (due[ii]->getWaketime() <= now) {
+                ExTask task = due[ii];
+                erase(task->getId());
+                callback(std::move(task));
+                ++count;
+                // erase() moved the last task into position ii.
+            } else {
+                ++ii;
+            }
+        }
+        return count;
+    }
+
+    /**
+     * @returns a lower bound on the wakeTime of the earliest task - exact if
+     *          the earliest task is within the current level 0 rotation - or
+     *          time_point::max() if the wheel is empty.
+     */
+    time_point nextWaketime() const;
+
+    size_t size() const {
+        return index.size();
+    }
+
+    bool empty() const {
+        return index.empty();
+    }
+
+private:
+    static constexpr size_t WheelSlots = Levels * SlotsPerLevel;
+    /// Tasks whose tick has been reached (but may not yet be ready).
+    static constexpr size_t DueSlot = WheelSlots;
+    /// Tasks beyond the range of the wheel.
+    static constexpr size_t OverflowSlot = WheelSlots + 1;
+
+    struct Location {
+        uint32_t slot;
+        uint32_t pos;
+    };
+
+    static uint64_t toTick(time_point tp);
+
+    /// Place the task according to its current wakeTime.
+    void insert(ExTask task);
+
+    /// Remove the task with the given id; it must be present.
+    void erase(size_t id);
+
+    /// Take all tasks out of the given slot and place them again.
+    void cascade(size_t slot);
+
+    /// Move the current tick forward to 'target', cascading slots reached.
+    void advance(uint64_t target);
+
+    /**
+     * @returns the tick at which the earliest non-empty slot must be
+     *          cascaded, or UINT64_MAX if there is none.
+     */
+    uint64_t nextEventTick(size_t& level) const;
+
+    /// Current tick; every task in a wheel slot has a later tick.
+    uint64_t curTick;
+
+    std::array<std::vector<ExTask>, WheelSlots + 2> slots;
+
+    /// Bitmask of the non-empty slots of each level.
+    std::array<uint64_t, Levels> occupied{};
+
+    /// Where each task (keyed by id) is in `slots`.
+    std::unordered_map<size_t, Location> index;
+};
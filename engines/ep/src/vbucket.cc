@@ -179,7 +179,15 @@ VBucket::VBucket(Vbid i,
                  int64_t hlcEpochSeqno,
                  bool mightContainXattrs,
                  const nlohmann::json& replTopology)
-    : ht(st, std::move(valFact), config.getHtSize(), config.getHtLocks()),
+    : ht(st,
+         std::move(valFact),
+         config.getHtSize(),
+         config.getHtLocks(),
+         config.getHtLayout() == "tagged" ? HashTable::Layout::Tagged
+                                          : HashTable::Layout::Chained,
+         config.getHtResizeMode() == "incremental"
+                 ? HashTable::ResizeMode::Incremental
+                 : HashTable::ResizeMode::Blocking),
       checkpointManager(std::make_unique<CheckpointManager>(st,
                                                             i,
                                                             chkConfig,
@@ -383,6 +391,15 @@ size_t VBucket::size() {
 }
 
 VBucket::ItemsToFlush VBucket::getItemsToPersist(size_t approxLimit) {
+    if (preparedItemsToPersist) {
+        ItemsToFlush result = std::move(*preparedItemsToPersist);
+        preparedItemsToPersist.reset();
+        // Items may have been queued since the batch was prepared.
+        result.moreAvailable = result.moreAvailable || !rejectQueue.empty() ||
+                               checkpointManager->getNumItemsForPersistence();
+        return result;
+    }
+
     // Fetch up to approxLimit items from rejectQueue, backfill items and
     // checkpointManager (in that order); then check if we obtained everything
     // which is available.
@@ -419,6 +436,24 @@ VBucket::ItemsToFlush VBucket::getItemsToPersist(size_t approxLimit) {
     return result;
 }
 
+void VBucket::itemsPersisted() {
+    if (preparedItemsToPersist) {
+        checkpointManager->itemsPersisted(
+                preparedItemsToPersist->preparedFromChkId);
+    } else {
+        checkpointManager->itemsPersisted();
+    }
+}
+
+std::vector<queued_item> VBucket::discardPreparedItemsToPersist() {
+    std::vector<queued_item> items;
+    if (preparedItemsToPersist) {
+        items = std::move(preparedItemsToPersist->items);
+        preparedItemsToPersist.reset();
+    }
+    return items;
+}
+
 const char* VBucket::toString(vbucket_state_t s) {
     switch (s) {
     case vbucket_state_active:
@@ -1074,27 +1109,31 @@ bool VBucket::isResidentRatioUnderThreshold(float threshold) {
     }
 }
 
-void VBucket::createFilter(size_t key_count, double probability) {
+void VBucket::createFilter(size_t key_count,
+                           double probability,
+                           BloomFilter::Type type) {
     // Create the actual bloom filter upon vbucket creation during
     // scenarios:
     //      - Bucket creation
     //      - Rebalance
     LockHolder lh(bfMutex);
     if (bFilter == nullptr && tempFilter == nullptr) {
-        bFilter = std::make_unique<BloomFilter>(key_count, probability,
-                                        BFILTER_ENABLED);
+        bFilter = std::make_unique<BloomFilter>(
+                key_count, probability, BFILTER_ENABLED, type);
     } else {
         EP_LOG_WARN("({}) Bloom filter / Temp filter already exist!", id);
     }
 }
 
-void VBucket::initTempFilter(size_t key_count, double probability) {
+void VBucket::initTempFilter(size_t key_count,
+                             double probability,
+                             BloomFilter::Type type) {
     // Create a temp bloom filter with status as COMPACTING,
     // if the main filter is found to exist, set its state to
     // COMPACTING as well.
     LockHolder lh(bfMutex);
-    tempFilter = std::make_unique<BloomFilter>(key_count, probability,
-                                     BFILTER_COMPACTING);
+    tempFilter = std::make_unique<BloomFilter>(
+            key_count, probability, BFILTER_COMPACTING, type);
     if (bFilter) {
         bFilter->setStatus(BFILTER_COMPACTING);
     }
@@ -1216,6 +1255,52 @@ size_t VBucket::getNumOfKeysInFilter() {
     }
 }
 
+std::unique_ptr<BloomFilter> VBucket::snapshotFilter() {
+    std::unique_ptr<BloomFilter> snapshot;
+    {
+        LockHolder lh(bfMutex);
+        if (!bFilter || bFilter->getStatus() != BFILTER_ENABLED) {
+            return {};
+        }
+        snapshot = bFilter->makeEmptyCopy();
+    }
+
+    class AddKeysVisitor : public HashTableVisitor {
+    public:
+        explicit AddKeysVisitor(BloomFilter& target) : filter(target) {
+        }
+
+        bool visit(const HashTable::HashBucketLock& lh,
+                   StoredValue& v) override {
+            filter.addKey(v.getKey());
+            return true;
+        }
+
+    private:
+        BloomFilter& filter;
+    } visitor(*snapshot);
+    ht.visit(visitor);
+
+    // Merge in the filter's keys last: an item evicted from the HashTable
+    // while it was being visited is added to bFilter under the HashBucketLock,
+    // so it is either in the snapshot already or in bFilter by now.
+    LockHolder lh(bfMutex);
+    if (!bFilter || !snapshot->merge(*bFilter)) {
+        // Filter was disabled or replaced (by compaction) meanwhile.
+        return {};
+    }
+    return snapshot;
+}
+
+bool VBucket::restoreFilter(std::unique_ptr<BloomFilter> filter) {
+    LockHolder lh(bfMutex);
+    if (bFilter || tempFilter) {
+        return false;
+    }
+    bFilter = std::move(filter);
+    return true;
+}
+
 VBNotifyCtx VBucket::queueItem(queued_item& item, const VBQueueItemCtx& ctx) {
     // Ensure that durable writes are queued with the same seqno-order in both
     // Backfill/CheckpointManager Queues and DurabilityMonitor. Note that
@@ -2627,6 +2712,31 @@ GetValue VBucket::getInternal(
     const bool getDeletedValue = (options & GET_DELETED_VALUE);
     const bool bgFetchRequired = (options & QUEUE_BG_FETCH);
 
+    // Common case of a resident, live item: try to copy it without acquiring
+    // the hash bucket lock (see HashTable::findForReadOptimistic).
+    auto optimistic = ht.findForReadOptimistic(
+            cHandle.getKey(),
+            getId(),
+            trackReference,
+            getReplicaItem,
+            (options & HIDE_LOCKED_CAS) && getKeyOnly == GetKeyOnly::No,
+            getKeyOnly == GetKeyOnly::Yes ? StoredValue::IncludeValue::No
+                                          : StoredValue::IncludeValue::Yes);
+    if (optimistic.item) {
+        const auto bySeqno = optimistic.item->getBySeqno();
+        if (cHandle.isLogicallyDeleted(bySeqno)) {
+            return GetValue();
+        }
+        if (options & TRACK_STATISTICS) {
+            opsGet++;
+        }
+        return GetValue(std::move(optimistic.item),
+                        ENGINE_SUCCESS,
+                        bySeqno,
+                        false,
+                        optimistic.nru);
+    }
+
     auto res = fetchValidValue(WantsDeleted::Yes,
                                trackReference,
                                QueueExpired::Yes,
@@ -2955,6 +3065,7 @@ bool VBucket::removeItemFromMemory(const Item& item) {
 void VBucket::postProcessRollback(const RollbackResult& rollbackResult,
                                   uint64_t prevHighSeqno) {
     failovers->pruneEntries(rollbackResult.highSeqno);
+    discardPreparedItemsToPersist();
     checkpointManager->clear(*this, rollbackResult.highSeqno);
     setPersistedSnapshot(
             {rollbackResult.snapStartSeqno, rollbackResult.snapEndSeqno});
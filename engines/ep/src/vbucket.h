@@ -496,10 +496,17 @@ public:
         bool moreAvailable = false;
         boost::optional<uint64_t> maxDeletedRevSeqno = {};
         CheckpointType checkpointType = CheckpointType::Memory;
+        /// True if the items have been ordered by KVStore::optimizeWrites.
+        bool writesOptimized = false;
+        /// For a batch prepared ahead of the flush, the checkpoint the
+        /// persistence cursor was in before the items were obtained.
+        uint64_t preparedFromChkId = 0;
     };
 
     /**
-     * Obtain the series of items to be flushed for this vBucket.
+     * Obtain the series of items to be flushed for this vBucket. If a batch
+     * was prepared ahead of the flush (see setPreparedItemsToPersist) that
+     * batch is returned.
      *
      * @param vb VBucket to fetch items for.
      * @param approxLimit Upper bound on how many items to fetch.
@@ -509,6 +516,32 @@ public:
      */
     ItemsToFlush getItemsToPersist(size_t approxLimit);
 
+    /**
+     * Record a batch of items obtained by getItemsToPersist ahead of the
+     * flush, to be returned by the next call to getItemsToPersist. Must be
+     * called with the vBucket locked (as for the rejectQueue).
+     */
+    void setPreparedItemsToPersist(ItemsToFlush items) {
+        preparedItemsToPersist = std::move(items);
+    }
+
+    bool hasPreparedItemsToPersist() const {
+        return preparedItemsToPersist.is_initialized();
+    }
+
+    /**
+     * Notify the checkpoint manager that the items flushed so far have been
+     * persisted. If the next batch was prepared ahead of the flush, the
+     * persistence cursor has already moved past its items.
+     */
+    void itemsPersisted();
+
+    /**
+     * Discard the batch of items prepared ahead of the flush (when the
+     * checkpoints are cleared), returning its items.
+     */
+    std::vector<queued_item> discardPreparedItemsToPersist();
+
     bool isReceivingInitialDiskSnapshot() {
         return receivingInitialDiskSnapshot.load();
     }
@@ -596,8 +629,12 @@ public:
     /**
      * BloomFilter operations for vbucket
      */
-    void createFilter(size_t key_count, double probability);
-    void initTempFilter(size_t key_count, double probability);
+    void createFilter(size_t key_count,
+                      double probability,
+                      BloomFilter::Type type = BloomFilter::Type::BitArray);
+    void initTempFilter(size_t key_count,
+                        double probability,
+                        BloomFilter::Type type = BloomFilter::Type::BitArray);
     void addToFilter(const DocKey& key);
     virtual bool maybeKeyExistsInFilter(const DocKey& key);
     bool isTempFilterAvailable();
@@ -609,6 +646,24 @@ public:
     size_t getFilterSize();
     size_t getNumOfKeysInFilter();
 
+    /**
+     * Create a copy of the bloom filter which can be persisted and used
+     * after a restart: as well as the keys in the filter it contains the key
+     * of every item in the HashTable, since those items will not be in
+     * memory after a restart.
+     *
+     * @return the copy, or nullptr if the vBucket has no enabled filter.
+     */
+    std::unique_ptr<BloomFilter> snapshotFilter();
+
+    /**
+     * Install a filter loaded from disk (see snapshotFilter) as the bloom
+     * filter of the vBucket, if it doesn't already have one.
+     *
+     * @return true if the filter was installed.
+     */
+    bool restoreFilter(std::unique_ptr<BloomFilter> filter);
+
     uint64_t nextHLCCas() {
         return hlc.nextHLC();
     }
@@ -2367,6 +2422,10 @@ private:
      */
     std::atomic<bool> receivingInitialDiskSnapshot;
 
+    /// The next flush batch, if prepared ahead of the flush. Guarded by the
+    /// vBucket lock, as rejectQueue.
+    boost::optional<ItemsToFlush> preparedItemsToPersist;
+
     std::mutex bfMutex;
     std::unique_ptr<BloomFilter> bFilter;
     std::unique_ptr<BloomFilter> tempFilter;    // Used during compaction.
@@ -223,6 +223,41 @@ private:
     Warmup& warmup;
 };
 
+class WarmupLoadingBloomFilters : public GlobalTask {
+public:
+    WarmupLoadingBloomFilters(EPBucket& st, uint16_t sh, Warmup& w)
+        : GlobalTask(&st.getEPEngine(),
+                     TaskId::WarmupLoadingBloomFilters,
+                     0,
+                     false),
+          shardId(sh),
+          warmup(w) {
+        warmup.addToTaskSet(uid);
+    }
+
+    std::string getDescription() override {
+        return "Warmup - loading bloom filters: shard " +
+               std::to_string(shardId);
+    }
+
+    std::chrono::microseconds maxExpectedDuration() override {
+        // Reads one document per VB, but for large VBs the filter can be
+        // several MB.
+        return std::chrono::seconds(10);
+    }
+
+    bool run() override {
+        TRACE_EVENT0("ep-engine/task", "WarmupLoadingBloomFilters");
+        warmup.loadBloomFiltersForShard(shardId);
+        warmup.removeFromTaskSet(uid);
+        return false;
+    }
+
+private:
+    uint16_t shardId;
+    Warmup& warmup;
+};
+
 class WarmupEstimateDatabaseItemCount : public GlobalTask {
 public:
     WarmupEstimateDatabaseItemCount(EPBucket& st, uint16_t sh, Warmup* w)
@@ -410,12 +445,19 @@ private:
 
 class WarmupLoadAccessLog : public GlobalTask {
 public:
-    WarmupLoadAccessLog(EPBucket& st, uint16_t sh, Warmup* w)
+    WarmupLoadAccessLog(EPBucket& st,
+                        uint16_t sh,
+                        size_t partition,
+                        size_t numPartitions,
+                        Warmup* w)
         : GlobalTask(&st.getEPEngine(), TaskId::WarmupLoadAccessLog, 0, false),
           _shardId(sh),
+          _partition(partition),
+          _numPartitions(numPartitions),
           _warmup(w),
           _description("Warmup - loading access log: shard " +
-                       std::to_string(_shardId)) {
+                       std::to_string(_shardId) + " partition " +
+                       std::to_string(_partition)) {
         _warmup->addToTaskSet(uid);
     }
 
@@ -433,25 +475,26 @@ public:
 
     bool run() override {
         TRACE_EVENT0("ep-engine/task", "WarmupLoadAccessLog");
-        _warmup->loadingAccessLog(_shardId);
+        _warmup->loadingAccessLog(_shardId, _partition, _numPartitions);
         _warmup->removeFromTaskSet(uid);
         return false;
     }
 
 private:
     uint16_t _shardId;
+    size_t _partition;
+    size_t _numPartitions;
     Warmup* _warmup;
     const std::string _description;
 };
 
 class WarmupLoadingKVPairs : public GlobalTask {
 public:
-    WarmupLoadingKVPairs(EPBucket& st, uint16_t sh, Warmup* w)
+    WarmupLoadingKVPairs(EPBucket& st, size_t taskIdx, Warmup* w)
         : GlobalTask(&st.getEPEngine(), TaskId::WarmupLoadingKVPairs, 0, false),
-          _shardId(sh),
           _warmup(w),
-          _description("Warmup - loading KV Pairs: shard " +
-                       std::to_string(_shardId)) {
+          _description("Warmup - loading KV Pairs: task " +
+                       std::to_string(taskIdx)) {
         _warmup->addToTaskSet(uid);
     }
 
@@ -470,25 +513,23 @@ public:
 
     bool run() override {
         TRACE_EVENT0("ep-engine/task", "WarmupLoadingKVPairs");
-        _warmup->loadKVPairsforShard(_shardId);
+        _warmup->loadKVPairs();
         _warmup->removeFromTaskSet(uid);
         return false;
     }
 
 private:
-    uint16_t _shardId;
     Warmup* _warmup;
     const std::string _description;
 };
 
 class WarmupLoadingData : public GlobalTask {
 public:
-    WarmupLoadingData(EPBucket& st, uint16_t sh, Warmup* w)
+    WarmupLoadingData(EPBucket& st, size_t taskIdx, Warmup* w)
         : GlobalTask(&st.getEPEngine(), TaskId::WarmupLoadingData, 0, false),
-          _shardId(sh),
           _warmup(w),
-          _description("Warmup - loading data: shard " +
-                       std::to_string(_shardId)) {
+          _description("Warmup - loading data: task " +
+                       std::to_string(taskIdx)) {
         _warmup->addToTaskSet(uid);
     }
 
@@ -507,13 +548,12 @@ public:
 
     bool run() override {
         TRACE_EVENT0("ep-engine/task", "WarmupLoadingData");
-        _warmup->loadDataforShard(_shardId);
+        _warmup->loadData();
         _warmup->removeFromTaskSet(uid);
         return false;
     }
 
 private:
-    uint16_t _shardId;
     Warmup* _warmup;
     const std::string _description;
 };
@@ -622,6 +662,8 @@ const char* WarmupState::getStateDescription(State st) const {
         return "creating vbuckets";
     case State::LoadingCollectionCounts:
         return "loading collection counts";
+    case State::LoadingBloomFilters:
+        return "loading bloom filters";
     case State::EstimateDatabaseItemCount:
         return "estimating database item count";
     case State::LoadPreparedSyncWrites:
@@ -644,6 +686,38 @@ const char* WarmupState::getStateDescription(State st) const {
     return "Illegal state";
 }
 
+const char* WarmupState::getPhaseStatName(State val) {
+    switch (val) {
+    case State::Initialize:
+        return "initialize_time";
+    case State::CreateVBuckets:
+        return "create_vbuckets_time";
+    case State::LoadingCollectionCounts:
+        return "loading_collection_counts_time";
+    case State::LoadingBloomFilters:
+        return "loading_bloom_filters_time";
+    case State::EstimateDatabaseItemCount:
+        return "estimate_item_count_time";
+    case State::LoadPreparedSyncWrites:
+        return "load_prepared_sync_writes_time";
+    case State::PopulateVBucketMap:
+        return "populate_vbucket_map_time";
+    case State::KeyDump:
+        return "key_dump_time";
+    case State::CheckForAccessLog:
+        return "check_for_access_log_time";
+    case State::LoadingAccessLog:
+        return "loading_access_log_time";
+    case State::LoadingKVPairs:
+        return "loading_kv_pairs_time";
+    case State::LoadingData:
+        return "loading_data_time";
+    case State::Done:
+        return "done_time";
+    }
+    return "illegal_state_time";
+}
+
 void WarmupState::transition(State to, bool allowAnystate) {
     if (allowAnystate || legalTransition(to)) {
         EP_LOG_DEBUG("Warmup transition from state \"{}\" to \"{}\"",
@@ -666,6 +740,8 @@ bool WarmupState::legalTransition(State to) const {
     case State::CreateVBuckets:
         return (to == State::LoadingCollectionCounts);
     case State::LoadingCollectionCounts:
+        return (to == State::LoadingBloomFilters);
+    case State::LoadingBloomFilters:
         return (to == State::EstimateDatabaseItemCount);
     case State::EstimateDatabaseItemCount:
         return (to == State::LoadPreparedSyncWrites);
@@ -973,6 +1049,10 @@ void Warmup::initialize()
         std::lock_guard<std::mutex> lock(warmupStart.mutex);
         warmupStart.time = std::chrono::steady_clock::now();
     }
+    {
+        std::lock_guard<std::mutex> lock(phaseStart.mutex);
+        phaseStart.time = std::chrono::steady_clock::now();
+    }
 
     std::map<std::string, std::string> session_stats;
     store.getOneROUnderlying()->getPersistedStats(session_stats);
@@ -1158,6 +1238,69 @@ void Warmup::loadCollectionStatsForShard(uint16_t shardId) {
         }
     }
 
+    if (++threadtask_count == store.vbMap.getNumShards()) {
+        transition(WarmupState::State::LoadingBloomFilters);
+    }
+}
+
+void Warmup::scheduleLoadingBloomFilters() {
+    threadtask_count = 0;
+    for (size_t i = 0; i < store.vbMap.shards.size(); i++) {
+        ExTask task =
+                std::make_shared<WarmupLoadingBloomFilters>(store, i, *this);
+        ExecutorPool::get()->schedule(task);
+    }
+}
+
+void Warmup::loadBloomFiltersForShard(uint16_t shardId) {
+    if (config.isBfilterEnabled()) {
+        KVStore* kvstore = store.getROUnderlyingByShard(shardId);
+        size_t loaded = 0;
+        for (const auto vbid : shardVbIds[shardId]) {
+            auto itr = warmedUpVbuckets.find(vbid.get());
+            if (itr == warmedUpVbuckets.end()) {
+                continue;
+            }
+            auto& vb = *itr->second;
+
+            auto persisted = kvstore->getBloomFilter(vbid);
+            if (persisted.filter.empty()) {
+                continue;
+            }
+
+            // Keys persisted after the filter was written may not be in it;
+            // using it would make them appear not to exist.
+            if (persisted.highSeqno != vb.getPersistenceSeqno()) {
+                EP_LOG_DEBUG(
+                        "Warmup::loadBloomFiltersForShard: {} ignoring stale "
+                        "bloom filter (filter seqno:{}, persisted seqno:{})",
+                        vbid,
+                        persisted.highSeqno,
+                        vb.getPersistenceSeqno());
+                continue;
+            }
+
+            auto filter = BloomFilter::decode(
+                    {persisted.filter.data(), persisted.filter.size()});
+            if (!filter) {
+                EP_LOG_WARN(
+                        "Warmup::loadBloomFiltersForShard: {} ignoring "
+                        "invalid bloom filter (size:{})",
+                        vbid,
+                        persisted.filter.size());
+                continue;
+            }
+
+            if (vb.restoreFilter(std::move(filter))) {
+                ++loaded;
+            }
+        }
+        EP_LOG_INFO("Warmup::loadBloomFiltersForShard: shard:{} loaded {} "
+                    "bloom filter(s)",
+                    shardId,
+                    loaded);
+    }
+
     if (++threadtask_count == store.vbMap.getNumShards()) {
         transition(WarmupState::State::EstimateDatabaseItemCount);
     }
@@ -1348,49 +1491,66 @@ void Warmup::checkForAccessLog()
 
 void Warmup::scheduleLoadingAccessLog()
 {
+    // Each shard's access log is loaded by (readers / shards) tasks, each
+    // reading its own range of the log's blocks, so the fetches of all the
+    // logs' keys are spread over all the reader threads.
+    const size_t numShards = store.vbMap.shards.size();
+    const size_t tasksPerShard = std::max(
+            size_t(1), ExecutorPool::get()->getNumReaders() / numShards);
+
+    numLoadTasks = numShards * tasksPerShard;
     threadtask_count = 0;
-    for (size_t i = 0; i < store.vbMap.shards.size(); i++) {
-        ExTask task = std::make_shared<WarmupLoadAccessLog>(store, i, this);
-        ExecutorPool::get()->schedule(task);
+    for (size_t i = 0; i < numShards; i++) {
+        for (size_t p = 0; p < tasksPerShard; p++) {
+            ExTask task = std::make_shared<WarmupLoadAccessLog>(
+                    store, i, p, tasksPerShard, this);
+            ExecutorPool::get()->schedule(task);
+        }
     }
 }
 
-void Warmup::loadingAccessLog(uint16_t shardId)
-{
+bool Warmup::loadingAccessLog(const std::string& path,
+                              size_t partition,
+                              size_t numPartitions,
+                              const std::map<Vbid, vbucket_state>& vbmap,
+                              StatusCallback<GetValue>& cb) {
+    // Each task reads the log through its own read-only (memory-mapped)
+    // MutationLog, as the partitions of a shard read the same file
+    // concurrently.
+    MutationLog log(path);
+    if (!log.exists()) {
+        return false;
+    }
+    try {
+        log.open(true);
+        const auto numBlocks = log.getNumBlocks();
+        return doWarmup(log,
+                        vbmap,
+                        cb,
+                        numBlocks * partition / numPartitions,
+                        numBlocks * (partition + 1) / numPartitions) !=
+               (size_t)-1;
+    } catch (MutationLog::ReadException& e) {
+        corruptAccessLog = true;
+        EP_LOG_WARN("Error reading warmup access log '{}': {}", path, e.what());
+    }
+    return false;
+}
+
+void Warmup::loadingAccessLog(uint16_t shardId,
+                              size_t partition,
+                              size_t numPartitions) {
     LoadStorageKVPairCallback load_cb(store, true, state.getState());
-    bool success = false;
     auto stTime = std::chrono::steady_clock::now();
-    if (store.accessLog[shardId].exists()) {
-        try {
-            store.accessLog[shardId].open();
-            if (doWarmup(store.accessLog[shardId],
-                         shardVbStates[shardId],
-                         load_cb) != (size_t)-1) {
-                success = true;
-            }
-        } catch (MutationLog::ReadException &e) {
-            corruptAccessLog = true;
-            EP_LOG_WARN("Error reading warmup access log:  {}", e.what());
-        }
-    }
 
+    const auto& vbmap = shardVbStates[shardId];
+    const auto& logFile = store.accessLog[shardId].getLogFile();
+    bool success =
+            loadingAccessLog(logFile, partition, numPartitions, vbmap, load_cb);
     if (!success) {
         // Do we have the previous file?
-        std::string nm = store.accessLog[shardId].getLogFile();
-        nm.append(".old");
-        MutationLog old(nm);
-        if (old.exists()) {
-            try {
-                old.open();
-                if (doWarmup(old, shardVbStates[shardId], load_cb) !=
-                    (size_t)-1) {
-                    success = true;
-                }
-            } catch (MutationLog::ReadException &e) {
-                corruptAccessLog = true;
-                EP_LOG_WARN("Error reading old access log:  {}", e.what());
-            }
-        }
+        success = loadingAccessLog(
+                logFile + ".old", partition, numPartitions, vbmap, load_cb);
     }
 
     size_t numItems = store.getEPEngine().getEpStats().warmedUpValues;
@@ -1403,7 +1563,7 @@ void Warmup::loadingAccessLog(uint16_t shardId)
         setEstimatedWarmupCount(estimatedCount);
     }
 
-    if (++threadtask_count == store.vbMap.getNumShards()) {
+    if (++threadtask_count == numLoadTasks) {
         if (!store.maybeEnableTraffic()) {
             transition(WarmupState::State::LoadingData);
         } else {
@@ -1415,7 +1575,9 @@ void Warmup::loadingAccessLog(uint16_t shardId)
 
 size_t Warmup::doWarmup(MutationLog& lf,
                         const std::map<Vbid, vbucket_state>& vbmap,
-                        StatusCallback<GetValue>& cb) {
+                        StatusCallback<GetValue>& cb,
+                        size_t firstBlock,
+                        size_t lastBlock) {
     MutationLogHarvester harvester(lf, &store.getEPEngine());
     std::map<Vbid, vbucket_state>::const_iterator it;
     for (it = vbmap.begin(); it != vbmap.end(); ++it) {
@@ -1429,7 +1591,7 @@ size_t Warmup::doWarmup(MutationLog& lf,
     std::chrono::nanoseconds log_apply_duration{};
     WarmupCookie cookie(&store, cb);
 
-    auto alog_iter = lf.begin();
+    auto alog_iter = lf.begin(firstBlock, lastBlock);
     do {
         // Load a chunk of the access log file
         auto start = std::chrono::steady_clock::now();
@@ -1465,47 +1627,18 @@ void Warmup::scheduleLoadingKVPairs()
     // keys have been warmed up at this point.
     setEstimatedWarmupCount(estimatedItemCount);
 
-    threadtask_count = 0;
-    for (size_t i = 0; i < store.vbMap.shards.size(); i++) {
+    prepareLoadingTasks();
+    for (size_t i = 0; i < numLoadTasks; i++) {
         ExTask task = std::make_shared<WarmupLoadingKVPairs>(store, i, this);
         ExecutorPool::get()->schedule(task);
     }
 
 }
 
-void Warmup::loadKVPairsforShard(uint16_t shardId)
-{
-    bool maybe_enable_traffic = false;
-    scan_error_t errorCode = scan_success;
-
-    if (store.getItemEvictionPolicy() == EvictionPolicy::Full) {
-        maybe_enable_traffic = true;
-    }
-
-    KVStore* kvstore = store.getROUnderlyingByShard(shardId);
-    auto cb = std::make_shared<LoadStorageKVPairCallback>(
-            store, maybe_enable_traffic, state.getState());
-    auto cl =
-            std::make_shared<LoadValueCallback>(store.vbMap, state.getState());
-
-    ValueFilter valFilter = store.getValueFilterForCompressionMode();
-
-    for (const auto vbid : shardVbIds[shardId]) {
-        ScanContext* ctx = kvstore->initScanContext(cb, cl, vbid, 0,
-                                                    DocumentFilter::NO_DELETES,
-                                                    valFilter);
-        if (ctx) {
-            errorCode = kvstore->scan(ctx);
-            kvstore->destroyScanContext(ctx);
-            if (errorCode == scan_again) { // ENGINE_ENOMEM
-                // skip loading remaining VBuckets as memory limit was reached
-                break;
-            }
-        }
-    }
-    if (++threadtask_count == store.vbMap.getNumShards()) {
-        transition(WarmupState::State::Done);
-    }
+void Warmup::loadKVPairs() {
+    // With full eviction, traffic may be enabled as soon as enough items
+    // are loaded.
+    loadVBuckets(store.getItemEvictionPolicy() == EvictionPolicy::Full);
 }
 
 void Warmup::scheduleLoadingData()
@@ -1513,40 +1646,75 @@ void Warmup::scheduleLoadingData()
     size_t estimatedCount = store.getEPEngine().getEpStats().warmedUpKeys;
     setEstimatedWarmupCount(estimatedCount);
 
-    threadtask_count = 0;
-    for (size_t i = 0; i < store.vbMap.shards.size(); i++) {
+    prepareLoadingTasks();
+    for (size_t i = 0; i < numLoadTasks; i++) {
         ExTask task = std::make_shared<WarmupLoadingData>(store, i, this);
         ExecutorPool::get()->schedule(task);
     }
 }
 
-void Warmup::loadDataforShard(uint16_t shardId)
-{
-    scan_error_t errorCode = scan_success;
+void Warmup::loadData() {
+    loadVBuckets(true);
+}
 
-    KVStore* kvstore = store.getROUnderlyingByShard(shardId);
+void Warmup::prepareLoadingTasks() {
+    // Interleave the shards' vBuckets, so the vBuckets being loaded at any
+    // time are spread over the shards.
+    loadVbIds.clear();
+    for (size_t ii = 0;; ++ii) {
+        bool added = false;
+        for (const auto& vbids : shardVbIds) {
+            if (ii < vbids.size()) {
+                loadVbIds.push_back(vbids[ii]);
+                added = true;
+            }
+        }
+        if (!added) {
+            break;
+        }
+    }
+    nextLoadVb = 0;
+    loadStopped = false;
+
+    // One task per reader thread (but at least one per shard, as before
+    // loading was split by vBucket), each loading whole vBuckets until
+    // none are left.
+    numLoadTasks = std::max(size_t(store.vbMap.getNumShards()),
+                            ExecutorPool::get()->getNumReaders());
+    numLoadTasks =
+            std::max(size_t(1), std::min(numLoadTasks, loadVbIds.size()));
+    threadtask_count = 0;
+}
+
+void Warmup::loadVBuckets(bool maybeEnableTraffic) {
     auto cb = std::make_shared<LoadStorageKVPairCallback>(
-            store, true, state.getState());
+            store, maybeEnableTraffic, state.getState());
     auto cl =
             std::make_shared<LoadValueCallback>(store.vbMap, state.getState());
 
     ValueFilter valFilter = store.getValueFilterForCompressionMode();
 
-    for (const auto vbid : shardVbIds[shardId]) {
+    while (!loadStopped) {
+        const size_t next = nextLoadVb++;
+        if (next >= loadVbIds.size()) {
+            break;
+        }
+        const auto vbid = loadVbIds[next];
+        KVStore* kvstore = store.getROUnderlying(vbid);
         ScanContext* ctx = kvstore->initScanContext(cb, cl, vbid, 0,
                                                     DocumentFilter::NO_DELETES,
                                                     valFilter);
         if (ctx) {
-            errorCode = kvstore->scan(ctx);
+            auto errorCode = kvstore->scan(ctx);
             kvstore->destroyScanContext(ctx);
             if (errorCode == scan_again) { // ENGINE_ENOMEM
                 // skip loading remaining VBuckets as memory limit was reached
-                break;
+                loadStopped = true;
             }
         }
     }
 
-    if (++threadtask_count == store.vbMap.getNumShards()) {
+    if (++threadtask_count == numLoadTasks) {
         transition(WarmupState::State::Done);
     }
 }
@@ -1576,6 +1744,9 @@ void Warmup::step() {
     case WarmupState::State::LoadingCollectionCounts:
         scheduleLoadingCollectionCounts();
         return;
+    case WarmupState::State::LoadingBloomFilters:
+        scheduleLoadingBloomFilters();
+        return;
     case WarmupState::State::EstimateDatabaseItemCount:
         scheduleEstimateDatabaseItemCount();
         return;
@@ -1611,6 +1782,12 @@ void Warmup::step() {
 void Warmup::transition(WarmupState::State to, bool force) {
     auto old = state.getState();
     if (old != WarmupState::State::Done) {
+        {
+            std::lock_guard<std::mutex> lock(phaseStart.mutex);
+            const auto now = std::chrono::steady_clock::now();
+            phaseTimes[size_t(old)].store(now - phaseStart.time);
+            phaseStart.time = now;
+        }
         state.transition(to, force);
         step();
     }
@@ -1684,6 +1861,16 @@ void Warmup::addStats(const AddStatFn& add_stat, const void* c) const {
         addStat("estimated_key_count", itemCount, add_stat, c);
     }
 
+    for (size_t ii = 0; ii < phaseTimes.size(); ++ii) {
+        auto p_time = phaseTimes[ii].load();
+        if (p_time > p_time.zero()) {
+            addStat(WarmupState::getPhaseStatName(WarmupState::State(ii)),
+                    duration_cast<microseconds>(p_time).count(),
+                    add_stat,
+                    c);
+        }
+    }
+
     if (corruptAccessLog) {
         addStat("access_log", "corrupt", add_stat, c);
     }
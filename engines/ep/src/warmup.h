@@ -24,6 +24,7 @@
 #include <memcached/engine_common.h>
 #include <platform/atomic_duration.h>
 
+#include <array>
 #include <atomic>
 #include <chrono>
 #include <deque>
@@ -63,6 +64,7 @@ public:
         Initialize,
         CreateVBuckets,
         LoadingCollectionCounts,
+        LoadingBloomFilters,
         EstimateDatabaseItemCount,
         LoadPreparedSyncWrites,
         PopulateVBucketMap,
@@ -89,6 +91,9 @@ public:
 
     const char* toString() const;
 
+    /// @returns the name of the stat recording the time spent in the state.
+    static const char* getPhaseStatName(State val);
+
     State getState() const {
         return state;
     }
@@ -129,6 +134,9 @@ private:
  *           [LoadingCollectionCounts]
  *                     |
  *                     V
+ *             [LoadingBloomFilters]
+ *                     |
+ *                     V
  *          [EstimateDatabaseItemCount]
  *                     |
  *                     V
@@ -175,6 +183,7 @@ private:
  *    Initialise
  *    CreateVBuckets
  *    LoadingCollectionCounts
+ *    LoadingBloomFilters
  *    EstimateDatabaseItemCount
  *    LoadPreparedSyncWrites
  *    PopulateVBucketMap
@@ -240,9 +249,15 @@ public:
                      std::chrono::steady_clock::duration(1));
     }
 
+    /**
+     * Loads the keys of the given vBuckets found in the (data) blocks
+     * [firstBlock, lastBlock) of the given access log.
+     */
     size_t doWarmup(MutationLog& lf,
                     const std::map<Vbid, vbucket_state>& vbmap,
-                    StatusCallback<GetValue>& cb);
+                    StatusCallback<GetValue>& cb,
+                    size_t firstBlock,
+                    size_t lastBlock);
 
     bool isComplete() const {
         return warmupComplete.load();
@@ -317,6 +332,15 @@ private:
      */
     void loadCollectionStatsForShard(uint16_t shardId);
 
+    /**
+     * Loads the persisted bloom filter of each vBucket in the given shard (if
+     * bloom filters are enabled), so that lookups of keys which don't exist
+     * can avoid a disk read without waiting for the next compaction to
+     * rebuild the filter. A persisted filter is only loaded if no items have
+     * been persisted since it was written.
+     */
+    void loadBloomFiltersForShard(uint16_t shardId);
+
     /**
      * Loads the item count of each vBucket from disk for the given shardId:
      * - Reads the item count from disk and sets VBucket::numTotalItems
@@ -356,26 +380,58 @@ private:
     void checkForAccessLog();
 
     /**
-     * Loads the access log for the given shardId:
-     * - Reads a batch of keys from the access log
+     * Loads the given partition of the access log for the given shardId
+     * (the access log of each shard is split into numPartitions ranges of
+     * blocks, loaded by as many tasks concurrently):
+     * - Reads a batch of keys from the partition's blocks of the access log
      * - For each key read, attempt to fetch key+value from the underlying
      *   KVStore.
      * - If key exists (wasn't subsequently deleted), insert into the
      *   HashTable.
+     * If the access log cannot be read, the same partition of the previous
+     * (.old) log is loaded instead.
+     */
+    void loadingAccessLog(uint16_t shardId,
+                          size_t partition,
+                          size_t numPartitions);
+
+    /**
+     * Loads the keys of the given vBuckets from the given partition of the
+     * access log at path.
+     *
+     * @return true if the log exists and was read successfully.
      */
-    void loadingAccessLog(uint16_t shardId);
+    bool loadingAccessLog(const std::string& path,
+                          size_t partition,
+                          size_t numPartitions,
+                          const std::map<Vbid, vbucket_state>& vbmap,
+                          StatusCallback<GetValue>& cb);
 
     /**
      * [Full-eviction only]
-     * Loads both keys and values into memory for each vBucket in the given
-     * shard.
+     * Loads both keys and values into memory for the vBuckets claimed by the
+     * calling task.
      */
-    void loadKVPairsforShard(uint16_t shardId);
+    void loadKVPairs();
 
     /**
-     * Loads values into memory for each vBucket in the given shard.
+     * Loads values into memory for the vBuckets claimed by the calling task.
      */
-    void loadDataforShard(uint16_t shardId);
+    void loadData();
+
+    /**
+     * Set up the list of vBuckets to be loaded by the LoadingKVPairs /
+     * LoadingData tasks, and the number of tasks to load them with.
+     */
+    void prepareLoadingTasks();
+
+    /**
+     * Run by each LoadingKVPairs / LoadingData task: repeatedly claims the
+     * next vBucket from loadVbIds and scans it into memory, until all have
+     * been claimed or loading has stopped (memory limit reached). The last
+     * task to finish moves warmup to Done.
+     */
+    void loadVBuckets(bool maybeEnableTraffic);
 
     /* Terminal state of warmup. Updates statistics and marks warmup as
      * completed
@@ -390,6 +446,7 @@ private:
     void scheduleInitialize();
     void scheduleCreateVBuckets();
     void scheduleLoadingCollectionCounts();
+    void scheduleLoadingBloomFilters();
     void scheduleEstimateDatabaseItemCount();
     void scheduleLoadPreparedSyncWrites();
     void schedulePopulateVBucketMap();
@@ -430,6 +487,30 @@ private:
     /// contains all vBucket IDs which are present for the given shard.
     std::vector<std::vector<Vbid>> shardVbIds;
 
+    /// vBuckets to be loaded by the LoadingKVPairs / LoadingData tasks, with
+    /// the shards interleaved. Each task claims the next one by incrementing
+    /// nextLoadVb, so the work is balanced over the tasks by vBucket rather
+    /// than by shard.
+    std::vector<Vbid> loadVbIds;
+    std::atomic<size_t> nextLoadVb{0};
+    /// Set when a task stops loading; the other tasks then stop claiming
+    /// vBuckets.
+    std::atomic<bool> loadStopped{false};
+    /// Number of LoadingAccessLog / LoadingKVPairs / LoadingData tasks
+    /// scheduled for the current phase.
+    size_t numLoadTasks{0};
+
+    // Stores the time when the current phase (state) started; guarded by the
+    // mutex.
+    struct {
+        std::mutex mutex;
+        std::chrono::steady_clock::time_point time;
+    } phaseStart;
+
+    /// Time spent in each phase, indexed by WarmupState::State.
+    std::array<cb::AtomicDuration<>, size_t(WarmupState::State::Done) + 1>
+            phaseTimes;
+
     cb::AtomicDuration<> estimateTime;
     std::atomic<size_t> estimatedItemCount{std::numeric_limits<size_t>::max()};
     bool cleanShutdown{true};
@@ -459,6 +540,7 @@ private:
     friend class WarmupInitialize;
     friend class WarmupCreateVBuckets;
     friend class WarmupLoadingCollectionCounts;
+    friend class WarmupLoadingBloomFilters;
     friend class WarmupEstimateDatabaseItemCount;
     friend class WarmupLoadPreparedSyncWrites;
     friend class WarmupPopulateVBucketMap;
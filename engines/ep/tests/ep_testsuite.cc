@@ -6722,7 +6722,11 @@ static enum test_result test_mb19687_fixed(EngineIface* h) {
               "chk_items",
               "estimate"}},
             {"dcp",
-             {"ep_dcp_count",
+             {"ep_dcp_backfill_scans_joined",
+              "ep_dcp_compression_cache_hits",
+              "ep_dcp_compression_cache_mem_used",
+              "ep_dcp_compression_cache_misses",
+              "ep_dcp_count",
               "ep_dcp_dead_conn_count",
               "ep_dcp_items_remaining",
               "ep_dcp_items_sent",
@@ -6855,8 +6859,13 @@ static enum test_result test_mb19687_fixed(EngineIface* h) {
               "ep_bfilter_fp_prob",
               "ep_bfilter_key_count",
               "ep_bfilter_residency_threshold",
+              "ep_bfilter_type",
+              "ep_bg_fetcher_coalesce_window_us",
+              "ep_bg_fetcher_tasks",
               "ep_bucket_type",
               "ep_cache_size",
+              "ep_chk_expel_eager",
+              "ep_chk_expel_eager_min_items",
               "ep_chk_expel_enabled",
               "ep_chk_max_items",
               "ep_chk_period",
@@ -6876,6 +6885,9 @@ static enum test_result test_mb19687_fixed(EngineIface* h) {
               "ep_data_traffic_enabled",
               "ep_dbname",
               "ep_dcp_backfill_byte_limit",
+              "ep_dcp_backfill_readahead_size",
+              "ep_dcp_backfill_shared_scans",
+              "ep_dcp_compression_cache_size",
               "ep_dcp_conn_buffer_size",
               "ep_dcp_conn_buffer_size_aggr_mem_threshold",
               "ep_dcp_conn_buffer_size_aggressive_perc",
@@ -6890,6 +6902,7 @@ static enum test_result test_mb19687_fixed(EngineIface* h) {
               "ep_dcp_producer_snapshot_marker_yield_limit",
               "ep_dcp_consumer_process_buffered_messages_yield_limit",
               "ep_dcp_consumer_process_buffered_messages_batch_size",
+              "ep_dcp_consumer_processor_tasks",
               "ep_dcp_scan_byte_limit",
               "ep_dcp_scan_item_limit",
               "ep_dcp_takeover_max_time",
@@ -6899,11 +6912,14 @@ static enum test_result test_mb19687_fixed(EngineIface* h) {
               "ep_defragmenter_interval",
               "ep_defragmenter_stored_value_age_threshold",
               "ep_durability_timeout_task_interval",
+              "ep_executor_work_stealing",
               "ep_exp_pager_enabled",
               "ep_exp_pager_initial_run_time",
               "ep_exp_pager_stime",
               "ep_failpartialwarmup",
               "ep_flusher_batch_split_trigger",
+              "ep_flusher_group_commit_time_ms",
+              "ep_flusher_pipeline_enabled",
               "ep_fsync_after_every_n_bytes_written",
               "ep_couchstore_tracing",
               "ep_couchstore_write_validation",
@@ -6912,8 +6928,10 @@ static enum test_result test_mb19687_fixed(EngineIface* h) {
               "ep_getl_max_timeout",
               "ep_hlc_drift_ahead_threshold_us",
               "ep_hlc_drift_behind_threshold_us",
+              "ep_ht_layout",
               "ep_ht_locks",
               "ep_ht_resize_interval",
+              "ep_ht_resize_mode",
               "ep_ht_size",
               "ep_item_compressor_chunk_duration",
               "ep_item_compressor_interval",
@@ -7041,8 +7059,11 @@ static enum test_result test_mb19687_fixed(EngineIface* h) {
               "ep_bfilter_fp_prob",
               "ep_bfilter_key_count",
               "ep_bfilter_residency_threshold",
+              "ep_bfilter_type",
               "ep_bg_fetch_avg_read_amplification",
               "ep_bg_fetched",
+              "ep_bg_fetcher_coalesce_window_us",
+              "ep_bg_fetcher_tasks",
               "ep_bg_meta_fetched",
               "ep_bg_remaining_items",
               "ep_bg_remaining_jobs",
@@ -7051,6 +7072,8 @@ static enum test_result test_mb19687_fixed(EngineIface* h) {
               "ep_bucket_priority",
               "ep_bucket_type",
               "ep_cache_size",
+              "ep_chk_expel_eager",
+              "ep_chk_expel_eager_min_items",
               "ep_chk_expel_enabled",
               "ep_chk_max_items",
               "ep_chk_period",
@@ -7078,6 +7101,9 @@ static enum test_result test_mb19687_fixed(EngineIface* h) {
               "ep_data_traffic_enabled",
               "ep_dbname",
               "ep_dcp_backfill_byte_limit",
+              "ep_dcp_backfill_readahead_size",
+              "ep_dcp_backfill_shared_scans",
+              "ep_dcp_compression_cache_size",
               "ep_dcp_conn_buffer_size",
               "ep_dcp_conn_buffer_size_aggr_mem_threshold",
               "ep_dcp_conn_buffer_size_aggressive_perc",
@@ -7085,6 +7111,7 @@ static enum test_result test_mb19687_fixed(EngineIface* h) {
               "ep_dcp_conn_buffer_size_perc",
               "ep_dcp_consumer_process_buffered_messages_batch_size",
               "ep_dcp_consumer_process_buffered_messages_yield_limit",
+              "ep_dcp_consumer_processor_tasks",
               "ep_dcp_enable_noop",
               "ep_dcp_flow_control_policy",
               "ep_dcp_idle_timeout",
@@ -7110,6 +7137,7 @@ static enum test_result test_mb19687_fixed(EngineIface* h) {
               "ep_diskqueue_memory",
               "ep_diskqueue_pending",
               "ep_durability_timeout_task_interval",
+              "ep_executor_work_stealing",
               "ep_exp_pager_enabled",
               "ep_exp_pager_initial_run_time",
               "ep_exp_pager_stime",
@@ -7121,6 +7149,8 @@ static enum test_result test_mb19687_fixed(EngineIface* h) {
               "ep_flush_all",
               "ep_flush_duration_total",
               "ep_flusher_batch_split_trigger",
+              "ep_flusher_group_commit_time_ms",
+              "ep_flusher_pipeline_enabled",
               "ep_fsync_after_every_n_bytes_written",
               "ep_couchstore_tracing",
               "ep_couchstore_write_validation",
@@ -7129,8 +7159,10 @@ static enum test_result test_mb19687_fixed(EngineIface* h) {
               "ep_getl_max_timeout",
               "ep_hlc_drift_ahead_threshold_us",
               "ep_hlc_drift_behind_threshold_us",
+              "ep_ht_layout",
               "ep_ht_locks",
               "ep_ht_resize_interval",
+              "ep_ht_resize_mode",
               "ep_ht_size",
               "ep_io_bg_fetch_read_count",
               "ep_io_compaction_read_bytes",
@@ -7161,6 +7193,7 @@ static enum test_result test_mb19687_fixed(EngineIface* h) {
               "ep_max_threads",
               "ep_max_ttl",
               "ep_max_vbuckets",
+              "ep_mem_freed_by_checkpoint_item_expel",
               "ep_mem_high_wat",
               "ep_mem_high_wat_percent",
               "ep_mem_low_wat",
@@ -1619,6 +1619,40 @@ static enum test_result test_dcp_consumer_flow_control_static(EngineIface* h) {
     return SUCCESS;
 }
 
+static enum test_result test_dcp_consumer_flow_control_adaptive(
+        EngineIface* h) {
+    const auto* cookie1 = testHarness->create_cookie();
+    const std::string name("unittest");
+    const uint32_t opaque = 0;
+    const uint32_t seqno = 0;
+    const uint32_t flags = 0;
+    const auto flow_ctl_buf_min = 10485760;
+    auto dcp = requireDcpIface(h);
+
+    checkeq(ENGINE_SUCCESS,
+            dcp->open(cookie1,
+                      opaque,
+                      seqno,
+                      flags,
+                      name,
+                      R"({"consumer_name":"replica1"})"),
+            "Failed dcp consumer open connection.");
+
+    /* A new connection starts at the min size until it has measured its
+       round trip time and drain rate */
+    const auto stat_name("eq_dcpq:" + name + ":max_buffer_bytes");
+    checkeq(flow_ctl_buf_min,
+            get_int_stat(h, stat_name.c_str(), "dcp"),
+            "Flow Control Buffer Size not equal to min value");
+    const auto rtt_stat_name("eq_dcpq:" + name + ":round_trip_time_us");
+    checkeq(0,
+            get_int_stat(h, rtt_stat_name.c_str(), "dcp"),
+            "Round trip time should not be measured yet");
+    testHarness->destroy_cookie(cookie1);
+
+    return SUCCESS;
+}
+
 static enum test_result test_dcp_consumer_flow_control_dynamic(EngineIface* h) {
     const auto* cookie1 = testHarness->create_cookie();
     const std::string name("unittest");
@@ -7829,6 +7863,10 @@ BaseTestCase testsuite_testcases[] = {
                  test_dcp_consumer_flow_control_aggressive,
                  test_setup, teardown, "dcp_flow_control_policy=aggressive",
                  prepare, cleanup),
+        TestCase("test dcp consumer flow control adaptive",
+                 test_dcp_consumer_flow_control_adaptive,
+                 test_setup, teardown, "dcp_flow_control_policy=adaptive",
+                 prepare, cleanup),
         TestCase("test open producer", test_dcp_producer_open,
                  test_setup, teardown, nullptr, prepare, cleanup),
         TestCase("test open producer same cookie", test_dcp_producer_open_same_cookie,
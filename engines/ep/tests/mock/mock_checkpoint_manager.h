@@ -50,7 +50,7 @@ public:
      * @return the next item to be sent to a given connection.
      */
     queued_item nextItem(CheckpointCursor* cursor, bool& isLastMutationItem) {
-        LockHolder lh(queueLock);
+        WriteLockHolder lh(queueLock);
         static StoredDocKey emptyKey("", CollectionID::System);
         if (!cursor) {
             queued_item qi(
@@ -75,12 +75,12 @@ public:
     }
 
     size_t getNumOfCursors() const {
-        LockHolder lh(queueLock);
+        WriteLockHolder lh(queueLock);
         return connCursors.size();
     }
 
     size_t getNumCheckpoints() const {
-        LockHolder lh(queueLock);
+        WriteLockHolder lh(queueLock);
         return checkpointList.size();
     }
 
@@ -91,7 +91,7 @@ public:
     queued_item public_createCheckpointItem(uint64_t id,
                                             Vbid vbid,
                                             queue_op checkpoint_op) {
-        LockHolder lh(queueLock);
+        WriteLockHolder lh(queueLock);
         return createCheckpointItem(id, vbid, checkpoint_op);
     }
 
@@ -100,7 +100,7 @@ public:
     }
 
     void forceNewCheckpoint() {
-        LockHolder lh(queueLock);
+        WriteLockHolder lh(queueLock);
         checkOpenCheckpoint_UNLOCKED(lh, true, 0);
     }
 
@@ -516,6 +516,42 @@ TEST_F(BasicLinkedListTest, RangeIterator) {
     EXPECT_EQ(expectedSeqno, actualSeqno);
 }
 
+/* Check that a range iterator created from a seqno starts at the first item
+   at or after it, including after indexed items have been moved */
+TEST_F(BasicLinkedListTest, RangeIteratorFromSeqno) {
+    const int numItems = 1000;
+    const std::string keyPrefix("key");
+    addNewItemsToList(1, keyPrefix, numItems);
+
+    /* Move every 4th item of the first 300 (which includes items 1, 65, 129,
+       ... which were indexed) to the end of the list */
+    seqno_t highSeqno = numItems;
+    for (int i = 1; i <= 300; i += 4) {
+        updateItem(highSeqno, keyPrefix + std::to_string(i));
+        ++highSeqno;
+    }
+
+    /* Item 257 has been moved, so the iterator should start at 258 */
+    const seqno_t startSeqno = 257;
+    std::vector<seqno_t> expectedSeqno;
+    for (auto seqno : basicLL->getAllSeqnoForVerification()) {
+        if (seqno >= startSeqno) {
+            expectedSeqno.push_back(seqno);
+        }
+    }
+
+    auto itr = basicLL->makeRangeIterator(true /*isBackfill*/, startSeqno);
+    ASSERT_TRUE(itr);
+    EXPECT_EQ(startSeqno + 1, itr->curr());
+
+    std::vector<seqno_t> actualSeqno;
+    while (itr->curr() != itr->end()) {
+        actualSeqno.push_back((**itr).getBySeqno());
+        ++(*itr);
+    }
+    EXPECT_EQ(expectedSeqno, actualSeqno);
+}
+
 TEST_F(BasicLinkedListTest, RangeIteratorNoItems) {
     auto itr = getRangeIterator();
     /* Since there are no items in the list to iterate over, we expect itr start
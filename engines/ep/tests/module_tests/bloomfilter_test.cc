@@ -80,6 +80,76 @@ TEST_P(BloomFilterDocKeyTest, check_maybeKeyExist) {
     }
 }
 
+class BloomFilterBlockedTest : public BloomFilter, public ::testing::Test {
+public:
+    BloomFilterBlockedTest()
+        : BloomFilter(10000, 0.01, BFILTER_ENABLED, Type::Blocked) {
+    }
+};
+
+TEST_F(BloomFilterBlockedTest, BlocksCachelineAligned) {
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(blocks) % (bitsPerBlock / 8));
+    EXPECT_EQ(0, getFilterSize() % bitsPerBlock);
+    EXPECT_GE(getFilterSize(), estimateFilterSize(10000, 0.01));
+}
+
+// Every probe of a key must land in the same block.
+TEST_F(BloomFilterBlockedTest, SingleBlockPerKey) {
+    auto key = makeStoredDocKey("key");
+    addKey(key);
+    block_mask_type mask;
+    const uint64_t* block = getBlockForKey(key, mask);
+
+    size_t bitsSet = 0;
+    for (size_t i = 0; i < numBlocks * wordsPerBlock; i++) {
+        bitsSet += __builtin_popcountll(blocks[i]);
+    }
+    size_t blockBitsSet = 0;
+    for (size_t i = 0; i < wordsPerBlock; i++) {
+        blockBitsSet += __builtin_popcountll(block[i]);
+        EXPECT_EQ(mask[i], block[i]);
+    }
+    EXPECT_EQ(noOfHashes, blockBitsSet);
+    EXPECT_EQ(bitsSet, blockBitsSet);
+}
+
+TEST_F(BloomFilterBlockedTest, NoFalseNegatives) {
+    const size_t keys = 10000;
+    for (size_t i = 0; i < keys; i++) {
+        addKey(makeStoredDocKey("key_" + std::to_string(i)));
+    }
+    for (size_t i = 0; i < keys; i++) {
+        auto key = makeStoredDocKey("key_" + std::to_string(i));
+        EXPECT_TRUE(maybeKeyExists(key));
+    }
+    EXPECT_GT(getNumOfKeysInFilter(), keys * 0.99);
+}
+
+// A blocked filter trades a little accuracy for locality; check the false
+// positive rate is still close to the one requested.
+TEST_F(BloomFilterBlockedTest, FalsePositiveRate) {
+    const size_t keys = 10000;
+    for (size_t i = 0; i < keys; i++) {
+        addKey(makeStoredDocKey("key_" + std::to_string(i)));
+    }
+    size_t falsePositives = 0;
+    for (size_t i = 0; i < keys; i++) {
+        if (maybeKeyExists(makeStoredDocKey("miss_" + std::to_string(i)))) {
+            falsePositives++;
+        }
+    }
+    EXPECT_LT(falsePositives, keys * 0.03);
+}
+
+TEST_F(BloomFilterBlockedTest, Disable) {
+    auto key = makeStoredDocKey("key");
+    addKey(key);
+    setStatus(BFILTER_DISABLED);
+    EXPECT_EQ(0, getFilterSize());
+    // A disabled filter must not rule any key out.
+    EXPECT_TRUE(maybeKeyExists(makeStoredDocKey("other")));
+}
+
 // Test params includes our labelled collections that have 'special meaning' and
 // one normal collection ID (100)
 static std::vector<CollectionID> allDocNamespaces = {
@@ -109,11 +109,6 @@ TEST_F(CheckpointRemoverEPTest, CheckpointManagerMemoryUsage) {
     // We should have one checkpoint which is for the state change
     ASSERT_EQ(1, checkpointManager->getNumCheckpoints());
 
-    // The queue (toWrite) is implemented as std:list, therefore
-    // when we add an item it results in the creation of 3 pointers -
-    // forward ptr, backward ptr and ptr to object.
-    const size_t perElementOverhead = 3 * sizeof(uintptr_t);
-
     // Allocator used for tracking memory used by the CheckpointQueue
     checkpoint_index::allocator_type memoryTrackingAllocator;
     // Emulate the Checkpoint metaKeyIndex so we can determine the number
@@ -131,25 +126,24 @@ TEST_F(CheckpointRemoverEPTest, CheckpointManagerMemoryUsage) {
 
     // Check that the expected memory usage of the checkpoints is correct
     size_t expected_size = 0;
+    size_t lastCheckpointItems = 0;
     for (auto& checkpoint :
          CheckpointManagerTestIntrospector::public_getCheckpointList(
                  *checkpointManager)) {
         // Add the overhead of the Checkpoint object
         expected_size += sizeof(Checkpoint);
-#ifdef WIN32
-        // On windows for an empty list we still allocate space for
-        // containing one element.
-        expected_size += perElementOverhead;
-#endif
 
+        size_t numItems = 0;
         for (auto itr = checkpoint->begin(); itr != checkpoint->end(); ++itr) {
             // Add the size of the item
             expected_size += (*itr)->size();
-            // Add the size of adding to the queue
-            expected_size += perElementOverhead;
+            ++numItems;
             // Add to the emulated metaKeyIndex
             metaKeyIndex.emplace((*itr)->getKey(), entry);
         }
+        // Add the chunks the queue (toWrite) has allocated for the items
+        expected_size += CheckpointQueue::getBytesForElements(numItems);
+        lastCheckpointItems = numItems;
     }
 
     const auto metaKeyIndexSize =
@@ -163,8 +157,10 @@ TEST_F(CheckpointRemoverEPTest, CheckpointManagerMemoryUsage) {
     size_t new_expected_size = expected_size;
     // Add the size of the item
     new_expected_size += item.size();
-    // Add the size of adding to the queue
-    new_expected_size += perElementOverhead;
+    // Add any chunk the queue needed to allocate for the item
+    new_expected_size +=
+            CheckpointQueue::getBytesForElements(lastCheckpointItems + 1) -
+            CheckpointQueue::getBytesForElements(lastCheckpointItems);
     // Add to the keyIndex
     keyIndex.emplace(
             CheckpointIndexKey(item.getKey(),
@@ -254,20 +250,12 @@ TEST_F(CheckpointRemoverEPTest, CursorDropMemoryFreed) {
 
     createDcpStream(*producer);
 
-    // The queue (toWrite) is implemented as std:list, therefore
-    // when we add an item it results in the creation of 3 pointers -
-    // forward ptr, backward ptr and ptr to object.
-    const size_t perElementOverhead = 3 * sizeof(uintptr_t);
-
     // Allocator used for tracking memory used by the CheckpointQueue
     checkpoint_index::allocator_type memoryTrackingAllocator;
-    // Emulate the Checkpoint keyIndex so we can determine the number
-    // of bytes that should be allocated during its use.
+    // Emulate the Checkpoint metaKeyIndex and keyIndex so we can determine
+    // the number of bytes that should be allocated during their use.
+    meta_checkpoint_index metaKeyIndex(memoryTrackingAllocator);
     checkpoint_index keyIndex(memoryTrackingAllocator);
-    // Grab the initial size of the keyIndex because on Windows an empty
-    // std::unordered_map allocated 200 bytes.
-    const auto initialKeyIndexSize =
-            *(keyIndex.get_allocator().getBytesAllocated());
     ChkptQueueIterator iterator =
             CheckpointManagerTestIntrospector::public_getCheckpointList(
                     *checkpointManager)
@@ -275,19 +263,28 @@ TEST_F(CheckpointRemoverEPTest, CursorDropMemoryFreed) {
                     ->begin();
     index_entry entry{iterator, 0};
 
+    // The initial checkpoint only holds meta items (including the initial
+    // setVBucketState), all of which are in the metaKeyIndex.
+    size_t numQueued = 0;
+    auto& firstCheckpoint =
+            *CheckpointManagerTestIntrospector::public_getCheckpointList(
+                     *checkpointManager)
+                     .front();
+    for (auto itr = firstCheckpoint.begin(); itr != firstCheckpoint.end();
+         ++itr) {
+        metaKeyIndex.emplace((*itr)->getKey(), entry);
+        ++numQueued;
+    }
+    const auto initialQueued = numQueued;
+    const auto initialIndexSize =
+            *(keyIndex.get_allocator().getBytesAllocated());
+
     auto expectedFreedMemoryFromItems = initialSize;
-    // The initial setVBucketState is a meta item and will be dropped when we
-    // drop the first checkpoint. It is slightly smaller than an item enqueued
-    // in the keyIndex as it does not include the CheckpointIndexKeyNamespace
-    // the CheckpointIndexKeyNamespace ends up generating 3 bytes of padding,
-    // which is also removed here
-    expectedFreedMemoryFromItems -= (sizeof(CheckpointIndexKeyNamespace) + 3);
     for (size_t i = 0; i < getMaxCheckpointItems(*vb); i++) {
         std::string doc_key = "key_" + std::to_string(i);
         Item item = store_item(vbid, makeStoredDocKey(doc_key), "value");
         expectedFreedMemoryFromItems += item.size();
-        // Add the size of adding to the queue
-        expectedFreedMemoryFromItems += perElementOverhead;
+        ++numQueued;
         // Add to the emulated keyIndex
         keyIndex.emplace(
                 CheckpointIndexKey(
@@ -319,25 +316,21 @@ TEST_F(CheckpointRemoverEPTest, CursorDropMemoryFreed) {
     // Needed to calculate the size of a checkpoint_end queued_item
     StoredDocKey key("checkpoint_end", CollectionID::System);
     queued_item chkptEnd(new Item(key, vbid, queue_op::checkpoint_end, 0, 0));
-    // checkpoint_end is a meta item and has slightly smaller size than an item
-    // enqueued in the keyIndex as it does not include the
-    // CheckpointIndexKeyNamespace
-    expectedFreedMemoryFromItems -= (sizeof(CheckpointIndexKeyNamespace) + 3);
 
     // Add the size of the checkpoint end
     expectedFreedMemoryFromItems += chkptEnd->size();
-    // Add the size of adding to the queue
-    expectedFreedMemoryFromItems += perElementOverhead;
-    // Add to the emulated keyIndex
-    keyIndex.emplace(
-            CheckpointIndexKey(chkptEnd->getKey(),
-                               chkptEnd->isCommitted()
-                                       ? CheckpointIndexKeyNamespace::Committed
-                                       : CheckpointIndexKeyNamespace::Prepared),
-            entry);
-
-    const auto keyIndexSize = *(keyIndex.get_allocator().getBytesAllocated());
-    expectedFreedMemoryFromItems += (keyIndexSize - initialKeyIndexSize);
+    ++numQueued;
+    // Add to the emulated metaKeyIndex
+    metaKeyIndex.emplace(chkptEnd->getKey(), entry);
+
+    // Add the chunks the queue (toWrite) allocated for the new items
+    expectedFreedMemoryFromItems +=
+            CheckpointQueue::getBytesForElements(numQueued) -
+            CheckpointQueue::getBytesForElements(initialQueued);
+    // As the metaKeyIndex and keyIndex share the same allocator, this is the
+    // growth of both indexes.
+    const auto indexSize = *(keyIndex.get_allocator().getBytesAllocated());
+    expectedFreedMemoryFromItems += (indexSize - initialIndexSize);
 
     // Manually handle the slow stream, this is the same logic as the checkpoint
     // remover task uses, just without the overhead of setting up the task
@@ -816,3 +809,86 @@ TEST_F(CheckpointRemoverEPTest, UseOpenCheckpointIfCanDedupeAfterExpel) {
     // We should have decremented numItems when we added again
     EXPECT_EQ(3, cm->getNumOpenChkItems());
 }
+
+// With chk_expel_eager, items are expelled as soon as the last cursor in the
+// oldest checkpoint fetches past them, without the remover task running.
+TEST_F(CheckpointRemoverEPTest, expelEagerlyOnceAllCursorsPass) {
+    engine->getConfiguration().setChkExpelEager(true);
+    engine->getConfiguration().setChkExpelEagerMinItems(1);
+    setVBucketStateAndRunPersistTask(vbid, vbucket_state_active);
+
+    auto vb = engine->getVBucket(vbid);
+    auto* cm = static_cast<MockCheckpointManager*>(vb->checkpointManager.get());
+    ASSERT_TRUE(cm->getCheckpointConfig().isExpelEager());
+
+    // A second cursor at the start of the checkpoint, which holds back
+    // expelling until it has also moved past the items.
+    auto regRes = cm->registerCursorBySeqno("Cursor1", 0);
+    auto cursor = regRes.cursor.lock();
+
+    // Three items needed to expel anything; see
+    // expelsOnlyIfOldestCheckpointIsReferenced.
+    for (int i = 0; i < 3; i++) {
+        store_item(vbid, makeStoredDocKey("key_" + std::to_string(i)), "value");
+    }
+    flush_vbucket_to_disk(vbid, 3);
+
+    EXPECT_EQ(0, engine->getEpStats().itemsExpelledFromCheckpoints);
+    EXPECT_EQ(0, engine->getEpStats().memFreedByCheckpointItemExpel);
+
+    std::vector<queued_item> items;
+    cm->getNextItemsForCursor(cursor.get(), items);
+
+    EXPECT_LT(0, engine->getEpStats().itemsExpelledFromCheckpoints);
+    EXPECT_LT(0, engine->getEpStats().memFreedByCheckpointItemExpel);
+
+    // Disabled, fetching does not expel.
+    engine->getConfiguration().setChkExpelEager(false);
+    const size_t expelled =
+            engine->getEpStats().itemsExpelledFromCheckpoints.load();
+    for (int i = 3; i < 6; i++) {
+        store_item(vbid, makeStoredDocKey("key_" + std::to_string(i)), "value");
+    }
+    flush_vbucket_to_disk(vbid, 3);
+    items.clear();
+    cm->getNextItemsForCursor(cursor.get(), items);
+    EXPECT_EQ(expelled, engine->getEpStats().itemsExpelledFromCheckpoints);
+}
+
+// Eager expels (which take the queueLock exclusively) are only done once
+// cursors have fetched chk_expel_eager_min_items from the oldest checkpoint,
+// not on every fetch.
+TEST_F(CheckpointRemoverEPTest, expelEagerlyRateLimited) {
+    engine->getConfiguration().setChkExpelEager(true);
+    engine->getConfiguration().setChkExpelEagerMinItems(40);
+    setVBucketStateAndRunPersistTask(vbid, vbucket_state_active);
+
+    auto vb = engine->getVBucket(vbid);
+    auto* cm = static_cast<MockCheckpointManager*>(vb->checkpointManager.get());
+    ASSERT_EQ(40, cm->getCheckpointConfig().getExpelEagerMinItems());
+
+    auto regRes = cm->registerCursorBySeqno("Cursor1", 0);
+    auto cursor = regRes.cursor.lock();
+
+    // The persistence cursor and Cursor1 fetch fewer than 40 items between
+    // them (the 3 mutations each, plus a few meta items); nothing is
+    // expelled.
+    for (int i = 0; i < 3; i++) {
+        store_item(vbid, makeStoredDocKey("key_" + std::to_string(i)), "value");
+    }
+    flush_vbucket_to_disk(vbid, 3);
+    std::vector<queued_item> items;
+    cm->getNextItemsForCursor(cursor.get(), items);
+    EXPECT_EQ(0, engine->getEpStats().itemsExpelledFromCheckpoints);
+
+    // The flusher fetching 20 more doesn't reach the threshold; Cursor1
+    // fetching them does, and expels everything both cursors have passed.
+    for (int i = 3; i < 23; i++) {
+        store_item(vbid, makeStoredDocKey("key_" + std::to_string(i)), "value");
+    }
+    flush_vbucket_to_disk(vbid, 20);
+    EXPECT_EQ(0, engine->getEpStats().itemsExpelledFromCheckpoints);
+    items.clear();
+    cm->getNextItemsForCursor(cursor.get(), items);
+    EXPECT_LT(0, engine->getEpStats().itemsExpelledFromCheckpoints);
+}
@@ -1587,6 +1587,39 @@ TYPED_TEST(CheckpointTest, dedupeMemoryTest) {
     EXPECT_LT(memoryUsage3, memoryUsage4);
 }
 
+// Test that repeatedly de-duplicating a key reclaims the space of the
+// de-duplicated items from the queue, and that cursors are moved along with
+// the items they point to.
+TYPED_TEST(CheckpointTest, dedupeCompactsQueue) {
+    auto dcpCursor = this->manager->registerCursorBySeqno("dcp", 0);
+    ASSERT_TRUE(this->queueNewItem("key0"));
+    ASSERT_TRUE(this->queueNewItem("key1"));
+
+    // Move the cursor to the end of the checkpoint (key1).
+    std::vector<queued_item> items;
+    this->manager->getNextItemsForCursor(dcpCursor.cursor.lock().get(), items);
+    ASSERT_EQ(3, items.size());
+
+    const auto initialOverhead = this->manager->getMemoryOverhead();
+    for (int ii = 0; ii < 10 * int(CheckpointQueue::ChunkSize); ++ii) {
+        EXPECT_FALSE(this->queueNewItem("key0"));
+    }
+    EXPECT_EQ(1, this->manager->getNumCheckpoints());
+
+    // Without compaction the queue would hold every de-duplicated item.
+    EXPECT_LE(this->manager->getMemoryOverhead(),
+              initialOverhead + CheckpointQueue::getBytesForElements(
+                                        2 * CheckpointQueue::ChunkSize));
+
+    // The cursor should still be at key1, so next see the latest key0.
+    ASSERT_TRUE(this->queueNewItem("key2"));
+    items.clear();
+    this->manager->getNextItemsForCursor(dcpCursor.cursor.lock().get(), items);
+    ASSERT_EQ(2, items.size());
+    EXPECT_EQ(makeStoredDocKey("key0"), items[0]->getKey());
+    EXPECT_EQ(makeStoredDocKey("key2"), items[1]->getKey());
+}
+
 // Test that the checkpoint memory stat is correctly maintained when
 // de-duplication occurs and also when the checkpoint containing the
 // mutation is removed.
@@ -1629,18 +1662,12 @@ TYPED_TEST(CheckpointTest, checkpointMemoryTest) {
                               GenerateCas::Yes,
                               /*preLinkDocCtx*/ nullptr);
 
-    // The queue (toWrite) is implemented as std:list, therefore
-    // when we add an item it results in the creation of 3 pointers -
-    // forward ptr, backward ptr and ptr to object.
-    const size_t perElementOverhead = 3 * sizeof(uintptr_t);
-
     // Check that checkpoint size is the initial size plus the addition of
     // qiSmall.
     auto expectedSize = initialSize;
-    // Add the size of the item
+    // Add the size of the item. The queue (toWrite) has space for it in its
+    // first chunk, so needs no more memory.
     expectedSize += qiSmall->size();
-    // Add the size of adding to the queue
-    expectedSize += perElementOverhead;
     // Add to the emulated keyIndex
     keyIndex.emplace(
             CheckpointIndexKey(qiSmall->getKey(),
@@ -1678,8 +1705,6 @@ TYPED_TEST(CheckpointTest, checkpointMemoryTest) {
     expectedSize = initialSize;
     // Add the size of the item
     expectedSize += qiBig->size();
-    // Add the size of adding to the queue
-    expectedSize += perElementOverhead;
     // Add to the keyIndex
     keyIndex.emplace(
             CheckpointIndexKey(qiBig->getKey(),
@@ -1767,8 +1792,6 @@ TYPED_TEST(CheckpointTest, checkpointTrackingMemoryOverheadTest) {
 
     // Re-measure the checkpoint overhead
     const auto updatedOverhead = this->manager->getMemoryOverhead();
-    // Three pointers - forward, backward and pointer to item
-    const auto perElementListOverhead = sizeof(uintptr_t) * 3;
     // Add entry into keyIndex
     keyIndex.emplace(
             CheckpointIndexKey(qiSmall->getKey(),
@@ -1778,7 +1801,9 @@ TYPED_TEST(CheckpointTest, checkpointTrackingMemoryOverheadTest) {
             entry);
 
     const auto keyIndexSize = *(keyIndex.get_allocator().getBytesAllocated());
-    EXPECT_EQ(perElementListOverhead + (keyIndexSize - initialKeyIndexSize),
+    // The queue (toWrite) has space for the item in its first chunk, so only
+    // the keyIndex grows.
+    EXPECT_EQ(keyIndexSize - initialKeyIndexSize,
               updatedOverhead - initialOverhead);
 
     bool isLastMutationItem;
@@ -2191,20 +2216,11 @@ TYPED_TEST(CheckpointTest, expelCheckpointItemsMemoryRecoveredTest) {
     // Get the memory usage after expelling
     auto checkpointMemoryUsageAfterExpel = this->manager->getMemoryUsage();
 
-    size_t extra = 0;
-    // A list is comprised of 3 pointers (forward, backwards and
-    // pointer to the element).
-    const size_t perElementOverhead = extra + (3 * sizeof(uintptr_t));
-#if WIN32
-    // On windows for an empty list we still allocate space for
-    // containing one element.
-    extra = perElementOverhead;
-#endif
-
     const size_t reductionInCheckpointMemoryUsage =
             checkpointMemoryUsageBeforeExpel - checkpointMemoryUsageAfterExpel;
-    const size_t checkpointListSaving =
-            (perElementOverhead * expelResult.expelCount);
+    // The expelled items were in the same chunk of the queue (toWrite) as the
+    // remaining items, so no chunk is freed.
+    const size_t checkpointQueueSaving = 0;
     const auto& checkpointStartItem =
             this->manager->public_createCheckpointItem(
                     0, Vbid(0), queue_op::checkpoint_start);
@@ -2214,7 +2230,7 @@ TYPED_TEST(CheckpointTest, expelCheckpointItemsMemoryRecoveredTest) {
     const size_t queuedItemSaving =
             (sizeOfItem * 2) + checkpointStartItem->size();
     const size_t expectedMemoryRecovered =
-            checkpointListSaving + queuedItemSaving;
+            checkpointQueueSaving + queuedItemSaving;
 
     EXPECT_EQ(3, expelResult.expelCount);
     EXPECT_EQ(expectedMemoryRecovered, expelResult.estimateOfFreeMemory);
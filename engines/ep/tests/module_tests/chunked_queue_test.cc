@@ -0,0 +1,163 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2019 Couchbase, Inc
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+
+#include "chunked_queue.h"
+#include "memory_tracking_allocator.h"
+
+#include <folly/portability/GTest.h>
+
+#include <memory>
+#include <vector>
+
+/*
+ * Unit tests for the ChunkedQueue
+ */
+
+using Queue = ChunkedQueue<std::shared_ptr<int>,
+                           MemoryTrackingAllocator<std::shared_ptr<int>>>;
+
+class ChunkedQueueTest : public ::testing::Test {
+public:
+    void push(int first, int last) {
+        for (int i = first; i < last; i++) {
+            queue.push_back(std::make_shared<int>(i));
+        }
+    }
+
+    std::vector<int> contents() {
+        std::vector<int> values;
+        for (auto& element : queue) {
+            values.push_back(element ? *element : -1);
+        }
+        return values;
+    }
+
+    size_t bytesAllocated() {
+        return *queue.get_allocator().getBytesAllocated();
+    }
+
+    MemoryTrackingAllocator<std::shared_ptr<int>> allocator;
+    Queue queue{allocator};
+};
+
+TEST_F(ChunkedQueueTest, initAssumptions) {
+    EXPECT_TRUE(queue.empty());
+    EXPECT_EQ(0, queue.size());
+    EXPECT_TRUE(queue.begin() == queue.end());
+    // The first chunk is allocated up front.
+    EXPECT_EQ(Queue::getBytesForElements(0), bytesAllocated());
+}
+
+// Pushing over chunk boundaries keeps the elements in order, and allocates a
+// chunk every ChunkSize elements.
+TEST_F(ChunkedQueueTest, pushBack) {
+    const int count = 3 * Queue::ChunkSize + 1;
+    push(0, count);
+    EXPECT_EQ(count, queue.size());
+    EXPECT_EQ(Queue::getBytesForElements(count), bytesAllocated());
+
+    int expected = 0;
+    for (auto it = queue.begin(); it != queue.end(); ++it, ++expected) {
+        EXPECT_EQ(expected, **it);
+        EXPECT_EQ(size_t(expected), it.getPosition());
+    }
+    EXPECT_EQ(count, expected);
+
+    // And backwards.
+    auto it = queue.end();
+    while (it != queue.begin()) {
+        --it;
+        EXPECT_EQ(--expected, **it);
+    }
+    EXPECT_EQ(0, expected);
+}
+
+// Iterators (including end()) remain valid as elements are pushed.
+TEST_F(ChunkedQueueTest, iteratorStability) {
+    push(0, Queue::ChunkSize - 1);
+    auto last = queue.end();
+    --last;
+    const auto end = queue.end();
+
+    push(Queue::ChunkSize - 1, 2 * Queue::ChunkSize);
+    EXPECT_EQ(Queue::ChunkSize - 2, **last);
+    EXPECT_EQ(Queue::ChunkSize - 1, **end);
+    EXPECT_EQ(Queue::ChunkSize - 1, end.getPosition());
+}
+
+// Removing from the front frees the chunks no longer used, and keeps the
+// positions of the remaining elements.
+TEST_F(ChunkedQueueTest, eraseFront) {
+    push(0, 3 * Queue::ChunkSize);
+    auto pos = queue.begin();
+    std::advance(pos, Queue::ChunkSize + 1);
+    auto weak = std::weak_ptr<int>(*queue.begin());
+
+    queue.erase_front(pos);
+    EXPECT_TRUE(weak.expired());
+    EXPECT_EQ(2 * Queue::ChunkSize - 1, queue.size());
+    EXPECT_EQ(Queue::ChunkSize + 1, **queue.begin());
+    EXPECT_EQ(Queue::ChunkSize + 1, queue.begin().getPosition());
+    // One chunk has been freed.
+    EXPECT_EQ(Queue::getBytesForElements(2 * Queue::ChunkSize), bytesAllocated());
+
+    queue.erase_front(queue.end());
+    EXPECT_TRUE(queue.empty());
+    EXPECT_EQ(Queue::getBytesForElements(0), bytesAllocated());
+
+    // The queue can be re-used.
+    push(0, 1);
+    EXPECT_EQ(std::vector<int>{0}, contents());
+}
+
+// remove_if compacts the remaining elements towards the front, reporting
+// where each one moved to, and frees the unused chunks.
+TEST_F(ChunkedQueueTest, removeIf) {
+    const int count = 3 * Queue::ChunkSize;
+    push(0, count);
+    // Drop the front element, then null out all odd values.
+    auto second = queue.begin();
+    ++second;
+    queue.erase_front(second);
+    for (auto& element : queue) {
+        if (*element % 2) {
+            element.reset();
+        }
+    }
+
+    std::vector<std::pair<size_t, size_t>> moves;
+    queue.remove_if([](const std::shared_ptr<int>& e) { return !e; },
+                    [&moves](size_t oldPos, Queue::iterator newPos) {
+                        moves.emplace_back(oldPos, newPos.getPosition());
+                    });
+
+    ASSERT_EQ(count / 2 - 1, queue.size());
+    ASSERT_EQ(queue.size(), moves.size());
+    int expected = 2;
+    size_t i = 0;
+    for (auto it = queue.begin(); it != queue.end(); ++it, ++i) {
+        EXPECT_EQ(expected, **it);
+        EXPECT_EQ(size_t(expected), moves[i].first);
+        EXPECT_EQ(it.getPosition(), moves[i].second);
+        expected += 2;
+    }
+    EXPECT_EQ(Queue::getBytesForElements(queue.size() + 1), bytesAllocated());
+
+    // Pushing continues from the new end.
+    push(count, count + 1);
+    EXPECT_EQ(count, **(--queue.end()));
+}
@@ -0,0 +1,93 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2019 Couchbase, Inc
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+
+#include "dcp/compressed_value_cache.h"
+#include "item.h"
+#include "test_helpers.h"
+
+#include <folly/portability/GTest.h>
+
+class CompressedValueCacheTest : public ::testing::Test {
+public:
+    Item makeItem(int64_t seqno, uint64_t cas = 1, Vbid vbid = Vbid(0)) {
+        auto item = make_item(vbid,
+                              makeStoredDocKey("key_" + std::to_string(seqno)),
+                              std::string(1024, 'x'));
+        item.setBySeqno(seqno);
+        item.setCas(cas);
+        return item;
+    }
+
+    /// @returns the compressed value of the item.
+    value_t compress(const Item& item) {
+        Item copy(item);
+        EXPECT_TRUE(copy.compressValue());
+        EXPECT_TRUE(mcbp::datatype::is_snappy(copy.getDataType()));
+        return copy.getValue();
+    }
+};
+
+TEST_F(CompressedValueCacheTest, FindInserted) {
+    CompressedValueCache cache(1024 * 1024);
+    auto item = makeItem(1);
+    EXPECT_FALSE(cache.find(item));
+
+    auto compressed = compress(item);
+    cache.insert(item, compressed);
+    EXPECT_EQ(compressed.get(), cache.find(item).get());
+    EXPECT_EQ(compressed->getSize(), cache.getSize());
+
+    // A different revision of the item (or vBucket) isn't a match.
+    EXPECT_FALSE(cache.find(makeItem(1, 2)));
+    EXPECT_FALSE(cache.find(makeItem(1, 1, Vbid(1))));
+}
+
+// Inserting an item which is already present keeps the first value.
+TEST_F(CompressedValueCacheTest, InsertExisting) {
+    CompressedValueCache cache(1024 * 1024);
+    auto item = makeItem(1);
+    auto first = compress(item);
+    cache.insert(item, first);
+    cache.insert(item, compress(item));
+    EXPECT_EQ(first.get(), cache.find(item).get());
+    EXPECT_EQ(first->getSize(), cache.getSize());
+}
+
+// The oldest values are evicted once the cache is full.
+TEST_F(CompressedValueCacheTest, Eviction) {
+    // Fill one shard worth of items (all items of the same vBucket and seqno
+    // map to the same shard).
+    const size_t valueSize = compress(makeItem(1))->getSize();
+    CompressedValueCache cache(valueSize * 2 * 16);
+    std::vector<Item> items;
+    for (uint64_t cas = 1; cas <= 3; cas++) {
+        items.push_back(makeItem(1, cas));
+        cache.insert(items.back(), compress(items.back()));
+    }
+    EXPECT_FALSE(cache.find(items[0]));
+    EXPECT_TRUE(cache.find(items[1]));
+    EXPECT_TRUE(cache.find(items[2]));
+    EXPECT_EQ(valueSize * 2, cache.getSize());
+}
+
+TEST_F(CompressedValueCacheTest, Disabled) {
+    CompressedValueCache cache(0);
+    auto item = makeItem(1);
+    cache.insert(item, compress(item));
+    EXPECT_FALSE(cache.find(item));
+    EXPECT_EQ(0, cache.getSize());
+}
@@ -1633,6 +1633,151 @@ TEST_P(SingleThreadedActiveStreamTest, DiskBackfillInitializingItemsRemaining) {
     EXPECT_TRUE(statusFound);
 }
 
+/// Test that a disk backfill of a second producer joins the first producer's
+/// scan of the vBucket, and both streams receive all the items.
+TEST_P(SingleThreadedActiveStreamTest, DiskBackfillSharedBetweenProducers) {
+    if (!persistent()) {
+        // Ephemeral buckets backfill from memory.
+        return;
+    }
+    engine->getConfiguration().setDcpBackfillSharedScans(true);
+    auto vb = engine->getVBucket(vbid);
+    auto& ckptMgr = *vb->checkpointManager;
+    stream.reset();
+
+    // Add items, flush them to disk, then clear checkpoint to force backfill.
+    store_item(vbid, makeStoredDocKey("key1"), "value");
+    store_item(vbid, makeStoredDocKey("key2"), "value");
+    store_item(vbid, makeStoredDocKey("key3"), "value");
+    ckptMgr.createNewCheckpoint();
+
+    flushVBucketToDiskIfPersistent(vbid, 3);
+
+    bool newCKptCreated;
+    ASSERT_EQ(3, ckptMgr.removeClosedUnrefCheckpoints(*vb, newCKptCreated));
+
+    setupProducer();
+    ASSERT_TRUE(stream->isBackfilling());
+
+    auto* cookie2 = create_mock_cookie();
+    auto producer2 = std::make_shared<MockDcpProducer>(*engine,
+                                                       cookie2,
+                                                       "test_producer2",
+                                                       0 /*flags*/,
+                                                       false /*startTask*/);
+    auto stream2 = std::make_shared<MockActiveStream>(engine.get(),
+                                                      producer2,
+                                                      0 /*flags*/,
+                                                      0 /*opaque*/,
+                                                      *vb,
+                                                      0 /*st_seqno*/,
+                                                      ~0 /*en_seqno*/,
+                                                      0x0 /*vb_uuid*/,
+                                                      0 /*snap_start_seqno*/,
+                                                      ~0 /*snap_end_seqno*/);
+    stream2->setActive();
+    ASSERT_TRUE(stream2->isBackfilling());
+
+    // Create the first scan, then the second backfill joins it.
+    auto& bfm = producer->getBFM();
+    auto& bfm2 = producer2->getBFM();
+    bfm.backfill();
+    bfm2.backfill();
+    auto& sharedScans = engine->getDcpConnMap().getSharedBackfillScans();
+    EXPECT_EQ(1, sharedScans.getNumJoined());
+
+    // One scan delivers the snapshot marker and 3 mutations to both streams.
+    bfm.backfill();
+    EXPECT_EQ(4, stream->public_readyQSize());
+    EXPECT_EQ(4, stream2->public_readyQSize());
+
+    // The joined backfill finds the scan finished; complete both.
+    bfm2.backfill();
+    bfm2.backfill();
+    bfm.backfill();
+    EXPECT_EQ(4, stream->public_readyQSize());
+    EXPECT_EQ(4, stream2->public_readyQSize());
+
+    stream2.reset();
+    producer2.reset();
+    destroy_mock_cookie(cookie2);
+}
+
+/// Test that when a shared scan is paused on one producer's full backfill
+/// buffer, the other producer's backfill snoozes instead of re-running the
+/// scan.
+TEST_P(SingleThreadedActiveStreamTest, DiskBackfillSharedPausedSnoozes) {
+    if (!persistent()) {
+        // Ephemeral buckets backfill from memory.
+        return;
+    }
+    engine->getConfiguration().setDcpBackfillSharedScans(true);
+    auto vb = engine->getVBucket(vbid);
+    auto& ckptMgr = *vb->checkpointManager;
+    stream.reset();
+
+    store_item(vbid, makeStoredDocKey("key1"), "value");
+    store_item(vbid, makeStoredDocKey("key2"), "value");
+    store_item(vbid, makeStoredDocKey("key3"), "value");
+    ckptMgr.createNewCheckpoint();
+
+    flushVBucketToDiskIfPersistent(vbid, 3);
+
+    bool newCKptCreated;
+    ASSERT_EQ(3, ckptMgr.removeClosedUnrefCheckpoints(*vb, newCKptCreated));
+
+    setupProducer();
+    ASSERT_TRUE(stream->isBackfilling());
+    // The first producer's buffer only takes one item at a time.
+    producer->setBackfillBufferSize(1);
+
+    auto* cookie2 = create_mock_cookie();
+    auto producer2 = std::make_shared<MockDcpProducer>(*engine,
+                                                       cookie2,
+                                                       "test_producer2",
+                                                       0 /*flags*/,
+                                                       false /*startTask*/);
+    auto stream2 = std::make_shared<MockActiveStream>(engine.get(),
+                                                      producer2,
+                                                      0 /*flags*/,
+                                                      0 /*opaque*/,
+                                                      *vb,
+                                                      0 /*st_seqno*/,
+                                                      ~0 /*en_seqno*/,
+                                                      0x0 /*vb_uuid*/,
+                                                      0 /*snap_start_seqno*/,
+                                                      ~0 /*snap_end_seqno*/);
+    stream2->setActive();
+    ASSERT_TRUE(stream2->isBackfilling());
+
+    auto& bfm = producer->getBFM();
+    auto& bfm2 = producer2->getBFM();
+    bfm.backfill();
+    bfm2.backfill();
+    auto& sharedScans = engine->getDcpConnMap().getSharedBackfillScans();
+    ASSERT_EQ(1, sharedScans.getNumJoined());
+
+    // The scan delivers key1 to both streams, then pauses on the first
+    // stream's full buffer.
+    bfm.backfill();
+    EXPECT_EQ(2, stream->public_readyQSize());
+    EXPECT_EQ(2, stream2->public_readyQSize());
+
+    // The second backfill finds the scan blocked and snoozes...
+    EXPECT_EQ(backfill_success, bfm2.backfill());
+    EXPECT_EQ(2, stream2->public_readyQSize());
+    // ... so the second manager has nothing to run; its task sleeps rather
+    // than re-running the scan.
+    EXPECT_EQ(backfill_snooze, bfm2.backfill());
+    EXPECT_EQ(backfill_snooze, bfm2.backfill());
+    EXPECT_EQ(2, stream->public_readyQSize());
+    EXPECT_EQ(2, stream2->public_readyQSize());
+
+    stream2.reset();
+    producer2.reset();
+    destroy_mock_cookie(cookie2);
+}
+
 /**
  * Unit test for MB-36146 to ensure that CheckpointCursor do not try to
  * use the currentCheckpoint member variable if its not point to a valid
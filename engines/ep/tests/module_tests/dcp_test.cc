@@ -1786,6 +1786,115 @@ TEST_P(ConnectionTest, SnapshotsAndNoData) {
     destroy_mock_cookie(cookie);
 }
 
+/**
+ * Test fixture for the adaptive flow control policy, which drives the
+ * buffer sizing of a consumer with explicit round trip time samples and
+ * times (rather than waiting for real ones).
+ */
+class FlowControlTest : public DCPTest {
+protected:
+    void SetUp() override {
+        config_string += "dcp_flow_control_policy=adaptive;"
+                         "dcp_conn_buffer_size=" +
+                         std::to_string(minSize);
+        DCPTest::SetUp();
+        cookie = create_mock_cookie();
+        consumer = std::make_shared<MockDcpConsumer>(
+                *engine, cookie, "test_consumer");
+        now = std::chrono::steady_clock::now();
+    }
+
+    void TearDown() override {
+        consumer.reset();
+        destroy_mock_cookie(cookie);
+        DCPTest::TearDown();
+    }
+
+    FlowControl& flowControl() {
+        return consumer->getFlowControl();
+    }
+
+    void addRttSample(std::chrono::milliseconds rtt) {
+        std::lock_guard<std::mutex> lh(flowControl().bufferSizeLock);
+        flowControl().addRttSample_UNLOCKED(
+                std::chrono::microseconds(rtt).count(), now);
+    }
+
+    /// Process the given bytes over the next adapt interval, then adapt.
+    void drain(uint32_t bytes) {
+        flowControl().incrFreedBytes(bytes);
+        now += std::chrono::seconds(1);
+        flowControl().maybeAdaptBufferSize(now);
+    }
+
+    uint64_t getRttMicros() {
+        return flowControl().rttMicros;
+    }
+
+    static const uint32_t minSize = 1024;
+    static const uint32_t drainRate = 1024 * 1024;
+    const void* cookie = nullptr;
+    std::shared_ptr<MockDcpConsumer> consumer;
+    std::chrono::steady_clock::time_point now;
+};
+
+const uint32_t FlowControlTest::minSize;
+const uint32_t FlowControlTest::drainRate;
+
+// The buffer grows to about twice the bandwidth-delay product
+TEST_F(FlowControlTest, Grow) {
+    ASSERT_EQ(minSize, flowControl().getFlowControlBufSize());
+    addRttSample(std::chrono::milliseconds(10));
+    for (int ii = 0; ii < 5; ++ii) {
+        drain(drainRate);
+    }
+    // 2 * ~1MiB/s * 10ms
+    EXPECT_LT(16 * 1024, flowControl().getFlowControlBufSize());
+    EXPECT_GT(21 * 1024, flowControl().getFlowControlBufSize());
+}
+
+// The buffer shrinks back (to the minimum) once the drain rate drops
+TEST_F(FlowControlTest, Shrink) {
+    addRttSample(std::chrono::milliseconds(10));
+    for (int ii = 0; ii < 5; ++ii) {
+        drain(drainRate);
+    }
+    ASSERT_LT(16 * 1024, flowControl().getFlowControlBufSize());
+
+    for (int ii = 0; ii < 10; ++ii) {
+        drain(0);
+    }
+    EXPECT_EQ(minSize, flowControl().getFlowControlBufSize());
+}
+
+// Round trip times bloated by queueing (e.g. behind the buffer itself) don't
+// grow the buffer while a lower sample is within the window; the estimate
+// only follows a longer path once the lower sample has aged out of it.
+TEST_F(FlowControlTest, BloatedRttIgnored) {
+    addRttSample(std::chrono::milliseconds(10));
+    for (int ii = 0; ii < 5; ++ii) {
+        drain(drainRate);
+    }
+    const auto size = flowControl().getFlowControlBufSize();
+    ASSERT_GT(21 * 1024, size);
+
+    // 20s of samples 20 times the minimum
+    for (int ii = 0; ii < 20; ++ii) {
+        addRttSample(std::chrono::milliseconds(200));
+        drain(drainRate);
+    }
+    EXPECT_EQ(10000, getRttMicros());
+    EXPECT_GT(21 * 1024, flowControl().getFlowControlBufSize());
+
+    // Once the 10ms sample is older than the window, the minimum is 200ms
+    for (int ii = 0; ii < 20; ++ii) {
+        addRttSample(std::chrono::milliseconds(200));
+        drain(drainRate);
+    }
+    EXPECT_EQ(200000, getRttMicros());
+    EXPECT_LT(10 * size, flowControl().getFlowControlBufSize());
+}
+
 class DcpConnMapTest : public ::testing::Test {
 protected:
     void SetUp() override {
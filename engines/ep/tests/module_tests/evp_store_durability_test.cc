@@ -2393,6 +2393,61 @@ TEST_P(DurabilityCouchstoreBucketTest, RemoveCommittedPreparesAtCompaction) {
     EXPECT_EQ(0, kvstore->getVBucketState(vbid)->onDiskPrepares);
 }
 
+// With group commit, the persistence of a flush (persistence seqno,
+// DurabilityMonitor and high priority requests) must only be notified once
+// the group's commits are durable - and not after a failed sync.
+TEST_P(DurabilityCouchstoreBucketTest, GroupCommitNotifiesOnceSynced) {
+    auto& bucket = dynamic_cast<EPBucket&>(*store);
+    auto vb = store->getVBucket(vbid);
+    const auto persistenceSeqno = vb->getPersistenceSeqno();
+
+    auto item = makePendingItem(
+            makeStoredDocKey("key"),
+            "value",
+            {cb::durability::Level::MajorityAndPersistOnMaster, {}});
+    ASSERT_EQ(ENGINE_SYNC_WRITE_PENDING, store->set(*item, cookie));
+    const uint64_t seqno = vb->getHighSeqno();
+    ASSERT_EQ(0, vb->getHighPreparedSeqno());
+
+    auto* hpCookie = create_mock_cookie();
+    ASSERT_EQ(HighPriorityVBReqStatus::RequestScheduled,
+              vb->checkAddHighPriorityVBEntry(
+                      seqno, hpCookie, HighPriorityVBNotify::Seqno));
+
+    auto& kvstore = *store->getOneRWUnderlying();
+    ASSERT_TRUE(kvstore.setDeferCommitSync(true));
+    GroupCommit group(kvstore);
+    EXPECT_EQ(std::make_pair(false, size_t(1)),
+              bucket.flushVBucket(vbid, &group));
+
+    auto expectHeldBack = [&]() {
+        EXPECT_EQ(persistenceSeqno, vb->getPersistenceSeqno());
+        EXPECT_EQ(0, vb->getHighPreparedSeqno());
+        EXPECT_EQ(1, vb->getHighPriorityChkSize());
+    };
+    {
+        SCOPED_TRACE("flushed, not yet synced");
+        expectHeldBack();
+    }
+
+    bucket.preGroupCommitSyncHook = []() { return false; };
+    EXPECT_FALSE(bucket.completeGroupCommit(group));
+    {
+        SCOPED_TRACE("sync failed");
+        expectHeldBack();
+        EXPECT_EQ(1, group.flushed.size());
+    }
+
+    bucket.preGroupCommitSyncHook = nullptr;
+    EXPECT_TRUE(bucket.completeGroupCommit(group));
+    EXPECT_EQ(seqno, vb->getPersistenceSeqno());
+    EXPECT_EQ(seqno, vb->getHighPreparedSeqno());
+    EXPECT_EQ(0, vb->getHighPriorityChkSize());
+    EXPECT_TRUE(group.flushed.empty());
+
+    destroy_mock_cookie(hpCookie);
+}
+
 TEST_P(DurabilityCouchstoreBucketTest, RemoveAbortedPreparesAtCompaction) {
     setVBucketToActiveWithValidTopology();
     using namespace cb::durability;
@@ -1759,6 +1759,159 @@ TEST_F(SingleThreadedEPBucketTest, MB18452_yield_dcp_processor) {
     consumer->closeStream(/*opaque*/0, vbid);
 }
 
+/**
+ * With more than one consumer Processor, each processes only the buffered
+ * messages of the vBuckets in its partition.
+ */
+TEST_F(SingleThreadedEPBucketTest, ConsumerProcessorsPartitionedByVBucket) {
+    engine->getConfiguration().setDcpConsumerProcessorTasks(2);
+    const Vbid vbid1(1);
+    setVBucketStateAndRunPersistTask(vbid, vbucket_state_replica);
+    setVBucketStateAndRunPersistTask(vbid1, vbucket_state_replica);
+
+    auto consumer = std::make_shared<MockDcpConsumer>(*engine, cookie, "test");
+    ASSERT_EQ(2, consumer->getNumProcessors());
+    ASSERT_EQ(ENGINE_SUCCESS,
+              consumer->addStream(/*opaque*/ 0, vbid, /*flags*/ 0));
+    ASSERT_EQ(ENGINE_SUCCESS,
+              consumer->addStream(/*opaque*/ 0, vbid1, /*flags*/ 0));
+
+    // Force the streams to buffer rather than process messages immediately
+    const ssize_t queueCap =
+            engine->getEpStats().replicationThrottleWriteQueueCap;
+    engine->getEpStats().replicationThrottleWriteQueueCap = 0;
+
+    // The streams were given opaques 1 and 2.
+    uint32_t opaque = 1;
+    for (auto vb : {vbid, vbid1}) {
+        consumer->snapshotMarker(opaque, vb, 0, 1, /*flags*/ 0, /*HCS*/ {});
+        const DocKey docKey{"key", DocKeyEncodesCollectionId::No};
+        std::string value = "value";
+        consumer->mutation(opaque,
+                           docKey,
+                           {(const uint8_t*)value.c_str(), value.length()},
+                           0, // privileged bytes
+                           PROTOCOL_BINARY_RAW_BYTES, // datatype
+                           0, // cas
+                           vb, // vbucket
+                           0, // flags
+                           1, // bySeqno
+                           0, // revSeqno
+                           0, // exptime
+                           0, // locktime
+                           {}, // meta
+                           0); // nru
+        consumer->public_notifyVbucketReady(vb);
+        ++opaque;
+    }
+    engine->getEpStats().replicationThrottleWriteQueueCap = queueCap;
+
+    // Processor 1 only applies the messages of vb:1...
+    EXPECT_EQ(more_to_process, consumer->processBufferedItems(1));
+    EXPECT_EQ(all_processed, consumer->processBufferedItems(1));
+    EXPECT_EQ(1, store->getVBucket(vbid1)->getHighSeqno());
+    EXPECT_EQ(0, store->getVBucket(vbid)->getHighSeqno());
+
+    // ... and Processor 0 those of vb:0.
+    EXPECT_EQ(more_to_process, consumer->processBufferedItems(0));
+    EXPECT_EQ(all_processed, consumer->processBufferedItems(0));
+    EXPECT_EQ(1, store->getVBucket(vbid)->getHighSeqno());
+
+    consumer->closeStream(/*opaque*/ 0, vbid);
+    consumer->closeStream(/*opaque*/ 0, vbid1);
+}
+
+/**
+ * A flush batch prepared ahead of the flush (as by the flusher pipeline) is
+ * written by the next flush of the vBucket; items queued since are left for
+ * the flush after.
+ */
+TEST_F(SingleThreadedEPBucketTest, FlushPreparedBatch) {
+    setVBucketStateAndRunPersistTask(vbid, vbucket_state_active);
+    auto vb = store->getVBucket(vbid);
+
+    store_item(vbid, makeStoredDocKey("key1"), "value");
+    getEPBucket().prepareFlush(vbid);
+    ASSERT_TRUE(vb->hasPreparedItemsToPersist());
+
+    store_item(vbid, makeStoredDocKey("key2"), "value");
+    EXPECT_EQ(std::make_pair(true, size_t(1)),
+              getEPBucket().flushVBucket(vbid));
+    EXPECT_FALSE(vb->hasPreparedItemsToPersist());
+    EXPECT_EQ(1, vb->getPersistenceSeqno());
+
+    EXPECT_EQ(std::make_pair(false, size_t(1)),
+              getEPBucket().flushVBucket(vbid));
+    EXPECT_EQ(2, vb->getPersistenceSeqno());
+}
+
+// With a coalescing window the BgFetcher task first snoozes for the window
+// after being woken, and only reads the queued fetches when it next runs.
+TEST_F(SingleThreadedEPBucketTest, BgFetchCoalesceWindow) {
+    setVBucketStateAndRunPersistTask(vbid, vbucket_state_active);
+    auto key = makeStoredDocKey("key");
+    store_item(vbid, key, "value");
+    flush_vbucket_to_disk(vbid);
+    evict_key(vbid, key);
+
+    engine->getConfiguration().setBgFetcherCoalesceWindowUs(1000);
+
+    get_options_t options = static_cast<get_options_t>(
+            QUEUE_BG_FETCH | HONOR_STATES | TRACK_REFERENCE | DELETE_TEMP |
+            HIDE_LOCKED_CAS | TRACK_STATISTICS);
+    auto gv = store->get(key, vbid, cookie, options);
+    EXPECT_EQ(ENGINE_EWOULDBLOCK, gv.getStatus());
+
+    auto vb = store->getVBucket(vbid);
+    runBGFetcherTask();
+    EXPECT_TRUE(vb->hasPendingBGFetchItems());
+
+    runBGFetcherTask();
+    EXPECT_FALSE(vb->hasPendingBGFetchItems());
+    gv = store->get(key, vbid, cookie, options);
+    ASSERT_EQ(ENGINE_SUCCESS, gv.getStatus());
+}
+
+// With several BgFetcher tasks, each fetches only for its own vBuckets.
+TEST_F(SingleThreadedEPBucketTest, BgFetcherTasksPartitionVBuckets) {
+    // One shard, so both vBuckets share a BgFetcher.
+    reinitialise(config_string + ";max_num_shards=1;bg_fetcher_tasks=2");
+
+    const Vbid vbid0(0);
+    const Vbid vbid1(1);
+    auto key = makeStoredDocKey("key");
+    for (auto id : {vbid0, vbid1}) {
+        setVBucketStateAndRunPersistTask(id, vbucket_state_active);
+        store_item(id, key, "value");
+        flush_vbucket_to_disk(id);
+        evict_key(id, key);
+    }
+
+    auto* bgFetcher = store->getVBucket(vbid0)->getShard()->getBgFetcher();
+    ASSERT_EQ(2, bgFetcher->getNumTasks());
+
+    get_options_t options = static_cast<get_options_t>(
+            QUEUE_BG_FETCH | HONOR_STATES | TRACK_REFERENCE | DELETE_TEMP |
+            HIDE_LOCKED_CAS | TRACK_STATISTICS);
+    for (auto id : {vbid0, vbid1}) {
+        EXPECT_EQ(ENGINE_EWOULDBLOCK,
+                  store->get(key, id, cookie, options).getStatus());
+    }
+
+    MockGlobalTask mockTask(engine->getTaskable(),
+                            TaskId::MultiBGFetcherTask);
+    bgFetcher->run(&mockTask, 1);
+    EXPECT_TRUE(store->getVBucket(vbid0)->hasPendingBGFetchItems());
+    EXPECT_FALSE(store->getVBucket(vbid1)->hasPendingBGFetchItems());
+
+    bgFetcher->run(&mockTask, 0);
+    EXPECT_FALSE(store->getVBucket(vbid0)->hasPendingBGFetchItems());
+    for (auto id : {vbid0, vbid1}) {
+        EXPECT_EQ(ENGINE_SUCCESS,
+                  store->get(key, id, cookie, options).getStatus());
+    }
+}
+
 /**
  * MB-29861: Ensure that a delete time is generated for a document
  * that is received on the consumer side as a result of a disk
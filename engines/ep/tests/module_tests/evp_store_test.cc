@@ -180,6 +180,70 @@ TEST_P(EPStoreEvictionTest, GetKeyStatsEjected) {
     }
 }
 
+// getMulti tests /////////////////////////////////////////////////////////////
+
+// Check that getMulti returns resident items and misses directly, and queues a
+// (cookie-less) bgfetch for evicted items, which get() finds completed.
+TEST_P(EPStoreEvictionTest, GetMulti) {
+    store_item(vbid, makeStoredDocKey("resident"), "value");
+    store_item(vbid, makeStoredDocKey("evicted"), "value");
+    flush_vbucket_to_disk(vbid, 2);
+    evict_key(vbid, makeStoredDocKey("evicted"));
+
+    const auto options = static_cast<get_options_t>(
+            QUEUE_BG_FETCH | HONOR_STATES | TRACK_REFERENCE | DELETE_TEMP |
+            HIDE_LOCKED_CAS | TRACK_STATISTICS);
+    const auto resident = makeStoredDocKey("resident");
+    const auto evicted = makeStoredDocKey("evicted");
+    const auto missing = makeStoredDocKey("missing");
+    auto results = store->getMulti({{resident, vbid},
+                                    {evicted, vbid},
+                                    {missing, vbid},
+                                    {resident, Vbid(1)}},
+                                   options);
+    ASSERT_EQ(4, results.size());
+
+    ASSERT_EQ(ENGINE_SUCCESS, results[0].getStatus());
+    EXPECT_EQ("value", results[0].item->getValue()->to_s());
+    EXPECT_EQ(ENGINE_EWOULDBLOCK, results[1].getStatus());
+    EXPECT_EQ(ENGINE_KEY_ENOENT, results[2].getStatus());
+    // Unknown vBucket - must be retried with get()
+    EXPECT_EQ(ENGINE_EWOULDBLOCK, results[3].getStatus());
+
+    runBGFetcherTask();
+
+    auto gv = store->get(evicted, vbid, cookie, options);
+    ASSERT_EQ(ENGINE_SUCCESS, gv.getStatus());
+    EXPECT_EQ("value", gv.item->getValue()->to_s());
+}
+
+// Check that GETs served by the engine's get_multi are recorded in the get_cmd
+// timings, and that those left for get() are not.
+TEST_P(EPStoreEvictionTest, GetMultiRecordsGetCmdTimings) {
+    store_item(vbid, makeStoredDocKey("resident"), "value");
+    store_item(vbid, makeStoredDocKey("evicted"), "value");
+    flush_vbucket_to_disk(vbid, 2);
+    evict_key(vbid, makeStoredDocKey("evicted"));
+
+    auto& histo = engine->getEpStats().getCmdHisto;
+    const auto before = histo.getValueCount();
+
+    const auto resident = makeStoredDocKey("resident");
+    const auto evicted = makeStoredDocKey("evicted");
+    const auto missing = makeStoredDocKey("missing");
+    auto results = engine->get_multi(
+            cookie,
+            {{resident, vbid}, {evicted, vbid}, {missing, vbid}},
+            DocStateFilter::Alive);
+    ASSERT_EQ(3, results.size());
+    EXPECT_EQ(cb::engine_errc::success, results[0].first);
+    EXPECT_EQ(cb::engine_errc::would_block, results[1].first);
+    EXPECT_EQ(cb::engine_errc::no_such_key, results[2].first);
+
+    // The hit and the miss; the evicted key is timed by the get() retry.
+    EXPECT_EQ(before + 2, histo.getValueCount());
+}
+
 // Replace tests //////////////////////////////////////////////////////////////
 
 // Test replace against an ejected key.
@@ -536,6 +536,91 @@ TEST_F(WarmupTest, MB_35599) {
     EXPECT_EQ(0, memcmp("value", gv.item->getData(), 5));
 }
 
+// Warmup loads vBuckets on a number of tasks, each claiming the next vBucket
+// to load; every vBucket's items should be loaded, and the time spent in each
+// phase recorded.
+TEST_F(WarmupTest, LoadAllVBucketsAndPhaseTimes) {
+    const size_t numVbs = 4;
+    for (uint16_t ii = 0; ii < numVbs; ++ii) {
+        setVBucketStateAndRunPersistTask(Vbid(ii), vbucket_state_active);
+        store_item(Vbid(ii), makeStoredDocKey("key"), "value");
+        flush_vbucket_to_disk(Vbid(ii));
+    }
+
+    resetEngineAndWarmup();
+
+    for (uint16_t ii = 0; ii < numVbs; ++ii) {
+        auto vb = store->getVBucket(Vbid(ii));
+        ASSERT_TRUE(vb);
+        EXPECT_EQ(1, vb->getNumItems());
+        EXPECT_EQ(0, vb->getNumNonResidentItems());
+    }
+
+    std::map<std::string, std::string> stats;
+    store->getWarmup()->addStats(
+            [](const char* key,
+               const uint16_t klen,
+               const char* val,
+               const uint32_t vlen,
+               gsl::not_null<const void*> cookie) {
+                auto* map =
+                        reinterpret_cast<std::map<std::string, std::string>*>(
+                                const_cast<void*>(cookie.get()));
+                (*map)[std::string(key, klen)] = std::string(val, vlen);
+            },
+            &stats);
+    EXPECT_EQ(1, stats.count("ep_warmup_initialize_time"));
+    EXPECT_EQ(1, stats.count("ep_warmup_create_vbuckets_time"));
+    const auto loadStat =
+            store->getItemEvictionPolicy() == EvictionPolicy::Full
+                    ? "ep_warmup_loading_kv_pairs_time"
+                    : "ep_warmup_loading_data_time";
+    EXPECT_EQ(1, stats.count(loadStat));
+    EXPECT_EQ(0, stats.count("ep_warmup_done_time"));
+}
+
+// The bloom filter persisted at shutdown should be loaded by warmup, and
+// include keys which were resident in the HashTable at shutdown.
+TEST_F(WarmupTest, BloomFilterLoadedAtWarmup) {
+    setVBucketStateAndRunPersistTask(vbid, vbucket_state_active);
+    ASSERT_EQ("ENABLED", store->getVBucket(vbid)->getFilterStatusString());
+
+    auto key = makeStoredDocKey("key");
+    store_item(vbid, key, "value");
+    flush_vbucket_to_disk(vbid);
+
+    resetEngineAndWarmup();
+
+    auto vb = store->getVBucket(vbid);
+    EXPECT_EQ("ENABLED", vb->getFilterStatusString());
+    EXPECT_EQ(1, vb->getNumOfKeysInFilter());
+    EXPECT_TRUE(vb->maybeKeyExistsInFilter(key));
+}
+
+// A persisted bloom filter must not be loaded if items were persisted after
+// it, as it may not contain their keys.
+TEST_F(WarmupTest, StaleBloomFilterNotLoaded) {
+    setVBucketStateAndRunPersistTask(vbid, vbucket_state_active);
+    store_item(vbid, makeStoredDocKey("key1"), "value");
+    flush_vbucket_to_disk(vbid);
+
+    auto& epBucket = dynamic_cast<EPBucket&>(*store);
+    {
+        auto vb = store->getLockedVBucket(vbid);
+        ASSERT_TRUE(epBucket.persistBloomFilter(vb));
+    }
+
+    store_item(vbid, makeStoredDocKey("key2"), "value");
+    flush_vbucket_to_disk(vbid);
+
+    // Disable filters so none is persisted again at shutdown.
+    engine->getConfiguration().setBfilterEnabled(false);
+    resetEngineAndWarmup();
+
+    EXPECT_EQ("DOESN'T EXIST",
+              store->getVBucket(vbid)->getFilterStatusString());
+}
+
 // Check that two state changes don't de-duplicate, that replica is the state
 // which lands in persistence. Note the addition of the key helped find an issue
 // where the flusher re-ordered the flush batch, allowing the older set-vbstate
@@ -22,6 +22,9 @@
 #include "executorpool_test.h"
 #include "lambda_task.h"
 
+#include <atomic>
+#include <future>
+
 MockTaskable::MockTaskable() : policy(HIGH_BUCKET_PRIORITY, 1) {
 }
 
@@ -154,6 +157,89 @@ TEST_F(ExecutorPoolTest, increase_workers) {
     pool.unregisterTaskable(taskable, false);
 }
 
+/* Check that with work stealing enabled a thread of another type runs a
+ * writer task when the only writer thread is busy: the two writer tasks can
+ * only complete (pass the ThreadGate) if they run concurrently.
+ */
+TEST_F(ExecutorPoolTest, work_stealing) {
+    const size_t numTasks = 2;
+    ThreadGate tg{numTasks};
+
+    TestExecutorPool pool(4, // MaxThreads
+                          NUM_TASK_GROUPS,
+                          1, // MaxNumReaders
+                          1, // MaxNumWriters
+                          1, // MaxNumAuxio
+                          1 // MaxNumNonio
+    );
+    pool.setWorkStealing(true);
+
+    MockTaskable taskable;
+    pool.registerTaskable(taskable);
+
+    std::vector<ExTask> tasks;
+    for (size_t i = 0; i < numTasks; ++i) {
+        ExTask task = makeTask(taskable, tg, i);
+        pool.schedule(task);
+        tasks.push_back(task);
+    }
+
+    tg.waitFor(std::chrono::seconds(10));
+    EXPECT_TRUE(tg.isComplete()) << "Timeout waiting for a task to be stolen";
+    EXPECT_LE(1, pool.getNumStolenTasks());
+
+    pool.unregisterTaskable(taskable, false);
+}
+
+/* Check that NONIO tasks are not stolen by the (idle) IO threads: while the
+ * only NONIO thread is busy, a second NONIO task must wait for it.
+ */
+TEST_F(ExecutorPoolTest, work_stealing_not_across_nonio) {
+    TestExecutorPool pool(4, // MaxThreads
+                          NUM_TASK_GROUPS,
+                          1, // MaxNumReaders
+                          1, // MaxNumWriters
+                          1, // MaxNumAuxio
+                          1 // MaxNumNonio
+    );
+    pool.setWorkStealing(true);
+
+    MockTaskable taskable;
+    pool.registerTaskable(taskable);
+
+    std::promise<void> release;
+    auto released = release.get_future().share();
+    std::atomic<int> ran{0};
+    auto makeNonIOTask = [&]() {
+        return std::make_shared<LambdaTask>(
+                taskable, TaskId::ItemPager, 0, true, [&, released]() -> bool {
+                    ++ran;
+                    released.wait();
+                    return false;
+                });
+    };
+    ExTask first = makeNonIOTask();
+    pool.schedule(first);
+    for (int i = 0; i < 1000 && ran == 0; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    ASSERT_EQ(1, ran);
+
+    ExTask second = makeNonIOTask();
+    pool.schedule(second);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    EXPECT_EQ(1, ran) << "NONIO task run by an IO thread";
+    EXPECT_EQ(0, pool.getNumStolenTasks());
+
+    release.set_value();
+    for (int i = 0; i < 1000 && ran < 2; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_EQ(2, ran);
+
+    pool.unregisterTaskable(taskable, false);
+}
+
 TEST_F(ExecutorPoolDynamicWorkerTest, decrease_workers) {
     EXPECT_EQ(2, pool->getNumWriters());
     pool->setNumWriters(1);
@@ -33,6 +33,7 @@
 #include <algorithm>
 #include <limits>
 #include <string>
+#include <thread>
 
 EPStats global_stats;
 
@@ -248,6 +249,301 @@ TEST_F(HashTableTest, Resize) {
     verifyFound(h, keys);
 }
 
+TEST_F(HashTableTest, TaggedFind) {
+    HashTable h(global_stats, makeFactory(), 5, 1, HashTable::Layout::Tagged);
+    ASSERT_EQ(HashTable::Layout::Tagged, h.getLayout());
+    testFind(h);
+}
+
+TEST_F(HashTableTest, TaggedResize) {
+    HashTable h(global_stats, makeFactory(), 5, 3, HashTable::Layout::Tagged);
+
+    auto keys = generateKeys(1000);
+    storeMany(h, keys);
+    verifyFound(h, keys);
+
+    h.resize(6143);
+    EXPECT_EQ(6143, h.getSize());
+    verifyFound(h, keys);
+
+    h.resize(769);
+    EXPECT_EQ(769, h.getSize());
+    verifyFound(h, keys);
+}
+
+// Check that tags are correctly maintained as items are removed from (and
+// re-added to) a bucket - keys sharing a bucket must remain findable after
+// other keys in the same chain are deleted or ejected.
+TEST_F(HashTableTest, TaggedDeletions) {
+    HashTable h(global_stats, makeFactory(), 5, 1, HashTable::Layout::Tagged);
+    const int nkeys = 1000;
+
+    auto keys = generateKeys(nkeys);
+    storeMany(h, keys);
+
+    // Delete every other key; the remainder must still be found.
+    std::vector<StoredDocKey> remaining;
+    for (int i = 0; i < nkeys; i++) {
+        if (i % 2) {
+            EXPECT_TRUE(del(h, keys[i]));
+            EXPECT_FALSE(h.findForRead(keys[i]).storedValue);
+        } else {
+            remaining.push_back(keys[i]);
+        }
+    }
+    verifyFound(h, remaining);
+
+    // Full-evict the remainder, then re-add everything.
+    for (const auto& key : remaining) {
+        auto res = h.findForWrite(key);
+        ASSERT_TRUE(res.storedValue);
+        res.storedValue->markClean();
+        EXPECT_TRUE(h.unlocked_ejectItem(
+                res.lock, res.storedValue, EvictionPolicy::Full));
+    }
+    EXPECT_EQ(0, count(h));
+    for (const auto& key : keys) {
+        EXPECT_FALSE(h.findForRead(key).storedValue);
+    }
+
+    storeMany(h, keys);
+    verifyFound(h, keys);
+
+    h.clear();
+    for (const auto& key : keys) {
+        EXPECT_FALSE(h.findForRead(key).storedValue);
+    }
+}
+
+// Test that items remain accessible (and can be added / removed) while an
+// incremental resize is in progress.
+TEST_F(HashTableTest, IncrementalResize) {
+    HashTable h(global_stats,
+                makeFactory(),
+                5,
+                3,
+                HashTable::Layout::Chained,
+                HashTable::ResizeMode::Incremental);
+    // Size is rounded up to a multiple of the number of locks.
+    EXPECT_EQ(6, h.getSize());
+
+    auto keys = generateKeys(1000);
+    storeMany(h, keys);
+
+    h.resize(6143);
+    EXPECT_EQ(6144, h.getSize());
+    EXPECT_TRUE(h.isResizing());
+    EXPECT_EQ(1000, count(h));
+    verifyFound(h, keys);
+
+    // Resize again while in progress is ignored.
+    h.resize(769);
+    EXPECT_EQ(6144, h.getSize());
+
+    // Migrate some of the buckets, then modify the HashTable.
+    EXPECT_FALSE(h.continueResize(2));
+    EXPECT_TRUE(h.isResizing());
+    auto moreKeys = generateKeys(1500, 1000);
+    storeMany(h, moreKeys);
+    for (int i = 0; i < 500; i++) {
+        EXPECT_TRUE(del(h, keys[i]));
+    }
+
+    EXPECT_TRUE(h.continueResize(std::numeric_limits<size_t>::max()));
+    EXPECT_FALSE(h.isResizing());
+    EXPECT_EQ(1000, count(h));
+    std::vector<StoredDocKey> remaining(keys.begin() + 500, keys.end());
+    verifyFound(h, remaining);
+    verifyFound(h, moreKeys);
+
+    // And back down again.
+    h.resize(769);
+    EXPECT_EQ(771, h.getSize());
+    EXPECT_TRUE(h.continueResize(std::numeric_limits<size_t>::max()));
+    EXPECT_EQ(1000, count(h));
+    verifyFound(h, moreKeys);
+}
+
+// Test that getRandomKey finds items not yet migrated by an incremental resize,
+// when the new size is not a multiple of the old size.
+TEST_F(HashTableTest, IncrementalResizeRandomKey) {
+    HashTable h(global_stats,
+                makeFactory(),
+                5,
+                3,
+                HashTable::Layout::Chained,
+                HashTable::ResizeMode::Incremental);
+    ASSERT_EQ(6, h.getSize());
+
+    // Find a key whose slot in the resized table (of 771 buckets) has a
+    // different index modulo 6 than its old bucket.
+    const int newSize = 771;
+    StoredDocKey key = makeStoredDocKey("key");
+    for (int i = 0;; ++i) {
+        key = makeStoredDocKey("key" + std::to_string(i));
+        const int hash = key.hash();
+        if (std::abs(hash % newSize) % 6 != std::abs(hash % 6)) {
+            break;
+        }
+    }
+    std::vector<StoredDocKey> keys{key};
+    storeMany(h, keys);
+
+    h.resize(769);
+    ASSERT_EQ(newSize, h.getSize());
+    ASSERT_TRUE(h.isResizing());
+
+    // Start sampling from the key's slot, so it is only found if its old
+    // bucket is migrated when that slot is sampled.
+    auto item = h.getRandomKey(std::abs(key.hash() % newSize));
+    ASSERT_TRUE(item);
+    EXPECT_EQ(key, item->getKey());
+}
+
+// Test that clearing the HashTable mid incremental resize completes the
+// resize and removes all items.
+TEST_F(HashTableTest, IncrementalResizeClear) {
+    size_t initialSize = global_stats.getCurrentSize();
+    HashTable h(global_stats,
+                makeFactory(),
+                47,
+                47,
+                HashTable::Layout::Tagged,
+                HashTable::ResizeMode::Incremental);
+
+    auto keys = generateKeys(1000);
+    storeMany(h, keys);
+    h.resize();
+    EXPECT_TRUE(h.isResizing());
+    verifyFound(h, keys);
+
+    h.clear();
+    EXPECT_FALSE(h.isResizing());
+    EXPECT_EQ(0, count(h));
+    EXPECT_EQ(initialSize, global_stats.getCurrentSize());
+    for (const auto& key : keys) {
+        EXPECT_FALSE(h.findForRead(key).storedValue);
+    }
+}
+
+static std::unique_ptr<Item> findOptimistic(
+        HashTable& ht,
+        const DocKey& key,
+        TrackReference trackReference = TrackReference::No) {
+    return ht.findForReadOptimistic(key,
+                                    Vbid(0),
+                                    trackReference,
+                                    ForGetReplicaOp::No,
+                                    false,
+                                    StoredValue::IncludeValue::Yes)
+            .item;
+}
+
+// Test that findForReadOptimistic() copies a resident, committed item without
+// acquiring the lock, and leaves anything else to findForRead().
+TEST_F(HashTableTest, FindForReadOptimistic) {
+    HashTable ht(global_stats, makeFactory(), 5, 1);
+    auto key = makeStoredDocKey("key");
+    store(ht, key);
+
+    auto item = findOptimistic(ht, key);
+    ASSERT_TRUE(item);
+    EXPECT_EQ(key, item->getKey());
+    EXPECT_EQ(key.to_string(), item->getValue()->to_s());
+    EXPECT_FALSE(findOptimistic(ht, makeStoredDocKey("missing")));
+
+    // Tracking the reference of a key which isn't yet hot modifies the
+    // StoredValue, so needs the lock.
+    EXPECT_FALSE(findOptimistic(ht, key, TrackReference::Yes));
+    {
+        auto res = ht.findForWrite(key);
+        res.storedValue->setFreqCounterValue(
+                std::numeric_limits<uint8_t>::max());
+        res.storedValue->setNRUValue(MIN_NRU_VALUE);
+    }
+    EXPECT_TRUE(findOptimistic(ht, key, TrackReference::Yes));
+
+    // The read fails while a writer holds the lock.
+    {
+        auto hbl = ht.getLockedBucket(key);
+        EXPECT_FALSE(findOptimistic(ht, key));
+    }
+    EXPECT_TRUE(findOptimistic(ht, key));
+
+    // Non-resident items need a BG fetch.
+    {
+        auto res = ht.findForWrite(key);
+        res.storedValue->markClean();
+        ASSERT_TRUE(ht.unlocked_ejectItem(
+                res.lock, res.storedValue, EvictionPolicy::Value));
+    }
+    EXPECT_FALSE(findOptimistic(ht, key));
+
+    // Deleted items are not found.
+    store(ht, key);
+    EXPECT_TRUE(findOptimistic(ht, key));
+    ASSERT_TRUE(del(ht, key));
+    EXPECT_FALSE(findOptimistic(ht, key));
+}
+
+// OrderedStoredValues (Ephemeral) are also owned by the sequence list, so
+// cannot be read optimistically.
+TEST_F(HashTableTest, FindForReadOptimisticOrdered) {
+    HashTable ht(global_stats, makeFactory(true), 5, 1);
+    auto key = makeStoredDocKey("key");
+    store(ht, key);
+    EXPECT_FALSE(findOptimistic(ht, key));
+    EXPECT_TRUE(ht.findForRead(key).storedValue);
+}
+
+// Test that optimistic readers only ever see a consistent copy of an item
+// while a writer concurrently replaces, deletes and re-adds it (and resizes
+// the HashTable) - i.e. StoredValues / values are not freed while a reader
+// may still be reading them.
+TEST_F(HashTableTest, FindForReadOptimisticConcurrentWriter) {
+    HashTable ht(global_stats, makeFactory(), 5, 3);
+    auto key = makeStoredDocKey("key");
+    const std::vector<std::string> values{"a", std::string(100, 'b')};
+    Item first(key, 0, 0, values[0].data(), values[0].size());
+    ASSERT_EQ(MutationStatus::WasClean, ht.set(first));
+
+    std::atomic<bool> done{false};
+    std::atomic<size_t> found{0};
+    std::vector<std::thread> readers;
+    for (int i = 0; i < 4; i++) {
+        readers.emplace_back([&ht, &key, &values, &done, &found]() {
+            while (!done) {
+                auto item = findOptimistic(ht, key);
+                if (item) {
+                    EXPECT_EQ(key, item->getKey());
+                    auto value = item->getValue()->to_s();
+                    EXPECT_NE(values.end(),
+                              std::find(values.begin(), values.end(), value))
+                            << value;
+                    ++found;
+                }
+            }
+        });
+    }
+
+    for (int i = 0; i < 10000; i++) {
+        const auto& value = values[i % values.size()];
+        Item item(key, 0, 0, value.data(), value.size());
+        ht.set(item);
+        if (i % 10 == 0) {
+            del(ht, key);
+        }
+        if (i % 1000 == 0) {
+            ht.resize(i % 2000 ? 97 : 5);
+        }
+    }
+    done = true;
+    for (auto& reader : readers) {
+        reader.join();
+    }
+    EXPECT_GT(found, 0);
+}
+
 class AccessGenerator : public Generator<bool> {
 public:
 
@@ -299,6 +299,42 @@ TEST_P(STItemPagerTest, HighWaterMarkTriggersPager) {
     runHighMemoryPager();
 }
 
+// With chk_expel_eager, if expelling checkpoint items which every cursor has
+// passed brings memory usage down to the low watermark, the pager should not
+// go on to evict any values.
+TEST_P(STItemPagerTest, CheckpointExpelReachingLowWatermarkSkipsEviction) {
+    // Items are only expelled once the persistence cursor has passed them.
+    if (std::get<0>(GetParam()) != "persistent") {
+        return;
+    }
+    auto& lpNonioQ = *task_executor->getLpTaskQ()[NONIO_TASK_IDX];
+
+    populateUntilAboveHighWaterMark(vbid);
+    // Move the persistence cursor to the end of the (open) checkpoint, only
+    // then enable eager expelling - so the items are still there for the
+    // pager to expel.
+    flushDirectlyIfPersistent(vbid);
+    engine->getConfiguration().setChkExpelEager(true);
+
+    auto vb = store->getVBucket(vbid);
+    ASSERT_LT(1, vb->checkpointManager->getNumItems());
+    ASSERT_EQ(0, vb->getNumNonResidentItems());
+
+    // Put the low watermark just below the current usage, so expelling any
+    // checkpoint items is enough to reach it.
+    auto& stats = engine->getEpStats();
+    stats.mem_low_wat.store(stats.getEstimatedTotalMemoryUsed() - 1024);
+    const auto expelledBefore = stats.itemsExpelledFromCheckpoints.load();
+
+    runNextTask(lpNonioQ, "Paging out items.");
+
+    EXPECT_LT(expelledBefore, stats.itemsExpelledFromCheckpoints.load());
+    // No PagingVisitor was scheduled, and no values were evicted.
+    EXPECT_EQ(0, lpNonioQ.getReadyQueueSize());
+    EXPECT_EQ(initialNonIoTasks, lpNonioQ.getFutureQueueSize());
+    EXPECT_EQ(0, vb->getNumNonResidentItems());
+}
+
 // Tests that for the hifi_mfu eviction algorithm we visit replica vbuckets
 // first.
 TEST_P(STItemPagerTest, ReplicaItemsVisitedFirst) {
@@ -775,6 +775,48 @@ TEST_F(CouchKVStoreErrorInjectionTest, commit_commit) {
     }
 }
 
+/**
+ * Check that while commits defer their sync, the final sync of a commit (and
+ * closing its file) happens only in syncDeferredCommits, which can be retried
+ * if the sync fails.
+ */
+TEST_F(CouchKVStoreErrorInjectionTest, commit_defer_sync) {
+    generate_items(1);
+    WriteCallback set_callback;
+
+    ASSERT_TRUE(kvstore->setDeferCommitSync(true));
+    kvstore->begin(std::make_unique<TransactionContext>());
+    kvstore->set(items.front(), set_callback);
+    ASSERT_TRUE(kvstore->commit(flush));
+    {
+        /* Establish Logger expectation */
+        EXPECT_CALL(logger, mlog(_, _)).Times(AnyNumber());
+        EXPECT_CALL(logger,
+                    mlog(Ge(spdlog::level::level_enum::warn),
+                         VCE(COUCHSTORE_ERROR_WRITE)))
+                .Times(1)
+                .RetiresOnSaturation();
+
+        /* Establish FileOps expectation */
+        EXPECT_CALL(ops, sync(_, _))
+                .WillOnce(Return(COUCHSTORE_ERROR_WRITE))
+                .RetiresOnSaturation();
+
+        EXPECT_FALSE(kvstore->syncDeferredCommits());
+    }
+    {
+        /* Establish FileOps expectation */
+        EXPECT_CALL(ops, sync(_, _)).Times(1).RetiresOnSaturation();
+        EXPECT_CALL(ops, close(_, _)).Times(1).RetiresOnSaturation();
+
+        EXPECT_TRUE(kvstore->syncDeferredCommits());
+    }
+    kvstore->setDeferCommitSync(false);
+
+    GetValue gv = kvstore->get(DiskDocKey{items.front()}, Vbid(0));
+    EXPECT_EQ(ENGINE_SUCCESS, gv.getStatus());
+}
+
 /**
  * Injects error during CouchKVStore::get/couchstore_docinfo_by_id
  */
@@ -986,6 +1028,39 @@ TEST_F(CouchKVStoreErrorInjectionTest, scan_changes_since) {
     kvstore->destroyScanContext(scan_context);
 }
 
+/**
+ * Check that a scan advises the OS to read ahead of it when read-ahead is
+ * enabled, and reads the same data.
+ */
+TEST_F(CouchKVStoreErrorInjectionTest, scan_read_ahead) {
+    populate_items(1);
+    config.setBackfillReadAheadBytes(1024 * 1024);
+    auto cb(std::make_shared<CustomCallback<GetValue>>());
+    auto cl(std::make_shared<CustomCallback<CacheLookup>>());
+    {
+        /* Establish FileOps expectation */
+        EXPECT_CALL(ops, advise(_, _, _, _, _)).Times(AnyNumber());
+        EXPECT_CALL(ops,
+                    advise(_, _, _, _, COUCHSTORE_FILE_ADVICE_SEQUENTIAL))
+                .Times(1)
+                .RetiresOnSaturation();
+        EXPECT_CALL(ops, advise(_, _, _, _, COUCHSTORE_FILE_ADVICE_WILLNEED))
+                .Times(AtLeast(1));
+
+        auto scan_context =
+                kvstore->initScanContext(cb,
+                                         cl,
+                                         Vbid(0),
+                                         0,
+                                         DocumentFilter::ALL_ITEMS,
+                                         ValueFilter::VALUES_DECOMPRESSED);
+        ASSERT_TRUE(scan_context);
+        EXPECT_EQ(scan_success, kvstore->scan(scan_context));
+        kvstore->destroyScanContext(scan_context);
+    }
+    EXPECT_EQ(1, cb->getProcessedCount());
+}
+
 /**
  * Injects error during CouchKVStore::recordDbDump/couchstore_open_doc_with_docinfo
  */
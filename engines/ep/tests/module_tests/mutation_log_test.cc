@@ -506,6 +506,92 @@ TEST_F(MutationLogTest, ReadOnly) {
                  MutationLog::WriteException);
 }
 
+// A read-only log is read through a memory mapping, and gives the same
+// entries as reading the file.
+TEST_F(MutationLogTest, ReadOnlyMapped) {
+    {
+        MutationLog ml(tmp_log_filename.c_str());
+        ml.open();
+        for (size_t ii = 0; ii < 1000; ii++) {
+            std::string key = std::string("key") + std::to_string(ii);
+            ml.newItem(Vbid(ii % 4), makeStoredDocKey(key));
+        }
+        ml.commit1();
+        ml.commit2();
+    }
+
+    MutationLog ml(tmp_log_filename.c_str());
+    ml.open(true);
+    EXPECT_TRUE(ml.isMapped());
+
+    // Load only half of the vBuckets.
+    MutationLogHarvester h(ml);
+    h.setVBucket(Vbid(1));
+    h.setVBucket(Vbid(3));
+    EXPECT_EQ(ml.end(), h.loadBatch(ml.begin(), 0));
+    EXPECT_EQ(1002, h.total());
+
+    std::set<StoredDocKey> maps[4];
+    h.apply(&maps, loaderFun);
+    EXPECT_EQ(0, maps[0].size());
+    EXPECT_EQ(250, maps[1].size());
+    EXPECT_EQ(0, maps[2].size());
+    EXPECT_EQ(250, maps[3].size());
+
+    ml.close();
+    EXPECT_FALSE(ml.isMapped());
+
+    // A truncated log cannot be opened read-only, and is left in place.
+    EXPECT_EQ(0, truncate(tmp_log_filename.c_str(), 4000));
+    MutationLog truncated(tmp_log_filename.c_str());
+    EXPECT_THROW(truncated.open(true), MutationLog::ShortReadException);
+    EXPECT_TRUE(truncated.exists());
+}
+
+// Iterating over ranges of blocks which partition the log (as the warmup
+// tasks of a shard do) reads each entry exactly once.
+TEST_F(MutationLogTest, BlockRanges) {
+    {
+        MutationLog ml(tmp_log_filename.c_str());
+        ml.open();
+        for (size_t ii = 0; ii < 1000; ii++) {
+            std::string key = std::string("key") + std::to_string(ii);
+            ml.newItem(Vbid(ii % 4), makeStoredDocKey(key));
+        }
+        ml.commit1();
+        ml.commit2();
+    }
+
+    MutationLog ml(tmp_log_filename.c_str());
+    ml.open(true);
+    const auto numBlocks = ml.getNumBlocks();
+    ASSERT_GT(numBlocks, 2);
+
+    // An empty range is at the end.
+    EXPECT_EQ(ml.end(), ml.begin(1, 1));
+
+    const size_t numPartitions = 3;
+    size_t entries = 0;
+    std::set<StoredDocKey> maps[4];
+    for (size_t p = 0; p < numPartitions; p++) {
+        MutationLogHarvester h(ml);
+        for (uint16_t vb = 0; vb < 4; vb++) {
+            h.setVBucket(Vbid(vb));
+        }
+        EXPECT_EQ(ml.end(),
+                  h.loadBatch(ml.begin(numBlocks * p / numPartitions,
+                                       numBlocks * (p + 1) / numPartitions),
+                              0));
+        EXPECT_GT(h.total(), 0);
+        entries += h.total();
+        h.apply(&maps, loaderFun);
+    }
+    EXPECT_EQ(1002, entries);
+    for (const auto& map : maps) {
+        EXPECT_EQ(250, map.size());
+    }
+}
+
 class MockMutationLogEntryV1 : public MutationLogEntryV1 {
 public:
     /**
@@ -0,0 +1,105 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2019 Couchbase, Inc
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+
+#include "memory_tracking_allocator.h"
+#include "open_hash_map.h"
+
+#include <folly/portability/GTest.h>
+
+#include <map>
+#include <string>
+
+/*
+ * Unit tests for the OpenHashMap
+ */
+
+using Map = OpenHashMap<std::string,
+                        int,
+                        std::hash<std::string>,
+                        std::equal_to<std::string>,
+                        MemoryTrackingAllocator<std::pair<std::string, int>>>;
+
+class OpenHashMapTest : public ::testing::Test {
+public:
+    MemoryTrackingAllocator<std::pair<std::string, int>> allocator;
+    Map map{allocator};
+};
+
+TEST_F(OpenHashMapTest, initAssumptions) {
+    EXPECT_TRUE(map.empty());
+    EXPECT_EQ(0, map.size());
+    EXPECT_TRUE(map.begin() == map.end());
+    EXPECT_TRUE(map.find("key") == map.end());
+    // Nothing is allocated until the first insert.
+    EXPECT_EQ(0, *map.get_allocator().getBytesAllocated());
+}
+
+TEST_F(OpenHashMapTest, emplace) {
+    auto result = map.emplace(std::string("key"), 1);
+    EXPECT_TRUE(result.second);
+    EXPECT_EQ("key", result.first->first);
+    EXPECT_EQ(1, result.first->second);
+
+    // A second emplace of the key doesn't replace the value.
+    result = map.emplace(std::string("key"), 2);
+    EXPECT_FALSE(result.second);
+    EXPECT_EQ(1, result.first->second);
+    EXPECT_EQ(1, map.size());
+
+    // But the value can be updated via the iterator.
+    result.first->second = 3;
+    EXPECT_EQ(3, map.find("key")->second);
+}
+
+// Insert enough keys to grow the table a number of times, checking every key
+// is still found and iteration visits each key once.
+TEST_F(OpenHashMapTest, grow) {
+    std::map<std::string, int> expected;
+    for (int i = 0; i < 10000; i++) {
+        const auto key = "key_" + std::to_string(i);
+        ASSERT_TRUE(map.emplace(key, i).second);
+        expected[key] = i;
+    }
+    EXPECT_EQ(expected.size(), map.size());
+    EXPECT_NE(0, *map.get_allocator().getBytesAllocated());
+
+    for (const auto& kv : expected) {
+        auto it = map.find(kv.first);
+        ASSERT_TRUE(it != map.end()) << kv.first;
+        EXPECT_EQ(kv.second, it->second);
+    }
+    EXPECT_TRUE(map.find("key_10000") == map.end());
+
+    std::map<std::string, int> visited;
+    for (const auto& kv : map) {
+        EXPECT_TRUE(visited.emplace(kv.first, kv.second).second);
+    }
+    EXPECT_EQ(expected, visited);
+}
+
+// All memory is returned to the allocator on destruction.
+TEST(OpenHashMapAllocTest, destroy) {
+    MemoryTrackingAllocator<std::pair<std::string, int>> allocator;
+    {
+        Map map(allocator);
+        for (int i = 0; i < 100; i++) {
+            map.emplace("key_" + std::to_string(i), i);
+        }
+        EXPECT_NE(0, *allocator.getBytesAllocated());
+    }
+    EXPECT_EQ(0, *allocator.getBytesAllocated());
+}
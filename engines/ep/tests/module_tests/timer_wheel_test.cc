@@ -0,0 +1,198 @@
+/* -*- Mode: C++; tab-width: 4; c-basic-offset: 4; indent-tabs-mode: nil -*- */
+/*
+ *     Copyright 2019 Couchbase, Inc.
+ *
+ *   Licensed under the Apache License, Version 2.0 (the "License");
+ *   you may not use this file except in compliance with the License.
+ *   You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   Unless required by applicable law or agreed to in writing, software
+ *   distributed under the License is distributed on an "AS IS" BASIS,
+ *   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *   See the License for the specific language governing permissions and
+ *   limitations under the License.
+ */
+
+#include <folly/portability/GTest.h>
+
+#include "tests/module_tests/executorpool_test.h"
+#include "tests/module_tests/test_task.h"
+#include "timer_wheel.h"
+
+#include <random>
+
+class TimerWheelTest : public ::testing::Test {
+public:
+    ExTask makeTask(std::chrono::steady_clock::time_point waketime,
+                    int order = 0) {
+        ExTask task = std::make_shared<TestTask>(
+                taskable, TaskId::PendingOpsNotification, order);
+        task->updateWaketime(waketime);
+        return task;
+    }
+
+    /// Pop the ready tasks at 'now', returning their orders.
+    std::vector<int> popReady(std::chrono::steady_clock::time_point now) {
+        std::vector<int> orders;
+        wheel.popReady(now, [&orders](ExTask task) {
+            orders.push_back(static_cast<TestTask*>(task.get())->order);
+        });
+        std::sort(orders.begin(), orders.end());
+        return orders;
+    }
+
+    const std::chrono::steady_clock::time_point now =
+            std::chrono::steady_clock::now();
+    TimerWheel wheel;
+    MockTaskable taskable;
+};
+
+TEST_F(TimerWheelTest, initAssumptions) {
+    EXPECT_EQ(0u, wheel.size());
+    EXPECT_TRUE(wheel.empty());
+    EXPECT_EQ(std::chrono::steady_clock::time_point::max(),
+              wheel.nextWaketime());
+    EXPECT_TRUE(popReady(std::chrono::steady_clock::time_point::max()).empty());
+}
+
+// Unlike FutureQueue, a task is only held once.
+TEST_F(TimerWheelTest, pushn) {
+    auto task = makeTask(now + std::chrono::seconds(1));
+    for (int i = 0; i < 10; i++) {
+        wheel.push(task);
+    }
+    EXPECT_EQ(1u, wheel.size());
+    EXPECT_EQ(std::vector<int>{0}, popReady(now + std::chrono::seconds(1)));
+    EXPECT_TRUE(wheel.empty());
+}
+
+// Tasks are only ready once their exact waketime has passed, not when the
+// tick they are in is reached.
+TEST_F(TimerWheelTest, popReadyExact) {
+    const auto base = now + std::chrono::milliseconds(5);
+    for (int i = 0; i < 10; i++) {
+        wheel.push(makeTask(base + std::chrono::microseconds(100 * i), i));
+    }
+    EXPECT_EQ(base, wheel.nextWaketime());
+
+    EXPECT_TRUE(popReady(base - std::chrono::nanoseconds(1)).empty());
+    EXPECT_EQ((std::vector<int>{0, 1, 2}),
+              popReady(base + std::chrono::microseconds(250)));
+    EXPECT_EQ(base + std::chrono::microseconds(300), wheel.nextWaketime());
+    EXPECT_EQ(7u, wheel.size());
+    EXPECT_EQ((std::vector<int>{3, 4, 5, 6, 7, 8, 9}),
+              popReady(base + std::chrono::seconds(1)));
+    EXPECT_TRUE(wheel.empty());
+}
+
+// Tasks in the past (or at min()) are ready immediately.
+TEST_F(TimerWheelTest, pastWaketime) {
+    wheel.push(makeTask(std::chrono::steady_clock::time_point::min(), 1));
+    wheel.push(makeTask(now - std::chrono::hours(1), 2));
+    EXPECT_EQ(std::chrono::steady_clock::time_point::min(),
+              wheel.nextWaketime());
+    EXPECT_EQ((std::vector<int>{1, 2}), popReady(now));
+}
+
+// Tasks spread over every level of the wheel, and beyond it, are cascaded
+// down and returned once ready.
+TEST_F(TimerWheelTest, cascade) {
+    const std::vector<std::chrono::steady_clock::duration> delays = {
+            std::chrono::milliseconds(3),
+            std::chrono::milliseconds(300),
+            std::chrono::seconds(30),
+            std::chrono::minutes(30),
+            std::chrono::hours(10),
+            std::chrono::hours(100)};
+    for (size_t i = 0; i < delays.size(); i++) {
+        wheel.push(makeTask(now + delays[i], int(i)));
+    }
+    wheel.push(makeTask(std::chrono::steady_clock::time_point::max(), 99));
+
+    for (size_t i = 0; i < delays.size(); i++) {
+        // The next waketime is never later than the next task.
+        EXPECT_LE(wheel.nextWaketime(), now + delays[i]);
+        EXPECT_TRUE(popReady(now + delays[i] - std::chrono::nanoseconds(1))
+                            .empty());
+        EXPECT_EQ(std::vector<int>{int(i)}, popReady(now + delays[i]));
+    }
+    EXPECT_EQ(1u, wheel.size());
+}
+
+TEST_F(TimerWheelTest, updateWaketime) {
+    auto task = makeTask(now + std::chrono::hours(1), 1);
+    wheel.push(task);
+    wheel.push(makeTask(now + std::chrono::minutes(1), 2));
+    EXPECT_TRUE(popReady(now).empty());
+
+    EXPECT_TRUE(wheel.updateWaketime(task, now));
+    EXPECT_EQ(now, wheel.nextWaketime());
+    EXPECT_EQ(std::vector<int>{1}, popReady(now));
+    EXPECT_EQ(1u, wheel.size());
+}
+
+TEST_F(TimerWheelTest, snooze) {
+    auto task = makeTask(now, 1);
+    wheel.push(task);
+    wheel.push(makeTask(now, 2));
+
+    EXPECT_TRUE(wheel.snooze(task, 60));
+    EXPECT_EQ(std::vector<int>{2}, popReady(now));
+    EXPECT_EQ(1u, wheel.size());
+    EXPECT_EQ(std::vector<int>{1}, popReady(task->getWaketime()));
+}
+
+/*
+ * snooze/wake a task not in the wheel
+ */
+TEST_F(TimerWheelTest, taskNotInWheel) {
+    wheel.push(makeTask(now + std::chrono::seconds(1), 1));
+
+    auto task = makeTask(now);
+    EXPECT_FALSE(wheel.snooze(task, 5.0));
+    // snooze uses the current time so we'll only check that it moved later.
+    EXPECT_LT(now, task->getWaketime());
+
+    EXPECT_FALSE(wheel.updateWaketime(
+            task, std::chrono::steady_clock::time_point::min()));
+    EXPECT_EQ(std::chrono::steady_clock::time_point::min(),
+              task->getWaketime());
+
+    EXPECT_EQ(1u, wheel.size());
+    EXPECT_TRUE(popReady(now).empty());
+}
+
+// Check the wheel against the expected set of ready tasks, for random
+// waketimes and a clock advancing by random amounts.
+TEST_F(TimerWheelTest, randomised) {
+    std::mt19937 gen(1);
+    std::uniform_int_distribution<int64_t> waketimeUs(0, 10 * 1000 * 1000);
+    std::vector<ExTask> tasks;
+    for (int i = 0; i < 1000; i++) {
+        tasks.push_back(
+                makeTask(now + std::chrono::microseconds(waketimeUs(gen)), i));
+        wheel.push(tasks.back());
+    }
+
+    std::uniform_int_distribution<int64_t> stepUs(0, 50 * 1000);
+    auto clock = now;
+    size_t popped = 0;
+    while (!wheel.empty()) {
+        clock += std::chrono::microseconds(stepUs(gen));
+        std::vector<int> expected;
+        for (const auto& task : tasks) {
+            if (task && task->getWaketime() <= clock) {
+                expected.push_back(static_cast<TestTask*>(task.get())->order);
+            }
+        }
+        const auto ready = popReady(clock);
+        ASSERT_EQ(expected, ready);
+        for (auto order : ready) {
+            tasks[order].reset();
+        }
+        popped += ready.size();
+    }
+    EXPECT_EQ(tasks.size(), popped);
+}
@@ -1328,14 +1328,25 @@ private:
     } dcp_mutation_item;
 
     /**
-     * The dcp_stream map is used to map a cookie to the count of objects
-     * it should send on the stream.
-     *
-     * Each entry in here constists of a pair containing a boolean specifying
-     * if the stream is opened or not, and a count of how many times we should
-     * return data
+     * The state of an internal DCP stream: whether it is opened, how many
+     * more times we should return data, and the seqno of the last mutation
+     * sent (so a client can check they arrive once and in order).
      */
-    std::map<const void*, std::pair<bool, uint64_t>> dcp_stream;
+    struct EwbDcpStream {
+        EwbDcpStream() = default;
+        explicit EwbDcpStream(uint64_t count) : count(count) {
+        }
+
+        bool opened = false;
+        uint64_t count = 0;
+        uint64_t seqno = 0;
+    };
+
+    /**
+     * The dcp_stream map is used to map a cookie to the internal DCP stream
+     * it is reading.
+     */
+    std::map<const void*, EwbDcpStream> dcp_stream;
 
     friend class BlockMonitorThread;
     std::map<uint32_t, const void*> suspended_map;
@@ -1428,9 +1439,9 @@ ENGINE_ERROR_CODE EWB_Engine::step(
         gsl::not_null<struct dcp_message_producers*> producers) {
     auto stream = dcp_stream.find(cookie);
     if (stream != dcp_stream.end()) {
-        auto& count = stream->second.second;
+        auto& state = stream->second;
         // If the stream is enabled and we have data to send..
-        if (stream->second.first && count > 0) {
+        if (state.opened && state.count > 0) {
             // This is using the internal dcp implementation which always
             // send the same item back
             auto ret = producers->mutation(
@@ -1438,12 +1449,18 @@ ENGINE_ERROR_CODE EWB_Engine::step(
                     cb::unique_item_ptr(&dcp_mutation_item,
                                         cb::ItemDeleter(this)),
                     Vbid(0),
-                    0 /*by_seqno*/,
+                    state.seqno + 1 /*by_seqno*/,
                     0 /*rev_seqno*/,
                     0 /*lock_time*/,
                     0 /*nru*/,
                     {});
-            --count;
+            // A message the server couldn't take (E2BIG when its write
+            // buffer is full) is sent again by the next step, as a real
+            // producer does.
+            if (ret == ENGINE_SUCCESS) {
+                --state.count;
+                ++state.seqno;
+            }
             return ret;
         }
         return ENGINE_EWOULDBLOCK;
@@ -1468,11 +1485,10 @@ ENGINE_ERROR_CODE EWB_Engine::open(gsl::not_null<const void*> cookie,
         auto idx = nm.rfind(":");
 
         if (idx != nm.npos) {
-            dcp_stream[cookie] =
-                    std::make_pair(false, std::stoull(nm.substr(idx + 1)));
+            dcp_stream[cookie] = EwbDcpStream(std::stoull(nm.substr(idx + 1)));
         } else {
             dcp_stream[cookie] =
-                    std::make_pair(false, std::numeric_limits<uint64_t>::max());
+                    EwbDcpStream(std::numeric_limits<uint64_t>::max());
         }
         return ENGINE_SUCCESS;
     }
@@ -1505,7 +1521,7 @@ ENGINE_ERROR_CODE EWB_Engine::stream_req(
             return ENGINE_ROLLBACK;
         }
         // Start the stream
-        stream->second.first = true;
+        stream->second.opened = true;
         return ENGINE_SUCCESS;
     }
 
@@ -12,6 +12,7 @@
 #include <string>
 #include <unordered_set>
 #include <utility>
+#include <vector>
 
 #include <boost/optional/optional_fwd.hpp>
 #include <gsl/gsl>
@@ -340,6 +341,32 @@ struct MEMCACHED_PUBLIC_CLASS EngineIface {
                                         Vbid vbucket,
                                         DocStateFilter documentStateFilter) = 0;
 
+    /**
+     * Retrieve a batch of items, typically a run of GETs the frontend found
+     * pipelined on a connection.
+     *
+     * Optional interface; not supported by all engines.
+     *
+     * Unlike get() this never blocks and never notifies the cookie. Only
+     * cb::engine_errc::success and cb::engine_errc::no_such_key are final;
+     * for any other status the caller should retry the key with get(), which
+     * applies the full semantics (blocking, vbucket state, error context...).
+     * An engine may start fetching keys it can't return immediately so that
+     * such a retry finds them resident (or already being fetched).
+     *
+     * @param cookie The cookie provided by the frontend
+     * @param keys the keys (and their virtual bucket ids) to look up
+     * @param documentStateFilter as for get()
+     * @return one entry per key, in the order of keys (or an empty vector if
+     *         not supported)
+     */
+    virtual std::vector<cb::EngineErrorItemPair> get_multi(
+            gsl::not_null<const void*> cookie,
+            const std::vector<std::pair<DocKey, Vbid>>& keys,
+            DocStateFilter documentStateFilter) {
+        return {};
+    }
+
     /**
      * Optionally retrieve an item. Only non-deleted items may be fetched
      * through this interface (Documents in deleted state may be evicted
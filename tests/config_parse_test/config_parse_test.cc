@@ -885,6 +885,28 @@ TEST_F(SettingsTest, max_concurrent_commands_per_connection) {
     EXPECT_TRUE(settings.has.max_concurrent_commands_per_connection);
 }
 
+TEST_F(SettingsTest, SendBatchSize) {
+    nonNumericValuesShouldFail("send_batch_size");
+
+    nlohmann::json obj;
+    const std::size_t size = 65536;
+    obj["send_batch_size"] = size;
+    Settings settings(obj);
+    EXPECT_EQ(size, settings.getSendBatchSize());
+    EXPECT_TRUE(settings.has.send_batch_size);
+}
+
+TEST_F(SettingsTest, ZerocopyThreshold) {
+    nonNumericValuesShouldFail("zerocopy_threshold");
+
+    nlohmann::json obj;
+    const std::size_t size = 65536;
+    obj["zerocopy_threshold"] = size;
+    Settings settings(obj);
+    EXPECT_EQ(size, settings.getZerocopyThreshold());
+    EXPECT_TRUE(settings.has.zerocopy_threshold);
+}
+
 TEST_F(SettingsTest, SaslMechanisms) {
     nonStringValuesShouldFail("sasl_mechanisms");
 
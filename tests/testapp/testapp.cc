@@ -477,6 +477,12 @@ nlohmann::json TestappTest::generate_config(uint16_t ssl_port) {
         ret["verbosity"] = memcached_verbose - 1;
     }
 
+    // Allow the test suites to be run with response batching enabled
+    const char* sendBatchSize = getenv("TESTAPP_SEND_BATCH_SIZE");
+    if (sendBatchSize != nullptr) {
+        ret["send_batch_size"] = std::stoul(sendBatchSize);
+    }
+
     // For simplicity in the test to check for max connections we mark the
     // SSL port as an admin port
     ret["interfaces"][0] = {{"tag", "plain"},
@@ -27,9 +27,46 @@
 #include <xattr/utils.h>
 
 class DcpTest : public TestappClientTest {
-
+protected:
+    /**
+     * Stream `count` mutations from the ewouldblock engine's internal DCP
+     * producer, and check that each arrives exactly once and in order.
+     */
+    void streamAndCheckOrder(uint64_t count);
 };
 
+void DcpTest::streamAndCheckOrder(uint64_t count) {
+    auto& conn = getConnection();
+    conn.sendCommand(BinprotDcpOpenCommand{
+            "ewb_internal:" + std::to_string(count),
+            0,
+            cb::mcbp::request::DcpOpenPayload::Producer});
+
+    BinprotResponse rsp;
+    conn.recvResponse(rsp);
+    ASSERT_TRUE(rsp.isSuccess());
+
+    conn.sendCommand(BinprotDcpStreamRequestCommand{});
+    conn.recvResponse(rsp);
+    ASSERT_TRUE(rsp.isSuccess());
+
+    Frame frame;
+    for (uint64_t seqno = 1; seqno <= count; ++seqno) {
+        conn.recvFrame(frame);
+        ASSERT_EQ(cb::mcbp::Magic::ClientRequest, frame.getMagic());
+        const auto* request = frame.getRequest();
+        ASSERT_EQ(cb::mcbp::ClientOpcode::DcpMutation,
+                  request->getClientOpcode());
+        const auto extras = request->getExtdata();
+        ASSERT_EQ(sizeof(cb::mcbp::request::DcpMutationPayload),
+                  extras.size());
+        const auto* payload =
+                reinterpret_cast<const cb::mcbp::request::DcpMutationPayload*>(
+                        extras.data());
+        ASSERT_EQ(seqno, payload->getBySeqno());
+    }
+}
+
 INSTANTIATE_TEST_CASE_P(TransportProtocols,
                         DcpTest,
                         ::testing::Values(TransportProtocols::McbpPlain,
@@ -165,3 +202,29 @@ TEST_P(DcpTest, MB35928_DcpCantReauthenticate) {
                 << "SASL AUTH should fail";
     }
 }
+
+/**
+ * conn_ship_log queues as many DCP messages as the producer has ready before
+ * writing them. Check a batch cut short by the producer running out of
+ * messages (step returning EWOULDBLOCK after some were queued) is sent.
+ */
+TEST_P(DcpTest, ShipLogPartialBatch) {
+    // Fewer than the default requests per event, so the whole stream is one
+    // batch ending with EWOULDBLOCK.
+    streamAndCheckOrder(7);
+}
+
+/**
+ * As above, but with enough messages per event to fill the connection's
+ * write buffer (step returning E2BIG) in every batch; the message which
+ * didn't fit must be sent (once) at the start of the next batch.
+ */
+TEST_P(DcpTest, ShipLogBatchFillsWriteBuffer) {
+    memcached_cfg["default_reqs_per_event"] = 200;
+    reconfigure();
+
+    streamAndCheckOrder(1000);
+
+    memcached_cfg["default_reqs_per_event"] = 20;
+    reconfigure();
+}
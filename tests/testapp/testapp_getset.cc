@@ -608,6 +608,31 @@ TEST_P(GetSetTest, TestGetSuccess) {
     EXPECT_EQ(document.value, stored.value);
 }
 
+/// Verify that large values are returned intact when sent with MSG_ZEROCOPY
+TEST_P(GetSetTest, TestGetSuccessZerocopy) {
+    memcached_cfg["zerocopy_threshold"] = 16 * 1024;
+    reconfigure();
+
+    MemcachedConnection& conn = getConnection();
+    document.info.datatype = cb::mcbp::Datatype::Raw;
+    document.value.resize(1024 * 1024);
+    for (size_t ii = 0; ii < document.value.size(); ++ii) {
+        document.value[ii] = char('a' + (ii % 26));
+    }
+    conn.mutate(document, Vbid(0), MutationType::Set);
+
+    // Fetch it a number of times so that we've got sends in flight while
+    // the (possibly out of order) completions for the earlier ones arrive
+    for (int ii = 0; ii < 10; ++ii) {
+        const auto stored = conn.get(name, Vbid(0));
+        EXPECT_EQ(document.info.flags, stored.info.flags);
+        EXPECT_EQ(document.value, stored.value);
+    }
+
+    memcached_cfg["zerocopy_threshold"] = 0;
+    reconfigure();
+}
+
 TEST_P(GetSetTest, TestAppend) {
     MemcachedConnection& conn = getConnection();
     document.info.datatype = cb::mcbp::Datatype::Raw;
@@ -255,6 +255,46 @@ TEST_P(McdTestappTest, GetK) {
     delete_object(key);
 }
 
+// A pipeline of GETs for different keys (hits and misses) is looked up in
+// one batch by the server; check each still gets its own response, in order.
+TEST_P(McdTestappTest, GetKPipelineMixed) {
+    const int numKeys = 20;
+    for (int ii = 0; ii < numKeys; ii += 2) {
+        store_document("test_getk_pipeline_" + std::to_string(ii), "value");
+    }
+
+    std::vector<uint8_t> blob;
+    for (int ii = 0; ii < numKeys; ++ii) {
+        BinprotGenericCommand get(ClientOpcode::Getk,
+                                  "test_getk_pipeline_" + std::to_string(ii));
+        std::vector<uint8_t> buf;
+        get.encode(buf);
+        reinterpret_cast<Request*>(buf.data())->setOpaque(ii);
+        std::copy(buf.begin(), buf.end(), std::back_inserter(blob));
+    }
+    safe_send(blob);
+
+    for (int ii = 0; ii < numKeys; ++ii) {
+        ASSERT_TRUE(safe_recv_packet(blob));
+        auto& response = *reinterpret_cast<Response*>(blob.data());
+        EXPECT_EQ(uint32_t(ii), response.getOpaque());
+        BinprotGetResponse rsp;
+        rsp.assign(std::move(blob));
+        EXPECT_EQ("test_getk_pipeline_" + std::to_string(ii),
+                  rsp.getKeyString());
+        if (ii % 2 == 0) {
+            EXPECT_EQ(Status::Success, rsp.getStatus());
+            EXPECT_EQ("value", rsp.getDataString());
+        } else {
+            EXPECT_EQ(Status::KeyEnoent, rsp.getStatus());
+        }
+    }
+
+    for (int ii = 0; ii < numKeys; ii += 2) {
+        delete_object("test_getk_pipeline_" + std::to_string(ii));
+    }
+}
+
 static void test_getq_impl(const char* key, ClientOpcode cmd) {
     BinprotGenericCommand command(cmd, key);
     std::vector<uint8_t> blob;